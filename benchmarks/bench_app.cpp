@@ -0,0 +1,635 @@
+#include "bench_common.h"
+#include "inference_opencl.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/model/Model.h"
+#include "nn/model/TFLiteLoader.h"
+#include "nn/kernels/SimdDispatch.h"
+#include "nn/kernels/ThreadPool.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Conv2D.h"
+#include "nn/layer/QuantizedDense.h"
+#include "nn/layer/QuantizedConv2D.h"
+#include "nn/layer/Pool2D.h"
+#include "nn/layer/GlobalAveragePool.h"
+#include "nn/layer/Flatten.h"
+#include "nn/layer/Reshape.h"
+#include "nn/layer/Activation.h"
+
+#include <CL/cl.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+* @brief  the benchmark suite: GEMM shapes, elementwise ops, argmax, every layer type and the MNIST model,
+*         on the host and on the OpenCL device
+* @note   every benchmark warms up, calibrates how many calls one repetition takes (see sample_per_call_us)
+*         and times the repetitions. GFLOP/s and GB/s are computed from the median time, with the bytes
+*         every call must read and write once. Results are printed and written as JSON, by default to
+*         bench_output.txt, so two runs can be diffed by benchmark name.
+*         Layers run as one-layer models through Model::execute, like they would in a network.
+*         OpenCL is skipped if the ICD loader finds no device (e.g. install PoCL for a CPU runtime).
+*         Usage: bench_app [--filter SUBSTRING] [--repetitions N] [--warmup N] [--min-time-us US]
+*                          [--platform host|opencl|all] [--output PATH] [--model PATH]
+*/
+namespace
+{
+    struct BenchSettings
+    {
+        size_t      warmup = 5u;
+        size_t      repetitions = 30u;
+        double      min_repetition_us = 200.0;
+        std::string filter;
+        bool        host = true;
+        bool        opencl = true;
+        std::string output_path = "bench_output.txt";
+        std::string model_path = std::string(MODELS_DIR) + "/TFLite/mnist_model.tflite";
+    };
+
+    // where the benchmarks run: host tensors, or TensorOpenCL whose work sync waits for
+    struct Backend
+    {
+        std::string                     platform;
+        std::function<Tensor<float>*()> make_tensor;
+        std::function<void()>           sync;
+        bool                            on_device = false;
+    };
+
+    struct BenchResult
+    {
+        std::string  name;
+        std::string  group;
+        std::string  platform;
+        std::vector<std::pair<std::string, size_t>> params;
+        BenchSamples samples;
+        double       flops = 0.0;   // per call, 0 if not counted
+        double       bytes = 0.0;
+    };
+
+    using Params = std::vector<std::pair<std::string, size_t>>;
+
+    std::vector<int8_t> make_random_int8(size_t size, unsigned seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dist(-127, 127);
+        std::vector<int8_t> data(size);
+        for (auto& value : data)
+        {
+            value = static_cast<int8_t>(dist(gen));
+        }
+        return data;
+    }
+
+    size_t get_size(const std::vector<size_t>& dims)
+    {
+        return std::accumulate(dims.cbegin(), dims.cend(), size_t{1}, std::multiplies<size_t>());
+    }
+
+    // random data of dims on the backend's platform
+    std::unique_ptr<Tensor<float>> make_input(const Backend& backend, const std::vector<size_t>& dims, unsigned seed)
+    {
+        std::unique_ptr<Tensor<float>> tensor(backend.make_tensor());
+        tensor->set_host_data(make_random_data(get_size(dims), seed));
+        tensor->set_dims(dims);
+        if (backend.on_device)
+        {
+            tensor->load_to_device();
+        }
+        return tensor;
+    }
+
+    // resized by the first call that writes it
+    std::unique_ptr<Tensor<float>> make_result(const Backend& backend)
+    {
+        std::unique_ptr<Tensor<float>> tensor(backend.make_tensor());
+        tensor->set_host_data({0.0f});
+        if (backend.on_device)
+        {
+            tensor->load_to_device();
+        }
+        return tensor;
+    }
+
+    // weights stay on the host until the layer or model moves them
+    std::unique_ptr<Tensor<float>> make_weight(const Backend& backend, const std::vector<size_t>& dims, unsigned seed)
+    {
+        std::unique_ptr<Tensor<float>> tensor(backend.make_tensor());
+        tensor->set_host_data(make_random_data(get_size(dims), seed));
+        tensor->set_dims(dims);
+        return tensor;
+    }
+
+    std::string escape_json(const std::string& text)
+    {
+        std::string escaped;
+        for (const auto c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    class BenchSuite
+    {
+    public:
+        explicit BenchSuite(const BenchSettings& settings) : m_settings(settings)
+        {
+        }
+
+        const BenchSettings& get_settings() const
+        {
+            return m_settings;
+        }
+
+        // group/platform/key=value,... is the name runs are matched by
+        std::string get_name(const std::string& group, const std::string& platform, const std::string& label, const Params& params) const
+        {
+            std::string name = group + "/" + platform + "/" + label;
+            for (auto i = 0u; i < params.size(); ++i)
+            {
+                name += (i == 0u ? ":" : ",") + params[i].first + "=" + std::to_string(params[i].second);
+            }
+            return name;
+        }
+
+        bool is_selected(const std::string& group, const std::string& platform, const std::string& label, const Params& params) const
+        {
+            return m_settings.filter.empty() || get_name(group, platform, label, params).find(m_settings.filter) != std::string::npos;
+        }
+
+        template<typename FUNC>
+        void run(const std::string& group, const Backend& backend, const std::string& label, const Params& params,
+                 double flops, double bytes, FUNC&& func)
+        {
+            BenchResult result;
+            result.name = get_name(group, backend.platform, label, params);
+            result.group = group;
+            result.platform = backend.platform;
+            result.params = params;
+            result.flops = flops;
+            result.bytes = bytes;
+            result.samples = sample_per_call_us(func, backend.sync, m_settings.repetitions, m_settings.warmup, 0u,
+                                                m_settings.min_repetition_us);
+
+            const auto p50 = get_percentile(result.samples.times_us, 0.5);
+            std::printf("%-64s %11.2f %11.2f %11.2f", result.name.c_str(), p50,
+                        get_percentile(result.samples.times_us, 0.9), get_percentile(result.samples.times_us, 0.99));
+            print_rate(flops, p50);
+            print_rate(bytes, p50);
+            std::printf("\n");
+            std::fflush(stdout);
+            m_results.push_back(std::move(result));
+        }
+
+        void write_json(std::ostream& out, const std::string& opencl_device) const
+        {
+            char timestamp[32];
+            const auto now = std::time(nullptr);
+            std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+            out << "{\n";
+            out << "  \"schema_version\": 1,\n";
+            out << "  \"timestamp\": \"" << timestamp << "\",\n";
+            out << "  \"environment\": {\"simd_isa\": \"" << get_simd_isa_name(get_simd_isa()) << "\", \"hardware_threads\": "
+                << ThreadPool::get_hardware_threads() << ", \"pool_threads\": " << ThreadPool::get_default()->get_num_threads()
+                << ", \"opencl_device\": \"" << escape_json(opencl_device) << "\"},\n";
+            out << "  \"settings\": {\"warmup\": " << m_settings.warmup << ", \"repetitions\": " << m_settings.repetitions
+                << ", \"min_repetition_us\": " << m_settings.min_repetition_us << "},\n";
+            out << "  \"benchmarks\": [";
+            for (auto i = 0u; i < m_results.size(); ++i)
+            {
+                const auto& result = m_results[i];
+                const auto& times = result.samples.times_us;
+                const auto p50 = get_percentile(times, 0.5);
+                const auto mean = std::accumulate(times.cbegin(), times.cend(), 0.0) / static_cast<double>(std::max<size_t>(times.size(), 1u));
+
+                out << (i == 0u ? "\n" : ",\n");
+                out << "    {\"name\": \"" << escape_json(result.name) << "\", \"group\": \"" << result.group
+                    << "\", \"platform\": \"" << result.platform << "\", \"params\": {";
+                for (auto j = 0u; j < result.params.size(); ++j)
+                {
+                    out << (j == 0u ? "" : ", ") << "\"" << result.params[j].first << "\": " << result.params[j].second;
+                }
+                out << "},\n";
+                out << "     \"repetitions\": " << times.size() << ", \"calls_per_repetition\": " << result.samples.calls_per_repetition << ",\n";
+                out << "     \"time_us\": {\"min\": " << get_percentile(times, 0.0) << ", \"mean\": " << mean << ", \"p50\": " << p50
+                    << ", \"p90\": " << get_percentile(times, 0.9) << ", \"p99\": " << get_percentile(times, 0.99)
+                    << ", \"max\": " << get_percentile(times, 1.0) << "},\n";
+                out << "     \"flops\": " << result.flops << ", \"bytes\": " << result.bytes << ", \"gflops\": ";
+                write_rate(out, result.flops, p50);
+                out << ", \"gbps\": ";
+                write_rate(out, result.bytes, p50);
+                out << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+    private:
+        // per microsecond is 1e-3 giga per second
+        static void print_rate(double amount, double us)
+        {
+            if (amount > 0.0 && us > 0.0)
+            {
+                std::printf(" %10.2f", amount / us * 1e-3);
+            }
+            else
+            {
+                std::printf(" %10s", "-");
+            }
+        }
+
+        static void write_rate(std::ostream& out, double amount, double us)
+        {
+            if (amount > 0.0 && us > 0.0)
+            {
+                out << amount / us * 1e-3;
+            }
+            else
+            {
+                out << "null";
+            }
+        }
+
+        BenchSettings            m_settings;
+        std::vector<BenchResult> m_results;
+    };
+
+    // A {m, k} x B {k, n}
+    void bench_gemm(BenchSuite& suite, const Backend& backend)
+    {
+        const std::vector<std::vector<size_t>> shapes = {{64u, 64u, 64u}, {256u, 256u, 256u}, {512u, 512u, 512u},
+                                                         {64u, 1600u, 64u}, {1u, 4096u, 4096u}};
+        for (const auto& shape : shapes)
+        {
+            const auto m = shape[0], k = shape[1], n = shape[2];
+            const Params params = {{"m", m}, {"k", k}, {"n", n}};
+            if (!suite.is_selected("gemm", backend.platform, "multiply", params))
+            {
+                continue;
+            }
+            auto a = make_input(backend, {m, k}, 1u);
+            auto b = make_input(backend, {k, n}, 2u);
+            auto c = make_result(backend);
+            suite.run("gemm", backend, "multiply", params, 2.0 * m * n * k, 4.0 * (m * k + k * n + m * n),
+                      [&]() { a->multiply(b.get(), c.get()); });
+        }
+    }
+
+    void bench_elementwise(BenchSuite& suite, const Backend& backend)
+    {
+        for (const size_t size : {size_t{1} << 12, size_t{1} << 20, size_t{1} << 24})
+        {
+            const Params params = {{"elements", size}};
+            if (suite.is_selected("elementwise", backend.platform, "add", params) ||
+                suite.is_selected("elementwise", backend.platform, "relu", params))
+            {
+                auto a = make_input(backend, {1u, size}, 1u);
+                auto b = make_input(backend, {1u, size}, 2u);
+                auto c = make_result(backend);
+                if (suite.is_selected("elementwise", backend.platform, "add", params))
+                {
+                    suite.run("elementwise", backend, "add", params, size, 12.0 * size, [&]() { a->add(b.get(), c.get()); });
+                }
+                if (suite.is_selected("elementwise", backend.platform, "relu", params))
+                {
+                    suite.run("elementwise", backend, "relu", params, size, 8.0 * size, [&]() { a->relu(c.get()); });
+                }
+            }
+        }
+    }
+
+    // one index per row
+    void bench_argmax(BenchSuite& suite, const Backend& backend)
+    {
+        const std::vector<std::pair<size_t, size_t>> shapes = {{1u, 1000u}, {64u, 1000u}, {1u, size_t{1} << 20}, {1024u, 4096u}};
+        for (const auto& shape : shapes)
+        {
+            const Params params = {{"rows", shape.first}, {"cols", shape.second}};
+            if (!suite.is_selected("argmax", backend.platform, "argmax", params))
+            {
+                continue;
+            }
+            const auto size = shape.first * shape.second;
+            auto a = make_input(backend, {shape.first, shape.second}, 1u);
+            auto c = make_result(backend);
+            suite.run("argmax", backend, "argmax", params, size, 4.0 * (size + shape.first), [&]() { a->argmax(c.get()); });
+        }
+    }
+
+    // layer as a one-layer model, bytes are the input, the output and weight_bytes
+    void bench_layer(BenchSuite& suite, const Backend& backend, const std::string& label, const Params& params, Layer* layer,
+                     const std::vector<size_t>& input_dims, double flops, double weight_bytes)
+    {
+        Model model;
+        model.add_layer(layer);
+        if (backend.on_device)
+        {
+            model.to_device();
+        }
+        else
+        {
+            model.to_host();
+        }
+        auto input = make_input(backend, input_dims, 7u);
+        auto result = make_result(backend);
+
+        const auto output_size = get_size(layer->get_output_dims(input_dims));
+        const auto bytes = layer->is_view() ? 0.0 : 4.0 * (get_size(input_dims) + output_size) + weight_bytes;
+        suite.run("layer", backend, label, params, flops, bytes, [&]() { model.execute(input.get(), result.get()); });
+    }
+
+    void bench_dense(BenchSuite& suite, const Backend& backend)
+    {
+        const size_t k = 1024u, n = 1024u;
+        const std::vector<std::pair<const char*, WEIGHT_FORMAT>> formats = {{"dense_fp32", WEIGHT_FORMAT::FP32},
+                                                                            {"dense_fp16", WEIGHT_FORMAT::FP16},
+                                                                            {"dense_bf16", WEIGHT_FORMAT::BF16}};
+        for (const auto& format : formats)
+        {
+            for (const size_t batch : {1u, 64u})
+            {
+                const Params params = {{"batch", batch}, {"k", k}, {"n", n}};
+                if (!suite.is_selected("layer", backend.platform, format.first, params))
+                {
+                    continue;
+                }
+                auto weight = make_weight(backend, {k, n}, 1u);
+                auto bias = make_weight(backend, {1u, n}, 2u);
+                Dense dense;
+                dense.set_weight(weight.get());
+                dense.set_bias(bias.get());
+                dense.set_weight_format(format.second);
+                const auto weight_bytes = static_cast<double>(dense.get_weight_bytes() + 4u * n);
+                bench_layer(suite, backend, format.first, params, &dense, {batch, k}, 2.0 * batch * k * n, weight_bytes);
+            }
+        }
+    }
+
+    void bench_conv2d(BenchSuite& suite, const Backend& backend)
+    {
+        const size_t size = 56u, in_c = 64u;
+        struct ConvCase
+        {
+            const char* label;
+            size_t      kernel;
+            size_t      out_c;
+            bool        winograd;
+        };
+        const std::vector<ConvCase> cases = {{"conv2d_3x3_winograd", 3u, 64u, true}, {"conv2d_3x3_im2col", 3u, 64u, false},
+                                             {"conv2d_1x1", 1u, 128u, false}};
+        for (const auto& conv_case : cases)
+        {
+            const Params params = {{"h", size}, {"w", size}, {"in_c", in_c}, {"out_c", conv_case.out_c}};
+            if (!suite.is_selected("layer", backend.platform, conv_case.label, params))
+            {
+                continue;
+            }
+            const std::vector<size_t> weight_dims = {conv_case.out_c, conv_case.kernel, conv_case.kernel, in_c};
+            auto weight = make_weight(backend, weight_dims, 1u);
+            auto bias = make_weight(backend, {1u, conv_case.out_c}, 2u);
+            Conv2D conv(1u, 1u, PADDING::SAME);
+            conv.set_weight(weight.get());
+            conv.set_bias(bias.get());
+            conv.set_winograd_enabled(conv_case.winograd);
+            const auto flops = 2.0 * size * size * conv_case.out_c * conv_case.kernel * conv_case.kernel * in_c;
+            bench_layer(suite, backend, conv_case.label, params, &conv, {1u, size, size, in_c}, flops, 4.0 * get_size(weight_dims));
+        }
+    }
+
+    void bench_quantized(BenchSuite& suite, const Backend& backend)
+    {
+        std::unique_ptr<Tensor<float>> factory(backend.make_tensor());
+        QuantizationParams quantization;
+        quantization.scales = {1.0f / 127.0f};
+        quantization.zero_points = {0};
+
+        const size_t batch = 64u, k = 1024u, n = 1024u;
+        const Params dense_params = {{"batch", batch}, {"k", k}, {"n", n}};
+        if (suite.is_selected("layer", backend.platform, "quantized_dense", dense_params))
+        {
+            std::unique_ptr<Tensor<int8_t>> weight(factory->create_empty_int8());
+            weight->set_host_data(make_random_int8(n * k, 1u));
+            weight->set_dims({n, k});
+            std::unique_ptr<Tensor<int32_t>> bias(factory->create_empty_int32());
+            bias->set_host_data(std::vector<int32_t>(n, 100));
+            bias->set_dims({1u, n});
+            QuantizedDense dense;
+            dense.set_weight(weight.get(), quantization);
+            dense.set_bias(bias.get());
+            dense.set_input_quantization(1.0f / 127.0f, 0);
+            dense.set_output_quantization(1.0f / 16.0f, 0);
+            bench_layer(suite, backend, "quantized_dense", dense_params, &dense, {batch, k}, 2.0 * batch * k * n, n * k + 4.0 * n);
+        }
+
+        const size_t size = 56u, channels = 64u;
+        const Params conv_params = {{"h", size}, {"w", size}, {"in_c", channels}, {"out_c", channels}};
+        if (suite.is_selected("layer", backend.platform, "quantized_conv2d_3x3", conv_params))
+        {
+            std::unique_ptr<Tensor<int8_t>> weight(factory->create_empty_int8());
+            weight->set_host_data(make_random_int8(channels * 9u * channels, 1u));
+            weight->set_dims({channels, 3u, 3u, channels});
+            std::unique_ptr<Tensor<int32_t>> bias(factory->create_empty_int32());
+            bias->set_host_data(std::vector<int32_t>(channels, 100));
+            bias->set_dims({1u, channels});
+            QuantizedConv2D conv(1u, 1u, PADDING::SAME);
+            conv.set_weight(weight.get(), quantization);
+            conv.set_bias(bias.get());
+            conv.set_input_quantization(1.0f / 127.0f, 0);
+            conv.set_output_quantization(1.0f / 16.0f, 0);
+            const auto flops = 2.0 * size * size * channels * 9u * channels;
+            bench_layer(suite, backend, "quantized_conv2d_3x3", conv_params, &conv, {1u, size, size, channels}, flops,
+                        channels * 9.0 * channels + 4.0 * channels);
+        }
+    }
+
+    void bench_pooling(BenchSuite& suite, const Backend& backend)
+    {
+        const std::vector<size_t> input_dims = {1u, 112u, 112u, 64u};
+        const Params params = {{"h", input_dims[1]}, {"w", input_dims[2]}, {"c", input_dims[3]}};
+        for (const auto pooling : {POOLING::MAX, POOLING::AVERAGE})
+        {
+            const auto label = pooling == POOLING::MAX ? "max_pool_2x2" : "average_pool_2x2";
+            if (suite.is_selected("layer", backend.platform, label, params))
+            {
+                Pool2D pool(pooling, 2u, 2u, 2u, 2u);
+                bench_layer(suite, backend, label, params, &pool, input_dims, get_size(input_dims), 0.0);
+            }
+        }
+
+        const std::vector<size_t> gap_dims = {8u, 7u, 7u, 1024u};
+        const Params gap_params = {{"batch", gap_dims[0]}, {"h", gap_dims[1]}, {"w", gap_dims[2]}, {"c", gap_dims[3]}};
+        if (suite.is_selected("layer", backend.platform, "global_average_pool", gap_params))
+        {
+            GlobalAveragePool pool;
+            bench_layer(suite, backend, "global_average_pool", gap_params, &pool, gap_dims, get_size(gap_dims), 0.0);
+        }
+    }
+
+    // views and activations
+    void bench_shape_layers(BenchSuite& suite, const Backend& backend)
+    {
+        const std::vector<size_t> view_dims = {64u, 7u, 7u, 64u};
+        const Params view_params = {{"batch", view_dims[0]}, {"h", view_dims[1]}, {"w", view_dims[2]}, {"c", view_dims[3]}};
+        if (suite.is_selected("layer", backend.platform, "flatten", view_params))
+        {
+            Flatten flatten;
+            bench_layer(suite, backend, "flatten", view_params, &flatten, view_dims, 0.0, 0.0);
+        }
+        if (suite.is_selected("layer", backend.platform, "reshape", view_params))
+        {
+            Reshape reshape({view_dims[1] * view_dims[2], view_dims[3]});
+            bench_layer(suite, backend, "reshape", view_params, &reshape, view_dims, 0.0, 0.0);
+        }
+
+        const std::vector<size_t> activation_dims = {64u, 4096u};
+        const Params activation_params = {{"batch", activation_dims[0]}, {"n", activation_dims[1]}};
+        if (suite.is_selected("layer", backend.platform, "relu", activation_params))
+        {
+            Activation relu(ACTIVATION::RELU);
+            bench_layer(suite, backend, "relu", activation_params, &relu, activation_dims, get_size(activation_dims), 0.0);
+        }
+        if (suite.is_selected("layer", backend.platform, "argmax", activation_params))
+        {
+            Activation argmax(ACTIVATION::ARGMAX);
+            bench_layer(suite, backend, "argmax", activation_params, &argmax, activation_dims, get_size(activation_dims), 0.0);
+        }
+        if (suite.is_selected("layer", backend.platform, "softmax", activation_params))
+        {
+            Activation softmax(ACTIVATION::SOFTMAX);
+            bench_layer(suite, backend, "softmax", activation_params, &softmax, activation_dims, get_size(activation_dims), 0.0);
+        }
+    }
+
+    void bench_model(BenchSuite& suite, const Backend& backend)
+    {
+        for (const size_t batch : {1u, 64u})
+        {
+            const Params params = {{"batch", batch}};
+            if (!suite.is_selected("model", backend.platform, "mnist", params))
+            {
+                continue;
+            }
+            const TFLiteLoader loader(suite.get_settings().model_path);
+            Model model;
+            loader.load(model, backend.make_tensor);
+            if (backend.on_device)
+            {
+                model.to_device();
+            }
+            else
+            {
+                model.to_host();
+            }
+
+            auto input_dims = loader.get_input_dims();
+            input_dims[0] = batch;
+            auto input = make_input(backend, input_dims, 7u);
+            auto result = make_result(backend);
+            // the bytes of the weights, read once per batch
+            suite.run("model", backend, "mnist", params, 0.0, static_cast<double>(loader.get_file().size()),
+                      [&]() { model.execute(input.get(), result.get()); });
+        }
+    }
+
+    void run_all(BenchSuite& suite, const Backend& backend)
+    {
+        bench_gemm(suite, backend);
+        bench_elementwise(suite, backend);
+        bench_argmax(suite, backend);
+        bench_dense(suite, backend);
+        bench_conv2d(suite, backend);
+        bench_quantized(suite, backend);
+        bench_pooling(suite, backend);
+        bench_shape_layers(suite, backend);
+        bench_model(suite, backend);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    for (auto i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string value = argv[i + 1];
+        if (std::strcmp(argv[i], "--filter") == 0)
+        {
+            settings.filter = value;
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0)
+        {
+            settings.repetitions = std::max<size_t>(std::stoul(value), 1u);
+        }
+        else if (std::strcmp(argv[i], "--warmup") == 0)
+        {
+            settings.warmup = std::stoul(value);
+        }
+        else if (std::strcmp(argv[i], "--min-time-us") == 0)
+        {
+            settings.min_repetition_us = std::stod(value);
+        }
+        else if (std::strcmp(argv[i], "--platform") == 0)
+        {
+            settings.host = value == "host" || value == "all";
+            settings.opencl = value == "opencl" || value == "all";
+        }
+        else if (std::strcmp(argv[i], "--output") == 0)
+        {
+            settings.output_path = value;
+        }
+        else if (std::strcmp(argv[i], "--model") == 0)
+        {
+            settings.model_path = value;
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    BenchSuite suite(settings);
+    std::printf("%-64s %11s %11s %11s %10s %10s\n", "benchmark", "p50 [us]", "p90 [us]", "p99 [us]", "GFLOP/s", "GB/s");
+    if (settings.host)
+    {
+        run_all(suite, {"host", []() { return new Tensor<float>(); }, []() {}, false});
+    }
+
+    const auto opencl_device = settings.opencl ? find_opencl_device() : std::string();
+    if (settings.opencl && opencl_device.empty())
+    {
+        std::printf("no OpenCL device found, skipping the opencl benchmarks\n");
+    }
+    if (!opencl_device.empty())
+    {
+        auto runtime = create_opencl_runtime(0, false);
+        {
+            const Backend backend = {"opencl",
+                                     [&]() { return new TensorOpenCL<float>(runtime.program, runtime.queue, runtime.context); },
+                                     [&]() { clFinish(runtime.queue); }, true};
+            run_all(suite, backend);
+        }
+        release_opencl_runtime(runtime);
+    }
+
+    std::ofstream out(settings.output_path);
+    suite.write_json(out, opencl_device);
+    if (!out)
+    {
+        std::fprintf(stderr, "could not write %s\n", settings.output_path.c_str());
+        return 1;
+    }
+    std::printf("results written to %s\n", settings.output_path.c_str());
+}
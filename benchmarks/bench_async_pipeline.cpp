@@ -0,0 +1,130 @@
+#include "bench_common.h"
+#include "inference_opencl.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+* @brief  request throughput of blocking execution against double-buffered execution
+* @note   an MLP of three 512 wide Dense layers and an argmax, every request is a batch of 64.
+*         "blocking" uploads, executes and downloads one request at a time, "pipelined" uses
+*         Model::execute_pipelined on an in-order and on an out-of-order queue
+*/
+namespace
+{
+    const size_t WIDTH = 512u;
+    const size_t BATCH = 64u;
+    const size_t NUM_LAYERS = 3u;
+
+    // requests per second over num_requests requests
+    double run(cl_command_queue_properties queue_properties, bool pipelined, size_t num_requests)
+    {
+        auto runtime = create_opencl_runtime(queue_properties, false);
+        auto make_tensor = [&]() { return std::make_unique<TensorOpenCL<float>>(runtime.program, runtime.queue, runtime.context); };
+
+        double requests_per_second = 0.0;
+        {
+            std::vector<std::unique_ptr<TensorOpenCL<float>>> parameters;
+            std::vector<std::unique_ptr<Layer>> layers;
+            auto model = Model();
+            for (auto i = 0u; i < NUM_LAYERS; ++i)
+            {
+                auto weight = make_tensor();
+                weight->set_host_data(make_random_data(WIDTH * WIDTH, i, 0.1f));
+                weight->set_dims({WIDTH, WIDTH});
+                auto bias = make_tensor();
+                bias->set_host_data(make_random_data(WIDTH, i + 100u, 0.1f));
+                bias->set_dims({1, WIDTH});
+
+                auto dense = std::make_unique<Dense>();
+                dense->set_weight(weight.get());
+                dense->set_bias(bias.get());
+                model.add_layer(dense.get());
+                layers.emplace_back(std::move(dense));
+                layers.emplace_back(std::make_unique<Activation>(ACTIVATION::RELU));
+                model.add_layer(layers.back().get());
+                parameters.emplace_back(std::move(weight));
+                parameters.emplace_back(std::move(bias));
+            }
+            layers.emplace_back(std::make_unique<Activation>(ACTIVATION::ARGMAX));
+            model.add_layer(layers.back().get());
+            model.to_device();
+
+            const auto input_data = make_random_data(BATCH * WIDTH, 7u, 0.1f);
+            auto make_requests = [&](std::vector<std::unique_ptr<TensorOpenCL<float>>>& owners,
+                                     std::vector<Tensor<float>*>& inputs, std::vector<Tensor<float>*>& results)
+            {
+                for (auto i = 0u; i < num_requests; ++i)
+                {
+                    auto input = make_tensor();
+                    input->set_host_data(input_data);
+                    input->set_dims({BATCH, WIDTH});
+                    auto result = make_tensor();
+                    result->set_host_data(std::vector<float>(BATCH, 0.0f));
+                    result->set_dims({BATCH, 1});
+                    result->load_to_device();
+                    inputs.emplace_back(input.get());
+                    results.emplace_back(result.get());
+                    owners.emplace_back(std::move(input));
+                    owners.emplace_back(std::move(result));
+                }
+            };
+
+            auto run_requests = [&](const std::vector<Tensor<float>*>& inputs, const std::vector<Tensor<float>*>& results)
+            {
+                if (pipelined)
+                {
+                    model.execute_pipelined(inputs, results);
+                    return;
+                }
+                for (auto i = 0u; i < inputs.size(); ++i)
+                {
+                    inputs[i]->load_to_device();
+                    model.execute(inputs[i], results[i]);
+                    results[i]->load_to_host();
+                }
+            };
+
+            // warm up kernels, the arena and the buffer pool
+            std::vector<std::unique_ptr<TensorOpenCL<float>>> warmup_owners;
+            std::vector<Tensor<float>*> warmup_inputs, warmup_results;
+            make_requests(warmup_owners, warmup_inputs, warmup_results);
+            run_requests(warmup_inputs, warmup_results);
+
+            std::vector<std::unique_ptr<TensorOpenCL<float>>> owners;
+            std::vector<Tensor<float>*> inputs, results;
+            make_requests(owners, inputs, results);
+            clFinish(runtime.queue);
+
+            const auto start = std::chrono::steady_clock::now();
+            run_requests(inputs, results);
+            const auto end = std::chrono::steady_clock::now();
+            requests_per_second = num_requests / std::chrono::duration<double>(end - start).count();
+        }
+
+        release_opencl_runtime(runtime);
+        return requests_per_second;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t num_requests = argc > 1 ? std::stoul(argv[1]) : 200u;
+
+    const auto blocking      = run(0, false, num_requests);
+    const auto in_order      = run(0, true, num_requests);
+    const auto out_of_order  = run(CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, true, num_requests);
+
+    std::printf("%-28s %14s %10s\n", "mode", "requests/s", "speedup");
+    std::printf("%-28s %14.1f %9.2fx\n", "blocking, in-order queue", blocking, 1.0);
+    std::printf("%-28s %14.1f %9.2fx\n", "pipelined, in-order queue", in_order, in_order / blocking);
+    std::printf("%-28s %14.1f %9.2fx\n", "pipelined, out-of-order queue", out_of_order, out_of_order / blocking);
+    return 0;
+}
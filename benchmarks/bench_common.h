@@ -0,0 +1,137 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <CL/cl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+* @brief  mean wall time of one call to func in microseconds
+* @note   warmup calls are not timed, sync (e.g. clFinish) runs once after the timed loop
+*         and is included, so queued device work is accounted for
+*/
+template<typename FUNC, typename SYNC>
+double time_per_call_us(FUNC&& func, SYNC&& sync, size_t iterations, size_t warmup = 10u)
+{
+    for (auto i = 0u; i < warmup; ++i)
+    {
+        func();
+    }
+    sync();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < iterations; ++i)
+    {
+        func();
+    }
+    sync();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / static_cast<double>(iterations);
+}
+
+/*
+* @brief  wall time of every repetition of calls_per_repetition calls to func, in microseconds per call
+* @note   each repetition ends with sync, so it includes the device work it queued. With
+*         calls_per_repetition 0 it is calibrated first, to the smallest power of two that keeps
+*         a repetition above min_repetition_us and so above the clock's resolution
+*/
+struct BenchSamples
+{
+    std::vector<double> times_us;
+    size_t              calls_per_repetition = 1u;
+};
+
+template<typename FUNC, typename SYNC>
+BenchSamples sample_per_call_us(FUNC&& func, SYNC&& sync, size_t repetitions, size_t warmup,
+                                size_t calls_per_repetition = 0u, double min_repetition_us = 200.0)
+{
+    auto time_repetition_us = [&](size_t calls)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0u; i < calls; ++i)
+        {
+            func();
+        }
+        sync();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count();
+    };
+
+    for (auto i = 0u; i < warmup; ++i)
+    {
+        func();
+    }
+    sync();
+
+    BenchSamples samples;
+    samples.calls_per_repetition = calls_per_repetition;
+    if (samples.calls_per_repetition == 0u)
+    {
+        samples.calls_per_repetition = 1u;
+        while (samples.calls_per_repetition < (size_t{1} << 20) &&
+               time_repetition_us(samples.calls_per_repetition) < min_repetition_us)
+        {
+            samples.calls_per_repetition *= 2u;
+        }
+    }
+
+    samples.times_us.reserve(repetitions);
+    for (auto i = 0u; i < repetitions; ++i)
+    {
+        samples.times_us.push_back(time_repetition_us(samples.calls_per_repetition) /
+                                   static_cast<double>(samples.calls_per_repetition));
+    }
+    return samples;
+}
+
+// nearest-rank percentile, fraction in [0, 1]
+inline double get_percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    const auto index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1u) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// uniform values in [-range, range), the same for a given seed
+inline std::vector<float> make_random_data(size_t size, unsigned seed, float range = 1.0f)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-range, range);
+    std::vector<float> data(size);
+    for (auto& value : data)
+    {
+        value = dist(gen);
+    }
+    return data;
+}
+
+// create_opencl_runtime only asserts on errors, so look for a device first; empty if there is none
+inline std::string find_opencl_device()
+{
+    cl_platform_id platform = nullptr;
+    cl_uint num_platforms = 0u;
+    if (clGetPlatformIDs(1, &platform, &num_platforms) != CL_SUCCESS || num_platforms == 0u)
+    {
+        return std::string();
+    }
+    cl_device_id device = nullptr;
+    if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, nullptr) != CL_SUCCESS &&
+        clGetDeviceIDs(platform, CL_DEVICE_TYPE_CPU, 1, &device, nullptr) != CL_SUCCESS)
+    {
+        return std::string();
+    }
+    char name[256] = {};
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name) - 1u, name, nullptr);
+    return name[0] ? std::string(name) : std::string("unnamed device");
+}
+
+#endif  // BENCH_COMMON_H
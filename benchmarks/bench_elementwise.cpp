@@ -0,0 +1,65 @@
+#include "bench_common.h"
+#include "nn/kernels/Elementwise.h"
+#include "nn/kernels/SimdDispatch.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+* @brief  host add, relu and argmax on every instruction set this CPU has
+* @note   sizes from 1K to 16M floats, so the small ones run from L1 and the large ones from memory.
+*         Bandwidth counts the bytes read and written once per call
+*/
+namespace
+{
+    // enough calls for about 256M elements per measurement, at least 3
+    size_t get_iterations(size_t size, size_t scale)
+    {
+        return std::max<size_t>(3u, scale * (size_t{1} << 28) / size / 64u);
+    }
+
+    void print_row(const char* op, SIMD_ISA isa, size_t size, double us, size_t bytes)
+    {
+        std::printf("%-8s %-8s %10zu %12.2f %10.2f\n", op, get_simd_isa_name(isa), size, us, bytes / us * 1e-3);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t scale = argc > 1 ? std::stoul(argv[1]) : 1u;
+
+    std::printf("%-8s %-8s %10s %12s %10s\n", "op", "isa", "elements", "time [us]", "GB/s");
+    for (size_t size = 1024u; size <= (size_t{1} << 24); size *= 4u)
+    {
+        const auto a = make_random_data(size, 1u);
+        const auto b = make_random_data(size, 2u);
+        std::vector<float> out(size);
+        const auto iterations = get_iterations(size, scale);
+
+        for (const auto isa : {SIMD_ISA::SCALAR, SIMD_ISA::SSE2, SIMD_ISA::AVX2, SIMD_ISA::AVX512})
+        {
+            if (isa > get_cpu_simd_isa())
+            {
+                continue;
+            }
+            set_max_simd_isa(isa);
+
+            const auto add_us = time_per_call_us([&]() { ElementwiseHost::add(a.data(), b.data(), out.data(), size); },
+                                                 []() {}, iterations);
+            print_row("add", isa, size, add_us, 3u * size * sizeof(float));
+
+            const auto relu_us = time_per_call_us([&]() { ElementwiseHost::relu(a.data(), out.data(), size); },
+                                                  []() {}, iterations);
+            print_row("relu", isa, size, relu_us, 2u * size * sizeof(float));
+
+            volatile size_t index = 0u;
+            const auto argmax_us = time_per_call_us([&]() { index = ElementwiseHost::argmax(a.data(), size); },
+                                                    []() {}, iterations);
+            print_row("argmax", isa, size, argmax_us, size * sizeof(float));
+            (void)index;
+        }
+    }
+    set_max_simd_isa(SIMD_ISA::AVX512);
+}
@@ -0,0 +1,122 @@
+#include "inference_opencl.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+* @brief  host overhead per inference of running the layers against replaying a recorded execution plan
+* @note   MLPs of 2 to 16 Dense(64 -> 64) + RELU layers and an argmax, batch 1, so the device work is tiny
+*         and the host cost of the layers, ops and clSetKernelArg calls dominates. "host" is the time spent
+*         in Model::execute, with the queue drained between batches of calls outside the timed region;
+*         "latency" is execute followed by clFinish, one inference at a time.
+*         Usage: bench_execution_plan [ITERATIONS]
+*/
+namespace
+{
+    const size_t WIDTH = 64u;
+    const size_t CALLS_PER_BATCH = 64u;
+
+    struct Timings
+    {
+        double host_us = 0.0;
+        double latency_us = 0.0;
+        size_t num_launches = 0u;
+    };
+
+    Timings run(OpenCLRuntime& runtime, size_t num_layers, bool replay, size_t iterations)
+    {
+        auto make_tensor = [&]() { return std::make_unique<TensorOpenCL<float>>(runtime.program, runtime.queue, runtime.context); };
+
+        std::vector<std::unique_ptr<TensorOpenCL<float>>> parameters;
+        std::vector<std::unique_ptr<Layer>> layers;
+        Model model;
+        for (auto i = 0u; i < num_layers; ++i)
+        {
+            auto weight = make_tensor();
+            weight->set_host_data(make_random_data(WIDTH * WIDTH, i, 0.1f));
+            weight->set_dims({WIDTH, WIDTH});
+            auto bias = make_tensor();
+            bias->set_host_data(make_random_data(WIDTH, i + 100u, 0.1f));
+            bias->set_dims({1, WIDTH});
+
+            auto dense = std::make_unique<Dense>();
+            dense->set_weight(weight.get());
+            dense->set_bias(bias.get());
+            model.add_layer(dense.get());
+            layers.emplace_back(std::move(dense));
+            layers.emplace_back(std::make_unique<Activation>(ACTIVATION::RELU));
+            model.add_layer(layers.back().get());
+            parameters.emplace_back(std::move(weight));
+            parameters.emplace_back(std::move(bias));
+        }
+        layers.emplace_back(std::make_unique<Activation>(ACTIVATION::ARGMAX));
+        model.add_layer(layers.back().get());
+        model.set_replay_enabled(replay);
+        model.to_device();
+
+        auto input = make_tensor();
+        input->set_host_data(make_random_data(WIDTH, 7u, 0.1f));
+        input->set_dims({1, WIDTH});
+        input->load_to_device();
+        auto result = make_tensor();
+        result->set_host_data({0.0f});
+        result->set_dims({1, 1});
+        result->load_to_device();
+
+        auto execute = [&]() { model.execute(input.get(), result.get()); };
+        auto sync = [&]() { clFinish(runtime.queue); };
+
+        Timings timings;
+        // the first calls tune the kernels and record the plan
+        timings.latency_us = time_per_call_us([&]() { execute(); sync(); }, sync, iterations);
+        const auto plan = model.get_execution_plan();
+        timings.num_launches = plan && plan->is_replayable() ? plan->get_num_launches() : 0u;
+
+        double host_us = 0.0;
+        size_t num_calls = 0u;
+        while (num_calls < iterations)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (auto i = 0u; i < CALLS_PER_BATCH; ++i)
+            {
+                execute();
+            }
+            host_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            num_calls += CALLS_PER_BATCH;
+            sync();
+        }
+        timings.host_us = host_us / static_cast<double>(num_calls);
+        return timings;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = argc > 1 ? std::stoul(argv[1]) : 2000u;
+    if (find_opencl_device().empty())
+    {
+        std::printf("no OpenCL device found, nothing to replay\n");
+        return 0;
+    }
+
+    auto runtime = create_opencl_runtime(0, false);
+    std::printf("%-7s %-8s %9s %12s %14s %9s\n", "layers", "mode", "launches", "host [us]", "latency [us]", "speedup");
+    for (const size_t num_layers : {2u, 4u, 8u, 16u})
+    {
+        const auto layers = run(runtime, num_layers, false, iterations);
+        const auto replay = run(runtime, num_layers, true, iterations);
+        std::printf("%-7zu %-8s %9s %12.2f %14.2f %8.2fx\n", num_layers, "layers", "-", layers.host_us, layers.latency_us, 1.0);
+        std::printf("%-7zu %-8s %9zu %12.2f %14.2f %8.2fx\n", num_layers, "replay", replay.num_launches, replay.host_us,
+                    replay.latency_us, layers.host_us / replay.host_us);
+    }
+    release_opencl_runtime(runtime);
+    return 0;
+}
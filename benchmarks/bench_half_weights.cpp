@@ -0,0 +1,92 @@
+#include "bench_common.h"
+#include "inference_opencl.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/layer/Dense.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+* @brief  batch-1 Dense layers with fp32, fp16 and bf16 weights
+* @note   at batch 1 a Dense layer reads every weight once per call, so it is bound by memory
+*         bandwidth and 16-bit weights should come close to halving its time.
+*         The host runs by default, pass --device to also time the OpenCL kernels
+*/
+namespace
+{
+    // microseconds per forward of a {1, size} x {size, size} Dense layer
+    double time_dense_us(const std::function<Tensor<float>*()>& make_tensor, const std::function<void()>& sync,
+                         size_t size, WEIGHT_FORMAT format, size_t iterations, bool on_device)
+    {
+        std::unique_ptr<Tensor<float>> input(make_tensor()), weight(make_tensor()), bias(make_tensor()), result(make_tensor());
+        input->set_host_data(make_random_data(size, 1u, 0.1f));
+        input->set_dims({1u, size});
+        weight->set_host_data(make_random_data(size * size, 2u, 0.1f));
+        weight->set_dims({size, size});
+        bias->set_host_data(make_random_data(size, 3u, 0.1f));
+        bias->set_dims({1u, size});
+        result->set_host_data({0.0f});
+
+        Dense dense;
+        dense.set_weight(weight.get(), true);
+        dense.set_bias(bias.get());
+        dense.set_weight_format(format);
+        if (on_device)
+        {
+            dense.to_device();
+            input->load_to_device();
+            result->load_to_device();
+        }
+        else
+        {
+            dense.to_host();
+        }
+
+        return time_per_call_us([&]() { dense.forward(input.get(), result.get(), nullptr); }, sync, iterations);
+    }
+
+    void run(const char* platform, const std::function<Tensor<float>*()>& make_tensor, const std::function<void()>& sync,
+             size_t iterations, bool on_device)
+    {
+        for (const size_t size : {512u, 1024u, 2048u, 4096u})
+        {
+            const auto fp32 = time_dense_us(make_tensor, sync, size, WEIGHT_FORMAT::FP32, iterations, on_device);
+            const auto fp16 = time_dense_us(make_tensor, sync, size, WEIGHT_FORMAT::FP16, iterations, on_device);
+            const auto bf16 = time_dense_us(make_tensor, sync, size, WEIGHT_FORMAT::BF16, iterations, on_device);
+            std::printf("%-8s %6zu %11.1f %11.1f %11.1f %8.2fx %8.2fx\n", platform, size, fp32, fp16, bf16, fp32 / fp16, fp32 / bf16);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = 200u;
+    bool device = false;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--device") == 0)
+        {
+            device = true;
+        }
+        else
+        {
+            iterations = std::stoul(argv[i]);
+        }
+    }
+
+    std::printf("host kernels: %s\n", GemmHalfHost::get_isa());
+    std::printf("%-8s %6s %11s %11s %11s %9s %9s\n", "platform", "size", "fp32 [us]", "fp16 [us]", "bf16 [us]", "fp16", "bf16");
+    run("host", []() { return new Tensor<float>(); }, []() {}, iterations, false);
+
+    if (device)
+    {
+        auto runtime = create_opencl_runtime(0, false);
+        run("device", [&]() { return new TensorOpenCL<float>(runtime.program, runtime.queue, runtime.context); },
+            [&]() { clFinish(runtime.queue); }, iterations, true);
+        release_opencl_runtime(runtime);
+    }
+}
@@ -0,0 +1,127 @@
+#include "nn/serving/InferenceServer.h"
+#include "nn/model/TFLiteLoader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+* @brief  load generator for InferenceServer
+* @note   serves the bundled MNIST model, or the .tflite model passed with --model.
+*         Open loop: every client thread submits at exponentially distributed intervals, so requests
+*         keep arriving at the target rate however slow the server is, like independent users would.
+*         Prints throughput, latency percentiles and the mean batch size for several max batch sizes.
+*         Usage: bench_inference_server [--rate REQUESTS_PER_S] [--seconds S] [--clients N] [--executors N] [--model PATH]
+*/
+namespace
+{
+    struct LoadParams
+    {
+        double      rate = 2000.0;
+        double      seconds = 2.0;
+        size_t      clients = 4u;
+        size_t      executors = 2u;
+        std::string model_path = std::string(MODELS_DIR) + "/TFLite/mnist_model.tflite";
+    };
+
+    InferenceServerStats run_load(const Model& model, const std::vector<size_t>& sample_dims, const LoadParams& load,
+                                  size_t max_batch_size)
+    {
+        InferenceServerParams params;
+        params.sample_dims = sample_dims;
+        params.max_batch_size = max_batch_size;
+        params.max_queue_delay = std::chrono::microseconds(1000);
+        params.num_executors = load.executors;
+        InferenceServer server(model, params);
+
+        size_t sample_size = 1u;
+        for (const auto dim : sample_dims)
+        {
+            sample_size *= dim;
+        }
+
+        const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(load.seconds);
+        std::vector<std::thread> clients;
+        for (auto client = 0u; client < load.clients; ++client)
+        {
+            clients.emplace_back([&, client]()
+            {
+                std::mt19937 gen(client);
+                std::exponential_distribution<double> interval(load.rate / static_cast<double>(load.clients));
+                std::uniform_real_distribution<float> pixel(0.0f, 1.0f);
+                std::vector<float> sample(sample_size);
+                std::vector<std::future<std::vector<float>>> futures;
+
+                auto next = std::chrono::steady_clock::now();
+                while (next < end)
+                {
+                    std::this_thread::sleep_until(next);
+                    for (auto& value : sample)
+                    {
+                        value = pixel(gen);
+                    }
+                    futures.push_back(server.submit(sample));
+                    next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval(gen)));
+                }
+                for (auto& future : futures)
+                {
+                    future.get();
+                }
+            });
+        }
+        for (auto& client : clients)
+        {
+            client.join();
+        }
+        return server.get_stats();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    LoadParams load;
+    for (auto i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--rate") == 0)
+        {
+            load.rate = std::stod(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            load.seconds = std::stod(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--clients") == 0)
+        {
+            load.clients = std::stoul(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--executors") == 0)
+        {
+            load.executors = std::stoul(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--model") == 0)
+        {
+            load.model_path = argv[i + 1];
+        }
+    }
+
+    Model model;
+    const TFLiteLoader loader(load.model_path);
+    loader.load(model);
+    model.to_host();
+    const auto& input_dims = loader.get_input_dims();
+    const std::vector<size_t> sample_dims(input_dims.begin() + 1, input_dims.end());
+
+    std::printf("%.0f requests/s from %zu clients for %.1f s, %zu executors\n", load.rate, load.clients, load.seconds, load.executors);
+    std::printf("%9s %14s %10s %10s %11s\n", "max batch", "throughput/s", "p50 [ms]", "p99 [ms]", "mean batch");
+    for (const size_t max_batch_size : {1u, 4u, 16u, 64u})
+    {
+        const auto stats = run_load(model, sample_dims, load, max_batch_size);
+        std::printf("%9zu %14.0f %10.3f %10.3f %11.2f\n", max_batch_size, stats.throughput,
+                    stats.p50_latency_ms, stats.p99_latency_ms, stats.mean_batch_size);
+    }
+}
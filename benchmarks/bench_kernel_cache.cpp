@@ -0,0 +1,68 @@
+#include "bench_common.h"
+#include "inference_opencl.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/tensor/OpenCLKernelCache.h"
+
+#include <cstdio>
+#include <vector>
+
+/*
+* @brief  per-op launch overhead of TensorOpenCL with and without the kernel cache
+* @note   "uncached" replays what every *_on_device did before the cache existed:
+*         clCreateKernel, clSetKernelArg, clEnqueueNDRangeKernel (plus the clReleaseKernel it leaked)
+*/
+int main(int argc, char** argv)
+{
+    const size_t iterations = argc > 1 ? std::stoul(argv[1]) : 10000u;
+
+    auto runtime = create_opencl_runtime(0, false);
+
+    auto make_tensor = [&](size_t size)
+    {
+        auto tensor = std::make_unique<TensorOpenCL<float>>(runtime.program, runtime.queue, runtime.context);
+        tensor->set_host_data(std::vector<float>(size, 1.0f));
+        tensor->set_dims({1u, size});
+        tensor->load_to_device();
+        return tensor;
+    };
+
+    const cl_uint size = 64u;
+    auto lhs    = make_tensor(size);
+    auto rhs    = make_tensor(size);
+    auto result = make_tensor(size);
+
+    auto sync = [&]() { clFinish(runtime.queue); };
+
+    auto uncached_launch = [&](const char* name, size_t num_buffers)
+    {
+        cl_int err = CL_SUCCESS;
+        cl_kernel kernel = clCreateKernel(runtime.program, name, &err);
+        CHECK_CL_ERROR(err, "Couldn't create the kernel");
+        const cl_mem buffers[] = {lhs->get_device_data(), rhs->get_device_data(), result->get_device_data()};
+        const cl_mem* args = num_buffers == 3u ? buffers : buffers + 1;
+        for (cl_uint i = 0u; i < num_buffers; ++i)
+        {
+            clSetKernelArg(kernel, i, sizeof(cl_mem), &args[i]);
+        }
+        clSetKernelArg(kernel, num_buffers, sizeof(cl_uint), &size);
+        size_t global_size = 32u;
+        clEnqueueNDRangeKernel(runtime.queue, kernel, 1, NULL, &global_size, NULL, 0, NULL, NULL);
+        clReleaseKernel(kernel);
+    };
+
+    const auto add_uncached  = time_per_call_us([&]() { uncached_launch("matSum", 3u); }, sync, iterations);
+    const auto add_cached    = time_per_call_us([&]() { lhs->add(rhs.get(), result.get()); }, sync, iterations);
+    const auto relu_uncached = time_per_call_us([&]() { uncached_launch("matRelu", 2u); }, sync, iterations);
+    const auto relu_cached   = time_per_call_us([&]() { rhs->relu(result.get()); }, sync, iterations);
+
+    std::printf("%-8s %14s %14s %10s\n", "op", "uncached [us]", "cached [us]", "speedup");
+    std::printf("%-8s %14.2f %14.2f %9.2fx\n", "add", add_uncached, add_cached, add_uncached / add_cached);
+    std::printf("%-8s %14.2f %14.2f %9.2fx\n", "relu", relu_uncached, relu_cached, relu_uncached / relu_cached);
+    std::printf("kernels created by the cache: %zu\n", OpenCLKernelCache::instance().get_num_created());
+
+    lhs.reset();
+    rhs.reset();
+    result.reset();
+    release_opencl_runtime(runtime);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "inference_opencl.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+/*
+* @brief  OpenCL runtime startup time, cold (kernels built from source) vs warm (cached binary)
+* @note   uses a private cache directory that is wiped before every cold start,
+*         the driver's own compiler cache may still make cold starts faster than a first run
+*/
+namespace
+{
+    // milliseconds from nothing to a ready runtime, teardown is not included
+    double time_startup_ms(bool& from_cache)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto runtime = create_opencl_runtime(0, false);
+        const auto end = std::chrono::steady_clock::now();
+
+        from_cache = runtime.program_from_cache;
+        release_opencl_runtime(runtime);
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = argc > 1 ? std::stoul(argv[1]) : 5u;
+
+    const auto cache_dir = std::filesystem::temp_directory_path() / "bench_program_cache";
+    set_program_cache_dir(cache_dir.string());
+
+    double cold_ms = 0.0;
+    double warm_ms = 0.0;
+    size_t num_warm_hits = 0u;
+    for (auto i = 0u; i < iterations; ++i)
+    {
+        bool from_cache = false;
+
+        std::filesystem::remove_all(cache_dir);
+        cold_ms += time_startup_ms(from_cache);
+
+        // the cold start just stored the binary
+        warm_ms += time_startup_ms(from_cache);
+        num_warm_hits += from_cache ? 1u : 0u;
+    }
+    std::filesystem::remove_all(cache_dir);
+
+    cold_ms /= static_cast<double>(iterations);
+    warm_ms /= static_cast<double>(iterations);
+    std::printf("%-6s %14s\n", "start", "startup [ms]");
+    std::printf("%-6s %14.2f\n", "cold", cold_ms);
+    std::printf("%-6s %14.2f\n", "warm", warm_ms);
+    std::printf("speedup: %.2fx, warm starts loaded from cache: %zu/%zu\n", cold_ms / warm_ms, num_warm_hits, iterations);
+}
@@ -0,0 +1,94 @@
+#include "bench_common.h"
+#include "inference_opencl.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/layer/Conv2D.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+* @brief  3x3 stride-1 SAME convolution, Winograd F(2x2, 3x3) against im2col + GEMM
+* @note   a {1, 32, 32, C} input convolved to C output channels, for several C.
+*         The host runs by default, pass --device to also time the OpenCL kernels
+*/
+namespace
+{
+    const size_t SPATIAL = 32u;
+
+    // microseconds per forward with the Winograd path on or off
+    double time_conv_us(const std::function<Tensor<float>*()>& make_tensor, const std::function<void()>& sync,
+                        size_t channels, bool winograd, size_t iterations, bool on_device)
+    {
+        std::unique_ptr<Tensor<float>> input(make_tensor()), weight(make_tensor()), bias(make_tensor());
+        std::unique_ptr<Tensor<float>> scratch(make_tensor()), result(make_tensor());
+        input->set_host_data(make_random_data(SPATIAL * SPATIAL * channels, 1u, 0.1f));
+        input->set_dims({1u, SPATIAL, SPATIAL, channels});
+        weight->set_host_data(make_random_data(channels * 9u * channels, 2u, 0.1f));
+        weight->set_dims({channels, 3u, 3u, channels});
+        bias->set_host_data(make_random_data(channels, 3u, 0.1f));
+        bias->set_dims({1u, channels});
+        scratch->set_host_data({0.0f});
+        result->set_host_data({0.0f});
+
+        Conv2D conv(1u, 1u, PADDING::SAME);
+        conv.set_weight(weight.get());
+        conv.set_bias(bias.get());
+        conv.set_winograd_enabled(winograd);
+        if (on_device)
+        {
+            conv.to_device();
+            input->load_to_device();
+            scratch->load_to_device();
+            result->load_to_device();
+        }
+        else
+        {
+            conv.to_host();
+        }
+
+        return time_per_call_us([&]() { conv.forward(input.get(), result.get(), scratch.get()); }, sync, iterations);
+    }
+
+    void run(const char* platform, const std::function<Tensor<float>*()>& make_tensor, const std::function<void()>& sync,
+             size_t iterations, bool on_device)
+    {
+        for (const size_t channels : {8u, 16u, 32u, 64u, 128u})
+        {
+            const auto im2col   = time_conv_us(make_tensor, sync, channels, false, iterations, on_device);
+            const auto winograd = time_conv_us(make_tensor, sync, channels, true, iterations, on_device);
+            std::printf("%-8s %8zu %14.1f %14.1f %9.2fx\n", platform, channels, im2col, winograd, im2col / winograd);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = 50u;
+    bool device = false;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--device") == 0)
+        {
+            device = true;
+        }
+        else
+        {
+            iterations = std::stoul(argv[i]);
+        }
+    }
+
+    std::printf("%-8s %8s %14s %14s %10s\n", "platform", "channels", "im2col [us]", "winograd [us]", "speedup");
+    run("host", []() { return new Tensor<float>(); }, []() {}, iterations, false);
+
+    if (device)
+    {
+        auto runtime = create_opencl_runtime(0, false);
+        run("device", [&]() { return new TensorOpenCL<float>(runtime.program, runtime.queue, runtime.context); },
+            [&]() { clFinish(runtime.queue); }, iterations, true);
+        release_opencl_runtime(runtime);
+    }
+}
@@ -0,0 +1,16 @@
+# Writes INPUT_FILE into OUTPUT_FILE as a null-terminated char array named VARIABLE_NAME.
+# Bytes rather than a string literal, since compilers limit the length of literals.
+# Usage: cmake -DINPUT_FILE=<path> -DOUTPUT_FILE=<path> -DVARIABLE_NAME=<name> -P EmbedFile.cmake
+
+file(READ "${INPUT_FILE}" HEX_CONTENTS HEX)
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX_CONTENTS}")
+
+get_filename_component(INPUT_NAME "${INPUT_FILE}" NAME)
+file(WRITE "${OUTPUT_FILE}.tmp"
+    "// generated from ${INPUT_NAME} at build time, do not edit\n"
+    "#ifndef ${VARIABLE_NAME}_H\n#define ${VARIABLE_NAME}_H\n\n"
+    "static const char ${VARIABLE_NAME}[] = {\n    ${BYTES}0x00\n};\n\n"
+    "#endif  // ${VARIABLE_NAME}_H\n")
+# only touch the header when the contents changed, so dependents aren't rebuilt needlessly
+configure_file("${OUTPUT_FILE}.tmp" "${OUTPUT_FILE}" COPYONLY)
+file(REMOVE "${OUTPUT_FILE}.tmp")
@@ -0,0 +1,285 @@
+#include "nn/model/Model.h"
+#include "nn/model/TFLiteLoader.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "inference_opencl.h"
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+// one OpenCL runtime per process, created by the first model that asks for the device
+static std::shared_ptr<OpenCLRuntime> get_opencl_runtime()
+{
+    static std::mutex mutex;
+    static std::weak_ptr<OpenCLRuntime> shared_runtime;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto runtime = shared_runtime.lock();
+    if (!runtime)
+    {
+        runtime.reset(new OpenCLRuntime(create_opencl_runtime(0, false)), [](OpenCLRuntime* runtime)
+        {
+            release_opencl_runtime(*runtime);
+            delete runtime;
+        });
+        shared_runtime = runtime;
+    }
+    return runtime;
+}
+
+// a view of array's memory, the tensor keeps the array alive; arrays that are not C-contiguous float32
+// are converted (and so copied) by the caller's FloatArray argument. The array may be read-only
+// (np.frombuffer, broadcast views), forcecast passes those through; only tensors that are never handed
+// back to Python, like execute's input, may wrap them
+static std::shared_ptr<Tensor<float>> wrap_array(FloatArray array)
+{
+    if (array.ndim() == 0)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Tensor needs at least one dimension");
+    }
+    const auto data = const_cast<float*>(array.data());
+    const auto size = static_cast<size_t>(array.size());
+    std::vector<size_t> dims(array.shape(), array.shape() + array.ndim());
+
+    // the last reference may be dropped by a thread that does not hold the GIL
+    std::shared_ptr<void> owner(new py::object(std::move(array)), [](void* object)
+    {
+        py::gil_scoped_acquire gil;
+        delete static_cast<py::object*>(object);
+    });
+
+    auto tensor = std::make_shared<Tensor<float>>();
+    tensor->set_dims(dims);
+    tensor->set_external_host_data(data, size, std::move(owner));
+    return tensor;
+}
+
+// Tensor(array) from Python: the tensor hands its memory out writable (buffer protocol, numpy()), so a
+// read-only array is copied first; a writable one is still wrapped without copying
+static std::shared_ptr<Tensor<float>> wrap_writable_array(FloatArray array)
+{
+    if (!array.writeable())
+    {
+        array = FloatArray(std::vector<py::ssize_t>(array.shape(), array.shape() + array.ndim()), array.data());
+    }
+    return wrap_array(std::move(array));
+}
+
+// a NumPy view of the tensor's host memory, the view keeps the tensor alive
+static py::array to_array(const std::shared_ptr<Tensor<float>>& tensor)
+{
+    const auto& dims = tensor->get_dims();
+    std::vector<py::ssize_t> shape(dims.cbegin(), dims.cend());
+    return py::array(py::dtype::of<float>(), shape, tensor->data(), py::cast(tensor));
+}
+
+/*
+* @brief  a .tflite model as seen from Python
+* @note   execute runs without the GIL, so Python threads can run inferences concurrently: every call
+*         borrows a clone of the model (see Model::clone) that shares its layers and weights and owns
+*         only an activation arena, clones are kept for later calls. On the device the clones record
+*         their reads of the shared weights under the lock of the weights' event history
+*/
+class PythonModel
+{
+public:
+    // with opencl the weights are loaded into TensorOpenCL, so the model can move to the device
+    PythonModel(const std::string& file_path, bool opencl);
+    virtual ~PythonModel() = default;
+
+    virtual void to_host();
+    virtual void to_device();
+    virtual PLATFORM get_platform() const;
+    virtual const std::vector<size_t>& get_input_dims() const;
+    virtual const std::vector<size_t>& get_output_dims() const;
+    // call without the GIL; result is resized to the output on the host
+    virtual void execute(const Tensor<float>* input, Tensor<float>* result);
+    // an empty tensor for execute, on the host
+    virtual std::shared_ptr<Tensor<float>> create_result() const;
+
+private:
+    std::shared_ptr<OpenCLRuntime> m_runtime;   // declared first, so it is released after every tensor
+    Model                          m_model;
+    std::vector<size_t>            m_input_dims;
+    std::vector<size_t>            m_output_dims;
+
+    std::shared_mutex              m_layers_mutex;  // shared by execute, exclusive while the layers move
+    std::mutex                     m_models_mutex;
+    std::vector<std::unique_ptr<Model>> m_idle_models;
+};
+
+PythonModel::PythonModel(const std::string& file_path, bool opencl)
+{
+    TFLiteLoader::TensorFactory tensor_factory = TFLiteLoader::default_tensor_factory;
+    if (opencl)
+    {
+        m_runtime = get_opencl_runtime();
+        const auto runtime = m_runtime;
+        tensor_factory = [runtime]() -> Tensor<float>*
+        {
+            return new TensorOpenCL<float>(runtime->program, runtime->queue, runtime->context);
+        };
+    }
+
+    const TFLiteLoader loader(file_path);
+    loader.load(m_model, tensor_factory);
+    m_input_dims = loader.get_input_dims();
+    m_output_dims = loader.get_output_dims();
+    m_model.to_host();
+}
+
+void PythonModel::to_host()
+{
+    std::unique_lock<std::shared_mutex> lock(m_layers_mutex);
+    m_model.to_host();
+    std::lock_guard<std::mutex> models_lock(m_models_mutex);
+    m_idle_models.clear();
+}
+
+void PythonModel::to_device()
+{
+    if (!m_runtime)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Model was not loaded with opencl=True");
+    }
+    std::unique_lock<std::shared_mutex> lock(m_layers_mutex);
+    m_model.to_device();
+    std::lock_guard<std::mutex> models_lock(m_models_mutex);
+    m_idle_models.clear();
+}
+
+PLATFORM PythonModel::get_platform() const
+{
+    return m_model.get_platform();
+}
+
+const std::vector<size_t>& PythonModel::get_input_dims() const
+{
+    return m_input_dims;
+}
+
+const std::vector<size_t>& PythonModel::get_output_dims() const
+{
+    return m_output_dims;
+}
+
+std::shared_ptr<Tensor<float>> PythonModel::create_result() const
+{
+    std::shared_ptr<Tensor<float>> result;
+    if (m_runtime)
+    {
+        // the deleter holds the runtime, a result may outlive the model in Python
+        const auto runtime = m_runtime;
+        result.reset(new TensorOpenCL<float>(runtime->program, runtime->queue, runtime->context),
+                     [runtime](Tensor<float>* tensor) { delete tensor; });
+    }
+    else
+    {
+        result = std::make_shared<Tensor<float>>();
+    }
+    result->set_host_data({0.0f});
+    return result;
+}
+
+void PythonModel::execute(const Tensor<float>* input, Tensor<float>* result)
+{
+    std::shared_lock<std::shared_mutex> lock(m_layers_mutex);
+
+    std::unique_ptr<Model> model;
+    {
+        std::lock_guard<std::mutex> models_lock(m_models_mutex);
+        if (!m_idle_models.empty())
+        {
+            model = std::move(m_idle_models.back());
+            m_idle_models.pop_back();
+        }
+    }
+    if (!model)
+    {
+        model.reset(m_model.clone());
+    }
+
+    if (model->get_platform() == PLATFORM::DEVICE)
+    {
+        // the caller's input stays a view of its array, the device copy is made here
+        TensorOpenCL<float> device_input(m_runtime->program, m_runtime->queue, m_runtime->context);
+        device_input.set_dims(input->get_dims());
+        device_input.set_external_host_data(const_cast<float*>(input->data()), input->get_size(), nullptr);
+        device_input.load_to_device();
+        result->load_to_device();
+        model->execute(&device_input, result);
+        result->load_to_host();
+    }
+    else
+    {
+        model->execute(input, result);
+    }
+
+    std::lock_guard<std::mutex> models_lock(m_models_mutex);
+    m_idle_models.push_back(std::move(model));
+}
+
+PYBIND11_MODULE(pybindings, m)
+{
+    m.doc() = "Parallel AI Inference: .tflite models on the host or an OpenCL device";
+
+    py::enum_<PLATFORM>(m, "Platform")
+        .value("UNKNOWN", PLATFORM::UNKNOWN)
+        .value("HOST", PLATFORM::HOST)
+        .value("DEVICE", PLATFORM::DEVICE);
+
+    py::class_<Tensor<float>, std::shared_ptr<Tensor<float>>>(m, "Tensor", py::buffer_protocol())
+        .def(py::init(&wrap_writable_array), py::arg("array"),
+             "Wraps a writable float32 array without copying, other arrays are copied or converted first")
+        .def_buffer([](Tensor<float>& tensor) -> py::buffer_info
+        {
+            const auto& dims = tensor.get_dims();
+            std::vector<py::ssize_t> shape(dims.cbegin(), dims.cend());
+            std::vector<py::ssize_t> strides(dims.size(), sizeof(float));
+            for (auto i = dims.size(); i-- > 1u;)
+            {
+                strides[i - 1u] = strides[i] * shape[i];
+            }
+            return py::buffer_info(tensor.data(), sizeof(float), py::format_descriptor<float>::format(),
+                                   static_cast<py::ssize_t>(dims.size()), shape, strides);
+        })
+        .def_property_readonly("dims", &Tensor<float>::get_dims)
+        .def_property_readonly("platform", &Tensor<float>::get_platform)
+        .def("numpy", &to_array, "A view of the tensor's memory")
+        .def("__repr__", [](const Tensor<float>& tensor) { return tensor.to_string(); });
+
+    py::class_<PythonModel>(m, "Model")
+        .def(py::init<const std::string&, bool>(), py::arg("path"), py::arg("opencl") = false,
+             "Loads a .tflite model onto the host, with opencl=True it can move to the device")
+        .def("to_host", &PythonModel::to_host, py::call_guard<py::gil_scoped_release>())
+        .def("to_device", &PythonModel::to_device, py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("platform", &PythonModel::get_platform)
+        .def_property_readonly("input_dims", &PythonModel::get_input_dims)
+        .def_property_readonly("output_dims", &PythonModel::get_output_dims)
+        .def("execute", [](PythonModel& model, FloatArray input)
+        {
+            const auto input_tensor = wrap_array(std::move(input));
+            const auto result = model.create_result();
+            {
+                py::gil_scoped_release release;
+                model.execute(input_tensor.get(), result.get());
+            }
+            return to_array(result);
+        }, py::arg("input"),
+        "Runs a batch without copying the input or the output: the result is a view of the output tensor. "
+        "Releases the GIL, so threads can execute concurrently");
+}
@@ -1,3 +1,3 @@
-#include "Activation.h"
-
-#include <cmath>
+#include "Activation.h"
+
+#include <cmath>
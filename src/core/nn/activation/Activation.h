@@ -1,10 +1,10 @@
-#ifndef ACTIVATION_H
-#define ACTIVATION_H
-
-#include "../tensor/Tensor.h"
-
-class Activation
-{
-};
-
+#ifndef ACTIVATION_H
+#define ACTIVATION_H
+
+#include "../tensor/Tensor.h"
+
+class Activation
+{
+};
+
 #endif
\ No newline at end of file
@@ -1,9 +1,50 @@
-#include "common.h"
-
-std::string read_file(const std::string& file_path)
-{
-    std::ifstream file(file_path);
-    assert(file.is_open() && "Couldn't open the file");
-    // Read the entire file into a string
-    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-}
\ No newline at end of file
+#include "common.h"
+
+#include <iostream>
+#include <stdexcept>
+
+std::string read_file(const std::string& file_path)
+{
+    std::ifstream file(file_path);
+    if (!file.is_open())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't open the file " + file_path);
+    }
+    // Read the entire file into a string
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+Conv2DParams get_window_params(const std::vector<size_t>& input_dims, const Conv2DParams& window, PADDING padding)
+{
+    auto params = window;
+
+    // extent of a dilated kernel
+    const auto window_h = (params.kernel_h - 1u) * params.dilation_h + 1u;
+    const auto window_w = (params.kernel_w - 1u) * params.dilation_w + 1u;
+    const auto in_h = input_dims[1];
+    const auto in_w = input_dims[2];
+    if (padding == PADDING::SAME)
+    {
+        // as TensorFlow does: the odd padding element goes to the bottom and right
+        params.out_h = (in_h + params.stride_h - 1u) / params.stride_h;
+        params.out_w = (in_w + params.stride_w - 1u) / params.stride_w;
+        const auto needed_h = (params.out_h - 1u) * params.stride_h + window_h;
+        const auto needed_w = (params.out_w - 1u) * params.stride_w + window_w;
+        params.pad_top = needed_h > in_h ? (needed_h - in_h) / 2u : 0u;
+        params.pad_left = needed_w > in_w ? (needed_w - in_w) / 2u : 0u;
+    }
+    else
+    {
+        if (in_h < window_h || in_w < window_w)
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::invalid_argument("Input is smaller than the window");
+        }
+        params.pad_top = 0u;
+        params.pad_left = 0u;
+        params.out_h = (in_h - window_h) / params.stride_h + 1u;
+        params.out_w = (in_w - window_w) / params.stride_w + 1u;
+    }
+    return params;
+}
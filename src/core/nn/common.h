@@ -1,26 +1,97 @@
-#ifndef COMMON_H
-#define COMMON_H
-
-#include <cassert>
-#include <cstring>
-#include <fstream>
-#include <streambuf>
-
-enum class PLATFORM
-{
-    UNKNOWN = 0,
-    HOST,
-    DEVICE
-
-};
-
-enum class ACTIVATION
-{
-    UNKNOWN = 0,
-    RELU,
-    ARGMAX
-};
-
-std::string read_file(const std::string& file_path);
-
+#ifndef COMMON_H
+#define COMMON_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+enum class PLATFORM
+{
+    UNKNOWN = 0,
+    HOST,
+    DEVICE
+
+};
+
+enum class ACTIVATION
+{
+    UNKNOWN = 0,
+    RELU,
+    ARGMAX,
+    SOFTMAX
+};
+
+enum class POOLING
+{
+    MAX = 0,
+    AVERAGE
+};
+
+// storage of Dense weights, activations and accumulation stay fp32 either way
+enum class WEIGHT_FORMAT
+{
+    FP32 = 0,
+    FP16,       // IEEE binary16
+    BF16        // bfloat16, the upper half of an fp32
+};
+
+enum class PADDING
+{
+    VALID = 0,  // no padding, windows stay inside the input
+    SAME        // zero padding so that the output is ceil(input / stride)
+};
+
+/*
+* @brief  window geometry of a 2-D convolution over NHWC tensors, pooling uses it too (dilation 1)
+* @note   padding is given for the top and left edge only, bottom and right follow from the output size
+*/
+struct Conv2DParams
+{
+    size_t kernel_h = 1u;
+    size_t kernel_w = 1u;
+    size_t stride_h = 1u;
+    size_t stride_w = 1u;
+    size_t dilation_h = 1u;
+    size_t dilation_w = 1u;
+    size_t pad_top = 0u;
+    size_t pad_left = 0u;
+    size_t out_h = 0u;
+    size_t out_w = 0u;
+};
+
+/*
+* @brief  affine quantization as TFLite defines it, real = scale * (quantized - zero_point)
+* @note   one scale and zero point for the whole tensor, or one per index along quantized_dimension
+*/
+struct QuantizationParams
+{
+    std::vector<float>   scales;
+    std::vector<int32_t> zero_points;
+    size_t               quantized_dimension = 0u;
+};
+
+/*
+* @brief  scalar parameters of an int8 GEMM, the per-column ones are in its requantization tensor
+* @note   activation_min / activation_max are the clamp in the output's int8 domain, a fused RELU raises
+*         the minimum to the output zero point
+*/
+struct QuantizedGemmParams
+{
+    float   input_scale = 1.0f;
+    int32_t input_zero_point = 0;
+    float   output_scale = 1.0f;
+    int32_t output_zero_point = 0;
+    int32_t activation_min = -128;
+    int32_t activation_max = 127;
+};
+
+// fills in the padding and output size of window (kernel, stride and dilation set) for an NHWC input shape
+Conv2DParams get_window_params(const std::vector<size_t>& input_dims, const Conv2DParams& window, PADDING padding);
+
+std::string read_file(const std::string& file_path);
+
 #endif  // COMMON_H
\ No newline at end of file
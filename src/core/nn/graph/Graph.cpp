@@ -0,0 +1,708 @@
+#include "Graph.h"
+#include "GraphPass.h"
+#include "../kernels/ThreadPool.h"
+#include "../model/ArenaPlan.h"
+#include "../kernels/Elementwise.h"
+#include "../profiling/Profiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+static size_t get_num_elements(const std::vector<size_t>& dims)
+{
+    return std::accumulate(dims.cbegin(), dims.cend(), size_t{1}, std::multiplies<size_t>());
+}
+
+// a node of fewer operations splits no kernel across the ThreadPool, so a stage of such nodes is
+// faster with its nodes side by side; a larger one would run its kernels on one thread
+static const size_t CONCURRENT_NODE_MAX_OPERATIONS = ElementwiseHost::PARALLEL_GRAIN;
+
+static bool is_defined(const GraphTensor& tensor)
+{
+    return tensor.producer != Graph::NO_NODE || tensor.is_input || tensor.constant;
+}
+
+// Tensor::add works on matrices, tensors of other ranks are added as one row
+static void add_tensors(const Tensor<float>* left, const Tensor<float>* right, Tensor<float>* result)
+{
+    const auto dims = left->get_dims();
+    if (dims.size() == 2u)
+    {
+        left->add(right, result);
+        return;
+    }
+
+    const std::vector<size_t> row_dims{1u, left->get_size()};
+    std::unique_ptr<Tensor<float>> left_row(left->create_empty());
+    std::unique_ptr<Tensor<float>> right_row(right->create_empty());
+    left->reshape(row_dims, left_row.get());
+    right->reshape(row_dims, right_row.get());
+    left_row->add(right_row.get(), result);
+    result->set_dims(dims);
+}
+
+Graph::Graph()
+{
+}
+
+size_t Graph::get_or_add_tensor(const std::string& name)
+{
+    if (name.empty())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Tensor names must not be empty");
+    }
+    const auto it = m_tensor_ids.find(name);
+    if (it != m_tensor_ids.end())
+    {
+        return it->second;
+    }
+    GraphTensor tensor;
+    tensor.name = name;
+    m_tensors.push_back(std::move(tensor));
+    m_tensor_ids.emplace(name, m_tensors.size() - 1u);
+    return m_tensors.size() - 1u;
+}
+
+size_t Graph::add_input(const std::string& name)
+{
+    const auto id = get_or_add_tensor(name);
+    if (is_defined(m_tensors[id]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Tensor " + name + " is already defined");
+    }
+    m_tensors[id].is_input = true;
+    m_inputs.push_back(id);
+    invalidate();
+    return id;
+}
+
+size_t Graph::add_constant(const std::string& name, std::shared_ptr<Tensor<float>> value)
+{
+    if (!value)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Constant " + name + " has no value");
+    }
+    const auto id = get_or_add_tensor(name);
+    if (is_defined(m_tensors[id]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Tensor " + name + " is already defined");
+    }
+    m_tensors[id].constant = std::move(value);
+    invalidate();
+    return id;
+}
+
+size_t Graph::add_node(const std::string& name, Layer* layer, const std::string& input, const std::string& output)
+{
+    if (!layer)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Node " + name + " has no layer");
+    }
+    return add_op(name, NODE_OP::LAYER, layer, {input}, output);
+}
+
+size_t Graph::add_add(const std::string& name, const std::string& left, const std::string& right, const std::string& output)
+{
+    return add_op(name, NODE_OP::ADD, nullptr, {left, right}, output);
+}
+
+size_t Graph::add_op(const std::string& name, NODE_OP op, Layer* layer, const std::vector<std::string>& inputs,
+                     const std::string& output)
+{
+    if (m_node_ids.count(name) > 0u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Node " + name + " already exists");
+    }
+    const auto output_id = get_or_add_tensor(output);
+    if (is_defined(m_tensors[output_id]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Tensor " + output + " is already defined");
+    }
+
+    GraphNode node;
+    node.name = name;
+    node.op = op;
+    node.layer = layer;
+    node.output = output_id;
+    for (const auto& input : inputs)
+    {
+        node.inputs.push_back(get_or_add_tensor(input));
+    }
+    m_nodes.push_back(std::move(node));
+    m_tensors[output_id].producer = m_nodes.size() - 1u;
+    m_node_ids.emplace(name, m_nodes.size() - 1u);
+    invalidate();
+    return m_nodes.size() - 1u;
+}
+
+void Graph::add_output(const std::string& name)
+{
+    const auto id = get_or_add_tensor(name);
+    if (!m_tensors[id].is_output)
+    {
+        m_tensors[id].is_output = true;
+        m_outputs.push_back(id);
+        invalidate();
+    }
+}
+
+void Graph::keep_alive(std::shared_ptr<void> resource)
+{
+    m_resources.emplace_back(std::move(resource));
+}
+
+size_t Graph::get_tensor_id(const std::string& name) const
+{
+    const auto it = m_tensor_ids.find(name);
+    if (it == m_tensor_ids.end())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::out_of_range("Graph has no tensor " + name);
+    }
+    return it->second;
+}
+
+bool Graph::has_tensor(const std::string& name) const
+{
+    return m_tensor_ids.count(name) > 0u;
+}
+
+const GraphTensor& Graph::get_tensor(size_t tensor) const
+{
+    return m_tensors.at(tensor);
+}
+
+const GraphNode& Graph::get_node(size_t node) const
+{
+    return m_nodes.at(node);
+}
+
+size_t Graph::get_num_tensors() const
+{
+    return m_tensors.size();
+}
+
+size_t Graph::get_node_capacity() const
+{
+    return m_nodes.size();
+}
+
+size_t Graph::get_num_nodes() const
+{
+    return static_cast<size_t>(std::count_if(m_nodes.cbegin(), m_nodes.cend(), [](const GraphNode& node)
+    {
+        return !node.removed;
+    }));
+}
+
+std::vector<size_t> Graph::get_consumers(size_t tensor) const
+{
+    std::vector<size_t> consumers;
+    for (auto i = 0u; i < m_nodes.size(); ++i)
+    {
+        const auto& inputs = m_nodes[i].inputs;
+        if (!m_nodes[i].removed && std::find(inputs.cbegin(), inputs.cend(), tensor) != inputs.cend())
+        {
+            consumers.push_back(i);
+        }
+    }
+    return consumers;
+}
+
+const std::vector<size_t>& Graph::get_inputs() const
+{
+    return m_inputs;
+}
+
+const std::vector<size_t>& Graph::get_outputs() const
+{
+    return m_outputs;
+}
+
+void Graph::remove_node(size_t node)
+{
+    auto& graph_node = m_nodes.at(node);
+    if (graph_node.removed)
+    {
+        return;
+    }
+    graph_node.removed = true;
+    if (m_tensors[graph_node.output].producer == node)
+    {
+        m_tensors[graph_node.output].producer = NO_NODE;
+    }
+    invalidate();
+}
+
+void Graph::set_node_output(size_t node, size_t tensor)
+{
+    auto& graph_node = m_nodes.at(node);
+    auto& graph_tensor = m_tensors.at(tensor);
+    if (graph_tensor.producer != node && is_defined(graph_tensor))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Tensor " + graph_tensor.name + " is already defined");
+    }
+    if (m_tensors[graph_node.output].producer == node)
+    {
+        m_tensors[graph_node.output].producer = NO_NODE;
+    }
+    graph_node.output = tensor;
+    graph_tensor.producer = node;
+    invalidate();
+}
+
+void Graph::set_constant(size_t tensor, std::shared_ptr<Tensor<float>> value)
+{
+    const auto producer = m_tensors.at(tensor).producer;
+    if (producer != NO_NODE)
+    {
+        remove_node(producer);
+    }
+    m_tensors[tensor].constant = std::move(value);
+    invalidate();
+}
+
+void Graph::invalidate()
+{
+    m_scheduled = false;
+    m_planned_platform = PLATFORM::UNKNOWN;
+}
+
+const std::vector<std::vector<size_t>>& Graph::get_schedule()
+{
+    if (m_scheduled)
+    {
+        return m_schedule;
+    }
+
+    // Kahn's algorithm, one stage at a time: a node is ready once every node it reads from ran
+    std::vector<std::vector<size_t>> consumers(m_tensors.size());
+    std::vector<size_t> num_pending(m_nodes.size(), 0u);
+    std::vector<size_t> ready;
+    size_t num_live = 0u;
+    for (auto i = 0u; i < m_nodes.size(); ++i)
+    {
+        if (m_nodes[i].removed)
+        {
+            continue;
+        }
+        ++num_live;
+        for (const auto input : m_nodes[i].inputs)
+        {
+            const auto& tensor = m_tensors[input];
+            if (!is_defined(tensor))
+            {
+                std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+                throw std::runtime_error("Tensor " + tensor.name + " is read but never written");
+            }
+            if (tensor.producer != NO_NODE)
+            {
+                // a node reading a tensor twice waits for it twice
+                consumers[input].push_back(i);
+                ++num_pending[i];
+            }
+        }
+        if (num_pending[i] == 0u)
+        {
+            ready.push_back(i);
+        }
+    }
+
+    std::vector<std::vector<size_t>> schedule;
+    size_t num_scheduled = 0u;
+    while (!ready.empty())
+    {
+        std::vector<size_t> next;
+        for (const auto node : ready)
+        {
+            for (const auto consumer : consumers[m_nodes[node].output])
+            {
+                if (--num_pending[consumer] == 0u)
+                {
+                    next.push_back(consumer);
+                }
+            }
+        }
+        num_scheduled += ready.size();
+        std::sort(next.begin(), next.end());
+        schedule.push_back(std::move(ready));
+        ready = std::move(next);
+    }
+    if (num_scheduled != num_live)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Graph has a cycle");
+    }
+
+    m_schedule = std::move(schedule);
+    m_scheduled = true;
+    return m_schedule;
+}
+
+std::vector<size_t> Graph::get_topological_order()
+{
+    std::vector<size_t> order;
+    for (const auto& stage : get_schedule())
+    {
+        order.insert(order.end(), stage.cbegin(), stage.cend());
+    }
+    return order;
+}
+
+size_t Graph::optimize()
+{
+    return PassManager::create_default()->run(*this);
+}
+
+void Graph::to_host()
+{
+    optimize();
+    m_platform = PLATFORM::HOST;
+    for (const auto& node : m_nodes)
+    {
+        if (!node.removed && node.layer)
+        {
+            node.layer->to_host();
+        }
+    }
+    for (const auto& tensor : m_tensors)
+    {
+        if (tensor.constant)
+        {
+            tensor.constant->load_to_host();
+        }
+    }
+}
+
+void Graph::to_device()
+{
+    optimize();
+    m_platform = PLATFORM::DEVICE;
+    for (const auto& node : m_nodes)
+    {
+        if (!node.removed && node.layer)
+        {
+            node.layer->to_device();
+        }
+    }
+    for (const auto& tensor : m_tensors)
+    {
+        if (tensor.constant)
+        {
+            tensor.constant->load_to_device();
+        }
+    }
+}
+
+PLATFORM Graph::get_platform() const
+{
+    return m_platform;
+}
+
+void Graph::execute(const std::map<std::string, const Tensor<float>*>& inputs,
+                    const std::map<std::string, Tensor<float>*>& outputs)
+{
+    if (m_platform == PLATFORM::UNKNOWN)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Graph is not loaded to a platform");
+    }
+    const auto& schedule = get_schedule();
+    if (schedule.empty())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Graph does not have any nodes");
+    }
+
+    std::vector<const Tensor<float>*> values(m_tensors.size(), nullptr);
+    std::vector<Tensor<float>*> results(m_tensors.size(), nullptr);
+    auto replan = m_planned_platform != m_platform;
+    for (auto i = 0u; i < m_inputs.size(); ++i)
+    {
+        const auto& name = m_tensors[m_inputs[i]].name;
+        const auto it = inputs.find(name);
+        if (it == inputs.end() || !it->second)
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::invalid_argument("Missing graph input " + name);
+        }
+        values[m_inputs[i]] = it->second;
+        replan = replan || i >= m_planned_dims.size() || it->second->get_dims() != m_planned_dims[i];
+    }
+    for (const auto output : m_outputs)
+    {
+        const auto& tensor = m_tensors[output];
+        const auto it = outputs.find(tensor.name);
+        if (it == outputs.end() || !it->second)
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::invalid_argument("Missing graph output " + tensor.name);
+        }
+        if (tensor.producer == NO_NODE)
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::runtime_error("Graph output " + tensor.name + " is not written by a node");
+        }
+        values[output] = results[output] = it->second;
+    }
+
+    if (replan)
+    {
+        plan(inputs);
+    }
+    for (auto i = 0u; i < m_tensors.size(); ++i)
+    {
+        if (m_tensors[i].constant)
+        {
+            values[i] = m_tensors[i].constant.get();
+        }
+        else if (m_values[i])
+        {
+            values[i] = results[i] = m_values[i].get();
+        }
+    }
+
+    const auto profile = Profiler::is_enabled();
+    const auto run_index = profile ? Profiler::instance().begin_run() : 0u;
+    auto run = [&](size_t node)
+    {
+        const auto& graph_node = m_nodes[node];
+        std::vector<const Tensor<float>*> node_inputs;
+        node_inputs.reserve(graph_node.inputs.size());
+        for (const auto input : graph_node.inputs)
+        {
+            node_inputs.push_back(values[input]);
+        }
+        if (!profile)
+        {
+            run_node(node, node_inputs, results[graph_node.output], m_scratch[node].get());
+            return;
+        }
+        // the node may run on a worker of the pool
+        auto& profiler = Profiler::instance();
+        profiler.join_run(run_index);
+        const auto start_us = profiler.now_us();
+        run_node(node, node_inputs, results[graph_node.output], m_scratch[node].get());
+        profiler.record_layer(graph_node.name, start_us, profiler.now_us());
+    };
+
+    // device commands are chained through events, enqueueing a stage in order loses no overlap
+    const auto concurrent = m_concurrent_branches && m_platform == PLATFORM::HOST;
+    for (auto stage_index = 0u; stage_index < schedule.size(); ++stage_index)
+    {
+        const auto& stage = schedule[stage_index];
+        if (concurrent && m_concurrent_stages[stage_index])
+        {
+            // one node per chunk, the kernels of a node then run on the thread that took it
+            ThreadPool::get_default()->parallel_for(0u, stage.size(), 1u, [&](size_t first, size_t last)
+            {
+                for (auto i = first; i < last; ++i)
+                {
+                    run(stage[i]);
+                }
+            });
+            continue;
+        }
+        for (const auto node : stage)
+        {
+            run(node);
+        }
+    }
+}
+
+void Graph::execute(const Tensor<float>* input, Tensor<float>* result1)
+{
+    if (m_inputs.size() != 1u || m_outputs.size() != 1u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Graph does not have one input and one output");
+    }
+    execute({{m_tensors[m_inputs[0]].name, input}}, {{m_tensors[m_outputs[0]].name, result1}});
+}
+
+void Graph::run_node(size_t node, const std::vector<const Tensor<float>*>& inputs, Tensor<float>* output,
+                     Tensor<float>* scratch) const
+{
+    const auto& graph_node = m_nodes.at(node);
+    switch (graph_node.op)
+    {
+        case NODE_OP::LAYER:
+            graph_node.layer->forward(inputs[0], output, scratch);
+            break;
+        case NODE_OP::ADD:
+            add_tensors(inputs[0], inputs[1], output);
+            break;
+    }
+}
+
+std::vector<size_t> Graph::get_output_dims(size_t node, const std::vector<std::vector<size_t>>& input_dims) const
+{
+    const auto& graph_node = m_nodes.at(node);
+    if (graph_node.op == NODE_OP::LAYER)
+    {
+        return graph_node.layer->get_output_dims(input_dims[0]);
+    }
+
+    // matrices may broadcast a row of the right operand, like Tensor::add
+    const auto& left = input_dims[0];
+    const auto& right = input_dims[1];
+    const auto valid = left.size() == 2u ? right.size() == 2u && left[1] == right[1] && (left[0] == right[0] || right[0] == 1u)
+                                         : left == right;
+    if (!valid)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Node " + graph_node.name + " adds tensors of different dims");
+    }
+    return left;
+}
+
+void Graph::set_concurrent_branches(bool concurrent_branches)
+{
+    m_concurrent_branches = concurrent_branches;
+}
+
+bool Graph::get_concurrent_branches() const
+{
+    return m_concurrent_branches;
+}
+
+const std::vector<bool>& Graph::get_concurrent_stages() const
+{
+    return m_concurrent_stages;
+}
+
+void Graph::plan(const std::map<std::string, const Tensor<float>*>& inputs)
+{
+    const auto& schedule = get_schedule();
+    const auto num_tensors = m_tensors.size();
+    const auto num_stages = schedule.size();
+
+    std::vector<std::vector<size_t>> dims(num_tensors);
+    std::vector<std::vector<size_t>> input_dims;
+    const Tensor<float>* reference = nullptr;
+    for (const auto input : m_inputs)
+    {
+        const auto it = inputs.find(m_tensors[input].name);
+        if (it == inputs.end() || !it->second)
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::invalid_argument("Missing graph input " + m_tensors[input].name);
+        }
+        dims[input] = it->second->get_dims();
+        input_dims.push_back(dims[input]);
+        reference = reference ? reference : it->second;
+    }
+    if (!reference)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Graph does not have any inputs");
+    }
+    for (auto i = 0u; i < num_tensors; ++i)
+    {
+        if (m_tensors[i].constant)
+        {
+            dims[i] = m_tensors[i].constant->get_dims();
+        }
+    }
+
+    // a tensor is written in the stage of its producer and read until the last stage of its consumers.
+    // Inputs, constants and outputs are not planned, the output of a view node is the storage of its input
+    ArenaPlan arena_plan;
+    const auto arena = arena_plan.add_arena(reference->get_alignment());
+    std::vector<size_t> values(num_tensors);
+    for (auto i = 0u; i < num_tensors; ++i)
+    {
+        values[i] = arena_plan.add_external();
+    }
+    std::vector<size_t> scratch_values(m_nodes.size());
+    std::vector<std::vector<size_t>> scratch_dims(m_nodes.size());
+    m_concurrent_stages.assign(num_stages, false);
+    for (size_t stage = 0u; stage < num_stages; ++stage)
+    {
+        auto small_nodes = true;
+        for (const auto node : schedule[stage])
+        {
+            const auto& graph_node = m_nodes[node];
+            std::vector<std::vector<size_t>> node_input_dims;
+            for (const auto input : graph_node.inputs)
+            {
+                node_input_dims.push_back(dims[input]);
+                arena_plan.add_use(values[input], stage);
+            }
+            const auto output = graph_node.output;
+            dims[output] = get_output_dims(node, node_input_dims);
+            if (graph_node.layer && graph_node.layer->is_view())
+            {
+                values[output] = arena_plan.add_view(values[graph_node.inputs[0]]);
+            }
+            else if (!m_tensors[output].is_output)
+            {
+                values[output] = arena_plan.add_value(arena, dims[output], stage);
+            }
+            if (graph_node.layer && graph_node.layer->requires_scratch())
+            {
+                scratch_dims[node] = graph_node.layer->get_scratch_dims(node_input_dims[0]);
+                scratch_values[node] = arena_plan.add_value(arena, scratch_dims[node], stage);
+            }
+
+            const auto num_operations = graph_node.layer ? graph_node.layer->get_num_operations(node_input_dims[0])
+                                                         : get_num_elements(dims[output]);
+            small_nodes = small_nodes && num_operations < CONCURRENT_NODE_MAX_OPERATIONS;
+        }
+        m_concurrent_stages[stage] = small_nodes && schedule[stage].size() > 1u;
+    }
+    // the caller reads outputs after the last stage, views of planned blocks must survive it
+    for (const auto output : m_outputs)
+    {
+        arena_plan.add_use(values[output], num_stages);
+    }
+    const auto arena_size = arena_plan.plan(arena);
+
+    // release the old windows before the arena they point into
+    m_values.clear();
+    m_scratch.clear();
+    m_arena.reset(reference->create_empty());
+    m_arena->allocate({std::max<size_t>(arena_size, 1u)});
+
+    m_values.resize(num_tensors);
+    m_scratch.resize(m_nodes.size());
+    for (auto i = 0u; i < m_nodes.size(); ++i)
+    {
+        const auto& graph_node = m_nodes[i];
+        if (graph_node.removed)
+        {
+            continue;
+        }
+        const auto output = graph_node.output;
+        if (!m_tensors[output].is_output)
+        {
+            // views get their storage from forward
+            m_values[output].reset(reference->create_empty());
+            arena_plan.alias(values[output], m_arena.get(), m_values[output].get());
+        }
+        if (graph_node.layer && graph_node.layer->requires_scratch())
+        {
+            m_scratch[i].reset(reference->create_empty());
+            arena_plan.alias(scratch_values[i], m_arena.get(), m_scratch[i].get());
+        }
+    }
+
+    m_planned_dims = input_dims;
+    m_planned_platform = m_platform;
+    m_peak_activation_bytes = arena_size * sizeof(float);
+}
+
+size_t Graph::get_peak_activation_bytes() const
+{
+    return m_peak_activation_bytes;
+}
@@ -0,0 +1,155 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include "../layer/Layer.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class NODE_OP
+{
+    LAYER = 0,  // forward of a Layer on one input
+    ADD         // sum of two inputs, e.g. a residual connection
+};
+
+struct GraphNode
+{
+    std::string         name;
+    NODE_OP             op = NODE_OP::LAYER;
+    Layer*              layer = nullptr;    // LAYER only
+    std::vector<size_t> inputs;             // tensor ids
+    size_t              output = 0u;        // tensor id
+    bool                removed = false;    // removed by a pass, ids of the other nodes stay valid
+};
+
+struct GraphTensor
+{
+    std::string                    name;
+    size_t                         producer = static_cast<size_t>(-1);  // node id, Graph::NO_NODE if none
+    bool                           is_input = false;
+    bool                           is_output = false;
+    std::shared_ptr<Tensor<float>> constant;            // data known before execute, e.g. folded
+};
+
+/*
+* @brief  dataflow graph of named tensors and the nodes between them
+* @note   every tensor is written by one node or is a graph input or constant; tensors may be
+*         referenced before the node writing them is added. Nodes run in stages (see get_schedule):
+*         the nodes of a stage only read tensors of earlier stages, so independent branches share a
+*         stage. On the host the nodes of a stage too small to split their own kernels across the
+*         default ThreadPool run concurrently on it instead; on the device
+*         they are enqueued back to back and, since every command waits on the events of its inputs
+*         only, an out-of-order queue overlaps them.
+*         Like Model, the graph does not own layers and plans its intermediates into one arena
+*/
+class Graph
+{
+public:
+    static constexpr size_t NO_NODE = static_cast<size_t>(-1);
+
+    Graph();
+    virtual ~Graph() = default;
+
+    Graph(const Graph&) = delete;
+    Graph& operator=(const Graph&) = delete;
+
+    // each returns the id of the named tensor or added node
+    virtual size_t add_input(const std::string& name);
+    virtual size_t add_constant(const std::string& name, std::shared_ptr<Tensor<float>> value);
+    virtual size_t add_node(const std::string& name, Layer* layer, const std::string& input, const std::string& output);
+    virtual size_t add_add(const std::string& name, const std::string& left, const std::string& right, const std::string& output);
+    virtual void add_output(const std::string& name);
+    // ties the lifetime of layers, tensors or mapped files to the graph
+    virtual void keep_alive(std::shared_ptr<void> resource);
+
+    virtual size_t get_tensor_id(const std::string& name) const;
+    virtual bool has_tensor(const std::string& name) const;
+    virtual const GraphTensor& get_tensor(size_t tensor) const;
+    virtual const GraphNode& get_node(size_t node) const;
+    virtual size_t get_num_tensors() const;
+    // including removed nodes, i.e. one past the largest node id
+    virtual size_t get_node_capacity() const;
+    // nodes that were not removed
+    virtual size_t get_num_nodes() const;
+    // nodes that read tensor and were not removed
+    virtual std::vector<size_t> get_consumers(size_t tensor) const;
+    virtual const std::vector<size_t>& get_inputs() const;
+    virtual const std::vector<size_t>& get_outputs() const;
+
+    // rewrites used by passes, each invalidates the schedule and the plan
+    virtual void remove_node(size_t node);
+    // node writes tensor instead of its current output, which loses its producer
+    virtual void set_node_output(size_t node, size_t tensor);
+    // tensor becomes a constant, its producer is removed
+    virtual void set_constant(size_t tensor, std::shared_ptr<Tensor<float>> value);
+
+    /*
+    * @brief  topological order of the live nodes, as stages of nodes that may run concurrently
+    * @note   a node is in the stage after the latest stage of the nodes it reads from. Throws if a
+    *         node reads a tensor that is neither written, an input nor a constant, or if there is a cycle
+    */
+    virtual const std::vector<std::vector<size_t>>& get_schedule();
+    virtual std::vector<size_t> get_topological_order();
+
+    // runs the default passes (see PassManager::create_default), returns the number of rewrites
+    virtual size_t optimize();
+    // optimize, then load the layers and constants
+    virtual void to_host();
+    virtual void to_device();
+    virtual PLATFORM get_platform() const;
+
+    // inputs and outputs by name, every graph input and output must be given
+    virtual void execute(const std::map<std::string, const Tensor<float>*>& inputs,
+                         const std::map<std::string, Tensor<float>*>& outputs);
+    // for a graph of one input and one output
+    virtual void execute(const Tensor<float>* input, Tensor<float>* result1);
+    // runs node on the platform of its inputs; scratch may be nullptr unless the layer requires it
+    virtual void run_node(size_t node, const std::vector<const Tensor<float>*>& inputs, Tensor<float>* output,
+                          Tensor<float>* scratch) const;
+    virtual std::vector<size_t> get_output_dims(size_t node, const std::vector<std::vector<size_t>>& input_dims) const;
+
+    // runs the nodes of a stage concurrently on the host, enabled by default. Only stages whose nodes are
+    // each too small to use the pool themselves do, a larger node keeps every thread to itself
+    virtual void set_concurrent_branches(bool concurrent_branches);
+    virtual bool get_concurrent_branches() const;
+    // per stage of the schedule, whether its nodes run concurrently on the host for the planned shapes
+    virtual const std::vector<bool>& get_concurrent_stages() const;
+
+    // assigns every intermediate a window of one arena with ArenaPlan, like Model::plan; blocks of nodes in
+    // one stage never overlap. execute plans again only if an input shape or the platform changes
+    virtual void plan(const std::map<std::string, const Tensor<float>*>& inputs);
+    virtual size_t get_peak_activation_bytes() const;
+
+protected:
+    virtual size_t get_or_add_tensor(const std::string& name);
+    virtual size_t add_op(const std::string& name, NODE_OP op, Layer* layer, const std::vector<std::string>& inputs,
+                          const std::string& output);
+    virtual void invalidate();
+
+protected:
+    std::vector<GraphNode>             m_nodes;
+    std::vector<GraphTensor>           m_tensors;
+    std::map<std::string, size_t>      m_tensor_ids;
+    std::map<std::string, size_t>      m_node_ids;
+    std::vector<size_t>                m_inputs;
+    std::vector<size_t>                m_outputs;
+    std::vector<std::shared_ptr<void>> m_resources;
+    PLATFORM                           m_platform = PLATFORM::UNKNOWN;
+    bool                               m_concurrent_branches = true;
+
+    std::vector<std::vector<size_t>>   m_schedule;
+    bool                               m_scheduled = false;
+
+    // activation arena, see plan()
+    std::unique_ptr<Tensor<float>>              m_arena;
+    std::vector<std::unique_ptr<Tensor<float>>> m_values;    // per tensor, written intermediates only
+    std::vector<std::unique_ptr<Tensor<float>>> m_scratch;   // per node, nullptr if not required
+    std::vector<bool>                           m_concurrent_stages;
+    std::vector<std::vector<size_t>>            m_planned_dims;
+    PLATFORM                                    m_planned_platform = PLATFORM::UNKNOWN;
+    size_t                                      m_peak_activation_bytes = 0u;
+};
+
+#endif  // GRAPH_H
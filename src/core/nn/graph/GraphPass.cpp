@@ -0,0 +1,218 @@
+#include "GraphPass.h"
+#include "../layer/Activation.h"
+
+#include <algorithm>
+#include <map>
+
+std::string FusionPass::get_name() const
+{
+    return "fusion";
+}
+
+size_t FusionPass::run(Graph& graph)
+{
+    std::map<const Layer*, size_t> layer_uses;
+    for (auto i = 0u; i < graph.get_node_capacity(); ++i)
+    {
+        const auto& node = graph.get_node(i);
+        if (!node.removed && node.layer)
+        {
+            ++layer_uses[node.layer];
+        }
+    }
+
+    size_t num_fused = 0u;
+    for (const auto node : graph.get_topological_order())
+    {
+        const auto& activation_node = graph.get_node(node);
+        const auto activation = dynamic_cast<const Activation*>(activation_node.layer);
+        if (activation_node.removed || !activation)
+        {
+            continue;
+        }
+
+        const auto input = activation_node.inputs[0];
+        const auto& tensor = graph.get_tensor(input);
+        if (tensor.producer == Graph::NO_NODE || tensor.is_output || graph.get_consumers(input).size() != 1u)
+        {
+            continue;
+        }
+        const auto producer = tensor.producer;
+        auto layer = graph.get_node(producer).layer;
+        if (!layer || layer_uses[layer] != 1u || !layer->fuse_activation(activation->get_activation()))
+        {
+            continue;
+        }
+
+        // the producer now writes what the activation wrote, its old output is left unread
+        const auto output = activation_node.output;
+        graph.remove_node(node);
+        graph.set_node_output(producer, output);
+        ++num_fused;
+    }
+    return num_fused;
+}
+
+std::string ConstantFoldingPass::get_name() const
+{
+    return "constant folding";
+}
+
+size_t ConstantFoldingPass::run(Graph& graph)
+{
+    size_t num_folded = 0u;
+    // in topological order a folded node's consumers see its constant output in the same run
+    for (const auto node : graph.get_topological_order())
+    {
+        const auto& graph_node = graph.get_node(node);
+        if (graph_node.removed || graph.get_tensor(graph_node.output).is_output)
+        {
+            continue;
+        }
+
+        std::vector<const Tensor<float>*> inputs;
+        std::vector<std::vector<size_t>> input_dims;
+        for (const auto input : graph_node.inputs)
+        {
+            const auto& constant = graph.get_tensor(input).constant;
+            if (!constant)
+            {
+                break;
+            }
+            if (constant->get_platform() != PLATFORM::HOST)
+            {
+                constant->load_to_host();
+            }
+            inputs.push_back(constant.get());
+            input_dims.push_back(constant->get_dims());
+        }
+        if (inputs.size() != graph_node.inputs.size())
+        {
+            continue;
+        }
+
+        auto layer = graph_node.layer;
+        if (layer && layer->get_platform() != PLATFORM::HOST)
+        {
+            layer->to_host();
+        }
+        std::shared_ptr<Tensor<float>> output(inputs[0]->create_empty());
+        output->allocate(graph.get_output_dims(node, input_dims));
+        std::unique_ptr<Tensor<float>> scratch;
+        if (layer && layer->requires_scratch())
+        {
+            scratch.reset(inputs[0]->create_empty());
+            scratch->allocate(layer->get_scratch_dims(input_dims[0]));
+        }
+        graph.run_node(node, inputs, output.get(), scratch.get());
+
+        if (layer && layer->is_view())
+        {
+            // the view shares the storage of its input, the constant gets a copy of its own
+            std::shared_ptr<Tensor<float>> copy(inputs[0]->create_empty());
+            copy->set_host_data(std::vector<float>(output->data(), output->data() + output->get_size()));
+            copy->set_dims(output->get_dims());
+            output = std::move(copy);
+        }
+        graph.set_constant(graph_node.output, std::move(output));
+        ++num_folded;
+    }
+    return num_folded;
+}
+
+std::string DeadNodeEliminationPass::get_name() const
+{
+    return "dead-node elimination";
+}
+
+size_t DeadNodeEliminationPass::run(Graph& graph)
+{
+    // without outputs every node would be dead, more likely the graph is still being built
+    if (graph.get_outputs().empty())
+    {
+        return 0u;
+    }
+
+    // walk back from the outputs through the producers
+    std::vector<bool> live(graph.get_num_tensors(), false);
+    std::vector<size_t> pending(graph.get_outputs());
+    while (!pending.empty())
+    {
+        const auto tensor = pending.back();
+        pending.pop_back();
+        if (live[tensor])
+        {
+            continue;
+        }
+        live[tensor] = true;
+        const auto producer = graph.get_tensor(tensor).producer;
+        if (producer != Graph::NO_NODE)
+        {
+            const auto& inputs = graph.get_node(producer).inputs;
+            pending.insert(pending.end(), inputs.cbegin(), inputs.cend());
+        }
+    }
+
+    size_t num_removed = 0u;
+    for (auto i = 0u; i < graph.get_node_capacity(); ++i)
+    {
+        const auto& node = graph.get_node(i);
+        if (!node.removed && !live[node.output])
+        {
+            graph.remove_node(i);
+            ++num_removed;
+        }
+    }
+    return num_removed;
+}
+
+PassManager::PassManager()
+{
+}
+
+void PassManager::add_pass(std::unique_ptr<GraphPass> pass)
+{
+    m_passes.push_back(std::move(pass));
+}
+
+size_t PassManager::get_num_passes() const
+{
+    return m_passes.size();
+}
+
+size_t PassManager::run(Graph& graph, size_t max_iterations)
+{
+    m_num_rewrites.assign(m_passes.size(), 0u);
+    size_t num_rewrites = 0u;
+    for (auto iteration = 0u; iteration < max_iterations; ++iteration)
+    {
+        size_t num_iteration_rewrites = 0u;
+        for (auto i = 0u; i < m_passes.size(); ++i)
+        {
+            const auto num_pass_rewrites = m_passes[i]->run(graph);
+            m_num_rewrites[i] += num_pass_rewrites;
+            num_iteration_rewrites += num_pass_rewrites;
+        }
+        num_rewrites += num_iteration_rewrites;
+        if (num_iteration_rewrites == 0u)
+        {
+            break;
+        }
+    }
+    return num_rewrites;
+}
+
+const std::vector<size_t>& PassManager::get_num_rewrites() const
+{
+    return m_num_rewrites;
+}
+
+std::unique_ptr<PassManager> PassManager::create_default()
+{
+    std::unique_ptr<PassManager> manager(new PassManager());
+    // dead nodes go first, so nothing is folded or fused only to be dropped
+    manager->add_pass(std::unique_ptr<GraphPass>(new DeadNodeEliminationPass()));
+    manager->add_pass(std::unique_ptr<GraphPass>(new ConstantFoldingPass()));
+    manager->add_pass(std::unique_ptr<GraphPass>(new FusionPass()));
+    return manager;
+}
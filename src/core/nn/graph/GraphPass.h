@@ -0,0 +1,79 @@
+#ifndef GRAPH_PASS_H
+#define GRAPH_PASS_H
+
+#include "Graph.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+* @brief  a rewrite of a Graph
+* @note   run returns how many rewrites it made, 0 once the graph is a fixed point of the pass
+*/
+class GraphPass
+{
+public:
+    virtual ~GraphPass() = default;
+    virtual std::string get_name() const = 0;
+    virtual size_t run(Graph& graph) = 0;
+};
+
+/*
+* @brief  folds a RELU node into the node it reads from, see Layer::fuse_activation
+* @note   only if nothing else reads the tensor between them and no other node shares the layer,
+*         which fusing would change as well
+*/
+class FusionPass : public GraphPass
+{
+public:
+    virtual std::string get_name() const override;
+    virtual size_t run(Graph& graph) override;
+};
+
+/*
+* @brief  runs every node whose inputs are all constants once, on the host, and makes its output a constant
+* @note   constants created by create_empty of the first input, so a TensorOpenCL constant folds into one that
+*         to_device can load. Graph outputs are still written by a node and are not folded
+*/
+class ConstantFoldingPass : public GraphPass
+{
+public:
+    virtual std::string get_name() const override;
+    virtual size_t run(Graph& graph) override;
+};
+
+// removes the nodes no graph output depends on
+class DeadNodeEliminationPass : public GraphPass
+{
+public:
+    virtual std::string get_name() const override;
+    virtual size_t run(Graph& graph) override;
+};
+
+/*
+* @brief  runs passes in the order they were added, repeatedly until none rewrites the graph
+* @note   one rewrite can enable another, e.g. folding a branch leaves its consumer with constant inputs only
+*/
+class PassManager
+{
+public:
+    PassManager();
+    virtual ~PassManager() = default;
+
+    virtual void add_pass(std::unique_ptr<GraphPass> pass);
+    virtual size_t get_num_passes() const;
+    // returns the number of rewrites, gives up after max_iterations rounds
+    virtual size_t run(Graph& graph, size_t max_iterations = 8u);
+    // rewrites of every pass in the last run, in the order the passes were added
+    virtual const std::vector<size_t>& get_num_rewrites() const;
+
+    // dead-node elimination, constant folding, fusion
+    static std::unique_ptr<PassManager> create_default();
+
+protected:
+    std::vector<std::unique_ptr<GraphPass>> m_passes;
+    std::vector<size_t>                     m_num_rewrites;
+};
+
+#endif  // GRAPH_PASS_H
@@ -0,0 +1,314 @@
+#include "Elementwise.h"
+#include "SimdDispatch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#ifdef HOST_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+static void add_scalar(const float* a, const float* b, float* out, size_t begin, size_t size)
+{
+    for (size_t i = begin; i < size; ++i)
+    {
+        out[i] = a[i] + b[i];
+    }
+}
+
+static void relu_scalar(const float* in, float* out, size_t begin, size_t size)
+{
+    for (size_t i = begin; i < size; ++i)
+    {
+        out[i] = std::max(0.0f, in[i]);
+    }
+}
+
+// continues a search that found best at best_index among the elements before begin
+static size_t argmax_scalar(const float* in, size_t begin, size_t size, float best, size_t best_index)
+{
+    for (size_t i = begin; i < size; ++i)
+    {
+        if (in[i] > best)
+        {
+            best = in[i];
+            best_index = i;
+        }
+    }
+    return best_index;
+}
+
+// the per-lane maxima of a vector search and the index each was first seen at; the first
+// maximum overall is the largest value with the smallest index among the lanes
+static void reduce_lanes(const float* values, const int32_t* indices, size_t lanes, float& best, size_t& best_index)
+{
+    best = values[0];
+    best_index = static_cast<size_t>(indices[0]);
+    for (size_t lane = 1u; lane < lanes; ++lane)
+    {
+        const auto index = static_cast<size_t>(indices[lane]);
+        if (values[lane] > best || (values[lane] == best && index < best_index))
+        {
+            best = values[lane];
+            best_index = index;
+        }
+    }
+}
+
+#ifdef HOST_SIMD_DISPATCH
+// max(x, 0) with x as the first operand returns 0 for nan and -0, like std::max(0.0f, x)
+
+static void add_sse2(const float* a, const float* b, float* out, size_t size)
+{
+    size_t i = 0u;
+    for (; i + 4u <= size; i += 4u)
+    {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    add_scalar(a, b, out, i, size);
+}
+
+static void relu_sse2(const float* in, float* out, size_t size)
+{
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0u;
+    for (; i + 4u <= size; i += 4u)
+    {
+        _mm_storeu_ps(out + i, _mm_max_ps(_mm_loadu_ps(in + i), zero));
+    }
+    relu_scalar(in, out, i, size);
+}
+
+static size_t argmax_sse2(const float* in, size_t size)
+{
+    // sse2 has no blend, select with and / andnot / or
+    auto select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+
+    // two independent compare / select chains, lanes of the second one hold indices 4..7 of every 8
+    // every lane starts from in[0] like argmax_scalar, so a nan is never greater and never becomes a lane's best
+    __m128 best[2] = {_mm_set1_ps(in[0]), _mm_set1_ps(in[0])};
+    __m128i index[2] = {_mm_setr_epi32(0, 1, 2, 3), _mm_setr_epi32(4, 5, 6, 7)};
+    __m128 best_index[2] = {_mm_setzero_ps(), _mm_setzero_ps()};
+    const __m128i step = _mm_set1_epi32(8);
+    size_t i = 0u;
+    for (; i + 8u <= size; i += 8u)
+    {
+        for (size_t acc = 0u; acc < 2u; ++acc)
+        {
+            const __m128 value = _mm_loadu_ps(in + i + 4u * acc);
+            const __m128 greater = _mm_cmpgt_ps(value, best[acc]);
+            best[acc] = select(greater, value, best[acc]);
+            best_index[acc] = select(greater, _mm_castsi128_ps(index[acc]), best_index[acc]);
+            index[acc] = _mm_add_epi32(index[acc], step);
+        }
+    }
+
+    alignas(16) float values[8];
+    alignas(16) int32_t indices[8];
+    for (size_t acc = 0u; acc < 2u; ++acc)
+    {
+        _mm_store_ps(values + 4u * acc, best[acc]);
+        _mm_store_ps(reinterpret_cast<float*>(indices + 4u * acc), best_index[acc]);
+    }
+    float best_value = 0.0f;
+    size_t result = 0u;
+    reduce_lanes(values, indices, 8u, best_value, result);
+    return argmax_scalar(in, i, size, best_value, result);
+}
+
+__attribute__((target("avx2")))
+static void add_avx2(const float* a, const float* b, float* out, size_t size)
+{
+    size_t i = 0u;
+    for (; i + 16u <= size; i += 16u)
+    {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        _mm256_storeu_ps(out + i + 8u, _mm256_add_ps(_mm256_loadu_ps(a + i + 8u), _mm256_loadu_ps(b + i + 8u)));
+    }
+    for (; i + 8u <= size; i += 8u)
+    {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    add_scalar(a, b, out, i, size);
+}
+
+__attribute__((target("avx2")))
+static void relu_avx2(const float* in, float* out, size_t size)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0u;
+    for (; i + 16u <= size; i += 16u)
+    {
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_loadu_ps(in + i), zero));
+        _mm256_storeu_ps(out + i + 8u, _mm256_max_ps(_mm256_loadu_ps(in + i + 8u), zero));
+    }
+    for (; i + 8u <= size; i += 8u)
+    {
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_loadu_ps(in + i), zero));
+    }
+    relu_scalar(in, out, i, size);
+}
+
+__attribute__((target("avx2")))
+static size_t argmax_avx2(const float* in, size_t size)
+{
+    // two independent compare / blend chains hide their latency, lanes start from in[0] as in argmax_sse2
+    __m256 best[2] = {_mm256_set1_ps(in[0]), _mm256_set1_ps(in[0])};
+    __m256i index[2] = {_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15)};
+    __m256 best_index[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+    const __m256i step = _mm256_set1_epi32(16);
+    size_t i = 0u;
+    for (; i + 16u <= size; i += 16u)
+    {
+        for (size_t acc = 0u; acc < 2u; ++acc)
+        {
+            const __m256 value = _mm256_loadu_ps(in + i + 8u * acc);
+            const __m256 greater = _mm256_cmp_ps(value, best[acc], _CMP_GT_OQ);
+            best[acc] = _mm256_blendv_ps(best[acc], value, greater);
+            best_index[acc] = _mm256_blendv_ps(best_index[acc], _mm256_castsi256_ps(index[acc]), greater);
+            index[acc] = _mm256_add_epi32(index[acc], step);
+        }
+    }
+
+    alignas(32) float values[16];
+    alignas(32) int32_t indices[16];
+    for (size_t acc = 0u; acc < 2u; ++acc)
+    {
+        _mm256_store_ps(values + 8u * acc, best[acc]);
+        _mm256_store_ps(reinterpret_cast<float*>(indices + 8u * acc), best_index[acc]);
+    }
+    float best_value = 0.0f;
+    size_t result = 0u;
+    reduce_lanes(values, indices, 16u, best_value, result);
+    return argmax_scalar(in, i, size, best_value, result);
+}
+
+__attribute__((target("avx512f")))
+static void add_avx512(const float* a, const float* b, float* out, size_t size)
+{
+    size_t i = 0u;
+    for (; i + 16u <= size; i += 16u)
+    {
+        _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    }
+    // the tail with a masked load and store instead of a scalar loop
+    const auto tail = static_cast<__mmask16>((1u << (size - i)) - 1u);
+    _mm512_mask_storeu_ps(out + i, tail, _mm512_add_ps(_mm512_maskz_loadu_ps(tail, a + i), _mm512_maskz_loadu_ps(tail, b + i)));
+}
+
+__attribute__((target("avx512f")))
+static void relu_avx512(const float* in, float* out, size_t size)
+{
+    const __m512 zero = _mm512_setzero_ps();
+    size_t i = 0u;
+    for (; i + 16u <= size; i += 16u)
+    {
+        _mm512_storeu_ps(out + i, _mm512_max_ps(_mm512_loadu_ps(in + i), zero));
+    }
+    const auto tail = static_cast<__mmask16>((1u << (size - i)) - 1u);
+    _mm512_mask_storeu_ps(out + i, tail, _mm512_max_ps(_mm512_maskz_loadu_ps(tail, in + i), zero));
+}
+
+__attribute__((target("avx512f")))
+static size_t argmax_avx512(const float* in, size_t size)
+{
+    // two independent compare / blend chains hide their latency, lanes start from in[0] as in argmax_sse2
+    __m512 best[2] = {_mm512_set1_ps(in[0]), _mm512_set1_ps(in[0])};
+    __m512i index[2] = {_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                        _mm512_setr_epi32(16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31)};
+    __m512i best_index[2] = {_mm512_setzero_si512(), _mm512_setzero_si512()};
+    const __m512i step = _mm512_set1_epi32(32);
+    size_t i = 0u;
+    for (; i + 32u <= size; i += 32u)
+    {
+        for (size_t acc = 0u; acc < 2u; ++acc)
+        {
+            const __m512 value = _mm512_loadu_ps(in + i + 16u * acc);
+            const __mmask16 greater = _mm512_cmp_ps_mask(value, best[acc], _CMP_GT_OQ);
+            best[acc] = _mm512_mask_blend_ps(greater, best[acc], value);
+            best_index[acc] = _mm512_mask_blend_epi32(greater, best_index[acc], index[acc]);
+            index[acc] = _mm512_add_epi32(index[acc], step);
+        }
+    }
+
+    alignas(64) float values[32];
+    alignas(64) int32_t indices[32];
+    for (size_t acc = 0u; acc < 2u; ++acc)
+    {
+        _mm512_store_ps(values + 16u * acc, best[acc]);
+        _mm512_store_si512(indices + 16u * acc, best_index[acc]);
+    }
+    float best_value = 0.0f;
+    size_t result = 0u;
+    reduce_lanes(values, indices, 32u, best_value, result);
+    return argmax_scalar(in, i, size, best_value, result);
+}
+#endif
+
+void ElementwiseHost::add(const float* a, const float* b, float* out, size_t size)
+{
+#ifdef HOST_SIMD_DISPATCH
+    switch (get_simd_isa())
+    {
+        case SIMD_ISA::AVX512:
+            add_avx512(a, b, out, size);
+            return;
+        case SIMD_ISA::AVX2:
+            add_avx2(a, b, out, size);
+            return;
+        case SIMD_ISA::SSE2:
+            add_sse2(a, b, out, size);
+            return;
+        default:
+            break;
+    }
+#endif
+    add_scalar(a, b, out, 0u, size);
+}
+
+void ElementwiseHost::relu(const float* in, float* out, size_t size)
+{
+#ifdef HOST_SIMD_DISPATCH
+    switch (get_simd_isa())
+    {
+        case SIMD_ISA::AVX512:
+            relu_avx512(in, out, size);
+            return;
+        case SIMD_ISA::AVX2:
+            relu_avx2(in, out, size);
+            return;
+        case SIMD_ISA::SSE2:
+            relu_sse2(in, out, size);
+            return;
+        default:
+            break;
+    }
+#endif
+    relu_scalar(in, out, 0u, size);
+}
+
+size_t ElementwiseHost::argmax(const float* in, size_t size)
+{
+    if (size == 0u)
+    {
+        return 0u;
+    }
+#ifdef HOST_SIMD_DISPATCH
+    // the vector paths track indices in int32 lanes and need two full vectors to start from
+    const auto isa = size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()) ? get_simd_isa() : SIMD_ISA::SCALAR;
+    if (isa == SIMD_ISA::AVX512 && size >= 32u)
+    {
+        return argmax_avx512(in, size);
+    }
+    if (isa >= SIMD_ISA::AVX2 && size >= 16u)
+    {
+        return argmax_avx2(in, size);
+    }
+    if (isa >= SIMD_ISA::SSE2 && size >= 8u)
+    {
+        return argmax_sse2(in, size);
+    }
+#endif
+    return argmax_scalar(in, 1u, size, in[0], 0u);
+}
@@ -0,0 +1,27 @@
+#ifndef ELEMENTWISE_H
+#define ELEMENTWISE_H
+
+#include <cstddef>
+
+/*
+* @brief  fp32 elementwise kernels on the host with SSE2, AVX2 and AVX-512 paths
+* @note   the path follows get_simd_isa (see SimdDispatch.h), a scalar loop is the fallback.
+*         Results match the scalar std:: algorithms exactly: relu(x) is std::max(0.0f, x) and
+*         argmax is the index of the first maximum, like std::max_element, including its nan
+*         ordering: a nan is never greater, so it is skipped unless it is in[0], which then wins
+*/
+class ElementwiseHost
+{
+public:
+    // elements per chunk when a tensor op splits a kernel across the ThreadPool
+    static constexpr size_t PARALLEL_GRAIN = 64u * 1024u;
+
+    // out = a + b, out may alias a or b
+    static void add(const float* a, const float* b, float* out, size_t size);
+    // out = max(0, in), out may alias in
+    static void relu(const float* in, float* out, size_t size);
+    // 0 for an empty range
+    static size_t argmax(const float* in, size_t size);
+};
+
+#endif  // ELEMENTWISE_H
@@ -0,0 +1,402 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/*
+* @brief  read-only view of a matrix operand described by a base pointer and strides
+* @note   a row-major m x n matrix has row_stride = n and col_stride = 1,
+*         its transpose is the same memory with the two strides swapped
+*/
+template<typename DATA_T>
+struct GemmOperand
+{
+    const DATA_T* data;
+    size_t        row_stride;
+    size_t        col_stride;
+
+    const DATA_T& at(size_t row, size_t col) const
+    {
+        return data[row * row_stride + col * col_stride];
+    }
+
+    GemmOperand<DATA_T> offset(size_t row, size_t col) const
+    {
+        return {data + row * row_stride + col * col_stride, row_stride, col_stride};
+    }
+};
+
+/*
+* @brief  work applied to C while it is written back for the last time
+* @note   bias is a row vector of n elements added to every row, relu clamps at zero afterwards.
+*         Fusing these into the GEMM saves a full read/write pass over C for each of them.
+*/
+template<typename DATA_T>
+struct GemmEpilogue
+{
+    const DATA_T* bias = nullptr;
+    bool          relu = false;
+
+    GemmEpilogue<DATA_T> offset(size_t col) const
+    {
+        return {bias ? bias + col : nullptr, relu};
+    }
+
+    DATA_T apply(DATA_T value, size_t col) const
+    {
+        if (bias)
+        {
+            value += bias[col];
+        }
+        return relu ? std::max(static_cast<DATA_T>(0), value) : value;
+    }
+};
+
+/*
+* @brief  cache-blocked, multi-threaded GEMM on the host: C (m x n) = A (m x k) * B (k x n)
+* @note   follows the GotoBLAS/BLIS loop nest: B is packed into KC x NC panels that stay in L3,
+*         A is packed into MC x KC blocks that stay in L2 and the micro-kernel accumulates an
+*         MR x NR register tile from NR-wide B slivers that stay in L1.
+*         The output is split into a 2-D grid of sub-problems, one per thread of the shared
+*         ThreadPool, so threads never write to the same element and need no synchronization.
+*/
+template<typename DATA_T>
+class GemmHost
+{
+public:
+    static constexpr size_t MR = 6;      // rows of the register tile
+    static constexpr size_t NR = 8;      // columns of the register tile
+    static constexpr size_t KC = 256;    // depth of a packed panel
+    static constexpr size_t MC = 96;     // rows of a packed A block, multiple of MR
+    static constexpr size_t NC = 2048;   // columns of a packed B panel, multiple of NR
+
+    // below this many multiply-adds a single thread is faster than waking workers
+    static constexpr size_t MIN_WORK_PER_THREAD = 64u * 64u * 64u;
+
+    static void multiply(size_t m, size_t n, size_t k,
+                         const GemmOperand<DATA_T>& a, const GemmOperand<DATA_T>& b,
+                         DATA_T* c, size_t ldc, size_t num_threads = 0,
+                         const GemmEpilogue<DATA_T>& epilogue = {});
+
+    static size_t default_num_threads();
+
+private:
+    static void multiply_serial(size_t m, size_t n, size_t k,
+                                const GemmOperand<DATA_T>& a, const GemmOperand<DATA_T>& b,
+                                DATA_T* c, size_t ldc, const GemmEpilogue<DATA_T>& epilogue);
+    static void multiply_small(size_t m, size_t n, size_t k,
+                               const GemmOperand<DATA_T>& a, const GemmOperand<DATA_T>& b,
+                               DATA_T* c, size_t ldc, const GemmEpilogue<DATA_T>& epilogue);
+    static void pack_a(size_t mc, size_t kc, const GemmOperand<DATA_T>& a, DATA_T* packed);
+    static void pack_b(size_t kc, size_t nc, const GemmOperand<DATA_T>& b, DATA_T* packed);
+    static void micro_kernel(size_t kc, const DATA_T* packed_a, const DATA_T* packed_b,
+                             DATA_T* c, size_t ldc, size_t mr, size_t nr, bool accumulate,
+                             const GemmEpilogue<DATA_T>* epilogue);
+};
+
+template<typename DATA_T>
+size_t GemmHost<DATA_T>::default_num_threads()
+{
+    return ThreadPool::get_default()->get_num_threads();
+}
+
+template<typename DATA_T>
+void GemmHost<DATA_T>::multiply(size_t m, size_t n, size_t k,
+                                const GemmOperand<DATA_T>& a, const GemmOperand<DATA_T>& b,
+                                DATA_T* c, size_t ldc, size_t num_threads,
+                                const GemmEpilogue<DATA_T>& epilogue)
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    if (num_threads == 0)
+    {
+        num_threads = default_num_threads();
+    }
+    num_threads = std::max<size_t>(1u, std::min(num_threads, m * n * std::max<size_t>(k, 1u) / MIN_WORK_PER_THREAD));
+
+    // split the output into a grid of thread_rows x thread_cols sub-problems,
+    // always halving the dimension that still has the most register tiles per thread
+    const size_t m_tiles = (m + MR - 1) / MR;
+    const size_t n_tiles = (n + NR - 1) / NR;
+    size_t thread_rows = 1u;
+    size_t thread_cols = 1u;
+    while (thread_rows * thread_cols * 2 <= num_threads)
+    {
+        const auto rows_per_thread = m_tiles / thread_rows;
+        const auto cols_per_thread = n_tiles / thread_cols;
+        if (rows_per_thread >= cols_per_thread && rows_per_thread >= 2)
+        {
+            thread_rows *= 2;
+        }
+        else if (cols_per_thread >= 2)
+        {
+            thread_cols *= 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    const size_t rows_per_worker = (m_tiles + thread_rows - 1) / thread_rows * MR;
+    const size_t cols_per_worker = (n_tiles + thread_cols - 1) / thread_cols * NR;
+
+    auto run_worker = [&](size_t worker)
+    {
+        const size_t row = (worker / thread_cols) * rows_per_worker;
+        const size_t col = (worker % thread_cols) * cols_per_worker;
+        if (row >= m || col >= n)
+        {
+            return;
+        }
+        multiply_serial(std::min(rows_per_worker, m - row), std::min(cols_per_worker, n - col), k,
+                        a.offset(row, 0), b.offset(0, col), c + row * ldc + col, ldc, epilogue.offset(col));
+    };
+
+    const size_t num_workers = thread_rows * thread_cols;
+    ThreadPool::get_default()->parallel_for(0u, num_workers, 1u, [&](size_t first, size_t last)
+    {
+        for (auto worker = first; worker < last; ++worker)
+        {
+            run_worker(worker);
+        }
+    }, num_workers);
+}
+
+template<typename DATA_T>
+void GemmHost<DATA_T>::multiply_serial(size_t m, size_t n, size_t k,
+                                       const GemmOperand<DATA_T>& a, const GemmOperand<DATA_T>& b,
+                                       DATA_T* c, size_t ldc, const GemmEpilogue<DATA_T>& epilogue)
+{
+    if (k == 0)
+    {
+        for (auto i = 0u; i < m; ++i)
+        {
+            for (auto j = 0u; j < n; ++j)
+            {
+                c[i * ldc + j] = epilogue.apply(static_cast<DATA_T>(0), j);
+            }
+        }
+        return;
+    }
+
+    // packing costs as much as the arithmetic when A is only a few rows (e.g. batch-1 Dense)
+    if (m < MR)
+    {
+        multiply_small(m, n, k, a, b, c, ldc, epilogue);
+        return;
+    }
+
+    thread_local std::vector<DATA_T> packed_a;
+    thread_local std::vector<DATA_T> packed_b;
+    packed_a.resize(MC * KC);
+    packed_b.resize(KC * NC);
+
+    for (size_t jc = 0u; jc < n; jc += NC)
+    {
+        const auto nc = std::min(NC, n - jc);
+        for (size_t pc = 0u; pc < k; pc += KC)
+        {
+            const auto kc = std::min(KC, k - pc);
+            const auto last_block = pc + kc == k;
+            const auto block_epilogue = epilogue.offset(jc);
+            pack_b(kc, nc, b.offset(pc, jc), packed_b.data());
+
+            for (size_t ic = 0u; ic < m; ic += MC)
+            {
+                const auto mc = std::min(MC, m - ic);
+                pack_a(mc, kc, a.offset(ic, pc), packed_a.data());
+
+                for (size_t jr = 0u; jr < nc; jr += NR)
+                {
+                    for (size_t ir = 0u; ir < mc; ir += MR)
+                    {
+                        const auto tile_epilogue = block_epilogue.offset(jr);
+                        micro_kernel(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc,
+                                     c + (ic + ir) * ldc + jc + jr, ldc,
+                                     std::min(MR, mc - ir), std::min(NR, nc - jr), pc != 0u,
+                                     last_block ? &tile_epilogue : nullptr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename DATA_T>
+void GemmHost<DATA_T>::multiply_small(size_t m, size_t n, size_t k,
+                                      const GemmOperand<DATA_T>& a, const GemmOperand<DATA_T>& b,
+                                      DATA_T* c, size_t ldc, const GemmEpilogue<DATA_T>& epilogue)
+{
+    for (auto i = 0u; i < m; ++i)
+    {
+        DATA_T* c_row = c + i * ldc;
+        if (b.col_stride == 1u)
+        {
+            // rows of B are contiguous: accumulate scaled rows of B into the output row
+            std::fill(c_row, c_row + n, static_cast<DATA_T>(0));
+            for (auto p = 0u; p < k; ++p)
+            {
+                const DATA_T a_value = a.at(i, p);
+                const DATA_T* b_row = b.data + p * b.row_stride;
+                for (auto j = 0u; j < n; ++j)
+                {
+                    c_row[j] += a_value * b_row[j];
+                }
+            }
+        }
+        else if (a.col_stride == 1u && b.row_stride == 1u)
+        {
+            // B is stored transposed: every output element is a dot product of two contiguous rows,
+            // NR independent partial sums let the compiler vectorize the reduction
+            const DATA_T* a_row = a.data + i * a.row_stride;
+            for (auto j = 0u; j < n; ++j)
+            {
+                const DATA_T* b_col = b.data + j * b.col_stride;
+                DATA_T partial[NR] = {};
+                size_t p = 0u;
+                for (; p + NR <= k; p += NR)
+                {
+                    for (size_t q = 0u; q < NR; ++q)
+                    {
+                        partial[q] += a_row[p + q] * b_col[p + q];
+                    }
+                }
+                DATA_T sum = static_cast<DATA_T>(0);
+                for (; p < k; ++p)
+                {
+                    sum += a_row[p] * b_col[p];
+                }
+                for (size_t q = 0u; q < NR; ++q)
+                {
+                    sum += partial[q];
+                }
+                c_row[j] = sum;
+            }
+        }
+        else
+        {
+            for (auto j = 0u; j < n; ++j)
+            {
+                DATA_T sum = static_cast<DATA_T>(0);
+                for (auto p = 0u; p < k; ++p)
+                {
+                    sum += a.at(i, p) * b.at(p, j);
+                }
+                c_row[j] = sum;
+            }
+        }
+
+        // the row is still in L1, finish it before moving on
+        if (epilogue.bias || epilogue.relu)
+        {
+            for (auto j = 0u; j < n; ++j)
+            {
+                c_row[j] = epilogue.apply(c_row[j], j);
+            }
+        }
+    }
+}
+
+template<typename DATA_T>
+void GemmHost<DATA_T>::pack_a(size_t mc, size_t kc, const GemmOperand<DATA_T>& a, DATA_T* packed)
+{
+    // MR-row panels, each stored column by column; short panels are zero-padded
+    for (size_t ir = 0u; ir < mc; ir += MR)
+    {
+        const auto mr = std::min(MR, mc - ir);
+        for (size_t p = 0u; p < kc; ++p)
+        {
+            for (size_t i = 0u; i < mr; ++i)
+            {
+                packed[i] = a.at(ir + i, p);
+            }
+            for (size_t i = mr; i < MR; ++i)
+            {
+                packed[i] = static_cast<DATA_T>(0);
+            }
+            packed += MR;
+        }
+    }
+}
+
+template<typename DATA_T>
+void GemmHost<DATA_T>::pack_b(size_t kc, size_t nc, const GemmOperand<DATA_T>& b, DATA_T* packed)
+{
+    // NR-column slivers, each stored row by row; short slivers are zero-padded
+    for (size_t jr = 0u; jr < nc; jr += NR)
+    {
+        const auto nr = std::min(NR, nc - jr);
+        for (size_t p = 0u; p < kc; ++p)
+        {
+            if (b.col_stride == 1u)
+            {
+                const DATA_T* b_row = &b.at(p, jr);
+                std::copy(b_row, b_row + nr, packed);
+            }
+            else
+            {
+                for (size_t j = 0u; j < nr; ++j)
+                {
+                    packed[j] = b.at(p, jr + j);
+                }
+            }
+            std::fill(packed + nr, packed + NR, static_cast<DATA_T>(0));
+            packed += NR;
+        }
+    }
+}
+
+template<typename DATA_T>
+void GemmHost<DATA_T>::micro_kernel(size_t kc, const DATA_T* packed_a, const DATA_T* packed_b,
+                                    DATA_T* c, size_t ldc, size_t mr, size_t nr, bool accumulate,
+                                    const GemmEpilogue<DATA_T>* epilogue)
+{
+    // fixed trip counts let the compiler keep acc in vector registers
+    DATA_T acc[MR][NR] = {};
+    for (size_t p = 0u; p < kc; ++p)
+    {
+        for (size_t i = 0u; i < MR; ++i)
+        {
+            const DATA_T a_value = packed_a[i];
+            for (size_t j = 0u; j < NR; ++j)
+            {
+                acc[i][j] += a_value * packed_b[j];
+            }
+        }
+        packed_a += MR;
+        packed_b += NR;
+    }
+
+    for (size_t i = 0u; i < mr; ++i)
+    {
+        DATA_T* c_row = c + i * ldc;
+        if (accumulate)
+        {
+            for (size_t j = 0u; j < nr; ++j)
+            {
+                acc[i][j] += c_row[j];
+            }
+        }
+        if (epilogue)
+        {
+            for (size_t j = 0u; j < nr; ++j)
+            {
+                acc[i][j] = epilogue->apply(acc[i][j], j);
+            }
+        }
+        for (size_t j = 0u; j < nr; ++j)
+        {
+            c_row[j] = acc[i][j];
+        }
+    }
+}
+
+#endif  // GEMM_H
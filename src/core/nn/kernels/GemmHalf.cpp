@@ -0,0 +1,304 @@
+#include "GemmHalf.h"
+#include "SimdDispatch.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef HOST_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+uint16_t float_to_half(float value)
+{
+    uint32_t bits = 0u;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    bits &= 0x7fffffffu;
+
+    if (bits >= 0x7f800000u)
+    {
+        // inf stays inf, nan stays a quiet nan
+        return sign | 0x7c00u | (bits > 0x7f800000u ? 0x200u : 0u);
+    }
+    if (bits >= 0x477ff000u)
+    {
+        // rounds past 65504, the largest finite half
+        return sign | 0x7c00u;
+    }
+    if (bits < 0x38800000u)
+    {
+        // below 2^-14: a subnormal m * 2^-24, 2^-25 and below round to zero
+        if (bits < 0x33000000u)
+        {
+            return sign;
+        }
+        const auto shift = 126u - (bits >> 23);
+        const auto mantissa = (bits & 0x7fffffu) | 0x800000u;
+        auto result = mantissa >> shift;
+        const auto remainder = mantissa & ((1u << shift) - 1u);
+        const auto halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (result & 1u)))
+        {
+            ++result;
+        }
+        return sign | static_cast<uint16_t>(result);
+    }
+
+    // rebias the exponent from 127 to 15 and drop 13 mantissa bits, a carry may bump the exponent
+    auto result = (bits - 0x38000000u) >> 13;
+    const auto remainder = bits & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1u)))
+    {
+        ++result;
+    }
+    return sign | static_cast<uint16_t>(result);
+}
+
+float half_to_float(uint16_t value)
+{
+    // written with masks instead of branches so the widening loops vectorize
+    const uint32_t exponent = (value >> 10) & 0x1fu;
+    const uint32_t mantissa = value & 0x3ffu;
+
+    // normal numbers: rebias the exponent from 15 to 127, inf / nan keep an all-ones exponent
+    const uint32_t infinite_mask = 0u - static_cast<uint32_t>(exponent == 0x1fu);
+    const uint32_t normal = (static_cast<uint32_t>(value & 0x7fffu) << 13) + ((127u - 15u) << 23) + (infinite_mask & ((128u - 16u) << 23));
+
+    // zero and subnormals are mantissa * 2^-24, exact in fp32
+    const float subnormal_value = static_cast<float>(mantissa) * 5.9604644775390625e-08f;
+    uint32_t subnormal = 0u;
+    std::memcpy(&subnormal, &subnormal_value, sizeof(subnormal));
+
+    const uint32_t subnormal_mask = 0u - static_cast<uint32_t>(exponent == 0u);
+    const uint32_t bits = ((normal & ~subnormal_mask) | (subnormal & subnormal_mask)) | (static_cast<uint32_t>(value & 0x8000u) << 16);
+    float result = 0.0f;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+uint16_t float_to_bfloat16(float value)
+{
+    uint32_t bits = 0u;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u)
+    {
+        // keep nan a quiet nan instead of rounding it to inf
+        return static_cast<uint16_t>((bits >> 16) | 0x40u);
+    }
+    const auto rounding = 0x7fffu + ((bits >> 16) & 1u);
+    return static_cast<uint16_t>((bits + rounding) >> 16);
+}
+
+float bfloat16_to_float(uint16_t value)
+{
+    const uint32_t bits = static_cast<uint32_t>(value) << 16;
+    float result = 0.0f;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+template<WEIGHT_FORMAT FORMAT>
+static float widen(uint16_t value)
+{
+    return FORMAT == WEIGHT_FORMAT::FP16 ? half_to_float(value) : bfloat16_to_float(value);
+}
+
+template<WEIGHT_FORMAT FORMAT>
+static void dot_rows_tail(size_t mr, size_t begin, size_t k, const float* a, size_t lda, const uint16_t* w, float* acc)
+{
+    for (size_t p = begin; p < k; ++p)
+    {
+        const auto weight = widen<FORMAT>(w[p]);
+        for (size_t r = 0u; r < mr; ++r)
+        {
+            acc[r] += a[r * lda + p] * weight;
+        }
+    }
+}
+
+template<WEIGHT_FORMAT FORMAT>
+static void dot_rows_generic(size_t mr, size_t k, const float* a, size_t lda, const uint16_t* w, float* sums)
+{
+    // widen a block of weights once, then multiply it with every row in fixed-width lanes,
+    // which the compiler vectorizes without reassociating a single sum
+    const size_t BLOCK = 64u, LANES = 8u;
+    size_t p = 0u;
+    float widened[BLOCK];
+    float lanes[GemmHalfHost::MR][LANES] = {};
+    for (; p + BLOCK <= k; p += BLOCK)
+    {
+        for (size_t q = 0u; q < BLOCK; ++q)
+        {
+            widened[q] = widen<FORMAT>(w[p + q]);
+        }
+        for (size_t r = 0u; r < mr; ++r)
+        {
+            const float* row = a + r * lda + p;
+            for (size_t q = 0u; q < BLOCK; q += LANES)
+            {
+                for (size_t lane = 0u; lane < LANES; ++lane)
+                {
+                    lanes[r][lane] += row[q + lane] * widened[q + lane];
+                }
+            }
+        }
+    }
+
+    float acc[GemmHalfHost::MR] = {};
+    for (size_t r = 0u; r < mr; ++r)
+    {
+        for (size_t lane = 0u; lane < LANES; ++lane)
+        {
+            acc[r] += lanes[r][lane];
+        }
+    }
+    dot_rows_tail<FORMAT>(mr, p, k, a, lda, w, acc);
+    std::copy(acc, acc + mr, sums);
+}
+
+#ifdef HOST_SIMD_DISPATCH
+// eight weights widened to fp32
+template<WEIGHT_FORMAT FORMAT>
+__attribute__((target("avx2,fma,f16c")))
+static __m256 load_weights(const uint16_t* w)
+{
+    const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w));
+    if (FORMAT == WEIGHT_FORMAT::FP16)
+    {
+        return _mm256_cvtph_ps(packed);
+    }
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(packed), 16));
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static float horizontal_sum(__m256 value)
+{
+    const __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    const __m128 sum64 = _mm_add_ps(sum128, _mm_movehl_ps(sum128, sum128));
+    const __m128 sum32 = _mm_add_ss(sum64, _mm_movehdup_ps(sum64));
+    return _mm_cvtss_f32(sum32);
+}
+
+template<WEIGHT_FORMAT FORMAT>
+__attribute__((target("avx2,fma,f16c")))
+static void dot_rows_avx2(size_t mr, size_t k, const float* a, size_t lda, const uint16_t* w, float* sums)
+{
+    // every widened weight vector is used for all mr rows
+    size_t p = 0u;
+    __m256 acc_vec[GemmHalfHost::MR] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+    for (; p + 8u <= k; p += 8u)
+    {
+        const __m256 weights = load_weights<FORMAT>(w + p);
+        for (size_t r = 0u; r < mr; ++r)
+        {
+            acc_vec[r] = _mm256_fmadd_ps(_mm256_loadu_ps(a + r * lda + p), weights, acc_vec[r]);
+        }
+    }
+
+    float acc[GemmHalfHost::MR] = {};
+    for (size_t r = 0u; r < mr; ++r)
+    {
+        acc[r] = horizontal_sum(acc_vec[r]);
+    }
+    dot_rows_tail<FORMAT>(mr, p, k, a, lda, w, acc);
+    std::copy(acc, acc + mr, sums);
+}
+#endif
+
+template<WEIGHT_FORMAT FORMAT>
+static void dot_rows_impl(size_t mr, size_t k, const float* a, size_t lda, const uint16_t* w, bool avx2, float* sums)
+{
+#ifdef HOST_SIMD_DISPATCH
+    if (avx2)
+    {
+        dot_rows_avx2<FORMAT>(mr, k, a, lda, w, sums);
+        return;
+    }
+#endif
+    (void)avx2;
+    dot_rows_generic<FORMAT>(mr, k, a, lda, w, sums);
+}
+
+void GemmHalfHost::dot_rows(size_t mr, size_t k, const float* a, size_t lda, const uint16_t* w, WEIGHT_FORMAT format,
+                            bool avx2, float* sums)
+{
+    if (format == WEIGHT_FORMAT::FP16)
+    {
+        dot_rows_impl<WEIGHT_FORMAT::FP16>(mr, k, a, lda, w, avx2, sums);
+    }
+    else
+    {
+        dot_rows_impl<WEIGHT_FORMAT::BF16>(mr, k, a, lda, w, avx2, sums);
+    }
+}
+
+void GemmHalfHost::convert(const float* input, size_t size, WEIGHT_FORMAT format, uint16_t* output)
+{
+    if (format != WEIGHT_FORMAT::FP16 && format != WEIGHT_FORMAT::BF16)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Weights can only be converted to FP16 or BF16");
+    }
+    for (size_t i = 0u; i < size; ++i)
+    {
+        output[i] = format == WEIGHT_FORMAT::FP16 ? float_to_half(input[i]) : float_to_bfloat16(input[i]);
+    }
+}
+
+const char* GemmHalfHost::get_isa()
+{
+#ifdef HOST_SIMD_DISPATCH
+    return get_simd_isa() >= SIMD_ISA::AVX2 ? "avx2" : "generic";
+#else
+    return "generic";
+#endif
+}
+
+void GemmHalfHost::multiply(size_t m, size_t n, size_t k, const float* a, size_t lda,
+                            const uint16_t* w, WEIGHT_FORMAT format, float* c, size_t ldc,
+                            const GemmEpilogue<float>& epilogue, size_t num_threads)
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    // columns are dealt out in chunks big enough to be worth a handoff, every thread reads its own rows of W and all of A
+    const size_t column_work = m * std::max<size_t>(k, 1u);
+    const size_t grain = std::max<size_t>(1u, MIN_WORK_PER_THREAD / column_work);
+    ThreadPool::get_default()->parallel_for(0u, n, grain, [&](size_t first, size_t last)
+    {
+        multiply_serial(m, first, last, k, a, lda, w, format, c, ldc, epilogue);
+    }, num_threads);
+}
+
+void GemmHalfHost::multiply_serial(size_t m, size_t col_begin, size_t col_end, size_t k, const float* a, size_t lda,
+                                   const uint16_t* w, WEIGHT_FORMAT format, float* c, size_t ldc,
+                                   const GemmEpilogue<float>& epilogue)
+{
+    const size_t panel_cols = std::max<size_t>(1u, PANEL_BYTES / (std::max<size_t>(k, 1u) * sizeof(uint16_t)));
+    float sums[MR];
+    const bool avx2 = get_simd_isa() >= SIMD_ISA::AVX2;
+
+    for (size_t panel = col_begin; panel < col_end; panel += panel_cols)
+    {
+        const auto panel_end = std::min(panel + panel_cols, col_end);
+        for (size_t i = 0u; i < m; i += MR)
+        {
+            const auto mr = std::min(MR, m - i);
+            for (size_t j = panel; j < panel_end; ++j)
+            {
+                dot_rows(mr, k, a + i * lda, lda, w + j * k, format, avx2, sums);
+                for (size_t r = 0u; r < mr; ++r)
+                {
+                    c[(i + r) * ldc + j] = epilogue.apply(sums[r], j);
+                }
+            }
+        }
+    }
+}
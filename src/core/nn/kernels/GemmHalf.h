@@ -0,0 +1,52 @@
+#ifndef GEMM_HALF_H
+#define GEMM_HALF_H
+
+#include "../common.h"
+#include "Gemm.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// conversions between fp32 and the 16-bit weight formats, rounding to nearest even
+uint16_t float_to_half(float value);
+float half_to_float(uint16_t value);
+uint16_t float_to_bfloat16(float value);
+float bfloat16_to_float(uint16_t value);
+
+/*
+* @brief  multi-threaded GEMM on the host with 16-bit weights: C (m x n) = A (m x k) * W^T (+ bias, relu)
+* @note   W is n x k row-major fp16 or bf16, A, C and the accumulation are fp32. Weights are widened
+*         to fp32 in registers right before they are used (F16C for fp16, a shift for bf16 when the
+*         CPU has AVX2, see SimdDispatch.h), so only half the bytes of an fp32 GEMV are read from memory.
+*         Threads split the columns of C, which keeps batch 1 parallel; each thread walks W in panels
+*         that stay in L2 while all rows of A are multiplied with them
+*/
+class GemmHalfHost
+{
+public:
+    static constexpr size_t MR = 4;                     // rows of A multiplied with each W row at once
+    static constexpr size_t PANEL_BYTES = 128u * 1024u; // W rows per panel are as many as fit in this
+
+    // below this many multiply-adds a single thread is faster than waking workers, chunks are at least this big
+    static constexpr size_t MIN_WORK_PER_THREAD = 64u * 64u * 64u;
+
+    static void multiply(size_t m, size_t n, size_t k, const float* a, size_t lda,
+                         const uint16_t* w, WEIGHT_FORMAT format, float* c, size_t ldc,
+                         const GemmEpilogue<float>& epilogue, size_t num_threads = 0);
+
+    // format must be FP16 or BF16
+    static void convert(const float* input, size_t size, WEIGHT_FORMAT format, uint16_t* output);
+    // instruction set the fp16 / bf16 dot products use: "avx2" or "generic"
+    static const char* get_isa();
+
+private:
+    // columns [col_begin, col_end) of C
+    static void multiply_serial(size_t m, size_t col_begin, size_t col_end, size_t k, const float* a, size_t lda,
+                                const uint16_t* w, WEIGHT_FORMAT format, float* c, size_t ldc,
+                                const GemmEpilogue<float>& epilogue);
+    // sums[r] = dot(a + r * lda, w) for r < mr, avx2 picks the F16C / FMA path
+    static void dot_rows(size_t mr, size_t k, const float* a, size_t lda, const uint16_t* w, WEIGHT_FORMAT format,
+                         bool avx2, float* sums);
+};
+
+#endif  // GEMM_HALF_H
@@ -0,0 +1,230 @@
+#include "GemmInt8.h"
+#include "SimdDispatch.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#ifdef HOST_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+QuantizedMultiplier QuantizedMultiplier::from_real(double real)
+{
+    QuantizedMultiplier result;
+    if (real == 0.0)
+    {
+        return result;
+    }
+
+    // real = q * 2^shift with q in [0.5, 1), q is stored as a Q31 fixed-point number
+    int shift = 0;
+    const double q = std::frexp(real, &shift);
+    auto q_fixed = static_cast<int64_t>(std::round(q * (1ll << 31)));
+    if (q_fixed == (1ll << 31))
+    {
+        q_fixed /= 2;
+        ++shift;
+    }
+    if (shift < -31)
+    {
+        // too small to be represented, the product is zero
+        return result;
+    }
+    result.multiplier = static_cast<int32_t>(q_fixed);
+    result.shift = shift;
+    return result;
+}
+
+int32_t QuantizedMultiplier::apply(int32_t value) const
+{
+    const int left_shift = shift > 0 ? shift : 0;
+    const int right_shift = shift > 0 ? 0 : -shift;
+
+    // rounding doubling high multiply, saturating the single overflowing case
+    const auto a = static_cast<int32_t>(static_cast<int64_t>(value) * (int64_t{1} << left_shift));
+    int32_t high = std::numeric_limits<int32_t>::max();
+    if (!(a == multiplier && a == std::numeric_limits<int32_t>::min()))
+    {
+        const int64_t product = static_cast<int64_t>(a) * multiplier;
+        const int64_t nudge = product >= 0 ? (1ll << 30) : (1 - (1ll << 30));
+        high = static_cast<int32_t>((product + nudge) / (1ll << 31));
+    }
+
+    // rounding right shift, ties away from zero
+    const int32_t mask = static_cast<int32_t>((int64_t{1} << right_shift) - 1);
+    const int32_t remainder = high & mask;
+    const int32_t threshold = (mask >> 1) + (high < 0 ? 1 : 0);
+    return (high >> right_shift) + (remainder > threshold ? 1 : 0);
+}
+
+float GemmInt8Epilogue::apply(int32_t acc, size_t col) const
+{
+    const QuantizedMultiplier requantize = {multiplier[col], shift[col]};
+    auto value = requantize.apply(acc + bias[col]) + output_zero_point;
+    value = std::min(std::max(value, activation_min), activation_max);
+    return static_cast<float>(value - output_zero_point) * output_scale;
+}
+
+void GemmInt8Host::quantize(const float* input, size_t size, float scale, int32_t zero_point, int8_t* output)
+{
+    for (size_t i = 0u; i < size; ++i)
+    {
+        const auto value = static_cast<int32_t>(std::round(input[i] / scale)) + zero_point;
+        output[i] = static_cast<int8_t>(std::min(std::max(value, -128), 127));
+    }
+}
+
+static int32_t dot_tail(const int8_t* a, const int8_t* b, size_t begin, size_t k, int32_t sum)
+{
+    for (size_t p = begin; p < k; ++p)
+    {
+        sum += static_cast<int32_t>(a[p]) * static_cast<int32_t>(b[p]);
+    }
+    return sum;
+}
+
+static int32_t dot_generic(const int8_t* a, const int8_t* b, size_t k)
+{
+    // fixed-width partial sums let the compiler vectorize the reduction
+    size_t p = 0u;
+    int32_t partial[16] = {};
+    for (; p + 16u <= k; p += 16u)
+    {
+        for (size_t q = 0u; q < 16u; ++q)
+        {
+            partial[q] += static_cast<int32_t>(a[p + q]) * static_cast<int32_t>(b[p + q]);
+        }
+    }
+    int32_t sum = 0;
+    for (size_t q = 0u; q < 16u; ++q)
+    {
+        sum += partial[q];
+    }
+    return dot_tail(a, b, p, k, sum);
+}
+
+#ifdef HOST_SIMD_DISPATCH
+__attribute__((target("avx2")))
+static int32_t dot_avx2(const int8_t* a, const int8_t* b, size_t k)
+{
+    // 16 products per step: sign-extend to 16 bits, vpmaddwd multiplies pairs and adds them to 8 int32 lanes
+    size_t p = 0u;
+    __m256i acc = _mm256_setzero_si256();
+    for (; p + 16u <= k; p += 16u)
+    {
+        const __m256i a16 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + p)));
+        const __m256i b16 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + p)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a16, b16));
+    }
+    const __m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    const __m128i acc64 = _mm_add_epi32(acc128, _mm_unpackhi_epi64(acc128, acc128));
+    const __m128i acc32 = _mm_add_epi32(acc64, _mm_shuffle_epi32(acc64, 1));
+    return dot_tail(a, b, p, k, _mm_cvtsi128_si32(acc32));
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static int32_t dot_avx512_vnni(const int8_t* a, const int8_t* b, size_t k)
+{
+    // 32 products per step: sign-extend to 16 bits, vpdpwssd multiplies pairs and adds them to 16 int32 lanes
+    size_t p = 0u;
+    __m512i acc = _mm512_setzero_si512();
+    for (; p + 32u <= k; p += 32u)
+    {
+        const __m512i a16 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + p)));
+        const __m512i b16 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + p)));
+        acc = _mm512_dpwssd_epi32(acc, a16, b16);
+    }
+    return dot_tail(a, b, p, k, _mm512_reduce_add_epi32(acc));
+}
+#endif
+
+using DotFunction = int32_t (*)(const int8_t*, const int8_t*, size_t);
+
+// resolved per GEMM rather than per dot product
+static DotFunction get_dot_function()
+{
+#ifdef HOST_SIMD_DISPATCH
+    if (has_avx512_vnni())
+    {
+        return dot_avx512_vnni;
+    }
+    if (get_simd_isa() >= SIMD_ISA::AVX2)
+    {
+        return dot_avx2;
+    }
+#endif
+    return dot_generic;
+}
+
+int32_t GemmInt8Host::dot(const int8_t* a, const int8_t* b, size_t k)
+{
+    return get_dot_function()(a, b, k);
+}
+
+const char* GemmInt8Host::get_isa()
+{
+    const auto dot = get_dot_function();
+#ifdef HOST_SIMD_DISPATCH
+    if (dot == dot_avx512_vnni)
+    {
+        return "avx512vnni";
+    }
+    if (dot == dot_avx2)
+    {
+        return "avx2";
+    }
+#endif
+    return "generic";
+}
+
+void GemmInt8Host::multiply(size_t m, size_t n, size_t k, const float* a, size_t lda,
+                            float input_scale, int32_t input_zero_point, const int8_t* w,
+                            float* c, size_t ldc, const GemmInt8Epilogue& epilogue, size_t num_threads)
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    // rows are dealt out in MR blocks, each chunk big enough to be worth a handoff; every thread reads all of W
+    const size_t m_blocks = (m + MR - 1) / MR;
+    const size_t block_work = MR * n * std::max<size_t>(k, 1u);
+    const size_t grain = std::max<size_t>(1u, MIN_WORK_PER_THREAD / block_work);
+    ThreadPool::get_default()->parallel_for(0u, m_blocks, grain, [&](size_t first, size_t last)
+    {
+        const size_t row = first * MR;
+        multiply_serial(std::min(last * MR, m) - row, n, k, a + row * lda, lda,
+                        input_scale, input_zero_point, w, c + row * ldc, ldc, epilogue);
+    }, num_threads);
+}
+
+void GemmInt8Host::multiply_serial(size_t m, size_t n, size_t k, const float* a, size_t lda,
+                                   float input_scale, int32_t input_zero_point, const int8_t* w,
+                                   float* c, size_t ldc, const GemmInt8Epilogue& epilogue)
+{
+    thread_local std::vector<int8_t> quantized_a;
+    quantized_a.resize(MR * k);
+    const auto dot = get_dot_function();
+
+    for (size_t i = 0u; i < m; i += MR)
+    {
+        const auto mr = std::min(MR, m - i);
+        for (size_t r = 0u; r < mr; ++r)
+        {
+            quantize(a + (i + r) * lda, k, input_scale, input_zero_point, quantized_a.data() + r * k);
+        }
+
+        // the W row stays in L1 while it is used for all mr rows
+        for (size_t j = 0u; j < n; ++j)
+        {
+            const int8_t* w_row = w + j * k;
+            for (size_t r = 0u; r < mr; ++r)
+            {
+                c[(i + r) * ldc + j] = epilogue.apply(dot(quantized_a.data() + r * k, w_row, k), j);
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef GEMM_INT8_H
+#define GEMM_INT8_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* @brief  fixed-point multiplier: real = multiplier * 2^(shift - 31), multiplier in [2^30, 2^31)
+* @note   requantization with it rounds exactly like TFLite's reference kernels
+*/
+struct QuantizedMultiplier
+{
+    int32_t multiplier = 0;
+    int32_t shift = 0;      // positive is a left shift
+
+    static QuantizedMultiplier from_real(double real);
+    int32_t apply(int32_t value) const;
+};
+
+/*
+* @brief  work applied to the int32 accumulators of an int8 GEMM while they are written back
+* @note   per output column: add the bias (with the input zero point folded in), requantize to the output
+*         scale, add the output zero point and clamp to the activation range, which is how a fused RELU
+*         is applied. The result is written dequantized, so the float tensors between layers hold exactly
+*         the values the int8 model produces
+*/
+struct GemmInt8Epilogue
+{
+    const int32_t* bias = nullptr;          // n elements
+    const int32_t* multiplier = nullptr;    // n elements, see QuantizedMultiplier
+    const int32_t* shift = nullptr;         // n elements
+    int32_t output_zero_point = 0;
+    int32_t activation_min = -128;
+    int32_t activation_max = 127;
+    float   output_scale = 1.0f;
+
+    float apply(int32_t acc, size_t col) const;
+};
+
+/*
+* @brief  multi-threaded int8 x int8 -> int32 GEMM on the host: C (m x n) = quantize(A (m x k)) * W^T
+* @note   W is n x k row-major int8, the TFLite layout of FULLY_CONNECTED weights and of im2col'ed
+*         CONV_2D filters, with a zero point of 0 as TFLite requires for int8 weights. A is float and
+*         quantized MR rows at a time while it is read, so no int8 copy of it is kept. Every output is a
+*         dot product of two contiguous int8 rows, computed with AVX-512 VNNI or AVX2 when the CPU
+*         has them (see SimdDispatch.h) and with a loop the compiler vectorizes otherwise
+*/
+class GemmInt8Host
+{
+public:
+    static constexpr size_t MR = 4;     // rows of A quantized at once, each W row is reused for all of them
+
+    // below this many multiply-adds a single thread is faster than waking workers, chunks are at least this big
+    static constexpr size_t MIN_WORK_PER_THREAD = 64u * 64u * 64u;
+
+    static void multiply(size_t m, size_t n, size_t k, const float* a, size_t lda,
+                         float input_scale, int32_t input_zero_point, const int8_t* w,
+                         float* c, size_t ldc, const GemmInt8Epilogue& epilogue, size_t num_threads = 0);
+
+    // q = clamp(round(x / scale) + zero_point, -128, 127)
+    static void quantize(const float* input, size_t size, float scale, int32_t zero_point, int8_t* output);
+    static int32_t dot(const int8_t* a, const int8_t* b, size_t k);
+    // instruction set dot uses: "avx512vnni", "avx2" or "generic"
+    static const char* get_isa();
+
+private:
+    static void multiply_serial(size_t m, size_t n, size_t k, const float* a, size_t lda,
+                                float input_scale, int32_t input_zero_point, const int8_t* w,
+                                float* c, size_t ldc, const GemmInt8Epilogue& epilogue);
+};
+
+#endif  // GEMM_INT8_H
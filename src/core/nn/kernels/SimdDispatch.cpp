@@ -0,0 +1,67 @@
+#include "SimdDispatch.h"
+
+#include <algorithm>
+#include <atomic>
+
+static std::atomic<SIMD_ISA> max_simd_isa(SIMD_ISA::AVX512);
+
+SIMD_ISA get_cpu_simd_isa()
+{
+    // __builtin_cpu_supports also checks that the OS saves the wider registers
+    static const SIMD_ISA isa = []()
+    {
+#ifdef HOST_SIMD_DISPATCH
+        __builtin_cpu_init();
+        // AVX-512 CPUs all have AVX2, FMA and F16C too
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        {
+            return SIMD_ISA::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c"))
+        {
+            return SIMD_ISA::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return SIMD_ISA::SSE2;
+        }
+#endif
+        return SIMD_ISA::SCALAR;
+    }();
+    return isa;
+}
+
+SIMD_ISA get_simd_isa()
+{
+    return std::min(get_cpu_simd_isa(), max_simd_isa.load(std::memory_order_relaxed));
+}
+
+bool has_avx512_vnni()
+{
+#ifdef HOST_SIMD_DISPATCH
+    static const bool vnni = __builtin_cpu_supports("avx512vnni");
+    return vnni && get_simd_isa() == SIMD_ISA::AVX512;
+#else
+    return false;
+#endif
+}
+
+void set_max_simd_isa(SIMD_ISA isa)
+{
+    max_simd_isa.store(isa, std::memory_order_relaxed);
+}
+
+const char* get_simd_isa_name(SIMD_ISA isa)
+{
+    switch (isa)
+    {
+        case SIMD_ISA::SSE2:
+            return "sse2";
+        case SIMD_ISA::AVX2:
+            return "avx2";
+        case SIMD_ISA::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+
+// x86 host kernels are built for several instruction sets with target attributes and one is
+// picked at runtime, so a default build still uses AVX2 / AVX-512 on CPUs that have them
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HOST_SIMD_DISPATCH
+#endif
+
+// instruction sets the host kernels have paths for, ordered by vector width
+enum class SIMD_ISA
+{
+    SCALAR = 0,
+    SSE2,
+    AVX2,       // with FMA and F16C
+    AVX512      // AVX-512 F and BW
+};
+
+/*
+* @brief  widest instruction set the host kernels use
+* @note   detected once by CPUID (including OS support for the wider registers) and capped by
+*         set_max_simd_isa, which tests and benchmarks use to compare the paths
+*/
+SIMD_ISA get_simd_isa();
+// widest instruction set this CPU supports, ignoring the cap
+SIMD_ISA get_cpu_simd_isa();
+// AVX-512 VNNI, only used on top of SIMD_ISA::AVX512
+bool has_avx512_vnni();
+// caps get_simd_isa, SIMD_ISA::AVX512 removes the cap
+void set_max_simd_isa(SIMD_ISA isa);
+const char* get_simd_isa_name(SIMD_ISA isa);
+
+#endif  // SIMD_DISPATCH_H
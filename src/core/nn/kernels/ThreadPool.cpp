@@ -0,0 +1,310 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <limits>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// set while a thread runs chunks, a parallel_for inside a chunk then runs inline
+static thread_local bool inside_parallel_for = false;
+
+// a range of chunk indices [first, last) packed into one word, so it is claimed with a single CAS
+static uint64_t pack_range(uint64_t first, uint64_t last)
+{
+    return (first << 32) | last;
+}
+
+static uint64_t get_first(uint64_t range)
+{
+    return range >> 32;
+}
+
+static uint64_t get_last(uint64_t range)
+{
+    return range & 0xffffffffu;
+}
+
+struct ThreadPool::Job
+{
+    const RangeFunction*                        body = nullptr;
+    size_t                                      begin = 0u;
+    size_t                                      end = 0u;
+    size_t                                      grain = 1u;
+    size_t                                      num_slots = 0u;
+    std::unique_ptr<std::atomic<uint64_t>[]>    ranges;         // chunks not started yet, one range per slot
+    std::atomic<size_t>                         remaining{0u};  // chunks not finished yet
+    size_t                                      next_slot = 0u; // guarded by the pool mutex
+    size_t                                      active = 0u;    // workers inside work_on, guarded by the pool mutex
+    std::mutex                                  error_mutex;
+    std::exception_ptr                          error;
+};
+
+ThreadPool::ThreadPool(size_t num_threads, bool pin_threads)
+    : m_pin_threads(pin_threads)
+{
+    if (num_threads == 0)
+    {
+        num_threads = get_hardware_threads();
+    }
+    m_workers.reserve(num_threads - 1);
+    for (size_t worker = 1u; worker < num_threads; ++worker)
+    {
+        m_workers.emplace_back(&ThreadPool::run_worker, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_available.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::get_num_threads() const
+{
+    return m_workers.size() + 1u;
+}
+
+bool ThreadPool::get_pin_threads() const
+{
+    return m_pin_threads;
+}
+
+void ThreadPool::set_caller_participates(bool caller_participates)
+{
+    m_caller_participates = caller_participates;
+}
+
+bool ThreadPool::get_caller_participates() const
+{
+    return m_caller_participates;
+}
+
+size_t ThreadPool::get_hardware_threads()
+{
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1u);
+}
+
+static std::mutex default_pool_mutex;
+static std::shared_ptr<ThreadPool> default_pool;
+
+std::shared_ptr<ThreadPool> ThreadPool::get_default()
+{
+    std::lock_guard<std::mutex> lock(default_pool_mutex);
+    if (!default_pool)
+    {
+        default_pool = std::make_shared<ThreadPool>();
+    }
+    return default_pool;
+}
+
+void ThreadPool::set_default(std::shared_ptr<ThreadPool> pool)
+{
+    std::lock_guard<std::mutex> lock(default_pool_mutex);
+    default_pool = std::move(pool);
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, const RangeFunction& body, size_t max_threads)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    // chunk indices have to fit the packed ranges
+    grain = std::max<size_t>(grain, 1u);
+    const size_t max_chunks = std::numeric_limits<uint32_t>::max();
+    if ((end - begin) / grain >= max_chunks)
+    {
+        grain = (end - begin) / (max_chunks - 1u) + 1u;
+    }
+    const size_t num_chunks = (end - begin + grain - 1u) / grain;
+
+    size_t num_slots = std::min(num_chunks, get_num_threads());
+    if (max_threads != 0)
+    {
+        num_slots = std::min(num_slots, max_threads);
+    }
+    const bool caller_participates = m_caller_participates || m_workers.empty();
+    if (inside_parallel_for || (num_slots == 1u && caller_participates))
+    {
+        body(begin, end);
+        return;
+    }
+    if (!caller_participates)
+    {
+        num_slots = std::min(num_slots, m_workers.size());
+    }
+
+    Job job;
+    job.body = &body;
+    job.begin = begin;
+    job.end = end;
+    job.grain = grain;
+    job.num_slots = num_slots;
+    job.remaining = num_chunks;
+    job.ranges.reset(new std::atomic<uint64_t>[num_slots]);
+    for (size_t slot = 0u; slot < num_slots; ++slot)
+    {
+        job.ranges[slot] = pack_range(num_chunks * slot / num_slots, num_chunks * (slot + 1u) / num_slots);
+    }
+    // the caller owns slot 0, one worker is woken per other slot
+    job.next_slot = caller_participates ? 1u : 0u;
+    const auto num_wakeups = num_slots - job.next_slot;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(&job);
+    }
+    for (size_t wakeup = 0u; wakeup < num_wakeups; ++wakeup)
+    {
+        m_work_available.notify_one();
+    }
+
+    if (caller_participates)
+    {
+        inside_parallel_for = true;
+        work_on(job, 0u);
+        inside_parallel_for = false;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job_done.wait(lock, [&]() { return job.remaining == 0u && job.active == 0u; });
+        // slots nobody claimed were stolen from, the job must not be picked up after this
+        const auto it = std::find(m_jobs.begin(), m_jobs.end(), &job);
+        if (it != m_jobs.end())
+        {
+            m_jobs.erase(it);
+        }
+    }
+
+    if (job.error)
+    {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void ThreadPool::run_worker(size_t worker)
+{
+#ifdef __linux__
+    if (m_pin_threads)
+    {
+        // the caller usually runs on the first core, workers take the next ones
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(worker % get_hardware_threads(), &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+#else
+    (void)worker;
+#endif
+    inside_parallel_for = true;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_work_available.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+        if (m_stop)
+        {
+            return;
+        }
+
+        Job* job = m_jobs.front();
+        const auto slot = job->next_slot++;
+        if (job->next_slot == job->num_slots)
+        {
+            m_jobs.erase(m_jobs.begin());
+        }
+        ++job->active;
+        lock.unlock();
+
+        work_on(*job, slot);
+
+        lock.lock();
+        if (--job->active == 0u)
+        {
+            m_job_done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::work_on(Job& job, size_t slot)
+{
+    auto& own = job.ranges[slot];
+    while (true)
+    {
+        // own chunks front to back
+        auto range = own.load();
+        while (get_first(range) < get_last(range))
+        {
+            if (own.compare_exchange_weak(range, pack_range(get_first(range) + 1u, get_last(range))))
+            {
+                run_chunk(job, get_first(range));
+                range = own.load();
+            }
+        }
+
+        // then the back half of the largest range left, which keeps the victim's front in its cache
+        bool stolen = false;
+        while (!stolen)
+        {
+            size_t victim = job.num_slots;
+            uint64_t victim_range = 0u;
+            uint64_t victim_size = 0u;
+            for (size_t other = 0u; other < job.num_slots; ++other)
+            {
+                const auto other_range = job.ranges[other].load();
+                const auto size = get_last(other_range) - std::min(get_first(other_range), get_last(other_range));
+                if (other != slot && size > victim_size)
+                {
+                    victim = other;
+                    victim_range = other_range;
+                    victim_size = size;
+                }
+            }
+            if (victim == job.num_slots)
+            {
+                return;
+            }
+
+            const auto middle = get_first(victim_range) + victim_size / 2u;
+            if (job.ranges[victim].compare_exchange_strong(victim_range, pack_range(get_first(victim_range), middle)))
+            {
+                // own is empty and nobody touches an empty range
+                own.store(pack_range(middle, get_last(victim_range)));
+                stolen = true;
+            }
+        }
+    }
+}
+
+void ThreadPool::run_chunk(Job& job, size_t chunk)
+{
+    const auto chunk_begin = job.begin + chunk * job.grain;
+    const auto chunk_end = std::min(job.end, chunk_begin + job.grain);
+    try
+    {
+        (*job.body)(chunk_begin, chunk_end);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(job.error_mutex);
+        if (!job.error)
+        {
+            job.error = std::current_exception();
+        }
+    }
+    job.remaining.fetch_sub(1u);
+}
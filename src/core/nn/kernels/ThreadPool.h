@@ -0,0 +1,78 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* @brief  fixed set of worker threads that host kernels split their loops across
+* @note   parallel_for cuts [begin, end) into chunks of grain iterations and deals them out as one
+*         contiguous range per participant. A participant runs its range front to back and, once
+*         it is empty, steals the back half of the fullest remaining range, so uneven chunks are
+*         balanced without a shared queue. The calling thread participates by default, so an op
+*         that fits in one chunk runs inline without waking anyone. Concurrent callers share the
+*         workers: every caller adds only itself, the pool never starts more threads than it was
+*         built with, and a call that finds every worker busy still completes on its caller.
+*         A parallel_for from inside a worker runs inline, nested loops do not fan out again
+*/
+class ThreadPool
+{
+public:
+    using RangeFunction = std::function<void(size_t, size_t)>;
+
+    // num_threads counts the caller, 0 means one thread per core; pinning is Linux only
+    explicit ThreadPool(size_t num_threads = 0, bool pin_threads = false);
+    virtual ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /*
+    * @brief  calls body(range_begin, range_end) for disjoint ranges covering [begin, end)
+    * @note   ranges are cut at multiples of grain from begin, so each holds whole chunks of grain
+    *         iterations (the last chunk may be short). At most max_threads threads work on them,
+    *         0 means all of them. Returns once every range has run; the first exception body
+    *         throws is rethrown here after the other chunks finish
+    */
+    virtual void parallel_for(size_t begin, size_t end, size_t grain, const RangeFunction& body, size_t max_threads = 0);
+
+    // workers plus the caller
+    virtual size_t get_num_threads() const;
+    virtual bool get_pin_threads() const;
+    // with false the caller only waits, every chunk runs on a worker
+    virtual void set_caller_participates(bool caller_participates);
+    virtual bool get_caller_participates() const;
+
+    /*
+    * @brief  the pool host kernels use, created on first use with one thread per core
+    * @note   set_default replaces it; calls already running keep the old pool alive until they return
+    */
+    static std::shared_ptr<ThreadPool> get_default();
+    static void set_default(std::shared_ptr<ThreadPool> pool);
+    static size_t get_hardware_threads();
+
+private:
+    struct Job;
+
+    void run_worker(size_t worker);
+    // runs chunks of the slot, then steals until the job has no work left
+    static void work_on(Job& job, size_t slot);
+    static void run_chunk(Job& job, size_t chunk);
+
+    std::vector<std::thread>    m_workers;
+    std::vector<Job*>           m_jobs;     // jobs with slots no participant has claimed yet
+    mutable std::mutex          m_mutex;
+    std::condition_variable     m_work_available;
+    std::condition_variable     m_job_done;
+    bool                        m_stop = false;
+    bool                        m_pin_threads = false;
+    std::atomic<bool>           m_caller_participates{true};
+};
+
+#endif  // THREAD_POOL_H
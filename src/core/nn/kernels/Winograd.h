@@ -0,0 +1,263 @@
+#ifndef WINOGRAD_H
+#define WINOGRAD_H
+
+#include "Gemm.h"
+#include "Elementwise.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/*
+* @brief  Winograd F(2x2, 3x3) convolution on the host for NHWC input and OHWI 3x3 filters, stride 1
+* @note   every 2x2 output tile is computed from a 4x4 input tile with 16 multiplies per channel pair
+*         instead of 36. The work splits into three passes:
+*           input transform   V[xi][tile][ic] = (B^T d B)[xi]
+*           16 GEMMs          M[xi] = V[xi] * U[xi], with U[xi][ic][oc] = (G g G^T)[xi] precomputed once
+*           output transform  Y = A^T M A, plus the epilogue (bias, relu)
+*         Channels are innermost in all three layouts. Each transform is two separable 1-D passes, and
+*         each pass is a loop over the channels of 4 non-aliasing rows that the compiler vectorizes.
+*         The transforms split their tiles across the ThreadPool, the GEMMs split themselves.
+*/
+template<typename DATA_T>
+class WinogradHost
+{
+public:
+    static constexpr size_t TILE = 4;        // input tile edge
+    static constexpr size_t OUT_TILE = 2;    // output tile edge
+    static constexpr size_t NUM_XI = TILE * TILE;
+
+    // u holds NUM_XI matrices of in_c x out_c
+    static void transform_filter(const DATA_T* weight, size_t out_c, size_t in_c, DATA_T* u);
+
+    // number of scratch elements convolve needs for num_tiles tiles
+    static size_t get_scratch_size(size_t num_tiles, size_t in_c, size_t out_c);
+
+    // input is {batch, in_h, in_w, in_c}, output is {batch, out_h, out_w, out_c}
+    static void convolve(const DATA_T* input, size_t batch, size_t in_h, size_t in_w, size_t in_c,
+                         const DATA_T* u, size_t out_c, size_t pad_top, size_t pad_left,
+                         size_t out_h, size_t out_w, DATA_T* scratch, DATA_T* output,
+                         const GemmEpilogue<DATA_T>& epilogue = {});
+
+private:
+    static void transform_input(const DATA_T* input, size_t batch, size_t in_h, size_t in_w, size_t in_c,
+                                size_t pad_top, size_t pad_left, size_t tiles_h, size_t tiles_w, DATA_T* v);
+    static void transform_output(const DATA_T* m, size_t batch, size_t tiles_h, size_t tiles_w, size_t out_c,
+                                 size_t out_h, size_t out_w, const GemmEpilogue<DATA_T>& epilogue, DATA_T* output);
+
+    // one 1-D pass of B^T or A^T over 4 rows of channels; the rows never alias, so the channel loop vectorizes
+    static void apply_bt(const DATA_T* __restrict x0, const DATA_T* __restrict x1, const DATA_T* __restrict x2,
+                         const DATA_T* __restrict x3, DATA_T* __restrict y0, DATA_T* __restrict y1,
+                         DATA_T* __restrict y2, DATA_T* __restrict y3, size_t size);
+    static void apply_at(const DATA_T* __restrict x0, const DATA_T* __restrict x1, const DATA_T* __restrict x2,
+                         const DATA_T* __restrict x3, DATA_T* __restrict y0, DATA_T* __restrict y1, size_t size);
+};
+
+template<typename DATA_T>
+void WinogradHost<DATA_T>::transform_filter(const DATA_T* weight, size_t out_c, size_t in_c, DATA_T* u)
+{
+    const DATA_T half = static_cast<DATA_T>(0.5);
+    for (size_t oc = 0u; oc < out_c; ++oc)
+    {
+        for (size_t ic = 0u; ic < in_c; ++ic)
+        {
+            // g is 3x3, taps of one (oc, ic) pair are in_c apart in OHWI
+            DATA_T g[3][3];
+            for (size_t kh = 0u; kh < 3u; ++kh)
+            {
+                for (size_t kw = 0u; kw < 3u; ++kw)
+                {
+                    g[kh][kw] = weight[((oc * 3u + kh) * 3u + kw) * in_c + ic];
+                }
+            }
+
+            // t = G g, G = {{1, 0, 0}, {1/2, 1/2, 1/2}, {1/2, -1/2, 1/2}, {0, 0, 1}}
+            DATA_T t[TILE][3];
+            for (size_t kw = 0u; kw < 3u; ++kw)
+            {
+                t[0][kw] = g[0][kw];
+                t[1][kw] = half * (g[0][kw] + g[1][kw] + g[2][kw]);
+                t[2][kw] = half * (g[0][kw] - g[1][kw] + g[2][kw]);
+                t[3][kw] = g[2][kw];
+            }
+
+            // u = t G^T
+            for (size_t i = 0u; i < TILE; ++i)
+            {
+                const DATA_T row[TILE] = {t[i][0],
+                                          half * (t[i][0] + t[i][1] + t[i][2]),
+                                          half * (t[i][0] - t[i][1] + t[i][2]),
+                                          t[i][2]};
+                for (size_t j = 0u; j < TILE; ++j)
+                {
+                    u[((i * TILE + j) * in_c + ic) * out_c + oc] = row[j];
+                }
+            }
+        }
+    }
+}
+
+template<typename DATA_T>
+size_t WinogradHost<DATA_T>::get_scratch_size(size_t num_tiles, size_t in_c, size_t out_c)
+{
+    return NUM_XI * num_tiles * (in_c + out_c);
+}
+
+template<typename DATA_T>
+void WinogradHost<DATA_T>::convolve(const DATA_T* input, size_t batch, size_t in_h, size_t in_w, size_t in_c,
+                                    const DATA_T* u, size_t out_c, size_t pad_top, size_t pad_left,
+                                    size_t out_h, size_t out_w, DATA_T* scratch, DATA_T* output,
+                                    const GemmEpilogue<DATA_T>& epilogue)
+{
+    const size_t tiles_h = (out_h + OUT_TILE - 1u) / OUT_TILE;
+    const size_t tiles_w = (out_w + OUT_TILE - 1u) / OUT_TILE;
+    const size_t num_tiles = batch * tiles_h * tiles_w;
+    DATA_T* v = scratch;
+    DATA_T* m = scratch + NUM_XI * num_tiles * in_c;
+
+    transform_input(input, batch, in_h, in_w, in_c, pad_top, pad_left, tiles_h, tiles_w, v);
+    for (size_t xi = 0u; xi < NUM_XI; ++xi)
+    {
+        GemmHost<DATA_T>::multiply(num_tiles, out_c, in_c,
+                                   {v + xi * num_tiles * in_c, in_c, 1u},
+                                   {u + xi * in_c * out_c, out_c, 1u},
+                                   m + xi * num_tiles * out_c, out_c);
+    }
+    transform_output(m, batch, tiles_h, tiles_w, out_c, out_h, out_w, epilogue, output);
+}
+
+template<typename DATA_T>
+void WinogradHost<DATA_T>::transform_input(const DATA_T* input, size_t batch, size_t in_h, size_t in_w, size_t in_c,
+                                           size_t pad_top, size_t pad_left, size_t tiles_h, size_t tiles_w, DATA_T* v)
+{
+    const size_t num_tiles = batch * tiles_h * tiles_w;
+    const std::vector<DATA_T> zeros(in_c, static_cast<DATA_T>(0));
+    const size_t grain = std::max<size_t>(1u, ElementwiseHost::PARALLEL_GRAIN / (NUM_XI * std::max<size_t>(in_c, 1u)));
+
+    ThreadPool::get_default()->parallel_for(0u, num_tiles, grain, [&](size_t first, size_t last)
+    {
+        thread_local std::vector<DATA_T> t;
+        t.resize(NUM_XI * in_c);
+        for (size_t tile = first; tile < last; ++tile)
+        {
+            const size_t n = tile / (tiles_h * tiles_w);
+            const size_t th = tile / tiles_w % tiles_h;
+            const size_t tw = tile % tiles_w;
+
+            // d[i][j] points at the channels of one input pixel, or at zeros in the padding;
+            // unsigned wrap-around turns pixels above or left of the input into out-of-range ones
+            const DATA_T* d[TILE][TILE];
+            for (size_t i = 0u; i < TILE; ++i)
+            {
+                const size_t ih = th * OUT_TILE + i - pad_top;
+                for (size_t j = 0u; j < TILE; ++j)
+                {
+                    const size_t iw = tw * OUT_TILE + j - pad_left;
+                    d[i][j] = ih < in_h && iw < in_w ? input + ((n * in_h + ih) * in_w + iw) * in_c : zeros.data();
+                }
+            }
+
+            // V = B^T d B: B^T on the columns of d into t[i][j], then on the rows of t into V[i][j]
+            for (size_t j = 0u; j < TILE; ++j)
+            {
+                apply_bt(d[0][j], d[1][j], d[2][j], d[3][j], t.data() + (0u * TILE + j) * in_c, t.data() + (1u * TILE + j) * in_c,
+                         t.data() + (2u * TILE + j) * in_c, t.data() + (3u * TILE + j) * in_c, in_c);
+            }
+            for (size_t i = 0u; i < TILE; ++i)
+            {
+                const DATA_T* t_row = t.data() + i * TILE * in_c;
+                DATA_T* v_row = v + (i * TILE * num_tiles + tile) * in_c;
+                const size_t v_stride = num_tiles * in_c;
+                apply_bt(t_row, t_row + in_c, t_row + 2u * in_c, t_row + 3u * in_c,
+                         v_row, v_row + v_stride, v_row + 2u * v_stride, v_row + 3u * v_stride, in_c);
+            }
+        }
+    });
+}
+
+template<typename DATA_T>
+void WinogradHost<DATA_T>::transform_output(const DATA_T* m, size_t batch, size_t tiles_h, size_t tiles_w, size_t out_c,
+                                            size_t out_h, size_t out_w, const GemmEpilogue<DATA_T>& epilogue, DATA_T* output)
+{
+    const size_t num_tiles = batch * tiles_h * tiles_w;
+    const size_t m_stride = num_tiles * out_c;
+    const size_t grain = std::max<size_t>(1u, ElementwiseHost::PARALLEL_GRAIN / (NUM_XI * std::max<size_t>(out_c, 1u)));
+
+    ThreadPool::get_default()->parallel_for(0u, num_tiles, grain, [&](size_t first, size_t last)
+    {
+        thread_local std::vector<DATA_T> t;
+        thread_local std::vector<DATA_T> y;
+        t.resize(OUT_TILE * TILE * out_c);
+        y.resize(OUT_TILE * OUT_TILE * out_c);
+        for (size_t tile = first; tile < last; ++tile)
+        {
+            const size_t n = tile / (tiles_h * tiles_w);
+            const size_t th = tile / tiles_w % tiles_h;
+            const size_t tw = tile % tiles_w;
+
+            // Y = A^T M A: A^T on the columns of M into t[i][j], then on the rows of t into y[i][j]
+            for (size_t j = 0u; j < TILE; ++j)
+            {
+                const DATA_T* m_col = m + (j * num_tiles + tile) * out_c;
+                apply_at(m_col, m_col + TILE * m_stride, m_col + 2u * TILE * m_stride, m_col + 3u * TILE * m_stride,
+                         t.data() + j * out_c, t.data() + (TILE + j) * out_c, out_c);
+            }
+            for (size_t i = 0u; i < OUT_TILE; ++i)
+            {
+                const DATA_T* t_row = t.data() + i * TILE * out_c;
+                apply_at(t_row, t_row + out_c, t_row + 2u * out_c, t_row + 3u * out_c,
+                         y.data() + i * OUT_TILE * out_c, y.data() + (i * OUT_TILE + 1u) * out_c, out_c);
+            }
+
+            // the last row and column of tiles may hang over an odd-sized output
+            for (size_t i = 0u; i < OUT_TILE; ++i)
+            {
+                const size_t oh = th * OUT_TILE + i;
+                for (size_t j = 0u; j < OUT_TILE; ++j)
+                {
+                    const size_t ow = tw * OUT_TILE + j;
+                    if (oh >= out_h || ow >= out_w)
+                    {
+                        continue;
+                    }
+                    const DATA_T* y_pixel = y.data() + (i * OUT_TILE + j) * out_c;
+                    DATA_T* out_pixel = output + ((n * out_h + oh) * out_w + ow) * out_c;
+                    for (size_t c = 0u; c < out_c; ++c)
+                    {
+                        out_pixel[c] = epilogue.apply(y_pixel[c], c);
+                    }
+                }
+            }
+        }
+    });
+}
+
+template<typename DATA_T>
+void WinogradHost<DATA_T>::apply_bt(const DATA_T* __restrict x0, const DATA_T* __restrict x1, const DATA_T* __restrict x2,
+                                    const DATA_T* __restrict x3, DATA_T* __restrict y0, DATA_T* __restrict y1,
+                                    DATA_T* __restrict y2, DATA_T* __restrict y3, size_t size)
+{
+    // B^T = {{1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}}
+    for (size_t c = 0u; c < size; ++c)
+    {
+        y0[c] = x0[c] - x2[c];
+        y1[c] = x1[c] + x2[c];
+        y2[c] = x2[c] - x1[c];
+        y3[c] = x1[c] - x3[c];
+    }
+}
+
+template<typename DATA_T>
+void WinogradHost<DATA_T>::apply_at(const DATA_T* __restrict x0, const DATA_T* __restrict x1, const DATA_T* __restrict x2,
+                                    const DATA_T* __restrict x3, DATA_T* __restrict y0, DATA_T* __restrict y1, size_t size)
+{
+    // A^T = {{1, 1, 1, 0}, {0, 1, -1, -1}}
+    for (size_t c = 0u; c < size; ++c)
+    {
+        y0[c] = x0[c] + x1[c] + x2[c];
+        y1[c] = x1[c] - x2[c] - x3[c];
+    }
+}
+
+#endif  // WINOGRAD_H
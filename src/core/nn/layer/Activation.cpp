@@ -1,56 +1,87 @@
-#include "Activation.h"
-
-Activation::Activation(ACTIVATION activation): Layer()
-{
-    set_activation(activation);
-}
-
-void Activation::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
-{
-    // do something
-    if (m_platform != input->get_platform())
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Input and Layer are not on the same platform");
-    }
-
-    if (m_activation == ACTIVATION::UNKNOWN)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Activation type is not set properly. Unknown in unhandled.");
-    }
-
-    switch(m_activation)
-    {
-        case ACTIVATION::RELU:
-            input->relu(result1);
-            break;
-        case ACTIVATION::ARGMAX:
-            input->argmax(result1);
-            break;
-        default:
-            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-            throw std::invalid_argument("Unhndled Activation type rather than UNKNOWN is encountered.");
-            break;
-    }
-}
-
-void Activation::to_device()
-{
-    m_platform = PLATFORM::DEVICE;
-}
-
-void Activation::to_host()
-{
-    m_platform = PLATFORM::HOST;
-}
-
-ACTIVATION Activation::get_activation() const
-{
-    return m_activation;
-}
-
-void Activation::set_activation(ACTIVATION activation)
-{
-    m_activation = activation;
-}
\ No newline at end of file
+#include "Activation.h"
+
+Activation::Activation(ACTIVATION activation): Layer()
+{
+    set_activation(activation);
+}
+
+void Activation::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    // do something
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    if (m_activation == ACTIVATION::UNKNOWN)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Activation type is not set properly. Unknown in unhandled.");
+    }
+
+    switch(m_activation)
+    {
+        case ACTIVATION::RELU:
+            input->relu(result1);
+            break;
+        case ACTIVATION::ARGMAX:
+            input->argmax(result1);
+            break;
+        case ACTIVATION::SOFTMAX:
+            input->softmax(result1);
+            break;
+        default:
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::invalid_argument("Unhndled Activation type rather than UNKNOWN is encountered.");
+            break;
+    }
+}
+
+void Activation::to_device()
+{
+    m_platform = PLATFORM::DEVICE;
+}
+
+void Activation::to_host()
+{
+    m_platform = PLATFORM::HOST;
+}
+
+ACTIVATION Activation::get_activation() const
+{
+    return m_activation;
+}
+
+bool Activation::requires_scratch() const
+{
+    return false;
+}
+
+std::vector<size_t> Activation::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    if (m_activation == ACTIVATION::ARGMAX)
+    {
+        // one index per row, a column vector reduces to a single index
+        return {input_dims[1] == 1 ? size_t{1} : input_dims[0], 1};
+    }
+    return input_dims;
+}
+
+void Activation::set_activation(ACTIVATION activation)
+{
+    m_activation = activation;
+}
+
+std::string Activation::get_name() const
+{
+    switch (m_activation)
+    {
+        case ACTIVATION::ARGMAX:
+            return "ARGMAX";
+        case ACTIVATION::SOFTMAX:
+            return "SOFTMAX";
+        default:
+            return "RELU";
+    }
+}
@@ -1,23 +1,26 @@
-#ifndef ACTIVATION_H
-#define ACTIVATION_H
-
-#include "Layer.h"
-
-class Activation : public Layer
-{
-public:
-
-    Activation(ACTIVATION activation);
-    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
-    virtual void to_device() override;
-    virtual void to_host() override;
-    virtual ACTIVATION get_activation() const;
-
-protected:
-    virtual void set_activation(ACTIVATION activation);
-
-protected:
-    ACTIVATION m_activation = ACTIVATION::UNKNOWN;
-};
-
+#ifndef ACTIVATION_H
+#define ACTIVATION_H
+
+#include "Layer.h"
+
+class Activation : public Layer
+{
+public:
+
+    Activation(ACTIVATION activation);
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    virtual ACTIVATION get_activation() const;
+    virtual bool requires_scratch() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+
+protected:
+    virtual void set_activation(ACTIVATION activation);
+
+protected:
+    ACTIVATION m_activation = ACTIVATION::UNKNOWN;
+};
+
 #endif
\ No newline at end of file
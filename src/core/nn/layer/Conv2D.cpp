@@ -1,18 +1,192 @@
-#include "Conv2D.h"
-
-void Conv2D::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
-{
-    std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-    // do something
-}
-
-// void Conv2D::to_device()
-// {
-//     // m_weight.load_to_device();
-//     // m_bias.load_to_device();
-// }
-
-// void Conv2D::to_host()
-// {
-//     // m_jernel.load_to_host();
-// }
\ No newline at end of file
+#include "Conv2D.h"
+
+Conv2D::Conv2D(size_t stride_h, size_t stride_w, PADDING padding, size_t dilation_h, size_t dilation_w):
+    Layer(), m_stride_h(stride_h), m_stride_w(stride_w), m_padding(padding), m_dilation_h(dilation_h), m_dilation_w(dilation_w)
+{
+    if (stride_h == 0u || stride_w == 0u || dilation_h == 0u || dilation_w == 0u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Strides and dilations must be at least 1");
+    }
+}
+
+void Conv2D::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    const auto& input_dims = input->get_dims();
+    if (input_dims.size() != 4u || input_dims[3] != m_in_channels)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be NHWC with as many channels as the weights");
+    }
+
+    const bool relu = m_fused_activation == ACTIVATION::RELU;
+    if (uses_winograd())
+    {
+        input->winograd_conv2d(m_winograd_weight.get(), m_bias, get_params(input_dims), result2, result1, relu);
+        return;
+    }
+
+    // one row per output pixel, so the GEMM result is the NHWC output
+    input->im2col(get_params(input_dims), result2);
+    result2->dense(m_weight, m_bias, result1, true, relu);
+    result1->set_dims(get_output_dims(input_dims));
+}
+
+void Conv2D::to_device()
+{
+    prepare_winograd();
+    m_weight->load_to_device();
+    m_bias->load_to_device();
+    if (m_winograd_weight)
+    {
+        m_winograd_weight->load_to_device();
+    }
+    m_platform = PLATFORM::DEVICE;
+}
+
+void Conv2D::to_host()
+{
+    m_weight->load_to_host();
+    m_bias->load_to_host();
+    prepare_winograd();
+    if (m_winograd_weight)
+    {
+        m_winograd_weight->load_to_host();
+    }
+    m_platform = PLATFORM::HOST;
+}
+
+void Conv2D::set_winograd_enabled(bool enabled)
+{
+    m_winograd_enabled = enabled;
+    // the filter transform happens on load, redo it for a layer that is already loaded
+    if (m_platform == PLATFORM::HOST)
+    {
+        to_host();
+    }
+    else if (m_platform == PLATFORM::DEVICE)
+    {
+        to_device();
+    }
+}
+
+bool Conv2D::uses_winograd() const
+{
+    return m_winograd_enabled && m_kernel_h == 3u && m_kernel_w == 3u && m_stride_h == 1u && m_stride_w == 1u &&
+           m_dilation_h == 1u && m_dilation_w == 1u;
+}
+
+void Conv2D::prepare_winograd()
+{
+    if (m_winograd_weight || !uses_winograd())
+    {
+        return;
+    }
+    if (m_weight->get_platform() != PLATFORM::HOST)
+    {
+        m_weight->load_to_host();
+    }
+
+    std::vector<float> transformed(WinogradHost<float>::NUM_XI * m_in_channels * m_out_channels);
+    WinogradHost<float>::transform_filter(m_weight->data(), m_out_channels, m_in_channels, transformed.data());
+
+    // same tensor type as the weights, so it can follow them to the device
+    m_winograd_weight.reset(m_weight->create_empty());
+    m_winograd_weight->set_host_data(transformed);
+    m_winograd_weight->set_dims({WinogradHost<float>::NUM_XI * m_in_channels, m_out_channels});
+}
+
+void Conv2D::set_weight(Tensor<float>* weight)
+{
+    const auto dims = weight->get_dims();
+    if (dims.size() != 4u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Conv2D weights must be OHWI");
+    }
+    m_out_channels = dims[0];
+    m_kernel_h = dims[1];
+    m_kernel_w = dims[2];
+    m_in_channels = dims[3];
+
+    m_weight = weight;
+    m_weight->set_dims({m_out_channels, m_kernel_h * m_kernel_w * m_in_channels});
+    m_winograd_weight.reset();
+}
+
+void Conv2D::set_bias(Tensor<float>* bias)
+{
+    m_bias = bias;
+}
+
+void Conv2D::set_fused_activation(ACTIVATION activation)
+{
+    if (activation != ACTIVATION::UNKNOWN && activation != ACTIVATION::RELU)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Only RELU can be fused into Conv2D");
+    }
+    m_fused_activation = activation;
+}
+
+ACTIVATION Conv2D::get_fused_activation() const
+{
+    return m_fused_activation;
+}
+
+bool Conv2D::fuse_activation(ACTIVATION activation)
+{
+    if (activation != ACTIVATION::RELU || m_fused_activation != ACTIVATION::UNKNOWN)
+    {
+        return false;
+    }
+    m_fused_activation = activation;
+    return true;
+}
+
+Conv2DParams Conv2D::get_params(const std::vector<size_t>& input_dims) const
+{
+    Conv2DParams window;
+    window.kernel_h = m_kernel_h;
+    window.kernel_w = m_kernel_w;
+    window.stride_h = m_stride_h;
+    window.stride_w = m_stride_w;
+    window.dilation_h = m_dilation_h;
+    window.dilation_w = m_dilation_w;
+    return get_window_params(input_dims, window, m_padding);
+}
+
+std::vector<size_t> Conv2D::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    const auto params = get_params(input_dims);
+    return {input_dims[0], params.out_h, params.out_w, m_out_channels};
+}
+
+size_t Conv2D::get_num_operations(const std::vector<size_t>& input_dims) const
+{
+    // the direct convolution, a multiply and an add per output element and tap, Winograd needs fewer
+    const auto params = get_params(input_dims);
+    return 2u * input_dims[0] * params.out_h * params.out_w * m_out_channels * params.kernel_h * params.kernel_w * input_dims[3];
+}
+
+std::vector<size_t> Conv2D::get_scratch_dims(const std::vector<size_t>& input_dims) const
+{
+    const auto params = get_params(input_dims);
+    if (uses_winograd())
+    {
+        const auto num_tiles = input_dims[0] * ((params.out_h + 1u) / 2u) * ((params.out_w + 1u) / 2u);
+        return {WinogradHost<float>::NUM_XI * num_tiles, m_in_channels + m_out_channels};
+    }
+    return {input_dims[0] * params.out_h * params.out_w, m_kernel_h * m_kernel_w * m_in_channels};
+}
+
+std::string Conv2D::get_name() const
+{
+    return "Conv2D";
+}
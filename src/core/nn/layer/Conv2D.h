@@ -1,17 +1,65 @@
-#ifndef CONV2D_H
-#define CONV2D_H
-
-#include "Layer.h"
-
-class Conv2D : public Layer
-{
-public:
-    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
-    // virtual void to_device() override;
-    // virtual void to_host() override;
-
-protected:
-    Tensor<float> m_kernel;
-};
-
-#endif
\ No newline at end of file
+#ifndef CONV2D_H
+#define CONV2D_H
+
+#include "Layer.h"
+
+#include <memory>
+
+/*
+* @brief  2-D convolution over NHWC tensors, lowered to im2col followed by the fused Dense GEMM
+* @note   the im2col matrix lives in the scratch tensor, {batch * out_h * out_w, kernel_h * kernel_w * in_channels},
+*         and multiplied by the transposed weights it already is the NHWC output.
+*         3x3 stride-1 undilated convolutions take the Winograd F(2x2, 3x3) path instead, its filter
+*         transform is computed once by to_host / to_device
+*/
+class Conv2D : public Layer
+{
+public:
+    Conv2D(size_t stride_h = 1u, size_t stride_w = 1u, PADDING padding = PADDING::VALID,
+           size_t dilation_h = 1u, size_t dilation_w = 1u);
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    // weights are OHWI, {out_channels, kernel_h, kernel_w, in_channels} like TFLite stores them.
+    // The tensor is reshaped in place to the {out_channels, kernel_h * kernel_w * in_channels} matrix
+    // the GEMM reads, the memory layout doesn't change
+    virtual void set_weight(Tensor<float>* weight);
+    virtual void set_bias(Tensor<float>* bias);
+    // activation applied inside the GEMM epilogue, only RELU and UNKNOWN (none) are supported
+    virtual void set_fused_activation(ACTIVATION activation);
+    virtual ACTIVATION get_fused_activation() const;
+    virtual bool fuse_activation(ACTIVATION activation) override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual size_t get_num_operations(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+    virtual std::vector<size_t> get_scratch_dims(const std::vector<size_t>& input_dims) const override;
+    // window geometry for an NHWC input shape
+    virtual Conv2DParams get_params(const std::vector<size_t>& input_dims) const;
+    // on by default, turning it off forces im2col for every shape; a model using the layer
+    // has to be planned again afterwards since the scratch size changes
+    virtual void set_winograd_enabled(bool enabled);
+    virtual bool uses_winograd() const;
+
+protected:
+    // transforms the weights on the host into m_winograd_weight, on the same platform as the weights
+    virtual void prepare_winograd();
+
+protected:
+    Tensor<float>* m_weight = nullptr;
+    Tensor<float>* m_bias = nullptr;
+    size_t m_kernel_h = 0u;
+    size_t m_kernel_w = 0u;
+    size_t m_in_channels = 0u;
+    size_t m_out_channels = 0u;
+    size_t m_stride_h;
+    size_t m_stride_w;
+    PADDING m_padding;
+    size_t m_dilation_h;
+    size_t m_dilation_w;
+    ACTIVATION m_fused_activation = ACTIVATION::UNKNOWN;
+    bool m_winograd_enabled = true;
+    std::unique_ptr<Tensor<float>> m_winograd_weight;   // {16 * in_channels, out_channels}
+};
+
+#endif
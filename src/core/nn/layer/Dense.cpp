@@ -1,40 +1,167 @@
-#include "Dense.h"
-
-void Dense::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
-{
-    // do something
-    if (m_platform != input->get_platform())
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Input and Layer are not on the same platform");
-    }
-
-    input->multiply(m_weight, result2);
-    result2->add(m_bias, result1);
-}
-
-void Dense::to_device()
-{
-
-    m_weight->load_to_device();
-    m_bias->load_to_device();
-    m_platform = PLATFORM::DEVICE;
-}
-
-void Dense::to_host()
-{
-
-    m_weight->load_to_host();
-    m_bias->load_to_host();
-    m_platform = PLATFORM::HOST;
-}
-
-void Dense::set_weight(Tensor<float>* weight)
-{
-    m_weight = std::move(weight);
-}
-
-void Dense::set_bias(Tensor<float>* bias)
-{
-    m_bias = std::move(bias);
-}
\ No newline at end of file
+#include "Dense.h"
+
+void Dense::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    // do something
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    // bias and activation are applied while the GEMM output is still in registers
+    const bool relu = m_fused_activation == ACTIVATION::RELU;
+    if (m_half_weight)
+    {
+        input->half_dense(m_half_weight.get(), m_weight_format, m_bias, result1, relu);
+        return;
+    }
+    input->dense(m_weight, m_bias, result1, m_weight_transposed, relu);
+}
+
+void Dense::to_device()
+{
+    prepare_half_weight();
+    if (m_half_weight)
+    {
+        m_half_weight->load_to_device();
+    }
+    else
+    {
+        m_weight->load_to_device();
+    }
+    m_bias->load_to_device();
+    m_platform = PLATFORM::DEVICE;
+}
+
+void Dense::to_host()
+{
+
+    m_weight->load_to_host();
+    m_bias->load_to_host();
+    prepare_half_weight();
+    if (m_half_weight)
+    {
+        m_half_weight->load_to_host();
+    }
+    m_platform = PLATFORM::HOST;
+}
+
+void Dense::set_weight(Tensor<float>* weight, bool transposed)
+{
+    m_weight = std::move(weight);
+    m_weight_transposed = transposed;
+    m_half_weight.reset();
+}
+
+void Dense::set_weight_format(WEIGHT_FORMAT format)
+{
+    m_weight_format = format;
+    m_half_weight.reset();
+    // the conversion happens on load, redo it for a layer that is already loaded
+    if (m_platform == PLATFORM::HOST)
+    {
+        to_host();
+    }
+    else if (m_platform == PLATFORM::DEVICE)
+    {
+        to_device();
+    }
+}
+
+WEIGHT_FORMAT Dense::get_weight_format() const
+{
+    return m_weight_format;
+}
+
+size_t Dense::get_weight_bytes() const
+{
+    return m_weight->get_size() * (m_weight_format == WEIGHT_FORMAT::FP32 ? sizeof(float) : sizeof(uint16_t));
+}
+
+void Dense::prepare_half_weight()
+{
+    if (m_half_weight || m_weight_format == WEIGHT_FORMAT::FP32)
+    {
+        return;
+    }
+    if (m_weight->get_platform() != PLATFORM::HOST)
+    {
+        m_weight->load_to_host();
+    }
+
+    // always {out, in}, so every output reads one contiguous row
+    const auto weight = m_weight->view<2>();
+    const auto num_outputs = m_weight_transposed ? weight.dim(0) : weight.dim(1);
+    const auto num_inputs = m_weight_transposed ? weight.dim(1) : weight.dim(0);
+    std::vector<float> rows(m_weight->data(), m_weight->data() + m_weight->get_size());
+    if (!m_weight_transposed)
+    {
+        for (size_t out = 0u; out < num_outputs; ++out)
+        {
+            for (size_t in = 0u; in < num_inputs; ++in)
+            {
+                rows[out * num_inputs + in] = weight(in, out);
+            }
+        }
+    }
+    std::vector<uint16_t> converted(rows.size());
+    GemmHalfHost::convert(rows.data(), rows.size(), m_weight_format, converted.data());
+
+    // same tensor type as the weights, so it can follow them to the device
+    m_half_weight.reset(m_weight->create_empty_uint16());
+    m_half_weight->set_host_data(converted);
+    m_half_weight->set_dims({num_outputs, num_inputs});
+}
+
+void Dense::set_bias(Tensor<float>* bias)
+{
+    m_bias = std::move(bias);
+}
+
+void Dense::set_fused_activation(ACTIVATION activation)
+{
+    if (activation != ACTIVATION::UNKNOWN && activation != ACTIVATION::RELU)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Only RELU can be fused into Dense");
+    }
+    m_fused_activation = activation;
+}
+
+ACTIVATION Dense::get_fused_activation() const
+{
+    return m_fused_activation;
+}
+
+bool Dense::fuse_activation(ACTIVATION activation)
+{
+    if (activation != ACTIVATION::RELU || m_fused_activation != ACTIVATION::UNKNOWN)
+    {
+        return false;
+    }
+    m_fused_activation = activation;
+    return true;
+}
+
+bool Dense::requires_scratch() const
+{
+    return false;
+}
+
+std::vector<size_t> Dense::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    const auto& weight_dims = m_weight->get_dims();
+    return {input_dims[0], m_weight_transposed ? weight_dims[0] : weight_dims[1]};
+}
+
+size_t Dense::get_num_operations(const std::vector<size_t>& input_dims) const
+{
+    // a multiply and an add per input element and output column
+    return 2u * Layer::get_num_operations(input_dims) * get_output_dims(input_dims)[1];
+}
+
+std::string Dense::get_name() const
+{
+    return "Dense";
+}
@@ -1,21 +1,46 @@
-#ifndef DENSE_H
-#define DENSE_H
-
-#include "Layer.h"
-
-class Dense : public Layer
-{
-public:
-
-    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
-    virtual void to_device() override;
-    virtual void to_host() override;
-    virtual void set_weight(Tensor<float>* weight);
-    virtual void set_bias(Tensor<float>* bias);
-
-protected:
-    Tensor<float>* m_weight;
-    Tensor<float>* m_bias;
-};
-
+#ifndef DENSE_H
+#define DENSE_H
+
+#include "Layer.h"
+
+#include <memory>
+
+class Dense : public Layer
+{
+public:
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    // transposed weights are stored as {out, in} (TFLite layout) instead of {in, out}
+    virtual void set_weight(Tensor<float>* weight, bool transposed = false);
+    virtual void set_bias(Tensor<float>* bias);
+    // activation applied inside the GEMM epilogue, only RELU and UNKNOWN (none) are supported
+    virtual void set_fused_activation(ACTIVATION activation);
+    virtual ACTIVATION get_fused_activation() const;
+    virtual bool fuse_activation(ACTIVATION activation) override;
+    // FP16 / BF16 keep a 16-bit {out, in} copy of the weights, made by to_host / to_device, and
+    // multiply with it instead; the fp32 weights then stay on the host. Activations stay fp32
+    virtual void set_weight_format(WEIGHT_FORMAT format);
+    virtual WEIGHT_FORMAT get_weight_format() const;
+    // bytes of the weights forward reads
+    virtual size_t get_weight_bytes() const;
+    virtual bool requires_scratch() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual size_t get_num_operations(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+
+protected:
+    // converts the weights on the host into m_half_weight, on the same platform as the weights
+    virtual void prepare_half_weight();
+
+protected:
+    Tensor<float>* m_weight;
+    Tensor<float>* m_bias;
+    bool m_weight_transposed = false;
+    ACTIVATION m_fused_activation = ACTIVATION::UNKNOWN;
+    WEIGHT_FORMAT m_weight_format = WEIGHT_FORMAT::FP32;
+    std::unique_ptr<Tensor<uint16_t>> m_half_weight;    // {out, in}
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "Flatten.h"
+
+#include <numeric>
+
+Flatten::Flatten(): Layer()
+{
+}
+
+void Flatten::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    input->reshape(get_output_dims(input->get_dims()), result1);
+}
+
+void Flatten::to_device()
+{
+    m_platform = PLATFORM::DEVICE;
+}
+
+void Flatten::to_host()
+{
+    m_platform = PLATFORM::HOST;
+}
+
+bool Flatten::requires_scratch() const
+{
+    return false;
+}
+
+bool Flatten::is_view() const
+{
+    return true;
+}
+
+std::vector<size_t> Flatten::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    if (input_dims.empty())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input needs a batch dimension");
+    }
+    return {input_dims[0], std::accumulate(input_dims.cbegin() + 1, input_dims.cend(), size_t{1}, std::multiplies<size_t>())};
+}
+
+std::string Flatten::get_name() const
+{
+    return "Flatten";
+}
@@ -0,0 +1,24 @@
+#ifndef FLATTEN_H
+#define FLATTEN_H
+
+#include "Layer.h"
+
+/*
+* @brief  collapses every dimension but the batch, {batch, ...} becomes {batch, product of the rest}
+* @note   zero-copy on both platforms: the output is a view of the input, only its dims differ
+*/
+class Flatten : public Layer
+{
+public:
+    Flatten();
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    virtual bool requires_scratch() const override;
+    virtual bool is_view() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "GlobalAveragePool.h"
+
+GlobalAveragePool::GlobalAveragePool(): Layer()
+{
+}
+
+void GlobalAveragePool::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    const auto& input_dims = input->get_dims();
+    if (input_dims.size() != 4u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be NHWC");
+    }
+
+    // a single window covering the whole image
+    Conv2DParams params;
+    params.kernel_h = input_dims[1];
+    params.kernel_w = input_dims[2];
+    params.stride_h = input_dims[1];
+    params.stride_w = input_dims[2];
+    params.out_h = 1u;
+    params.out_w = 1u;
+    input->pool2d(POOLING::AVERAGE, params, result1);
+    result1->set_dims(get_output_dims(input_dims));
+}
+
+void GlobalAveragePool::to_device()
+{
+    m_platform = PLATFORM::DEVICE;
+}
+
+void GlobalAveragePool::to_host()
+{
+    m_platform = PLATFORM::HOST;
+}
+
+bool GlobalAveragePool::requires_scratch() const
+{
+    return false;
+}
+
+std::vector<size_t> GlobalAveragePool::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    return {input_dims[0], input_dims[3]};
+}
+
+std::string GlobalAveragePool::get_name() const
+{
+    return "GlobalAveragePool";
+}
@@ -0,0 +1,23 @@
+#ifndef GLOBAL_AVERAGE_POOL_H
+#define GLOBAL_AVERAGE_POOL_H
+
+#include "Layer.h"
+
+/*
+* @brief  averages every channel of an NHWC tensor over its whole height and width
+* @note   the output is {batch, channels}, ready for a Dense layer
+*/
+class GlobalAveragePool : public Layer
+{
+public:
+    GlobalAveragePool();
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    virtual bool requires_scratch() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+};
+
+#endif
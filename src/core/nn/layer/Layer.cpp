@@ -1,10 +1,45 @@
-#include "Layer.h"
-
-Layer::Layer()
-{
-}
-
-PLATFORM Layer::get_platform() const
-{
-    return m_platform;
-}
+#include "Layer.h"
+
+#include <functional>
+#include <numeric>
+
+Layer::Layer()
+{
+}
+
+PLATFORM Layer::get_platform() const
+{
+    return m_platform;
+}
+
+bool Layer::requires_scratch() const
+{
+    return true;
+}
+
+std::vector<size_t> Layer::get_scratch_dims(const std::vector<size_t>& input_dims) const
+{
+    // conservative default, as large as the output
+    return get_output_dims(input_dims);
+}
+
+size_t Layer::get_num_operations(const std::vector<size_t>& input_dims) const
+{
+    // one per input element, elementwise layers and reductions
+    return std::accumulate(input_dims.cbegin(), input_dims.cend(), size_t{1}, std::multiplies<size_t>());
+}
+
+bool Layer::fuse_activation(ACTIVATION activation)
+{
+    return false;
+}
+
+bool Layer::is_view() const
+{
+    return false;
+}
+
+std::string Layer::get_name() const
+{
+    return "Layer";
+}
@@ -1,18 +1,33 @@
-#ifndef LAYER_H
-#define LAYER_H
-
-#include "../tensor/Tensor.h"
-
-class Layer
-{
-public:
-    Layer();
-    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const = 0;
-    virtual PLATFORM get_platform() const;
-    virtual void to_device() = 0;
-    virtual void to_host() = 0;
-protected:
-    PLATFORM m_platform = PLATFORM::UNKNOWN;
-};
-
+#ifndef LAYER_H
+#define LAYER_H
+
+#include "../tensor/Tensor.h"
+
+class Layer
+{
+public:
+    Layer();
+    virtual ~Layer() = default;
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const = 0;
+    virtual PLATFORM get_platform() const;
+    virtual void to_device() = 0;
+    virtual void to_host() = 0;
+    // whether forward writes intermediates to result2, otherwise it may be nullptr
+    virtual bool requires_scratch() const;
+    // shapes forward produces for an input shape, used to plan the activation arena
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const = 0;
+    virtual std::vector<size_t> get_scratch_dims(const std::vector<size_t>& input_dims) const;
+    // arithmetic operations of forward for an input shape, estimates its cost (see CostModel)
+    virtual size_t get_num_operations(const std::vector<size_t>& input_dims) const;
+    // applies activation inside this layer's forward instead of a separate layer, returns false if it can't
+    virtual bool fuse_activation(ACTIVATION activation);
+    // forward only makes result1 a view of the input with other dims (see Tensor::reshape),
+    // the model plans no memory for its output
+    virtual bool is_view() const;
+    // the layer type, e.g. to label profiles
+    virtual std::string get_name() const;
+protected:
+    PLATFORM m_platform = PLATFORM::UNKNOWN;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "Pool2D.h"
+
+Pool2D::Pool2D(POOLING pooling, size_t filter_h, size_t filter_w, size_t stride_h, size_t stride_w, PADDING padding):
+    Layer(), m_pooling(pooling), m_filter_h(filter_h), m_filter_w(filter_w), m_stride_h(stride_h), m_stride_w(stride_w), m_padding(padding)
+{
+    if (filter_h == 0u || filter_w == 0u || stride_h == 0u || stride_w == 0u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Filter sizes and strides must be at least 1");
+    }
+}
+
+void Pool2D::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    const auto& input_dims = input->get_dims();
+    if (input_dims.size() != 4u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be NHWC");
+    }
+
+    input->pool2d(m_pooling, get_params(input_dims), result1);
+}
+
+void Pool2D::to_device()
+{
+    m_platform = PLATFORM::DEVICE;
+}
+
+void Pool2D::to_host()
+{
+    m_platform = PLATFORM::HOST;
+}
+
+bool Pool2D::requires_scratch() const
+{
+    return false;
+}
+
+std::vector<size_t> Pool2D::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    const auto params = get_params(input_dims);
+    return {input_dims[0], params.out_h, params.out_w, input_dims[3]};
+}
+
+size_t Pool2D::get_num_operations(const std::vector<size_t>& input_dims) const
+{
+    // one per output element and tap
+    const auto params = get_params(input_dims);
+    return input_dims[0] * params.out_h * params.out_w * input_dims[3] * params.kernel_h * params.kernel_w;
+}
+
+POOLING Pool2D::get_pooling() const
+{
+    return m_pooling;
+}
+
+Conv2DParams Pool2D::get_params(const std::vector<size_t>& input_dims) const
+{
+    Conv2DParams window;
+    window.kernel_h = m_filter_h;
+    window.kernel_w = m_filter_w;
+    window.stride_h = m_stride_h;
+    window.stride_w = m_stride_w;
+    return get_window_params(input_dims, window, m_padding);
+}
+
+MaxPool2D::MaxPool2D(size_t filter_h, size_t filter_w, size_t stride_h, size_t stride_w, PADDING padding):
+    Pool2D(POOLING::MAX, filter_h, filter_w, stride_h, stride_w, padding)
+{
+}
+
+AvgPool2D::AvgPool2D(size_t filter_h, size_t filter_w, size_t stride_h, size_t stride_w, PADDING padding):
+    Pool2D(POOLING::AVERAGE, filter_h, filter_w, stride_h, stride_w, padding)
+{
+}
+
+std::string Pool2D::get_name() const
+{
+    return m_pooling == POOLING::MAX ? "MaxPool2D" : "AveragePool2D";
+}
@@ -0,0 +1,49 @@
+#ifndef POOL2D_H
+#define POOL2D_H
+
+#include "Layer.h"
+
+/*
+* @brief  max or average pooling over NHWC tensors
+* @note   taps in the padding are left out, so a SAME average is taken over the taps inside the input
+*         like TFLite does
+*/
+class Pool2D : public Layer
+{
+public:
+    Pool2D(POOLING pooling, size_t filter_h, size_t filter_w, size_t stride_h, size_t stride_w,
+           PADDING padding = PADDING::VALID);
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    virtual bool requires_scratch() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual size_t get_num_operations(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+    virtual POOLING get_pooling() const;
+    // window geometry for an NHWC input shape
+    virtual Conv2DParams get_params(const std::vector<size_t>& input_dims) const;
+
+protected:
+    POOLING m_pooling;
+    size_t m_filter_h;
+    size_t m_filter_w;
+    size_t m_stride_h;
+    size_t m_stride_w;
+    PADDING m_padding;
+};
+
+class MaxPool2D : public Pool2D
+{
+public:
+    MaxPool2D(size_t filter_h, size_t filter_w, size_t stride_h, size_t stride_w, PADDING padding = PADDING::VALID);
+};
+
+class AvgPool2D : public Pool2D
+{
+public:
+    AvgPool2D(size_t filter_h, size_t filter_w, size_t stride_h, size_t stride_w, PADDING padding = PADDING::VALID);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "QuantizedConv2D.h"
+
+QuantizedConv2D::QuantizedConv2D(size_t stride_h, size_t stride_w, PADDING padding, size_t dilation_h, size_t dilation_w):
+    QuantizedDense(), m_stride_h(stride_h), m_stride_w(stride_w), m_padding(padding), m_dilation_h(dilation_h), m_dilation_w(dilation_w)
+{
+    if (stride_h == 0u || stride_w == 0u || dilation_h == 0u || dilation_w == 0u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Strides and dilations must be at least 1");
+    }
+}
+
+void QuantizedConv2D::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    const auto& input_dims = input->get_dims();
+    if (input_dims.size() != 4u || input_dims[3] != m_in_channels)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be NHWC with as many channels as the weights");
+    }
+
+    // one row per output pixel, so the GEMM result is the NHWC output
+    input->im2col(get_params(input_dims), result2);
+    result2->quantized_dense(m_weight, m_requant.get(), get_gemm_params(), result1);
+    result1->set_dims(get_output_dims(input_dims));
+}
+
+void QuantizedConv2D::set_weight(Tensor<int8_t>* weight, const QuantizationParams& quantization)
+{
+    const auto dims = weight->get_dims();
+    if (dims.size() != 4u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("QuantizedConv2D weights must be OHWI");
+    }
+    m_out_channels = dims[0];
+    m_kernel_h = dims[1];
+    m_kernel_w = dims[2];
+    m_in_channels = dims[3];
+
+    weight->set_dims({m_out_channels, m_kernel_h * m_kernel_w * m_in_channels});
+    QuantizedDense::set_weight(weight, quantization);
+}
+
+bool QuantizedConv2D::requires_scratch() const
+{
+    return true;
+}
+
+Conv2DParams QuantizedConv2D::get_params(const std::vector<size_t>& input_dims) const
+{
+    Conv2DParams window;
+    window.kernel_h = m_kernel_h;
+    window.kernel_w = m_kernel_w;
+    window.stride_h = m_stride_h;
+    window.stride_w = m_stride_w;
+    window.dilation_h = m_dilation_h;
+    window.dilation_w = m_dilation_w;
+    return get_window_params(input_dims, window, m_padding);
+}
+
+std::vector<size_t> QuantizedConv2D::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    const auto params = get_params(input_dims);
+    return {input_dims[0], params.out_h, params.out_w, m_out_channels};
+}
+
+size_t QuantizedConv2D::get_num_operations(const std::vector<size_t>& input_dims) const
+{
+    // the direct convolution, a multiply and an add per output element and tap
+    const auto params = get_params(input_dims);
+    return 2u * input_dims[0] * params.out_h * params.out_w * m_out_channels * params.kernel_h * params.kernel_w * input_dims[3];
+}
+
+std::vector<size_t> QuantizedConv2D::get_scratch_dims(const std::vector<size_t>& input_dims) const
+{
+    const auto params = get_params(input_dims);
+    return {input_dims[0] * params.out_h * params.out_w, m_kernel_h * m_kernel_w * m_in_channels};
+}
+
+std::string QuantizedConv2D::get_name() const
+{
+    return "QuantizedConv2D";
+}
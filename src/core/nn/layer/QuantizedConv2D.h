@@ -0,0 +1,40 @@
+#ifndef QUANTIZED_CONV2D_H
+#define QUANTIZED_CONV2D_H
+
+#include "QuantizedDense.h"
+
+/*
+* @brief  2-D convolution over NHWC tensors with int8 weights, im2col followed by the int8 GEMM
+* @note   the im2col matrix in the scratch tensor is float like the input. Its padding taps are 0.0f,
+*         which quantize to the input zero point, so the padding is the one TFLite uses
+*/
+class QuantizedConv2D : public QuantizedDense
+{
+public:
+    QuantizedConv2D(size_t stride_h = 1u, size_t stride_w = 1u, PADDING padding = PADDING::VALID,
+                    size_t dilation_h = 1u, size_t dilation_w = 1u);
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    // weights are OHWI and reshaped in place to {out_channels, kernel_h * kernel_w * in_channels}, see Conv2D
+    virtual void set_weight(Tensor<int8_t>* weight, const QuantizationParams& quantization) override;
+    virtual bool requires_scratch() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual size_t get_num_operations(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+    virtual std::vector<size_t> get_scratch_dims(const std::vector<size_t>& input_dims) const override;
+    // window geometry for an NHWC input shape
+    virtual Conv2DParams get_params(const std::vector<size_t>& input_dims) const;
+
+protected:
+    size_t m_kernel_h = 0u;
+    size_t m_kernel_w = 0u;
+    size_t m_in_channels = 0u;
+    size_t m_out_channels = 0u;
+    size_t m_stride_h;
+    size_t m_stride_w;
+    PADDING m_padding;
+    size_t m_dilation_h;
+    size_t m_dilation_w;
+};
+
+#endif
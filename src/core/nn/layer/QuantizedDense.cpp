@@ -0,0 +1,169 @@
+#include "QuantizedDense.h"
+
+#include <algorithm>
+
+void QuantizedDense::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    input->quantized_dense(m_weight, m_requant.get(), get_gemm_params(), result1);
+}
+
+void QuantizedDense::to_device()
+{
+    prepare_requant();
+    m_weight->load_to_device();
+    m_requant->load_to_device();
+    m_platform = PLATFORM::DEVICE;
+}
+
+void QuantizedDense::to_host()
+{
+    m_weight->load_to_host();
+    prepare_requant();
+    m_requant->load_to_host();
+    m_platform = PLATFORM::HOST;
+}
+
+void QuantizedDense::prepare_requant()
+{
+    if (m_requant)
+    {
+        return;
+    }
+    if (m_weight->get_platform() != PLATFORM::HOST)
+    {
+        m_weight->load_to_host();
+    }
+    if (m_bias && m_bias->get_platform() != PLATFORM::HOST)
+    {
+        m_bias->load_to_host();
+    }
+
+    const auto num_outputs = m_weight->get_dims()[0];
+    const auto inner = m_weight->get_dims()[1];
+    std::vector<int32_t> requant(3 * num_outputs);
+    for (size_t n = 0u; n < num_outputs; ++n)
+    {
+        // sum((a - a_zp) * w) = sum(a * w) - a_zp * sum(w), the second term is constant
+        int32_t row_sum = 0;
+        const int8_t* row = m_weight->data() + n * inner;
+        for (size_t k = 0u; k < inner; ++k)
+        {
+            row_sum += row[k];
+        }
+        requant[n] = (m_bias ? m_bias->data()[n] : 0) - m_input_zero_point * row_sum;
+
+        const auto weight_scale = m_weight_quantization.scales.size() == 1u ? m_weight_quantization.scales[0]
+                                                                            : m_weight_quantization.scales[n];
+        const auto multiplier = QuantizedMultiplier::from_real(static_cast<double>(m_input_scale) * weight_scale / m_output_scale);
+        requant[num_outputs + n] = multiplier.multiplier;
+        requant[2 * num_outputs + n] = multiplier.shift;
+    }
+
+    // same tensor type as the weights, so it can follow them to the device
+    m_requant.reset(m_weight->create_empty_int32());
+    m_requant->set_host_data(requant);
+    m_requant->set_dims({3u, num_outputs});
+}
+
+QuantizedGemmParams QuantizedDense::get_gemm_params() const
+{
+    QuantizedGemmParams params;
+    params.input_scale = m_input_scale;
+    params.input_zero_point = m_input_zero_point;
+    params.output_scale = m_output_scale;
+    params.output_zero_point = m_output_zero_point;
+    if (m_fused_activation == ACTIVATION::RELU)
+    {
+        params.activation_min = std::max(params.activation_min, m_output_zero_point);
+    }
+    return params;
+}
+
+void QuantizedDense::set_weight(Tensor<int8_t>* weight, const QuantizationParams& quantization)
+{
+    const auto& dims = weight->get_dims();
+    if (dims.size() != 2u || !(quantization.scales.size() == 1u || quantization.scales.size() == dims[0]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Quantized weights need one scale or one per output channel");
+    }
+    if (std::any_of(quantization.zero_points.cbegin(), quantization.zero_points.cend(), [](int32_t zp) { return zp != 0; }))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Quantized weights must have a zero point of 0");
+    }
+    m_weight = weight;
+    m_weight_quantization = quantization;
+    m_requant.reset();
+}
+
+void QuantizedDense::set_bias(Tensor<int32_t>* bias)
+{
+    m_bias = bias;
+    m_requant.reset();
+}
+
+void QuantizedDense::set_input_quantization(float scale, int32_t zero_point)
+{
+    m_input_scale = scale;
+    m_input_zero_point = zero_point;
+    m_requant.reset();
+}
+
+void QuantizedDense::set_output_quantization(float scale, int32_t zero_point)
+{
+    m_output_scale = scale;
+    m_output_zero_point = zero_point;
+    m_requant.reset();
+}
+
+void QuantizedDense::set_fused_activation(ACTIVATION activation)
+{
+    if (activation != ACTIVATION::UNKNOWN && activation != ACTIVATION::RELU)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Only RELU can be fused into QuantizedDense");
+    }
+    m_fused_activation = activation;
+}
+
+ACTIVATION QuantizedDense::get_fused_activation() const
+{
+    return m_fused_activation;
+}
+
+bool QuantizedDense::fuse_activation(ACTIVATION activation)
+{
+    if (activation != ACTIVATION::RELU || m_fused_activation != ACTIVATION::UNKNOWN)
+    {
+        return false;
+    }
+    m_fused_activation = activation;
+    return true;
+}
+
+bool QuantizedDense::requires_scratch() const
+{
+    return false;
+}
+
+std::vector<size_t> QuantizedDense::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    return {input_dims[0], m_weight->get_dims()[0]};
+}
+
+size_t QuantizedDense::get_num_operations(const std::vector<size_t>& input_dims) const
+{
+    return 2u * Layer::get_num_operations(input_dims) * m_weight->get_dims()[0];
+}
+
+std::string QuantizedDense::get_name() const
+{
+    return "QuantizedDense";
+}
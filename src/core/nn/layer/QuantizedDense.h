@@ -0,0 +1,55 @@
+#ifndef QUANTIZED_DENSE_H
+#define QUANTIZED_DENSE_H
+
+#include "Layer.h"
+
+#include <memory>
+
+/*
+* @brief  fully connected layer with int8 weights, computed by the int8 GEMM (see Tensor::quantized_dense)
+* @note   the float input is quantized with the input scale / zero point while it is read and the output is
+*         requantized to the output scale / zero point, so the layer reproduces a TFLite int8 FULLY_CONNECTED.
+*         to_host / to_device fold the input zero point into the bias and compute the per-channel
+*         fixed-point multipliers once, they are kept in m_requant
+*/
+class QuantizedDense : public Layer
+{
+public:
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    // weights are {out, in} (TFLite layout), quantized per tensor (one scale) or per output channel.
+    // Their zero points must be 0, as TFLite requires for int8 weights
+    virtual void set_weight(Tensor<int8_t>* weight, const QuantizationParams& quantization);
+    // int32 with a scale of input_scale * weight_scale and a zero point of 0, may be nullptr
+    virtual void set_bias(Tensor<int32_t>* bias);
+    virtual void set_input_quantization(float scale, int32_t zero_point);
+    virtual void set_output_quantization(float scale, int32_t zero_point);
+    // activation applied as a clamp in the requantization, only RELU and UNKNOWN (none) are supported
+    virtual void set_fused_activation(ACTIVATION activation);
+    virtual ACTIVATION get_fused_activation() const;
+    virtual bool fuse_activation(ACTIVATION activation) override;
+    virtual bool requires_scratch() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual size_t get_num_operations(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+
+protected:
+    // builds m_requant on the host: {3, out} rows of folded bias, multipliers and shifts
+    virtual void prepare_requant();
+    virtual QuantizedGemmParams get_gemm_params() const;
+
+protected:
+    Tensor<int8_t>* m_weight = nullptr;
+    Tensor<int32_t>* m_bias = nullptr;
+    QuantizationParams m_weight_quantization;
+    float m_input_scale = 1.0f;
+    int32_t m_input_zero_point = 0;
+    float m_output_scale = 1.0f;
+    int32_t m_output_zero_point = 0;
+    ACTIVATION m_fused_activation = ACTIVATION::UNKNOWN;
+    std::unique_ptr<Tensor<int32_t>> m_requant;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "Reshape.h"
+
+#include <numeric>
+
+Reshape::Reshape(const std::vector<size_t>& dims): Layer(), m_dims(dims)
+{
+}
+
+void Reshape::forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const
+{
+    if (m_platform != input->get_platform())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input and Layer are not on the same platform");
+    }
+
+    input->reshape(get_output_dims(input->get_dims()), result1);
+}
+
+void Reshape::to_device()
+{
+    m_platform = PLATFORM::DEVICE;
+}
+
+void Reshape::to_host()
+{
+    m_platform = PLATFORM::HOST;
+}
+
+bool Reshape::requires_scratch() const
+{
+    return false;
+}
+
+bool Reshape::is_view() const
+{
+    return true;
+}
+
+std::vector<size_t> Reshape::get_output_dims(const std::vector<size_t>& input_dims) const
+{
+    const auto sample_size = std::accumulate(m_dims.cbegin(), m_dims.cend(), size_t{1}, std::multiplies<size_t>());
+    const auto input_size = std::accumulate(input_dims.cbegin(), input_dims.cend(), size_t{1}, std::multiplies<size_t>());
+    if (input_dims.empty() || input_size != input_dims[0] * sample_size)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Reshape must keep the number of elements per sample");
+    }
+
+    std::vector<size_t> output_dims = {input_dims[0]};
+    output_dims.insert(output_dims.end(), m_dims.cbegin(), m_dims.cend());
+    return output_dims;
+}
+
+const std::vector<size_t>& Reshape::get_dims() const
+{
+    return m_dims;
+}
+
+std::string Reshape::get_name() const
+{
+    return "Reshape";
+}
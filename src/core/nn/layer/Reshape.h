@@ -0,0 +1,29 @@
+#ifndef RESHAPE_H
+#define RESHAPE_H
+
+#include "Layer.h"
+
+/*
+* @brief  gives every sample of the batch a new shape, {batch, ...} becomes {batch, dims...}
+* @note   zero-copy on both platforms: the output is a view of the input, only its dims differ
+*/
+class Reshape : public Layer
+{
+public:
+    // dims of one sample, without the batch dimension
+    Reshape(const std::vector<size_t>& dims);
+
+    virtual void forward(const Tensor<float>* input, Tensor<float>* result1, Tensor<float>* result2) const override;
+    virtual void to_device() override;
+    virtual void to_host() override;
+    virtual bool requires_scratch() const override;
+    virtual bool is_view() const override;
+    virtual std::vector<size_t> get_output_dims(const std::vector<size_t>& input_dims) const override;
+    virtual std::string get_name() const override;
+    virtual const std::vector<size_t>& get_dims() const;
+
+protected:
+    std::vector<size_t> m_dims;
+};
+
+#endif
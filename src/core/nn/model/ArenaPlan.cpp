@@ -0,0 +1,80 @@
+#include "ArenaPlan.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+size_t ArenaPlan::add_arena(size_t alignment)
+{
+    m_alignments.push_back(alignment);
+    return m_alignments.size() - 1u;
+}
+
+size_t ArenaPlan::add_value(size_t arena, const std::vector<size_t>& dims, size_t step)
+{
+    if (arena >= m_alignments.size())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Arena does not exist");
+    }
+    m_values.push_back({dims, arena, m_values.size(), step, step});
+    return m_values.size() - 1u;
+}
+
+size_t ArenaPlan::add_view(size_t source)
+{
+    const auto owner = m_values.at(source).owner;
+    m_values.push_back({{}, NO_ARENA, owner, 0u, 0u});
+    return m_values.size() - 1u;
+}
+
+size_t ArenaPlan::add_external()
+{
+    m_values.push_back({{}, NO_ARENA, m_values.size(), 0u, 0u});
+    return m_values.size() - 1u;
+}
+
+void ArenaPlan::add_use(size_t value, size_t step)
+{
+    auto& owner = m_values[m_values.at(value).owner];
+    owner.last_use = std::max(owner.last_use, step);
+}
+
+size_t ArenaPlan::plan(size_t arena)
+{
+    if (m_planners.empty())
+    {
+        for (const auto alignment : m_alignments)
+        {
+            m_planners.emplace_back(alignment);
+        }
+        m_blocks.assign(m_values.size(), 0u);
+        for (auto i = 0u; i < m_values.size(); ++i)
+        {
+            const auto& value = m_values[i];
+            if (has_block(i))
+            {
+                const auto size = std::accumulate(value.dims.cbegin(), value.dims.cend(), size_t{1}, std::multiplies<size_t>());
+                m_blocks[i] = m_planners[value.arena].add_block(size, value.first_use, value.last_use);
+            }
+        }
+    }
+    return m_planners.at(arena).plan();
+}
+
+void ArenaPlan::alias(size_t value, Tensor<float>* arena, Tensor<float>* window) const
+{
+    if (!has_block(value))
+    {
+        return;
+    }
+    const auto& planned = m_values[value];
+    window->alias(arena, m_planners.at(planned.arena).get_offset(m_blocks[value]), planned.dims);
+}
+
+bool ArenaPlan::has_block(size_t value) const
+{
+    const auto& planned = m_values.at(value);
+    return planned.arena != NO_ARENA && planned.owner == value;
+}
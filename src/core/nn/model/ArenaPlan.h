@@ -0,0 +1,57 @@
+#ifndef ARENA_PLAN_H
+#define ARENA_PLAN_H
+
+#include "MemoryPlanner.h"
+#include "../tensor/Tensor.h"
+
+#include <cstddef>
+#include <vector>
+
+/*
+* @brief  the activations of one execution laid out in arenas, shared by Model::plan and Graph::plan
+* @note   a value is written at one step and read at later ones. Values with storage of their own get
+*         a block of their arena that lives from the step writing them to the last step reading them or
+*         any of their views; a view (Flatten, Reshape) shares the storage of its source. External values,
+*         e.g. inputs and results the caller passes, are not planned, and neither are views of them
+*/
+class ArenaPlan
+{
+public:
+    static constexpr size_t NO_ARENA = static_cast<size_t>(-1);
+
+    virtual ~ArenaPlan() = default;
+
+    // returns the index of a new arena, offsets are multiples of alignment, in elements
+    virtual size_t add_arena(size_t alignment);
+    // each returns the id of the new value
+    virtual size_t add_value(size_t arena, const std::vector<size_t>& dims, size_t step);
+    virtual size_t add_view(size_t source);
+    virtual size_t add_external();
+    // step reads value, which keeps the storage it shares alive until then
+    virtual void add_use(size_t value, size_t step);
+
+    // assigns every block of arena an offset, returns its size in elements; values added after the first
+    // plan of any arena are not planned
+    virtual size_t plan(size_t arena);
+    // window becomes the block of value in arena, the tensor plan(arena) was sized for; views and
+    // external values have no block and leave window as it is
+    virtual void alias(size_t value, Tensor<float>* arena, Tensor<float>* window) const;
+    virtual bool has_block(size_t value) const;
+
+private:
+    struct Value
+    {
+        std::vector<size_t> dims;
+        size_t              arena;      // NO_ARENA for views and external values
+        size_t              owner;      // the value whose storage this one is, itself if it has a block
+        size_t              first_use;
+        size_t              last_use;
+    };
+
+    std::vector<size_t>        m_alignments;
+    std::vector<Value>         m_values;
+    std::vector<MemoryPlanner> m_planners;
+    std::vector<size_t>        m_blocks;    // per value, valid if it has a block and its arena is planned
+};
+
+#endif  // ARENA_PLAN_H
@@ -0,0 +1,259 @@
+#include "CostModel.h"
+#include "../tensor/TensorOpenCL.h"
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+// square dense layers timed by calibrate, the small one is all overhead
+#define CALIBRATION_SMALL_DIM 8
+#define CALIBRATION_LARGE_DIM 256
+// elements of the transfers timed by calibrate
+#define CALIBRATION_SMALL_TRANSFER 16
+#define CALIBRATION_LARGE_TRANSFER (1 << 20)
+
+static size_t get_num_elements(const std::vector<size_t>& dims)
+{
+    return std::accumulate(dims.cbegin(), dims.cend(), size_t{1}, std::multiplies<size_t>());
+}
+
+template<typename FUNC>
+static double get_fastest_us(FUNC&& func, size_t repetitions)
+{
+    // the first run tunes the kernels and draws the buffers
+    func();
+    auto fastest_us = std::numeric_limits<double>::max();
+    for (auto i = 0u; i < std::max<size_t>(repetitions, 1u); ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        fastest_us = std::min(fastest_us, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return fastest_us;
+}
+
+// a {dim, dim} input through a dense layer of {dim, dim} weights, tensors made like prototype on platform
+static double time_dense_us(const Tensor<float>* prototype, PLATFORM platform, size_t dim, size_t repetitions)
+{
+    std::unique_ptr<Tensor<float>> input(prototype->create_empty());
+    std::unique_ptr<Tensor<float>> weight(prototype->create_empty());
+    std::unique_ptr<Tensor<float>> bias(prototype->create_empty());
+    std::unique_ptr<Tensor<float>> result(prototype->create_empty());
+    input->set_host_data(std::vector<float>(dim * dim, 0.5f));
+    input->set_dims({dim, dim});
+    weight->set_host_data(std::vector<float>(dim * dim, 0.25f));
+    weight->set_dims({dim, dim});
+    bias->set_host_data(std::vector<float>(dim, 1.0f));
+    bias->set_dims({1, dim});
+    result->set_host_data(std::vector<float>(dim * dim));
+    result->set_dims({dim, dim});
+    if (platform == PLATFORM::DEVICE)
+    {
+        input->load_to_device();
+        weight->load_to_device();
+        bias->load_to_device();
+        result->load_to_device();
+    }
+
+    return get_fastest_us([&]()
+    {
+        input->dense(weight.get(), bias.get(), result.get(), false, false);
+        result->wait();
+    }, repetitions);
+}
+
+// one way, averaged over a write and a read the way Model copies activations between platforms
+static double time_transfer_us(const Tensor<float>* prototype, size_t size, size_t repetitions)
+{
+    Tensor<float> host;
+    host.set_host_data(std::vector<float>(size, 1.0f));
+    std::unique_ptr<Tensor<float>> device(prototype->create_empty());
+    device->allocate({size, 1u});
+
+    return get_fastest_us([&]()
+    {
+        device->copy_from_host(&host);
+        device->copy_to_host(&host);
+    }, repetitions) / 2.0;
+}
+
+// the large run gives the rate, the small one the fixed cost on top of it
+static void fit(double small_us, double large_us, double small_amount, double large_amount, double& fixed_us, double& rate_per_us)
+{
+    rate_per_us = (large_amount - small_amount) / std::max(large_us - small_us, 1e-3);
+    fixed_us = std::max(small_us - small_amount / rate_per_us, 0.0);
+}
+
+CostModel::CostModel()
+{
+}
+
+void CostModel::calibrate(const Tensor<float>* prototype, size_t repetitions)
+{
+    if (prototype && !dynamic_cast<const TensorOpenCL<float>*>(prototype))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Prototype is not a TensorOpenCL");
+    }
+
+    const double small_dim = CALIBRATION_SMALL_DIM;
+    const double large_dim = CALIBRATION_LARGE_DIM;
+    const auto small_operations = 2.0 * small_dim * small_dim * small_dim;
+    const auto large_operations = 2.0 * large_dim * large_dim * large_dim;
+
+    Tensor<float> host_prototype;
+    fit(time_dense_us(&host_prototype, PLATFORM::HOST, CALIBRATION_SMALL_DIM, repetitions),
+        time_dense_us(&host_prototype, PLATFORM::HOST, CALIBRATION_LARGE_DIM, repetitions),
+        small_operations, large_operations, m_overhead_us[0], m_operations_per_us[0]);
+    if (!prototype)
+    {
+        return;
+    }
+
+    fit(time_dense_us(prototype, PLATFORM::DEVICE, CALIBRATION_SMALL_DIM, repetitions),
+        time_dense_us(prototype, PLATFORM::DEVICE, CALIBRATION_LARGE_DIM, repetitions),
+        small_operations, large_operations, m_overhead_us[1], m_operations_per_us[1]);
+    fit(time_transfer_us(prototype, CALIBRATION_SMALL_TRANSFER, repetitions),
+        time_transfer_us(prototype, CALIBRATION_LARGE_TRANSFER, repetitions),
+        CALIBRATION_SMALL_TRANSFER * sizeof(float), CALIBRATION_LARGE_TRANSFER * sizeof(float),
+        m_transfer_latency_us, m_transfer_bytes_per_us);
+}
+
+void CostModel::set_layer_costs(PLATFORM platform, double overhead_us, double operations_per_us)
+{
+    if (overhead_us < 0.0 || operations_per_us <= 0.0)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Layer costs must be a non-negative overhead and a positive throughput");
+    }
+    m_overhead_us[get_index(platform)] = overhead_us;
+    m_operations_per_us[get_index(platform)] = operations_per_us;
+}
+
+void CostModel::set_transfer_costs(double latency_us, double bytes_per_us)
+{
+    if (latency_us < 0.0 || bytes_per_us <= 0.0)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Transfer costs must be a non-negative latency and a positive bandwidth");
+    }
+    m_transfer_latency_us = latency_us;
+    m_transfer_bytes_per_us = bytes_per_us;
+}
+
+double CostModel::get_overhead_us(PLATFORM platform) const
+{
+    return m_overhead_us[get_index(platform)];
+}
+
+double CostModel::get_operations_per_us(PLATFORM platform) const
+{
+    return m_operations_per_us[get_index(platform)];
+}
+
+double CostModel::get_transfer_latency_us() const
+{
+    return m_transfer_latency_us;
+}
+
+double CostModel::get_transfer_bytes_per_us() const
+{
+    return m_transfer_bytes_per_us;
+}
+
+double CostModel::get_layer_us(const Layer* layer, PLATFORM platform, const std::vector<size_t>& input_dims) const
+{
+    if (layer->is_view())
+    {
+        return 0.0;
+    }
+    const auto index = get_index(platform);
+    return m_overhead_us[index] + layer->get_num_operations(input_dims) / m_operations_per_us[index];
+}
+
+double CostModel::get_transfer_us(size_t bytes) const
+{
+    return m_transfer_latency_us + bytes / m_transfer_bytes_per_us;
+}
+
+std::vector<PLATFORM> CostModel::place(const std::vector<Layer*>& layers, const std::vector<size_t>& input_dims,
+                                       PLATFORM input_platform, PLATFORM result_platform,
+                                       const std::vector<PLATFORM>& pinned) const
+{
+    const auto num_layers = layers.size();
+    if (pinned.size() != num_layers)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Every layer needs an entry in pinned");
+    }
+    if (num_layers == 0u)
+    {
+        return {};
+    }
+
+    const PLATFORM platforms[2] = {PLATFORM::HOST, PLATFORM::DEVICE};
+    const auto infinity = std::numeric_limits<double>::infinity();
+    // costs[i][p]: the least time until layer i has run on platform p, previous[i][p]: where layer i - 1 ran then
+    std::vector<std::array<double, 2>> costs(num_layers);
+    std::vector<std::array<size_t, 2>> previous(num_layers);
+    auto dims = input_dims;
+    for (auto i = 0u; i < num_layers; ++i)
+    {
+        const auto transfer_us = get_transfer_us(get_num_elements(dims) * sizeof(float));
+        for (auto p = 0u; p < 2u; ++p)
+        {
+            costs[i][p] = infinity;
+            previous[i][p] = p;
+            if (pinned[i] != PLATFORM::UNKNOWN && get_index(pinned[i]) != p)
+            {
+                continue;
+            }
+
+            const auto layer_us = get_layer_us(layers[i], platforms[p], dims);
+            if (i == 0u)
+            {
+                costs[i][p] = layer_us + (get_index(input_platform) == p ? 0.0 : transfer_us);
+                continue;
+            }
+            for (auto q = 0u; q < 2u; ++q)
+            {
+                const auto cost = costs[i - 1][q] + (q == p ? 0.0 : transfer_us) + layer_us;
+                if (cost < costs[i][p])
+                {
+                    costs[i][p] = cost;
+                    previous[i][p] = q;
+                }
+            }
+        }
+        dims = layers[i]->get_output_dims(dims);
+    }
+
+    const auto result_transfer_us = get_transfer_us(get_num_elements(dims) * sizeof(float));
+    size_t last = 0u;
+    auto least_us = infinity;
+    for (auto p = 0u; p < 2u; ++p)
+    {
+        const auto copy_us = result_platform == PLATFORM::UNKNOWN || get_index(result_platform) == p ? 0.0 : result_transfer_us;
+        if (costs[num_layers - 1][p] + copy_us < least_us)
+        {
+            least_us = costs[num_layers - 1][p] + copy_us;
+            last = p;
+        }
+    }
+
+    std::vector<PLATFORM> placement(num_layers);
+    for (auto i = num_layers; i-- > 0u;)
+    {
+        placement[i] = platforms[last];
+        last = previous[i][last];
+    }
+    return placement;
+}
+
+size_t CostModel::get_index(PLATFORM platform)
+{
+    return platform == PLATFORM::DEVICE ? 1u : 0u;
+}
@@ -0,0 +1,57 @@
+#ifndef COST_MODEL_H
+#define COST_MODEL_H
+
+#include "../layer/Layer.h"
+
+#include <vector>
+
+/*
+* @brief  estimated time of layers on the host and on the device and of the transfers between them
+* @note   a layer costs a fixed overhead plus its operations (Layer::get_num_operations) at the platform's
+*         throughput, views cost nothing; a transfer costs a fixed latency plus its bytes at the transfer
+*         bandwidth. The defaults are rough figures of a discrete GPU, calibrate measures them instead
+*/
+class CostModel
+{
+public:
+    CostModel();
+    virtual ~CostModel() = default;
+
+    // times a small and a large dense layer on the host and, given a TensorOpenCL prototype, on its device,
+    // and transfers of a small and a large tensor to and from that device. Each takes the fastest of
+    // repetitions runs, after a first one that tunes and allocates
+    virtual void calibrate(const Tensor<float>* prototype, size_t repetitions = 5u);
+    virtual void set_layer_costs(PLATFORM platform, double overhead_us, double operations_per_us);
+    virtual void set_transfer_costs(double latency_us, double bytes_per_us);
+    virtual double get_overhead_us(PLATFORM platform) const;
+    virtual double get_operations_per_us(PLATFORM platform) const;
+    virtual double get_transfer_latency_us() const;
+    virtual double get_transfer_bytes_per_us() const;
+
+    virtual double get_layer_us(const Layer* layer, PLATFORM platform, const std::vector<size_t>& input_dims) const;
+    // one way, either direction
+    virtual double get_transfer_us(size_t bytes) const;
+
+    /*
+    * @brief  the platform of every layer of a chain for which a run takes the least estimated time
+    * @note   the input starts on input_platform and the result is copied to result_platform, PLATFORM::UNKNOWN
+    *         if the result may stay where the last layer writes it. Layers whose entry in pinned is not
+    *         PLATFORM::UNKNOWN stay there. Dynamic programming over the layers, so the transfers of
+    *         every platform change are weighed against the time they save
+    */
+    virtual std::vector<PLATFORM> place(const std::vector<Layer*>& layers, const std::vector<size_t>& input_dims,
+                                        PLATFORM input_platform, PLATFORM result_platform,
+                                        const std::vector<PLATFORM>& pinned) const;
+
+protected:
+    // index into the per-platform costs: 0 is the host, 1 the device
+    static size_t get_index(PLATFORM platform);
+
+protected:
+    double m_overhead_us[2] = {1.0, 20.0};
+    double m_operations_per_us[2] = {2000.0, 100000.0};
+    double m_transfer_latency_us = 20.0;
+    double m_transfer_bytes_per_us = 4000.0;
+};
+
+#endif  // COST_MODEL_H
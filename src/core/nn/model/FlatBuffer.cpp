@@ -0,0 +1,118 @@
+#include "FlatBuffer.h"
+
+FlatBufferTable::FlatBufferTable()
+{
+}
+
+FlatBufferTable::FlatBufferTable(const uint8_t* buffer, size_t buffer_size, size_t table_offset):
+    m_buffer(buffer), m_buffer_size(buffer_size), m_table(table_offset)
+{
+    // the table starts with a signed offset back to its vtable
+    const auto vtable = static_cast<int64_t>(m_table) - read<int32_t>(m_table);
+    if (vtable < 0)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Malformed flatbuffer: vtable is out of range");
+    }
+    m_vtable = static_cast<size_t>(vtable);
+    m_vtable_size = read<uint16_t>(m_vtable);
+}
+
+FlatBufferTable FlatBufferTable::root(const uint8_t* buffer, size_t buffer_size)
+{
+    auto table = FlatBufferTable();
+    table.m_buffer = buffer;
+    table.m_buffer_size = buffer_size;
+    return FlatBufferTable(buffer, buffer_size, table.read<uint32_t>(0u));
+}
+
+bool FlatBufferTable::is_valid() const
+{
+    return m_buffer != nullptr;
+}
+
+bool FlatBufferTable::has_field(size_t field) const
+{
+    return field_offset(field) != 0u;
+}
+
+FlatBufferTable FlatBufferTable::get_table(size_t field) const
+{
+    const auto offset = field_offset(field);
+    if (offset == 0u)
+    {
+        return FlatBufferTable();
+    }
+    return FlatBufferTable(m_buffer, m_buffer_size, indirect(offset));
+}
+
+std::string FlatBufferTable::get_string(size_t field) const
+{
+    size_t length = 0u;
+    const auto start = vector_start(field, 1u, length);
+    return length == 0u ? std::string() : std::string(reinterpret_cast<const char*>(m_buffer + start), length);
+}
+
+std::vector<FlatBufferTable> FlatBufferTable::get_table_vector(size_t field) const
+{
+    size_t length = 0u;
+    const auto start = vector_start(field, sizeof(uint32_t), length);
+    std::vector<FlatBufferTable> tables;
+    tables.reserve(length);
+    for (auto i = 0u; i < length; ++i)
+    {
+        tables.emplace_back(m_buffer, m_buffer_size, indirect(start + i * sizeof(uint32_t)));
+    }
+    return tables;
+}
+
+const uint8_t* FlatBufferTable::get_byte_vector(size_t field, size_t& length) const
+{
+    const auto start = vector_start(field, 1u, length);
+    return length == 0u ? nullptr : m_buffer + start;
+}
+
+size_t FlatBufferTable::field_offset(size_t field) const
+{
+    if (!is_valid())
+    {
+        return 0u;
+    }
+    // vtable layout: vtable size, table size, then one uint16 offset per field
+    const auto entry = 4u + 2u * field;
+    if (entry + sizeof(uint16_t) > m_vtable_size)
+    {
+        return 0u;
+    }
+    const auto offset = read<uint16_t>(m_vtable + entry);
+    return offset == 0u ? 0u : m_table + offset;
+}
+
+size_t FlatBufferTable::indirect(size_t offset) const
+{
+    return offset + read<uint32_t>(offset);
+}
+
+size_t FlatBufferTable::vector_start(size_t field, size_t element_size, size_t& length) const
+{
+    length = 0u;
+    const auto offset = field_offset(field);
+    if (offset == 0u)
+    {
+        return 0u;
+    }
+    // vectors are a uint32 length followed by the elements
+    const auto vector = indirect(offset);
+    length = read<uint32_t>(vector);
+    check_range(vector + sizeof(uint32_t), length * element_size);
+    return vector + sizeof(uint32_t);
+}
+
+void FlatBufferTable::check_range(size_t offset, size_t size) const
+{
+    if (offset > m_buffer_size || size > m_buffer_size - offset)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Malformed flatbuffer: offset is out of range");
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef FLAT_BUFFER_H
+#define FLAT_BUFFER_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+* @brief  minimal, bounds-checked reader for a table inside a flatbuffer
+* @note   only what the TFLite schema needs: scalars, strings, scalar vectors and table vectors.
+*         Nothing is copied except small scalar vectors (shapes, tensor indices); byte vectors
+*         are returned as pointers into the underlying buffer.
+*/
+class FlatBufferTable
+{
+public:
+    FlatBufferTable();
+    FlatBufferTable(const uint8_t* buffer, size_t buffer_size, size_t table_offset);
+
+    // the table at the root offset of the buffer
+    static FlatBufferTable root(const uint8_t* buffer, size_t buffer_size);
+
+    bool is_valid() const;
+    bool has_field(size_t field) const;
+
+    template<typename T>
+    T get_scalar(size_t field, T default_value) const
+    {
+        const auto offset = field_offset(field);
+        return offset == 0 ? default_value : read<T>(offset);
+    }
+
+    FlatBufferTable get_table(size_t field) const;
+    std::string get_string(size_t field) const;
+    std::vector<FlatBufferTable> get_table_vector(size_t field) const;
+    // pointer to the first byte of a [ubyte] vector and its length, without copying
+    const uint8_t* get_byte_vector(size_t field, size_t& length) const;
+
+    template<typename T>
+    std::vector<T> get_scalar_vector(size_t field) const
+    {
+        size_t length = 0u;
+        const auto start = vector_start(field, sizeof(T), length);
+        std::vector<T> values(length);
+        for (auto i = 0u; i < length; ++i)
+        {
+            values[i] = read<T>(start + i * sizeof(T));
+        }
+        return values;
+    }
+
+private:
+    size_t field_offset(size_t field) const;
+    size_t indirect(size_t offset) const;
+    size_t vector_start(size_t field, size_t element_size, size_t& length) const;
+    void check_range(size_t offset, size_t size) const;
+
+    template<typename T>
+    T read(size_t offset) const
+    {
+        check_range(offset, sizeof(T));
+        T value;
+        std::memcpy(&value, m_buffer + offset, sizeof(T));
+        return value;
+    }
+
+private:
+    const uint8_t* m_buffer = nullptr;
+    size_t         m_buffer_size = 0u;
+    size_t         m_table = 0u;      // absolute offset of the table
+    size_t         m_vtable = 0u;     // absolute offset of its vtable
+    uint16_t       m_vtable_size = 0u;
+};
+
+#endif  // FLAT_BUFFER_H
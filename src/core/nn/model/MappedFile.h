@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdint>
+#include <string>
+
+/*
+* @brief  read-only file contents mapped into memory
+* @note   pages are mapped copy-on-write, so pointers into the mapping can be handed to
+*         tensors as mutable host data without ever modifying the file on disk.
+*         Pages are faulted in lazily, startup cost does not grow with the file size.
+*/
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& file_path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    virtual ~MappedFile();
+
+    virtual uint8_t* data() const;
+    virtual size_t size() const;
+
+private:
+    uint8_t* m_data = nullptr;
+    size_t   m_size = 0u;
+#ifdef _WIN32
+    void*    m_file = nullptr;
+    void*    m_mapping = nullptr;
+#endif
+};
+
+#endif  // MAPPED_FILE_H
@@ -0,0 +1,82 @@
+#include "MemoryPlanner.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+MemoryPlanner::MemoryPlanner(size_t alignment): m_alignment(std::max<size_t>(alignment, 1u))
+{
+}
+
+size_t MemoryPlanner::add_block(size_t size, size_t first_use, size_t last_use)
+{
+    if (last_use < first_use)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("A block cannot be released before it is first used");
+    }
+    m_blocks.push_back({size, first_use, last_use, 0u});
+    return m_blocks.size() - 1u;
+}
+
+size_t MemoryPlanner::plan()
+{
+    std::vector<size_t> order(m_blocks.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) { return m_blocks[lhs].size > m_blocks[rhs].size; });
+
+    std::vector<size_t> placed;  // ids of blocks that already have an offset, sorted by offset
+    m_arena_size = 0u;
+    for (auto id : order)
+    {
+        auto& block = m_blocks[id];
+
+        // walk the gaps between the placed blocks that are alive at the same time as this one
+        size_t best_offset = std::numeric_limits<size_t>::max();
+        size_t best_gap    = std::numeric_limits<size_t>::max();
+        size_t gap_start   = 0u;
+        for (auto other_id : placed)
+        {
+            const auto& other = m_blocks[other_id];
+            if (other.last_use < block.first_use || block.last_use < other.first_use)
+            {
+                continue;
+            }
+            if (other.offset >= gap_start + block.size && other.offset - gap_start < best_gap)
+            {
+                best_offset = gap_start;
+                best_gap    = other.offset - gap_start;
+            }
+            gap_start = std::max(gap_start, align_up(other.offset + other.size));
+        }
+        block.offset = best_offset != std::numeric_limits<size_t>::max() ? best_offset : gap_start;
+        m_arena_size = std::max(m_arena_size, block.offset + block.size);
+
+        const auto position = std::upper_bound(placed.begin(), placed.end(), block.offset,
+                                               [this](size_t offset, size_t other_id) { return offset < m_blocks[other_id].offset; });
+        placed.insert(position, id);
+    }
+    return m_arena_size;
+}
+
+size_t MemoryPlanner::get_offset(size_t block_id) const
+{
+    return m_blocks.at(block_id).offset;
+}
+
+size_t MemoryPlanner::get_arena_size() const
+{
+    return m_arena_size;
+}
+
+size_t MemoryPlanner::get_num_blocks() const
+{
+    return m_blocks.size();
+}
+
+size_t MemoryPlanner::align_up(size_t value) const
+{
+    return (value + m_alignment - 1u) / m_alignment * m_alignment;
+}
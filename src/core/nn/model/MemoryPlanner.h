@@ -0,0 +1,45 @@
+#ifndef MEMORY_PLANNER_H
+#define MEMORY_PLANNER_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+* @brief  static arena planner: every buffer has a size and a lifetime in execution steps,
+*         buffers whose lifetimes overlap get disjoint ranges of one arena
+* @note   greedy by size: the largest buffers are placed first, each into the smallest gap
+*         between the live buffers it overlaps with, or after the last of them
+*/
+class MemoryPlanner
+{
+public:
+    struct Block
+    {
+        size_t size;        // number of elements
+        size_t first_use;   // first step that writes or reads the buffer
+        size_t last_use;    // last step that reads it, inclusive
+        size_t offset;      // assigned by plan()
+    };
+
+    // offsets are multiples of alignment, in elements
+    explicit MemoryPlanner(size_t alignment = 1u);
+
+    // returns the id of the new block
+    virtual size_t add_block(size_t size, size_t first_use, size_t last_use);
+    // assigns every block an offset and returns the arena size, in elements
+    virtual size_t plan();
+
+    virtual size_t get_offset(size_t block_id) const;
+    virtual size_t get_arena_size() const;
+    virtual size_t get_num_blocks() const;
+
+private:
+    size_t align_up(size_t value) const;
+
+private:
+    size_t             m_alignment;
+    std::vector<Block> m_blocks;
+    size_t             m_arena_size = 0u;
+};
+
+#endif  // MEMORY_PLANNER_H
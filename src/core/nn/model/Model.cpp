@@ -1,77 +1,517 @@
-#include "Model.h"
-
-Model::Model(): m_layers()
-{
-}
-
-void Model::add_layer(Layer* p_layer)
-{
-    m_layers.emplace_back(p_layer);
-}
-
-void Model::to_host()
-{
-    m_platform = PLATFORM::HOST;
-    for (auto layer : m_layers)
-    {
-        layer->to_host();
-    }
-}
-
-void Model::to_device()
-{
-    m_platform = PLATFORM::DEVICE;
-    for (auto layer : m_layers)
-    {
-        layer->to_device();
-    }
-}
-
-void Model::execute(const Tensor<float>* input, Tensor<float>* result1)
-{
-    if (m_platform == PLATFORM::UNKNOWN)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Model is not loaded to a platform");
-    }
-    const auto num_layers = m_layers.size();
-    if (num_layers == 0)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Model does not have any layers");
-    }
-
-    auto result2 = result1->clone();
-    auto result3 = result1->clone();
-    
-    m_layers[0]->forward(input, result1, result2);
-
-    for (auto i = 1u; i < m_layers.size(); ++i)
-    {
-        // always the second argument would contain the result
-        if (i % 3 == 1)
-        {
-            m_layers[i]->forward(result1, result2, result3);
-        }
-        else if (i % 3 == 2)
-        {
-            m_layers[i]->forward(result2, result3, result1);
-        }
-        else
-        {
-            m_layers[i]->forward(result3, result1, result2);
-        }
-    }
-
-    if (m_layers.size() % 3 == 2)
-    {
-        result1->swap(result2);
-    }
-    else if (m_layers.size() % 3 == 0)
-    {
-        result1->swap(result3);
-    }
-
-    delete result2;
-    delete result3;
+#include "Model.h"
+#include "../layer/Activation.h"
+#include "ArenaPlan.h"
+#include "../profiling/Profiler.h"
+#include "../tensor/TensorOpenCL.h"
+
+#include <algorithm>
+
+// index into Model::m_arenas
+static size_t get_arena_index(PLATFORM platform)
+{
+    return platform == PLATFORM::DEVICE ? 1u : 0u;
+}
+
+// source and destination are on different platforms, one of them the host
+static void copy_across(const Tensor<float>* source, Tensor<float>* destination)
+{
+    if (destination->get_platform() == PLATFORM::HOST)
+    {
+        source->copy_to_host(destination);
+    }
+    else
+    {
+        destination->copy_from_host(source);
+    }
+}
+
+Model::Model(): m_layers()
+{
+}
+
+void Model::add_layer(Layer* p_layer)
+{
+    m_layers.emplace_back(p_layer);
+    m_planned_platform = PLATFORM::UNKNOWN;
+}
+
+void Model::keep_alive(std::shared_ptr<void> resource)
+{
+    m_resources.emplace_back(std::move(resource));
+}
+
+size_t Model::fuse_layers()
+{
+    std::vector<Layer*> fused_layers;
+    fused_layers.reserve(m_layers.size());
+    for (auto i = 0u; i < m_layers.size(); ++i)
+    {
+        auto layer = m_layers[i];
+        fused_layers.emplace_back(layer);
+
+        if (i + 1 == m_layers.size())
+        {
+            continue;
+        }
+        auto activation = dynamic_cast<Activation*>(m_layers[i + 1]);
+        if (activation && layer->fuse_activation(activation->get_activation()))
+        {
+            // the activation layer is dropped from the list, its owner still frees it
+            ++i;
+        }
+    }
+
+    const auto num_removed = m_layers.size() - fused_layers.size();
+    m_layers.swap(fused_layers);
+    if (num_removed > 0u)
+    {
+        m_planned_platform = PLATFORM::UNKNOWN;
+    }
+    return num_removed;
+}
+
+size_t Model::get_num_layers() const
+{
+    return m_layers.size();
+}
+
+void Model::to_host()
+{
+    fuse_layers();
+    m_cost_model.reset();
+    m_platform = PLATFORM::HOST;
+    m_planned_platform = PLATFORM::UNKNOWN;
+    for (auto layer : m_layers)
+    {
+        layer->to_host();
+    }
+}
+
+void Model::to_device()
+{
+    fuse_layers();
+    m_cost_model.reset();
+    m_platform = PLATFORM::DEVICE;
+    m_planned_platform = PLATFORM::UNKNOWN;
+    for (auto layer : m_layers)
+    {
+        layer->to_device();
+    }
+}
+
+void Model::to_heterogeneous(std::shared_ptr<const CostModel> cost_model)
+{
+    if (!cost_model)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Cost model is null");
+    }
+
+    // the layers are loaded by plan, once the input shape is known
+    fuse_layers();
+    m_cost_model = std::move(cost_model);
+    m_platform = PLATFORM::DEVICE;
+    m_planned_platform = PLATFORM::UNKNOWN;
+}
+
+void Model::set_layer_platform(const Layer* layer, PLATFORM platform)
+{
+    if (platform == PLATFORM::UNKNOWN)
+    {
+        m_pinned_platforms.erase(layer);
+    }
+    else
+    {
+        m_pinned_platforms[layer] = platform;
+    }
+    m_planned_platform = PLATFORM::UNKNOWN;
+}
+
+const std::vector<PLATFORM>& Model::get_layer_platforms() const
+{
+    return m_layer_platforms;
+}
+
+bool Model::is_heterogeneous() const
+{
+    return m_cost_model || !m_pinned_platforms.empty();
+}
+
+void Model::place_layers(const Tensor<float>* input, PLATFORM result_platform)
+{
+    const auto num_layers = m_layers.size();
+    std::vector<PLATFORM> pinned(num_layers, PLATFORM::UNKNOWN);
+    for (auto i = 0u; i < num_layers; ++i)
+    {
+        const auto pin = m_pinned_platforms.find(m_layers[i]);
+        if (pin != m_pinned_platforms.end())
+        {
+            pinned[i] = pin->second;
+        }
+    }
+
+    if (m_cost_model)
+    {
+        m_layer_platforms = m_cost_model->place(m_layers, input->get_dims(), input->get_platform(), result_platform, pinned);
+    }
+    else
+    {
+        m_layer_platforms = pinned;
+        std::replace(m_layer_platforms.begin(), m_layer_platforms.end(), PLATFORM::UNKNOWN, m_platform);
+    }
+
+    const auto on_device = std::find(m_layer_platforms.cbegin(), m_layer_platforms.cend(), PLATFORM::DEVICE) != m_layer_platforms.cend();
+    if (is_heterogeneous() && on_device && !dynamic_cast<const TensorOpenCL<float>*>(input))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Layers placed on the device need a TensorOpenCL input");
+    }
+
+    for (auto i = 0u; i < num_layers; ++i)
+    {
+        if (m_layers[i]->get_platform() == m_layer_platforms[i])
+        {
+            continue;
+        }
+        if (m_layer_platforms[i] == PLATFORM::DEVICE)
+        {
+            m_layers[i]->to_device();
+        }
+        else
+        {
+            m_layers[i]->to_host();
+        }
+    }
+}
+
+PLATFORM Model::get_platform() const
+{
+    return m_platform;
+}
+
+Model* Model::clone() const
+{
+    auto model = new Model();
+    model->m_layers = m_layers;
+    model->m_resources = m_resources;
+    model->m_platform = m_platform;
+    model->m_cost_model = m_cost_model;
+    model->m_pinned_platforms = m_pinned_platforms;
+    model->m_replay_enabled = m_replay_enabled;
+    return model;
+}
+
+Graph* Model::to_graph() const
+{
+    auto graph = new Graph();
+    graph->add_input("input");
+    for (auto i = 0u; i < m_layers.size(); ++i)
+    {
+        const auto input = i == 0 ? std::string("input") : std::to_string(i - 1);
+        const auto output = i + 1 == m_layers.size() ? std::string("output") : std::to_string(i);
+        graph->add_node(std::to_string(i) + ":" + m_layers[i]->get_name(), m_layers[i], input, output);
+    }
+    graph->add_output("output");
+    for (const auto& resource : m_resources)
+    {
+        graph->keep_alive(resource);
+    }
+    return graph;
+}
+
+void Model::execute(const Tensor<float>* input, Tensor<float>* result1)
+{
+    if (m_platform == PLATFORM::UNKNOWN)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Model is not loaded to a platform");
+    }
+    const auto num_layers = m_layers.size();
+    if (num_layers == 0)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Model does not have any layers");
+    }
+
+    // only a heterogeneous model places its last layer by the result
+    const auto result_platform = is_heterogeneous() ? result1->get_platform() : PLATFORM::UNKNOWN;
+    if (m_planned_platform != m_platform || input->get_dims() != m_planned_dims ||
+        input->get_platform() != m_planned_input_platform || result_platform != m_planned_result_platform)
+    {
+        plan(input, result_platform);
+    }
+
+    if (!m_replay_enabled || m_platform != PLATFORM::DEVICE || Profiler::is_enabled())
+    {
+        run_layers(input, result1);
+        return;
+    }
+
+    const auto device_input = dynamic_cast<const TensorOpenCL<float>*>(input);
+    const auto device_result = dynamic_cast<TensorOpenCL<float>*>(result1);
+    if (m_execution_plan)
+    {
+        if (m_execution_plan->is_replayable() && device_input && device_result)
+        {
+            m_execution_plan->replay(device_input, device_result);
+            return;
+        }
+        run_layers(input, result1);
+        return;
+    }
+
+    m_execution_plan.reset(new ExecutionPlan());
+    const auto previous = ExecutionPlan::set_recording(m_execution_plan.get());
+    try
+    {
+        run_layers(input, result1);
+    }
+    catch (...)
+    {
+        ExecutionPlan::set_recording(previous);
+        m_execution_plan.reset();
+        throw;
+    }
+    ExecutionPlan::set_recording(previous);
+    if (m_layers.back()->is_view())
+    {
+        // result1 is a view the layers set up, a replay would not
+        m_execution_plan->record_unsupported("a view as the last layer");
+    }
+    m_execution_plan->finish(device_input, device_result);
+}
+
+void Model::run_layers(const Tensor<float>* input, Tensor<float>* result1)
+{
+    const auto num_layers = m_layers.size();
+    const auto profiling = Profiler::is_enabled();
+    if (profiling)
+    {
+        Profiler::instance().begin_run();
+    }
+
+    // intermediates live in the arenas, only the last layer writes to result1 unless the result is
+    // on another platform. Copies between the platforms are profiled as transfers
+    const Tensor<float>* layer_input = input;
+    for (auto i = 0u; i < num_layers; ++i)
+    {
+        if (m_transfers[i])
+        {
+            copy_across(layer_input, m_transfers[i].get());
+            layer_input = m_transfers[i].get();
+        }
+
+        auto layer_output = m_activations[i] ? m_activations[i].get() : result1;
+        if (profiling)
+        {
+            // on the device the host time is the enqueue cost, the kernels are profiled by their events
+            auto& profiler = Profiler::instance();
+            const auto start_us = profiler.now_us();
+            m_layers[i]->forward(layer_input, layer_output, m_scratch[i].get());
+            profiler.record_layer(std::to_string(i) + ":" + m_layers[i]->get_name(), start_us, profiler.now_us());
+        }
+        else
+        {
+            m_layers[i]->forward(layer_input, layer_output, m_scratch[i].get());
+        }
+        layer_input = layer_output;
+    }
+    if (layer_input != result1)
+    {
+        copy_across(layer_input, result1);
+    }
+}
+
+void Model::execute_pipelined(const std::vector<Tensor<float>*>& inputs, const std::vector<Tensor<float>*>& results)
+{
+    if (inputs.size() != results.size())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Every input needs a result");
+    }
+
+    // host ops are synchronous, there is nothing to overlap
+    if (m_platform != PLATFORM::DEVICE)
+    {
+        for (auto i = 0u; i < inputs.size(); ++i)
+        {
+            execute(inputs[i], results[i]);
+        }
+        return;
+    }
+
+    const auto num_requests = inputs.size();
+    if (num_requests > 0u)
+    {
+        inputs[0]->load_to_device_async();
+    }
+    for (auto i = 0u; i < num_requests; ++i)
+    {
+        // the commands are chained through events, so nothing here blocks on the device
+        execute(inputs[i], results[i]);
+        results[i]->load_to_host_async();
+
+        if (i + 1u < num_requests)
+        {
+            // keep at most two requests in flight
+            if (i >= 1u)
+            {
+                results[i - 1u]->wait();
+            }
+            inputs[i + 1u]->load_to_device_async();
+        }
+    }
+
+    for (auto result : results)
+    {
+        result->wait();
+    }
+}
+
+void Model::plan(const Tensor<float>* input, PLATFORM result_platform)
+{
+    // the recording binds the windows of the old arena
+    m_execution_plan.reset();
+    const auto num_layers = m_layers.size();
+    place_layers(input, result_platform);
+
+    // a layer on another platform than its input reads a copy, the last one writes a window if the
+    // result is elsewhere
+    std::vector<bool> transfers(num_layers);
+    auto input_platform = input->get_platform();
+    for (auto i = 0u; i < num_layers; ++i)
+    {
+        transfers[i] = m_layer_platforms[i] != input_platform;
+        input_platform = m_layer_platforms[i];
+    }
+    const auto copy_result = result_platform != PLATFORM::UNKNOWN && result_platform != m_layer_platforms.back();
+
+    // windows on the host can't be sub-buffers, so next to OpenCL tensors they are plain tensors
+    const auto opencl_input = dynamic_cast<const TensorOpenCL<float>*>(input) != nullptr;
+    auto create_tensor = [&](PLATFORM platform) -> Tensor<float>*
+    {
+        return platform == PLATFORM::HOST && opencl_input ? new Tensor<float>() : input->create_empty();
+    };
+
+    // step i runs layer i and the copy of its input: its input is read at step i, its output is written
+    // at step i and read at step i + 1. Every platform has an arena of its own, indexed like m_arenas
+    ArenaPlan arena_plan;
+    for (const auto platform : {PLATFORM::HOST, PLATFORM::DEVICE})
+    {
+        std::unique_ptr<Tensor<float>> prototype(create_tensor(platform));
+        arena_plan.add_arena(prototype->get_alignment());
+    }
+    std::vector<std::vector<size_t>> input_dims(num_layers);
+    std::vector<std::vector<size_t>> output_dims(num_layers);
+    std::vector<std::vector<size_t>> scratch_dims(num_layers);
+    std::vector<size_t> output_values(num_layers);
+    std::vector<size_t> transfer_values(num_layers);
+    std::vector<size_t> scratch_values(num_layers);
+    // the model input and the result are the caller's, the output of a view layer is the storage of its input
+    auto value = arena_plan.add_external();
+    auto layer_input_dims = input->get_dims();
+    for (auto i = 0u; i < num_layers; ++i)
+    {
+        const auto arena = get_arena_index(m_layer_platforms[i]);
+        input_dims[i] = layer_input_dims;
+        output_dims[i] = m_layers[i]->get_output_dims(layer_input_dims);
+        if (transfers[i])
+        {
+            arena_plan.add_use(value, i);
+            value = transfer_values[i] = arena_plan.add_value(arena, input_dims[i], i);
+        }
+        arena_plan.add_use(value, i);
+        if (m_layers[i]->is_view())
+        {
+            value = arena_plan.add_view(value);
+        }
+        else if (i + 1 < num_layers || copy_result)
+        {
+            value = arena_plan.add_value(arena, output_dims[i], i);
+        }
+        else
+        {
+            value = arena_plan.add_external();
+        }
+        output_values[i] = value;
+        if (m_layers[i]->requires_scratch())
+        {
+            scratch_dims[i] = m_layers[i]->get_scratch_dims(input_dims[i]);
+            scratch_values[i] = arena_plan.add_value(arena, scratch_dims[i], i);
+        }
+        layer_input_dims = output_dims[i];
+    }
+
+    // release the old windows before the arenas they point into
+    m_activations.clear();
+    m_transfers.clear();
+    m_scratch.clear();
+    m_peak_activation_bytes = 0u;
+    for (const auto platform : {PLATFORM::HOST, PLATFORM::DEVICE})
+    {
+        const auto index = get_arena_index(platform);
+        m_arenas[index].reset();
+        if (std::find(m_layer_platforms.cbegin(), m_layer_platforms.cend(), platform) == m_layer_platforms.cend())
+        {
+            continue;
+        }
+        const auto arena_size = arena_plan.plan(index);
+        m_arenas[index].reset(create_tensor(platform));
+        m_arenas[index]->allocate({std::max<size_t>(arena_size, 1u)});
+        m_peak_activation_bytes += arena_size * sizeof(float);
+    }
+
+    m_activations.resize(num_layers);
+    m_transfers.resize(num_layers);
+    m_scratch.resize(num_layers);
+    for (auto i = 0u; i < num_layers; ++i)
+    {
+        const auto platform = m_layer_platforms[i];
+        const auto arena = m_arenas[get_arena_index(platform)].get();
+        if (transfers[i])
+        {
+            m_transfers[i].reset(create_tensor(platform));
+            arena_plan.alias(transfer_values[i], arena, m_transfers[i].get());
+        }
+        if (i + 1 < num_layers || copy_result)
+        {
+            // views get their storage from forward
+            m_activations[i].reset(create_tensor(platform));
+            arena_plan.alias(output_values[i], arena, m_activations[i].get());
+        }
+        if (m_layers[i]->requires_scratch())
+        {
+            m_scratch[i].reset(create_tensor(platform));
+            arena_plan.alias(scratch_values[i], arena, m_scratch[i].get());
+        }
+    }
+
+    m_planned_dims = input->get_dims();
+    m_planned_platform = m_platform;
+    m_planned_input_platform = input->get_platform();
+    m_planned_result_platform = result_platform;
+}
+
+size_t Model::get_peak_activation_bytes() const
+{
+    return m_peak_activation_bytes;
+}
+
+void Model::set_replay_enabled(bool replay_enabled)
+{
+    m_replay_enabled = replay_enabled;
+    if (!replay_enabled)
+    {
+        m_execution_plan.reset();
+    }
+}
+
+bool Model::get_replay_enabled() const
+{
+    return m_replay_enabled;
+}
+
+const ExecutionPlan* Model::get_execution_plan() const
+{
+    return m_execution_plan.get();
 }
\ No newline at end of file
@@ -1,23 +1,108 @@
-#ifndef MODEL_H
-#define MODEL_H
-
-#include "../layer/Layer.h"
-
-#include <vector>
-#include <string>
-#include <memory>
-
-class Model
-{
-public:
-    Model();
-    virtual void add_layer(Layer* p_layer);
-    virtual void execute(const Tensor<float>* input, Tensor<float>* result1);
-    virtual void to_host();
-    virtual void to_device();
-protected:
-    std::vector<Layer*> m_layers;
-    PLATFORM m_platform = PLATFORM::UNKNOWN;
-};
-
+#ifndef MODEL_H
+#define MODEL_H
+
+#include "../layer/Layer.h"
+#include "../graph/Graph.h"
+#include "../tensor/ExecutionPlan.h"
+#include "CostModel.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <map>
+
+class Model
+{
+public:
+    Model();
+    virtual ~Model() = default;
+    virtual void add_layer(Layer* p_layer);
+    // ties the lifetime of layers, tensors or mapped files to the model
+    virtual void keep_alive(std::shared_ptr<void> resource);
+    virtual void execute(const Tensor<float>* input, Tensor<float>* result1);
+    // double-buffered execution of independent requests: inputs hold host data, results must be on
+    // the model's platform. While request i computes, the input of request i + 1 is uploaded and the
+    // result of request i - 1 downloaded; at most two requests are in flight. Results are on the host
+    // once this returns
+    virtual void execute_pipelined(const std::vector<Tensor<float>*>& inputs, const std::vector<Tensor<float>*>& results);
+    // load every layer to the platform; both call fuse_layers first, so a RELU Activation following a
+    // Dense or Conv2D is folded into it and no longer counts in get_num_layers
+    virtual void to_host();
+    virtual void to_device();
+    /*
+    * @brief  every plan loads each layer to the platform cost_model estimates to be fastest for the planned
+    *         input shape, the input's platform and the result's
+    * @note   like to_host and to_device, this calls fuse_layers first.
+    *         Once a layer is placed on the device, inputs and results must be TensorOpenCL, on either platform;
+    *         the model counts as on the device.
+    *         Where an activation changes platform, execute copies it between the two arenas. Clones share
+    *         the layers and so must plan for the same shape
+    */
+    virtual void to_heterogeneous(std::shared_ptr<const CostModel> cost_model);
+    // layer runs on platform however the model is loaded, PLATFORM::UNKNOWN lifts the pin
+    virtual void set_layer_platform(const Layer* layer, PLATFORM platform);
+    // platform of every layer in the current plan
+    virtual const std::vector<PLATFORM>& get_layer_platforms() const;
+    virtual PLATFORM get_platform() const;
+    // a model over the same layers (and so the same weights) and kept-alive resources, with an arena
+    // of its own: copies can execute concurrently, forward only records reads of the shared weights,
+    // on the device in their event history, which is locked. Layers must not be loaded, fused or
+    // reconfigured while copies run
+    virtual Model* clone() const;
+    // the layers as a chain of nodes from the graph input "input" to the graph output "output", node i
+    // named "i:<layer name>", sharing the layers and kept-alive resources; see Graph for branches
+    virtual Graph* to_graph() const;
+    // folds a RELU Activation into the preceding Dense or Conv2D, returns the number of removed layers.
+    // to_host, to_device and to_heterogeneous call it, after which it finds nothing more to fold
+    virtual size_t fuse_layers();
+    virtual size_t get_num_layers() const;
+    // assigns every intermediate a window of a preallocated arena per platform, for inputs shaped like input;
+    // outputs of view layers (Flatten, Reshape) share their input's window instead. Layers placed on
+    // another platform than their input read a copy in the arena of theirs, and the last one writes to
+    // a window that is copied to a result on result_platform, PLATFORM::UNKNOWN if it writes the result.
+    // execute plans on its first call and again only if the input shape or a platform changes
+    virtual void plan(const Tensor<float>* input, PLATFORM result_platform = PLATFORM::UNKNOWN);
+    virtual size_t get_peak_activation_bytes() const;
+    /*
+    * @brief  on the device, the first execute of a plan records its kernel launches and later ones replay them
+    * @note   a replay skips the layers, the ops and their argument setup, it only rebinds the input and result
+    *         buffers (see ExecutionPlan). The recording is dropped whenever the model plans again. Models that
+    *         end with a view layer or transfer inside execute are not replayable and run their layers; so does
+    *         every execute while the Profiler is enabled. Layers must not be reconfigured while replayed
+    */
+    virtual void set_replay_enabled(bool replay_enabled);
+    virtual bool get_replay_enabled() const;
+    // recording of the current plan, nullptr if nothing was recorded
+    virtual const ExecutionPlan* get_execution_plan() const;
+protected:
+    // forward of every layer, intermediates in the arena
+    virtual void run_layers(const Tensor<float>* input, Tensor<float>* result1);
+    // whether layers may run on another platform than the model, see to_heterogeneous
+    virtual bool is_heterogeneous() const;
+    // fills m_layer_platforms and loads the layers there
+    virtual void place_layers(const Tensor<float>* input, PLATFORM result_platform);
+protected:
+    std::vector<Layer*> m_layers;
+    std::vector<std::shared_ptr<void>> m_resources;
+    PLATFORM m_platform = PLATFORM::UNKNOWN;
+    std::shared_ptr<const CostModel>            m_cost_model;       // set by to_heterogeneous
+    std::map<const Layer*, PLATFORM>            m_pinned_platforms;
+
+    // activation arenas, on the host and on the device, see plan()
+    std::unique_ptr<Tensor<float>>              m_arenas[2];
+    std::vector<std::unique_ptr<Tensor<float>>> m_activations;   // output of every layer but the last, and of the last if it is copied
+    std::vector<std::unique_ptr<Tensor<float>>> m_transfers;     // per layer, its input copied to its platform, nullptr if not required
+    std::vector<std::unique_ptr<Tensor<float>>> m_scratch;       // per layer, nullptr if not required
+    std::vector<PLATFORM>                       m_layer_platforms;
+    std::vector<size_t>                         m_planned_dims;
+    PLATFORM                                    m_planned_platform = PLATFORM::UNKNOWN;
+    PLATFORM                                    m_planned_input_platform = PLATFORM::UNKNOWN;
+    PLATFORM                                    m_planned_result_platform = PLATFORM::UNKNOWN;
+    size_t                                      m_peak_activation_bytes = 0u;
+
+    // after the arenas, so a replay still running finishes before the arena is released
+    bool                                        m_replay_enabled = false;
+    std::unique_ptr<ExecutionPlan>              m_execution_plan;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,595 @@
+#include "TFLiteLoader.h"
+
+#include "../layer/Dense.h"
+#include "../layer/Conv2D.h"
+#include "../layer/QuantizedDense.h"
+#include "../layer/QuantizedConv2D.h"
+#include "../layer/Activation.h"
+#include "../layer/Pool2D.h"
+#include "../layer/Reshape.h"
+
+#include <map>
+
+// field ids of the tables in the TFLite schema (tensorflow/lite/schema/schema.fbs)
+#define TFLITE_MODEL_OPERATOR_CODES     1
+#define TFLITE_MODEL_SUBGRAPHS          2
+#define TFLITE_MODEL_BUFFERS            4
+#define TFLITE_OPCODE_DEPRECATED_CODE   0
+#define TFLITE_OPCODE_BUILTIN_CODE      3
+#define TFLITE_SUBGRAPH_TENSORS         0
+#define TFLITE_SUBGRAPH_INPUTS          1
+#define TFLITE_SUBGRAPH_OUTPUTS         2
+#define TFLITE_SUBGRAPH_OPERATORS       3
+#define TFLITE_TENSOR_SHAPE             0
+#define TFLITE_TENSOR_TYPE              1
+#define TFLITE_TENSOR_BUFFER            2
+#define TFLITE_TENSOR_NAME              3
+#define TFLITE_TENSOR_QUANTIZATION      4
+#define TFLITE_QUANTIZATION_SCALE       2
+#define TFLITE_QUANTIZATION_ZERO_POINT  3
+#define TFLITE_QUANTIZATION_DIMENSION   6
+#define TFLITE_BUFFER_DATA              0
+#define TFLITE_BUFFER_OFFSET            1
+#define TFLITE_BUFFER_SIZE              2
+#define TFLITE_OPERATOR_OPCODE_INDEX    0
+#define TFLITE_OPERATOR_INPUTS          1
+#define TFLITE_OPERATOR_OUTPUTS         2
+#define TFLITE_OPERATOR_OPTIONS         4
+#define TFLITE_FC_FUSED_ACTIVATION      0
+#define TFLITE_CONV_PADDING             0
+#define TFLITE_CONV_STRIDE_W            1
+#define TFLITE_CONV_STRIDE_H            2
+#define TFLITE_CONV_FUSED_ACTIVATION    3
+#define TFLITE_CONV_DILATION_W          4
+#define TFLITE_CONV_DILATION_H          5
+#define TFLITE_POOL_PADDING             0
+#define TFLITE_POOL_STRIDE_W            1
+#define TFLITE_POOL_STRIDE_H            2
+#define TFLITE_POOL_FILTER_W            3
+#define TFLITE_POOL_FILTER_H            4
+#define TFLITE_POOL_FUSED_ACTIVATION    5
+#define TFLITE_SOFTMAX_BETA             0
+
+// tflite::Padding
+#define TFLITE_PADDING_SAME             0
+#define TFLITE_PADDING_VALID            1
+
+// tflite::ActivationFunctionType
+#define TFLITE_ACTIVATION_NONE          0
+#define TFLITE_ACTIVATION_RELU          1
+
+// wraps data of the mapped file in result without copying it, result's dims must be set
+template<typename DATA_T>
+static void set_constant_data(Tensor<DATA_T>* result, const TFLiteTensor& tensor, const std::shared_ptr<MappedFile>& file)
+{
+    if (!tensor.data || tensor.data_size != result->get_size() * sizeof(DATA_T))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Constant tensor has no data or its size does not match its shape: " + tensor.name);
+    }
+
+    auto data = const_cast<uint8_t*>(tensor.data);
+    if (reinterpret_cast<uintptr_t>(data) % alignof(DATA_T) == 0u)
+    {
+        result->set_external_host_data(reinterpret_cast<DATA_T*>(data), result->get_size(), file);
+    }
+    else
+    {
+        // flatbuffers align vectors to their element size, but fall back to a copy just in case
+        std::vector<DATA_T> copy(result->get_size());
+        std::memcpy(copy.data(), data, tensor.data_size);
+        result->set_host_data(copy);
+    }
+}
+
+// TFLite may leave out the zero points of symmetric quantization
+static int32_t get_zero_point(const QuantizationParams& quantization)
+{
+    return quantization.zero_points.empty() ? 0 : quantization.zero_points[0];
+}
+
+TFLiteLoader::TFLiteLoader(const std::string& file_path): m_file(std::make_shared<MappedFile>(file_path))
+{
+    parse();
+}
+
+void TFLiteLoader::parse()
+{
+    const auto buffer = m_file->data();
+    const auto buffer_size = m_file->size();
+
+    // the file identifier follows the root offset
+    if (buffer_size < 8u || std::memcmp(buffer + 4, "TFL3", 4) != 0)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Not a TFLite flatbuffer");
+    }
+
+    const auto model = FlatBufferTable::root(buffer, buffer_size);
+
+    std::vector<int32_t> opcodes;
+    for (const auto& opcode : model.get_table_vector(TFLITE_MODEL_OPERATOR_CODES))
+    {
+        // newer files store codes > 127 in builtin_code, older ones only in the deprecated int8 field
+        const auto deprecated_code = static_cast<int32_t>(opcode.get_scalar<int8_t>(TFLITE_OPCODE_DEPRECATED_CODE, 0));
+        const auto builtin_code = opcode.get_scalar<int32_t>(TFLITE_OPCODE_BUILTIN_CODE, 0);
+        opcodes.emplace_back(std::max(deprecated_code, builtin_code));
+    }
+
+    const auto buffers = model.get_table_vector(TFLITE_MODEL_BUFFERS);
+    const auto subgraphs = model.get_table_vector(TFLITE_MODEL_SUBGRAPHS);
+    if (subgraphs.size() != 1u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Only models with exactly one subgraph are supported");
+    }
+    const auto& subgraph = subgraphs[0];
+
+    for (const auto& table : subgraph.get_table_vector(TFLITE_SUBGRAPH_TENSORS))
+    {
+        auto tensor = TFLiteTensor();
+        tensor.name = table.get_string(TFLITE_TENSOR_NAME);
+        tensor.type = table.get_scalar<int8_t>(TFLITE_TENSOR_TYPE, 0);
+        for (const auto dim : table.get_scalar_vector<int32_t>(TFLITE_TENSOR_SHAPE))
+        {
+            tensor.dims.emplace_back(static_cast<size_t>(std::max(dim, 1)));
+        }
+
+        const auto quantization = table.get_table(TFLITE_TENSOR_QUANTIZATION);
+        if (quantization.is_valid())
+        {
+            tensor.quantization.scales = quantization.get_scalar_vector<float>(TFLITE_QUANTIZATION_SCALE);
+            for (const auto zero_point : quantization.get_scalar_vector<int64_t>(TFLITE_QUANTIZATION_ZERO_POINT))
+            {
+                tensor.quantization.zero_points.emplace_back(static_cast<int32_t>(zero_point));
+            }
+            tensor.quantization.quantized_dimension = quantization.get_scalar<int32_t>(TFLITE_QUANTIZATION_DIMENSION, 0);
+        }
+
+        const auto buffer_index = table.get_scalar<uint32_t>(TFLITE_TENSOR_BUFFER, 0u);
+        if (buffer_index < buffers.size())
+        {
+            const auto& buffer_table = buffers[buffer_index];
+            tensor.data = buffer_table.get_byte_vector(TFLITE_BUFFER_DATA, tensor.data_size);
+
+            // models larger than 2GB keep the data outside of the flatbuffer
+            const auto offset = buffer_table.get_scalar<uint64_t>(TFLITE_BUFFER_OFFSET, 0u);
+            const auto size = buffer_table.get_scalar<uint64_t>(TFLITE_BUFFER_SIZE, 0u);
+            if (!tensor.data && offset > 1u && offset + size <= buffer_size)
+            {
+                tensor.data = buffer + offset;
+                tensor.data_size = size;
+            }
+        }
+        m_tensors.emplace_back(std::move(tensor));
+    }
+
+    m_inputs = subgraph.get_scalar_vector<int32_t>(TFLITE_SUBGRAPH_INPUTS);
+    m_outputs = subgraph.get_scalar_vector<int32_t>(TFLITE_SUBGRAPH_OUTPUTS);
+    if (m_inputs.size() != 1u || m_outputs.size() != 1u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Only models with one input and one output are supported");
+    }
+
+    for (const auto& table : subgraph.get_table_vector(TFLITE_SUBGRAPH_OPERATORS))
+    {
+        auto op = TFLiteOperator();
+        const auto opcode_index = table.get_scalar<uint32_t>(TFLITE_OPERATOR_OPCODE_INDEX, 0u);
+        if (opcode_index >= opcodes.size())
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::runtime_error("Malformed TFLite model: opcode index is out of range");
+        }
+        op.builtin_code = opcodes[opcode_index];
+        op.inputs = table.get_scalar_vector<int32_t>(TFLITE_OPERATOR_INPUTS);
+        op.outputs = table.get_scalar_vector<int32_t>(TFLITE_OPERATOR_OUTPUTS);
+        op.options = table.get_table(TFLITE_OPERATOR_OPTIONS);
+
+        for (const auto index : op.inputs)
+        {
+            if (index >= static_cast<int32_t>(m_tensors.size()))
+            {
+                std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+                throw std::runtime_error("Malformed TFLite model: tensor index is out of range");
+            }
+        }
+        if (op.outputs.size() != 1u || op.outputs[0] < 0 || op.outputs[0] >= static_cast<int32_t>(m_tensors.size()))
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::runtime_error("Only operators with exactly one output are supported");
+        }
+        m_operators.emplace_back(std::move(op));
+    }
+}
+
+void TFLiteLoader::load(Model& model, const TensorFactory& tensor_factory) const
+{
+    // the weights point into the mapping, so it has to live as long as the model
+    model.keep_alive(m_file);
+
+    auto current = m_inputs[0];
+    for (const auto& op : m_operators)
+    {
+        if (op.inputs.empty() || op.inputs[0] != current)
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::runtime_error("Only linear graphs are supported");
+        }
+
+        switch (static_cast<TFLITE_OP>(op.builtin_code))
+        {
+            case TFLITE_OP::FULLY_CONNECTED:
+                add_fully_connected(model, op, tensor_factory);
+                break;
+            case TFLITE_OP::CONV_2D:
+                add_conv_2d(model, op, tensor_factory);
+                break;
+            case TFLITE_OP::MAX_POOL_2D:
+                add_pool_2d(model, op, POOLING::MAX);
+                break;
+            case TFLITE_OP::AVERAGE_POOL_2D:
+                add_pool_2d(model, op, POOLING::AVERAGE);
+                break;
+            case TFLITE_OP::RESHAPE:
+                add_reshape(model, op);
+                break;
+            case TFLITE_OP::QUANTIZE:
+            case TFLITE_OP::DEQUANTIZE:
+                // the activations already are the dequantized values, see the class comment
+                break;
+            case TFLITE_OP::RELU:
+            {
+                auto relu = std::make_shared<Activation>(ACTIVATION::RELU);
+                model.add_layer(relu.get());
+                model.keep_alive(relu);
+                break;
+            }
+            case TFLITE_OP::ARG_MAX:
+            {
+                auto argmax = std::make_shared<Activation>(ACTIVATION::ARGMAX);
+                model.add_layer(argmax.get());
+                model.keep_alive(argmax);
+                break;
+            }
+            case TFLITE_OP::SOFTMAX:
+            {
+                if (op.options.get_scalar<float>(TFLITE_SOFTMAX_BETA, 1.0f) != 1.0f)
+                {
+                    std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+                    throw std::runtime_error("Only SOFTMAX with beta 1 is supported");
+                }
+                auto softmax = std::make_shared<Activation>(ACTIVATION::SOFTMAX);
+                model.add_layer(softmax.get());
+                model.keep_alive(softmax);
+                break;
+            }
+            default:
+                std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+                throw std::runtime_error("Unsupported TFLite operator: " + get_operator_name(op.builtin_code));
+        }
+        current = op.outputs[0];
+    }
+
+    if (current != m_outputs[0])
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("The last operator does not produce the model output");
+    }
+}
+
+void TFLiteLoader::add_fully_connected(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const
+{
+    if (op.inputs.size() < 2u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("FULLY_CONNECTED needs an input and a weight tensor");
+    }
+
+    // TFLite stores the weights as {out, in}, Dense reads them transposed in place
+    const auto& weight_tensor = get_tensor(op.inputs[1]);
+    if (weight_tensor.dims.size() != 2u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("FULLY_CONNECTED weights must be 2-D");
+    }
+    if (static_cast<TFLITE_TYPE>(weight_tensor.type) == TFLITE_TYPE::INT8)
+    {
+        add_quantized_fully_connected(model, op, tensor_factory);
+        return;
+    }
+    const auto num_outputs = weight_tensor.dims[0];
+    auto weight = make_constant(weight_tensor, tensor_factory);
+
+    std::shared_ptr<Tensor<float>> bias;
+    if (op.inputs.size() > 2u && op.inputs[2] >= 0)
+    {
+        bias = make_constant(get_tensor(op.inputs[2]), tensor_factory, {1u, num_outputs});
+    }
+    else
+    {
+        bias = std::shared_ptr<Tensor<float>>(tensor_factory());
+        bias->set_host_data(std::vector<float>(num_outputs, 0.0f));
+        bias->set_dims({1u, num_outputs});
+    }
+
+    auto dense = std::make_shared<Dense>();
+    dense->set_weight(weight.get(), true);
+    dense->set_bias(bias.get());
+    model.add_layer(dense.get());
+    model.keep_alive(weight);
+    model.keep_alive(bias);
+    model.keep_alive(dense);
+
+    const auto fused_activation = op.options.get_scalar<int8_t>(TFLITE_FC_FUSED_ACTIVATION, TFLITE_ACTIVATION_NONE);
+    add_fused_activation(model, fused_activation);
+}
+
+void TFLiteLoader::add_conv_2d(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const
+{
+    if (op.inputs.size() < 2u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("CONV_2D needs an input and a filter tensor");
+    }
+
+    // TFLite filters are OHWI, which Conv2D reads as they are
+    const auto& weight_tensor = get_tensor(op.inputs[1]);
+    if (weight_tensor.dims.size() != 4u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("CONV_2D filters must be 4-D");
+    }
+    if (static_cast<TFLITE_TYPE>(weight_tensor.type) == TFLITE_TYPE::INT8)
+    {
+        add_quantized_conv_2d(model, op, tensor_factory);
+        return;
+    }
+    const auto num_outputs = weight_tensor.dims[0];
+    auto weight = make_constant(weight_tensor, tensor_factory);
+
+    std::shared_ptr<Tensor<float>> bias;
+    if (op.inputs.size() > 2u && op.inputs[2] >= 0)
+    {
+        bias = make_constant(get_tensor(op.inputs[2]), tensor_factory, {1u, num_outputs});
+    }
+    else
+    {
+        bias = std::shared_ptr<Tensor<float>>(tensor_factory());
+        bias->set_host_data(std::vector<float>(num_outputs, 0.0f));
+        bias->set_dims({1u, num_outputs});
+    }
+
+    const auto padding = op.options.get_scalar<int8_t>(TFLITE_CONV_PADDING, TFLITE_PADDING_SAME);
+    auto conv = std::make_shared<Conv2D>(op.options.get_scalar<int32_t>(TFLITE_CONV_STRIDE_H, 1),
+                                         op.options.get_scalar<int32_t>(TFLITE_CONV_STRIDE_W, 1),
+                                         padding == TFLITE_PADDING_VALID ? PADDING::VALID : PADDING::SAME,
+                                         op.options.get_scalar<int32_t>(TFLITE_CONV_DILATION_H, 1),
+                                         op.options.get_scalar<int32_t>(TFLITE_CONV_DILATION_W, 1));
+    conv->set_weight(weight.get());
+    conv->set_bias(bias.get());
+    model.add_layer(conv.get());
+    model.keep_alive(weight);
+    model.keep_alive(bias);
+    model.keep_alive(conv);
+
+    const auto fused_activation = op.options.get_scalar<int8_t>(TFLITE_CONV_FUSED_ACTIVATION, TFLITE_ACTIVATION_NONE);
+    add_fused_activation(model, fused_activation);
+}
+
+void TFLiteLoader::add_quantized_fully_connected(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const
+{
+    const auto& input_tensor = get_tensor(op.inputs[0]);
+    const auto& weight_tensor = get_tensor(op.inputs[1]);
+    const auto& output_tensor = get_tensor(op.outputs[0]);
+    if (input_tensor.quantization.scales.empty() || output_tensor.quantization.scales.empty())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Int8 FULLY_CONNECTED needs quantized input and output tensors");
+    }
+
+    auto weight = make_int8_constant(weight_tensor, tensor_factory);
+    std::shared_ptr<Tensor<int32_t>> bias;
+    if (op.inputs.size() > 2u && op.inputs[2] >= 0)
+    {
+        bias = make_int32_constant(get_tensor(op.inputs[2]), tensor_factory, {1u, weight_tensor.dims[0]});
+    }
+
+    auto dense = std::make_shared<QuantizedDense>();
+    dense->set_weight(weight.get(), weight_tensor.quantization);
+    dense->set_bias(bias.get());
+    dense->set_input_quantization(input_tensor.quantization.scales[0], get_zero_point(input_tensor.quantization));
+    dense->set_output_quantization(output_tensor.quantization.scales[0], get_zero_point(output_tensor.quantization));
+    model.add_layer(dense.get());
+    model.keep_alive(weight);
+    model.keep_alive(bias);
+    model.keep_alive(dense);
+
+    const auto fused_activation = op.options.get_scalar<int8_t>(TFLITE_FC_FUSED_ACTIVATION, TFLITE_ACTIVATION_NONE);
+    add_fused_activation(model, fused_activation);
+}
+
+void TFLiteLoader::add_quantized_conv_2d(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const
+{
+    const auto& input_tensor = get_tensor(op.inputs[0]);
+    const auto& weight_tensor = get_tensor(op.inputs[1]);
+    const auto& output_tensor = get_tensor(op.outputs[0]);
+    if (input_tensor.quantization.scales.empty() || output_tensor.quantization.scales.empty())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Int8 CONV_2D needs quantized input and output tensors");
+    }
+
+    auto weight = make_int8_constant(weight_tensor, tensor_factory);
+    std::shared_ptr<Tensor<int32_t>> bias;
+    if (op.inputs.size() > 2u && op.inputs[2] >= 0)
+    {
+        bias = make_int32_constant(get_tensor(op.inputs[2]), tensor_factory, {1u, weight_tensor.dims[0]});
+    }
+
+    const auto padding = op.options.get_scalar<int8_t>(TFLITE_CONV_PADDING, TFLITE_PADDING_SAME);
+    auto conv = std::make_shared<QuantizedConv2D>(op.options.get_scalar<int32_t>(TFLITE_CONV_STRIDE_H, 1),
+                                                  op.options.get_scalar<int32_t>(TFLITE_CONV_STRIDE_W, 1),
+                                                  padding == TFLITE_PADDING_VALID ? PADDING::VALID : PADDING::SAME,
+                                                  op.options.get_scalar<int32_t>(TFLITE_CONV_DILATION_H, 1),
+                                                  op.options.get_scalar<int32_t>(TFLITE_CONV_DILATION_W, 1));
+    conv->set_weight(weight.get(), weight_tensor.quantization);
+    conv->set_bias(bias.get());
+    conv->set_input_quantization(input_tensor.quantization.scales[0], get_zero_point(input_tensor.quantization));
+    conv->set_output_quantization(output_tensor.quantization.scales[0], get_zero_point(output_tensor.quantization));
+    model.add_layer(conv.get());
+    model.keep_alive(weight);
+    model.keep_alive(bias);
+    model.keep_alive(conv);
+
+    const auto fused_activation = op.options.get_scalar<int8_t>(TFLITE_CONV_FUSED_ACTIVATION, TFLITE_ACTIVATION_NONE);
+    add_fused_activation(model, fused_activation);
+}
+
+void TFLiteLoader::add_pool_2d(Model& model, const TFLiteOperator& op, POOLING pooling) const
+{
+    const auto padding = op.options.get_scalar<int8_t>(TFLITE_POOL_PADDING, TFLITE_PADDING_SAME);
+    auto pool = std::make_shared<Pool2D>(pooling,
+                                         op.options.get_scalar<int32_t>(TFLITE_POOL_FILTER_H, 1),
+                                         op.options.get_scalar<int32_t>(TFLITE_POOL_FILTER_W, 1),
+                                         op.options.get_scalar<int32_t>(TFLITE_POOL_STRIDE_H, 1),
+                                         op.options.get_scalar<int32_t>(TFLITE_POOL_STRIDE_W, 1),
+                                         padding == TFLITE_PADDING_VALID ? PADDING::VALID : PADDING::SAME);
+    model.add_layer(pool.get());
+    model.keep_alive(pool);
+
+    const auto fused_activation = op.options.get_scalar<int8_t>(TFLITE_POOL_FUSED_ACTIVATION, TFLITE_ACTIVATION_NONE);
+    add_fused_activation(model, fused_activation);
+}
+
+void TFLiteLoader::add_reshape(Model& model, const TFLiteOperator& op) const
+{
+    // the output tensor already has the resolved shape, the batch dimension follows the input
+    const auto& output_dims = get_tensor(op.outputs[0]).dims;
+    if (output_dims.empty())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("RESHAPE output needs a batch dimension");
+    }
+
+    auto reshape = std::make_shared<Reshape>(std::vector<size_t>(output_dims.cbegin() + 1, output_dims.cend()));
+    model.add_layer(reshape.get());
+    model.keep_alive(reshape);
+}
+
+void TFLiteLoader::add_fused_activation(Model& model, int8_t fused_activation) const
+{
+    switch (fused_activation)
+    {
+        case TFLITE_ACTIVATION_NONE:
+            break;
+        case TFLITE_ACTIVATION_RELU:
+        {
+            auto relu = std::make_shared<Activation>(ACTIVATION::RELU);
+            model.add_layer(relu.get());
+            model.keep_alive(relu);
+            break;
+        }
+        default:
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::runtime_error("Unsupported fused activation function: " + std::to_string(fused_activation));
+    }
+}
+
+std::shared_ptr<Tensor<float>> TFLiteLoader::make_constant(const TFLiteTensor& tensor, const TensorFactory& tensor_factory,
+                                                           const std::vector<size_t>& dims) const
+{
+    if (static_cast<TFLITE_TYPE>(tensor.type) != TFLITE_TYPE::FLOAT32)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Only float32 constant tensors are supported: " + tensor.name);
+    }
+
+    auto result = std::shared_ptr<Tensor<float>>(tensor_factory());
+    result->set_dims(dims.empty() ? tensor.dims : dims);
+    set_constant_data(result.get(), tensor, m_file);
+    return result;
+}
+
+std::shared_ptr<Tensor<int8_t>> TFLiteLoader::make_int8_constant(const TFLiteTensor& tensor, const TensorFactory& tensor_factory) const
+{
+    if (static_cast<TFLITE_TYPE>(tensor.type) != TFLITE_TYPE::INT8)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Expected an int8 constant tensor: " + tensor.name);
+    }
+
+    const std::unique_ptr<Tensor<float>> prototype(tensor_factory());
+    auto result = std::shared_ptr<Tensor<int8_t>>(prototype->create_empty_int8());
+    result->set_dims(tensor.dims);
+    set_constant_data(result.get(), tensor, m_file);
+    return result;
+}
+
+std::shared_ptr<Tensor<int32_t>> TFLiteLoader::make_int32_constant(const TFLiteTensor& tensor, const TensorFactory& tensor_factory,
+                                                                   const std::vector<size_t>& dims) const
+{
+    if (static_cast<TFLITE_TYPE>(tensor.type) != TFLITE_TYPE::INT32)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Expected an int32 constant tensor: " + tensor.name);
+    }
+
+    const std::unique_ptr<Tensor<float>> prototype(tensor_factory());
+    auto result = std::shared_ptr<Tensor<int32_t>>(prototype->create_empty_int32());
+    result->set_dims(dims.empty() ? tensor.dims : dims);
+    set_constant_data(result.get(), tensor, m_file);
+    return result;
+}
+
+const TFLiteTensor& TFLiteLoader::get_tensor(int32_t index) const
+{
+    if (index < 0 || index >= static_cast<int32_t>(m_tensors.size()))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Tensor index is out of range");
+    }
+    return m_tensors[index];
+}
+
+const std::vector<TFLiteTensor>& TFLiteLoader::get_tensors() const
+{
+    return m_tensors;
+}
+
+const std::vector<TFLiteOperator>& TFLiteLoader::get_operators() const
+{
+    return m_operators;
+}
+
+const std::vector<size_t>& TFLiteLoader::get_input_dims() const
+{
+    return get_tensor(m_inputs[0]).dims;
+}
+
+const std::vector<size_t>& TFLiteLoader::get_output_dims() const
+{
+    return get_tensor(m_outputs[0]).dims;
+}
+
+const MappedFile& TFLiteLoader::get_file() const
+{
+    return *m_file;
+}
+
+Tensor<float>* TFLiteLoader::default_tensor_factory()
+{
+    return new Tensor<float>();
+}
+
+std::string TFLiteLoader::get_operator_name(int32_t builtin_code)
+{
+    static const std::map<int32_t, std::string> names = {
+        {0, "ADD"}, {1, "AVERAGE_POOL_2D"}, {2, "CONCATENATION"}, {3, "CONV_2D"}, {4, "DEPTHWISE_CONV_2D"},
+        {6, "DEQUANTIZE"}, {9, "FULLY_CONNECTED"}, {14, "LOGISTIC"}, {17, "MAX_POOL_2D"}, {18, "MUL"},
+        {19, "RELU"}, {21, "RELU6"}, {22, "RESHAPE"}, {25, "SOFTMAX"}, {28, "TANH"}, {40, "MEAN"},
+        {56, "ARG_MAX"}, {114, "QUANTIZE"}
+    };
+    const auto it = names.find(builtin_code);
+    return it == names.end() ? "BUILTIN_" + std::to_string(builtin_code) : it->second;
+}
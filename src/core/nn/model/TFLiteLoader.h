@@ -0,0 +1,110 @@
+#ifndef TFLITE_LOADER_H
+#define TFLITE_LOADER_H
+
+#include "Model.h"
+#include "FlatBuffer.h"
+#include "MappedFile.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// subset of tflite::BuiltinOperator
+enum class TFLITE_OP
+{
+    AVERAGE_POOL_2D = 1,
+    CONV_2D         = 3,
+    DEQUANTIZE      = 6,
+    FULLY_CONNECTED = 9,
+    MAX_POOL_2D     = 17,
+    RELU            = 19,
+    RESHAPE         = 22,
+    SOFTMAX         = 25,
+    ARG_MAX         = 56,
+    QUANTIZE        = 114
+};
+
+// subset of tflite::TensorType
+enum class TFLITE_TYPE
+{
+    FLOAT32 = 0,
+    INT32   = 2,
+    INT8    = 9
+};
+
+struct TFLiteTensor
+{
+    std::string         name;
+    std::vector<size_t> dims;
+    int32_t             type = 0;
+    const uint8_t*      data = nullptr;   // points into the mapped file, null for activations
+    size_t              data_size = 0u;   // in bytes
+    QuantizationParams  quantization;     // no scales for float tensors
+};
+
+struct TFLiteOperator
+{
+    int32_t              builtin_code = 0;
+    std::vector<int32_t> inputs;          // indices into the tensor list, -1 for optional inputs
+    std::vector<int32_t> outputs;
+    FlatBufferTable      options;         // builtin options table, invalid if the op has none
+};
+
+/*
+* @brief  builds a Model from a .tflite flatbuffer without copying its weights
+* @note   the file is memory-mapped and constant tensors point straight into the mapping,
+*         the mapping is kept alive by the model (see Model::keep_alive).
+*         Only linear graphs are supported: every operator must consume the previous operator's output.
+*         Int8 FULLY_CONNECTED / CONV_2D become QuantizedDense / QuantizedConv2D. The activations between
+*         layers stay float and hold the dequantized int8 values, so QUANTIZE and DEQUANTIZE add no layer:
+*         every quantized layer quantizes its input with the scale of its own input tensor
+*/
+class TFLiteLoader
+{
+public:
+    using TensorFactory = std::function<Tensor<float>*()>;
+
+    explicit TFLiteLoader(const std::string& file_path);
+    virtual ~TFLiteLoader() = default;
+
+    // appends the graph's layers to model; tensor_factory decides the tensor type (e.g. TensorOpenCL)
+    virtual void load(Model& model, const TensorFactory& tensor_factory = default_tensor_factory) const;
+
+    virtual const std::vector<TFLiteTensor>& get_tensors() const;
+    virtual const std::vector<TFLiteOperator>& get_operators() const;
+    virtual const std::vector<size_t>& get_input_dims() const;
+    virtual const std::vector<size_t>& get_output_dims() const;
+    virtual const MappedFile& get_file() const;
+
+    static std::string get_operator_name(int32_t builtin_code);
+    static Tensor<float>* default_tensor_factory();
+
+protected:
+    virtual void parse();
+    virtual const TFLiteTensor& get_tensor(int32_t index) const;
+    // wraps a constant tensor's data in the mapping, dims override the file's shape if given
+    virtual std::shared_ptr<Tensor<float>> make_constant(const TFLiteTensor& tensor, const TensorFactory& tensor_factory,
+                                                         const std::vector<size_t>& dims = {}) const;
+    // the same for int8 weights and int32 biases of quantized operators, on the platform tensor_factory's tensors use
+    virtual std::shared_ptr<Tensor<int8_t>> make_int8_constant(const TFLiteTensor& tensor, const TensorFactory& tensor_factory) const;
+    virtual std::shared_ptr<Tensor<int32_t>> make_int32_constant(const TFLiteTensor& tensor, const TensorFactory& tensor_factory,
+                                                                 const std::vector<size_t>& dims = {}) const;
+    virtual void add_fully_connected(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const;
+    virtual void add_conv_2d(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const;
+    // int8 weights, op's input / output tensors carry the activation quantization
+    virtual void add_quantized_fully_connected(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const;
+    virtual void add_quantized_conv_2d(Model& model, const TFLiteOperator& op, const TensorFactory& tensor_factory) const;
+    virtual void add_pool_2d(Model& model, const TFLiteOperator& op, POOLING pooling) const;
+    virtual void add_reshape(Model& model, const TFLiteOperator& op) const;
+    virtual void add_fused_activation(Model& model, int8_t fused_activation) const;
+
+protected:
+    std::shared_ptr<MappedFile>  m_file;
+    std::vector<TFLiteTensor>    m_tensors;
+    std::vector<TFLiteOperator>  m_operators;
+    std::vector<int32_t>         m_inputs;
+    std::vector<int32_t>         m_outputs;
+};
+
+#endif  // TFLITE_LOADER_H
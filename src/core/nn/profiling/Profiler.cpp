@@ -0,0 +1,365 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+
+std::atomic<bool> Profiler::s_enabled{false};
+
+// the run the records of this thread belong to
+static thread_local size_t current_run = 0u;
+
+static std::string escape_json(const std::string& text)
+{
+    std::string escaped;
+    for (const auto c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+bool ProfileRecord::has_device_times() const
+{
+    return end_ns != 0u;
+}
+
+double ProfileRecord::get_duration_us() const
+{
+    if (has_device_times())
+    {
+        return static_cast<double>(end_ns - start_ns) * 1e-3;
+    }
+    return host_end_us - host_start_us;
+}
+
+Profiler::Profiler() : m_epoch(Clock::now())
+{
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::set_enabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+double Profiler::now_us() const
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - m_epoch).count();
+}
+
+size_t Profiler::begin_run()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    current_run = m_num_runs++;
+    return current_run;
+}
+
+void Profiler::join_run(size_t run)
+{
+    current_run = run;
+}
+
+size_t Profiler::get_thread_index()
+{
+    const auto id = std::this_thread::get_id();
+    const auto it = m_threads.find(id);
+    if (it != m_threads.end())
+    {
+        return it->second;
+    }
+    const auto index = m_threads.size();
+    m_threads.emplace(id, index);
+    return index;
+}
+
+void Profiler::record_layer(const std::string& name, double host_start_us, double host_end_us)
+{
+    ProfileRecord record;
+    record.name = name;
+    record.category = PROFILE_CATEGORY::LAYER;
+    record.run = current_run;
+    record.host_start_us = host_start_us;
+    record.host_end_us = host_end_us;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    record.thread = get_thread_index();
+    add_record(std::move(record));
+}
+
+void Profiler::record_event(cl_event event, const std::string& name, PROFILE_CATEGORY category, size_t bytes, double host_start_us)
+{
+    PendingEvent pending;
+    pending.record.name = name;
+    pending.record.category = category;
+    pending.record.run = current_run;
+    pending.record.host_start_us = host_start_us;
+    pending.record.host_end_us = now_us();
+    pending.record.bytes = bytes;
+    if (event && clRetainEvent(event) == CL_SUCCESS)
+    {
+        pending.event = event;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pending.record.thread = get_thread_index();
+    m_pending.push_back(std::move(pending));
+    if (m_pending.size() >= MAX_PENDING_EVENTS)
+    {
+        resolve_events(false);
+    }
+    // a device that never completes would grow the list without bound
+    if (m_pending.size() >= 4u * MAX_PENDING_EVENTS)
+    {
+        resolve_events(true);
+    }
+}
+
+void Profiler::resolve_events(bool wait)
+{
+    std::vector<PendingEvent> still_pending;
+    for (auto& pending : m_pending)
+    {
+        if (pending.event)
+        {
+            if (!wait)
+            {
+                cl_int status = CL_QUEUED;
+                clGetEventInfo(pending.event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL);
+                if (status > CL_COMPLETE)
+                {
+                    still_pending.push_back(std::move(pending));
+                    continue;
+                }
+            }
+            else
+            {
+                clWaitForEvents(1, &pending.event);
+            }
+
+            // fails without CL_QUEUE_PROFILING_ENABLE, the record then only has host times
+            auto& record = pending.record;
+            cl_int err = clGetEventProfilingInfo(pending.event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &record.queued_ns, NULL);
+            err |= clGetEventProfilingInfo(pending.event, CL_PROFILING_COMMAND_SUBMIT, sizeof(cl_ulong), &record.submit_ns, NULL);
+            err |= clGetEventProfilingInfo(pending.event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &record.start_ns, NULL);
+            err |= clGetEventProfilingInfo(pending.event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &record.end_ns, NULL);
+            if (err != CL_SUCCESS)
+            {
+                record.queued_ns = record.submit_ns = record.start_ns = record.end_ns = 0u;
+            }
+            clReleaseEvent(pending.event);
+        }
+        add_record(std::move(pending.record));
+    }
+    m_pending = std::move(still_pending);
+}
+
+void Profiler::add_record(ProfileRecord record)
+{
+    const auto duration_us = record.get_duration_us();
+    auto& summary = m_summary[SummaryKey(record.category, record.name)];
+    if (summary.count == 0u)
+    {
+        summary.name = record.name;
+        summary.category = record.category;
+        summary.min_us = duration_us;
+        summary.max_us = duration_us;
+    }
+    ++summary.count;
+    summary.total_us += duration_us;
+    summary.min_us = std::min(summary.min_us, duration_us);
+    summary.max_us = std::max(summary.max_us, duration_us);
+    summary.bytes += record.bytes;
+    if (record.has_device_times())
+    {
+        summary.total_queue_us += static_cast<double>(record.start_ns - record.queued_ns) * 1e-3;
+    }
+
+    if (m_records.size() < m_max_records)
+    {
+        m_records.push_back(std::move(record));
+    }
+    else
+    {
+        ++m_num_dropped;
+    }
+}
+
+void Profiler::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    resolve_events(true);
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pending : m_pending)
+    {
+        if (pending.event)
+        {
+            clReleaseEvent(pending.event);
+        }
+    }
+    m_pending.clear();
+    m_records.clear();
+    m_summary.clear();
+    m_threads.clear();
+    m_num_runs = 0u;
+    m_num_dropped = 0u;
+}
+
+void Profiler::set_max_records(size_t max_records)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_records = max_records;
+}
+
+size_t Profiler::get_num_runs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_runs;
+}
+
+size_t Profiler::get_num_dropped() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_dropped;
+}
+
+std::vector<ProfileRecord> Profiler::get_records()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    resolve_events(true);
+    return m_records;
+}
+
+std::vector<ProfileSummary> Profiler::get_summary()
+{
+    std::vector<ProfileSummary> summary;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resolve_events(true);
+        for (const auto& entry : m_summary)
+        {
+            summary.push_back(entry.second);
+        }
+    }
+    std::stable_sort(summary.begin(), summary.end(), [](const ProfileSummary& left, const ProfileSummary& right)
+    {
+        if (left.category != right.category)
+        {
+            return left.category < right.category;
+        }
+        return left.total_us > right.total_us;
+    });
+    return summary;
+}
+
+std::string Profiler::get_summary_table()
+{
+    const auto summary = get_summary();
+    std::map<PROFILE_CATEGORY, double> category_total_us;
+    for (const auto& entry : summary)
+    {
+        category_total_us[entry.category] += entry.total_us;
+    }
+
+    std::string table;
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-9s %-32s %8s %12s %11s %11s %11s %11s %7s\n", "category", "name", "count",
+                  "total [ms]", "mean [us]", "min [us]", "max [us]", "queue [us]", "share");
+    table += line;
+    for (const auto& entry : summary)
+    {
+        const auto count = static_cast<double>(entry.count);
+        const auto total_us = category_total_us[entry.category];
+        std::snprintf(line, sizeof(line), "%-9s %-32s %8zu %12.3f %11.2f %11.2f %11.2f %11.2f %6.1f%%\n",
+                      get_category_name(entry.category), entry.name.c_str(), entry.count, entry.total_us * 1e-3,
+                      entry.total_us / count, entry.min_us, entry.max_us, entry.total_queue_us / count,
+                      total_us > 0.0 ? 100.0 * entry.total_us / total_us : 0.0);
+        table += line;
+    }
+    return table;
+}
+
+void Profiler::write_chrome_trace(std::ostream& out)
+{
+    const auto records = get_records();
+
+    // the enqueue call returns after the command was queued, the smallest gap best aligns the clocks
+    auto device_offset_us = std::numeric_limits<double>::max();
+    for (const auto& record : records)
+    {
+        if (record.has_device_times())
+        {
+            device_offset_us = std::min(device_offset_us, record.host_end_us - static_cast<double>(record.queued_ns) * 1e-3);
+        }
+    }
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"host\"}},\n";
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 2, \"args\": {\"name\": \"OpenCL device\"}},\n";
+    out << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 2, \"tid\": 0, \"args\": {\"name\": \"kernels\"}},\n";
+    out << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 2, \"tid\": 1, \"args\": {\"name\": \"transfers\"}}";
+    for (const auto& record : records)
+    {
+        out << ",\n  {\"name\": \"" << escape_json(record.name) << "\", \"cat\": \"" << get_category_name(record.category)
+            << "\", \"ph\": \"X\", ";
+        if (record.has_device_times())
+        {
+            out << "\"pid\": 2, \"tid\": " << (record.category == PROFILE_CATEGORY::TRANSFER ? 1 : 0)
+                << ", \"ts\": " << static_cast<double>(record.start_ns) * 1e-3 + device_offset_us
+                << ", \"dur\": " << static_cast<double>(record.end_ns - record.start_ns) * 1e-3
+                << ", \"args\": {\"run\": " << record.run << ", \"queued_ns\": " << record.queued_ns
+                << ", \"submit_ns\": " << record.submit_ns << ", \"start_ns\": " << record.start_ns
+                << ", \"end_ns\": " << record.end_ns << ", \"bytes\": " << record.bytes << "}}";
+        }
+        else
+        {
+            out << "\"pid\": 1, \"tid\": " << record.thread << ", \"ts\": " << record.host_start_us
+                << ", \"dur\": " << record.host_end_us - record.host_start_us
+                << ", \"args\": {\"run\": " << record.run << ", \"bytes\": " << record.bytes << "}}";
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+const char* Profiler::get_category_name(PROFILE_CATEGORY category)
+{
+    switch (category)
+    {
+        case PROFILE_CATEGORY::LAYER:
+            return "layer";
+        case PROFILE_CATEGORY::KERNEL:
+            return "kernel";
+        case PROFILE_CATEGORY::TRANSFER:
+            return "transfer";
+    }
+    return "unknown";
+}
+
+std::string Profiler::get_kernel_name(cl_kernel kernel)
+{
+    char name[128] = {};
+    if (clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, sizeof(name) - 1u, name, NULL) != CL_SUCCESS)
+    {
+        return "kernel";
+    }
+    return name;
+}
@@ -0,0 +1,147 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <CL/cl.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class PROFILE_CATEGORY
+{
+    LAYER = 0,  // host wall time of a layer's forward
+    KERNEL,     // an OpenCL kernel launch
+    TRANSFER    // an OpenCL buffer write, read or copy
+};
+
+/*
+* @brief  one profiled layer, kernel or transfer
+* @note   host times are microseconds since the profiler was created; for OpenCL commands
+*         they span the enqueue call. Device timestamps come from the command's event, in nanoseconds
+*         on the device clock, and stay 0 if the queue was created without CL_QUEUE_PROFILING_ENABLE
+*/
+struct ProfileRecord
+{
+    std::string      name;
+    PROFILE_CATEGORY category = PROFILE_CATEGORY::LAYER;
+    size_t           run = 0u;          // Model::execute call of the recording thread
+    size_t           thread = 0u;       // host threads, numbered in the order they first record
+    double           host_start_us = 0.0;
+    double           host_end_us = 0.0;
+    cl_ulong         queued_ns = 0u;
+    cl_ulong         submit_ns = 0u;
+    cl_ulong         start_ns = 0u;
+    cl_ulong         end_ns = 0u;
+    size_t           bytes = 0u;        // transfers only
+
+    bool has_device_times() const;
+    // device execution time if known, host time otherwise
+    double get_duration_us() const;
+};
+
+// every record of one category and name, over all runs
+struct ProfileSummary
+{
+    std::string      name;
+    PROFILE_CATEGORY category = PROFILE_CATEGORY::LAYER;
+    size_t           count = 0u;
+    double           total_us = 0.0;
+    double           min_us = 0.0;
+    double           max_us = 0.0;
+    double           total_queue_us = 0.0;  // start - queued on the device, how long commands waited
+    size_t           bytes = 0u;
+};
+
+/*
+* @brief  opt-in process-wide profiler for Model::execute and the OpenCL commands it enqueues
+* @note   disabled, every hook costs one relaxed atomic load (see is_enabled). Enabled, Model::execute
+*         times every layer on the host and TensorOpenCL retains the event of every kernel and transfer;
+*         the events' timestamps are read once they completed, at the latest by flush.
+*         Summaries aggregate every record since the last clear, while only the first max_records
+*         records are kept for the trace.
+*         The Chrome trace (chrome://tracing, Perfetto) shows host threads in one process and the
+*         device in another, device timestamps shifted onto the host clock at the enqueue calls
+*/
+class Profiler
+{
+public:
+    static Profiler& instance();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static bool is_enabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    static void set_enabled(bool enabled);
+    // host clock of the records
+    double now_us() const;
+
+    // starts the next run of the calling thread, returns its index
+    size_t begin_run();
+    // the calling thread records into run, e.g. a worker running part of it
+    void join_run(size_t run);
+    void record_layer(const std::string& name, double host_start_us, double host_end_us);
+    // retains event until its timestamps are read
+    void record_event(cl_event event, const std::string& name, PROFILE_CATEGORY category, size_t bytes, double host_start_us);
+    // waits for the recorded events and reads their timestamps
+    void flush();
+    // drops every record and summary
+    void clear();
+
+    void set_max_records(size_t max_records);
+    size_t get_num_runs() const;
+    size_t get_num_dropped() const;
+    // flushed first
+    std::vector<ProfileRecord> get_records();
+    // by category, then by total time, longest first
+    std::vector<ProfileSummary> get_summary();
+    std::string get_summary_table();
+    void write_chrome_trace(std::ostream& out);
+
+    static const char* get_category_name(PROFILE_CATEGORY category);
+    // CL_KERNEL_FUNCTION_NAME
+    static std::string get_kernel_name(cl_kernel kernel);
+
+    // events recorded before completed ones are collected without blocking
+    static constexpr size_t MAX_PENDING_EVENTS = 1024u;
+
+private:
+    Profiler();
+
+    using Clock = std::chrono::steady_clock;
+    using SummaryKey = std::pair<PROFILE_CATEGORY, std::string>;
+
+    struct PendingEvent
+    {
+        cl_event      event = nullptr;
+        ProfileRecord record;
+    };
+
+    size_t get_thread_index();
+    void add_record(ProfileRecord record);
+    // reads the timestamps of pending events; without wait only of those that completed
+    void resolve_events(bool wait);
+
+private:
+    static std::atomic<bool>             s_enabled;
+
+    mutable std::mutex                   m_mutex;
+    const Clock::time_point              m_epoch;
+    std::vector<ProfileRecord>           m_records;
+    std::vector<PendingEvent>            m_pending;
+    std::map<SummaryKey, ProfileSummary> m_summary;
+    std::map<std::thread::id, size_t>    m_threads;
+    size_t                               m_max_records = size_t{1} << 20;
+    size_t                               m_num_runs = 0u;
+    size_t                               m_num_dropped = 0u;
+};
+
+#endif  // PROFILER_H
@@ -0,0 +1,330 @@
+#include "InferenceServer.h"
+
+#include <algorithm>
+#include <numeric>
+
+InferenceServer::InferenceServer(const Model& model, const InferenceServerParams& params, const TensorFactory& tensor_factory)
+    : m_model(model), m_params(params), m_tensor_factory(tensor_factory)
+{
+    if (m_model.get_platform() == PLATFORM::UNKNOWN)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Model is not loaded to a platform");
+    }
+    if (m_params.sample_dims.empty() || m_params.max_batch_size == 0u || m_params.num_executors == 0u)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Server needs sample dims, a batch size and an executor");
+    }
+    m_sample_size = std::accumulate(m_params.sample_dims.cbegin(), m_params.sample_dims.cend(), size_t{1}, std::multiplies<size_t>());
+    m_params.max_latency_samples = std::max<size_t>(m_params.max_latency_samples, 1u);
+    m_latencies_ms.reserve(m_params.max_latency_samples);
+    m_stats_start = Clock::now();
+
+    m_idle_executors = m_params.num_executors;
+    for (auto i = 0u; i < m_params.num_executors; ++i)
+    {
+        m_executors.emplace_back(&InferenceServer::run_executor, this);
+    }
+    m_batcher = std::thread(&InferenceServer::run_batcher, this);
+}
+
+InferenceServer::~InferenceServer()
+{
+    stop();
+    // requests that raced with stop are dropped, their futures report a broken promise
+    Request* request = nullptr;
+    while (m_requests.pop(request))
+    {
+        delete request;
+    }
+}
+
+Tensor<float>* InferenceServer::default_tensor_factory()
+{
+    return new Tensor<float>();
+}
+
+std::future<std::vector<float>> InferenceServer::submit(std::vector<float> input)
+{
+    if (m_stopping)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Server is stopped");
+    }
+    if (input.size() != m_sample_size)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input does not hold one sample");
+    }
+
+    auto request = new Request();
+    request->input = std::move(input);
+    request->submitted = Clock::now();
+    auto future = request->result.get_future();
+    m_requests.push(request);
+
+    // pairs with the fence in collect_requests: either the batcher sees the request or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_batcher_sleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(m_request_mutex);
+        m_request_available.notify_one();
+    }
+    return future;
+}
+
+void InferenceServer::stop()
+{
+    if (m_stopping.exchange(true))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_request_mutex);
+        m_request_available.notify_one();
+    }
+    m_batcher.join();
+    for (auto& executor : m_executors)
+    {
+        executor.join();
+    }
+}
+
+size_t InferenceServer::pop_requests(Batch& pending)
+{
+    size_t num_popped = 0u;
+    Request* request = nullptr;
+    while (pending.size() < m_params.max_batch_size && m_requests.pop(request))
+    {
+        pending.emplace_back(request);
+        ++num_popped;
+    }
+    return num_popped;
+}
+
+void InferenceServer::collect_requests(Batch& pending, Clock::time_point deadline)
+{
+    if (pop_requests(pending) > 0u || pending.size() >= m_params.max_batch_size || m_stopping)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_request_mutex);
+    m_batcher_sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // a request pushed before the flag was visible is found here, any later one notifies
+    if (pop_requests(pending) == 0u && !m_stopping)
+    {
+        m_request_available.wait_until(lock, deadline);
+    }
+    m_batcher_sleeping.store(false, std::memory_order_relaxed);
+}
+
+void InferenceServer::run_batcher()
+{
+    Batch pending;
+    while (true)
+    {
+        // requests keep queueing while every executor is busy, so the next batch grows meanwhile
+        {
+            std::unique_lock<std::mutex> lock(m_batch_mutex);
+            m_executor_idle.wait(lock, [this]() { return m_idle_executors > 0u; });
+        }
+
+        if (pending.empty())
+        {
+            collect_requests(pending, Clock::now() + std::chrono::milliseconds(100));
+            if (pending.empty())
+            {
+                if (m_stopping)
+                {
+                    break;
+                }
+                continue;
+            }
+        }
+
+        // wait for a fuller batch, but not past the oldest request's deadline
+        const auto deadline = pending.front()->submitted + m_params.max_queue_delay;
+        while (pending.size() < m_params.max_batch_size && Clock::now() < deadline && !m_stopping)
+        {
+            collect_requests(pending, deadline);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_batch_mutex);
+            m_batches.emplace_back(std::move(pending));
+            --m_idle_executors;
+        }
+        m_batch_available.notify_one();
+        pending.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_batch_mutex);
+        m_batcher_done = true;
+    }
+    m_batch_available.notify_all();
+}
+
+void InferenceServer::run_executor()
+{
+    // clones by batch size, each keeps the arena planned for its shape
+    std::vector<std::unique_ptr<Model>> models(m_params.max_batch_size + 1u);
+    std::unique_ptr<Tensor<float>> input(m_tensor_factory());
+    std::unique_ptr<Tensor<float>> result(m_tensor_factory());
+    result->set_host_data({0.0f});
+
+    while (true)
+    {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(m_batch_mutex);
+            m_batch_available.wait(lock, [this]() { return !m_batches.empty() || m_batcher_done; });
+            if (m_batches.empty())
+            {
+                return;
+            }
+            batch = std::move(m_batches.front());
+            m_batches.pop_front();
+        }
+
+        execute_batch(batch, models, input.get(), result.get());
+
+        {
+            std::lock_guard<std::mutex> lock(m_batch_mutex);
+            ++m_idle_executors;
+        }
+        m_executor_idle.notify_one();
+    }
+}
+
+void InferenceServer::execute_batch(Batch& batch, std::vector<std::unique_ptr<Model>>& models,
+                                    Tensor<float>* input, Tensor<float>* result)
+{
+    const auto batch_size = batch.size();
+    // a failure after the stats were recorded or after some futures were satisfied leaves both alone,
+    // a second set_value or set_exception would throw out of the executor
+    auto recorded = false;
+    size_t num_satisfied = 0u;
+    try
+    {
+        std::vector<float> batch_data(batch_size * m_sample_size);
+        for (auto i = 0u; i < batch_size; ++i)
+        {
+            std::copy(batch[i]->input.cbegin(), batch[i]->input.cend(), batch_data.begin() + i * m_sample_size);
+        }
+        std::vector<size_t> batch_dims = {batch_size};
+        batch_dims.insert(batch_dims.end(), m_params.sample_dims.cbegin(), m_params.sample_dims.cend());
+        input->set_host_data(batch_data);
+        input->set_dims(batch_dims);
+
+        auto& model = models[batch_size];
+        if (!model)
+        {
+            model.reset(m_model.clone());
+        }
+        if (model->get_platform() == PLATFORM::DEVICE)
+        {
+            input->load_to_device();
+            result->load_to_device();
+        }
+        model->execute(input, result);
+        if (model->get_platform() == PLATFORM::DEVICE)
+        {
+            result->load_to_host();
+        }
+
+        // recorded first, so the stats already count a request whose future is ready
+        record(batch);
+        recorded = true;
+        // scatter the rows of the batch output back to the requests
+        const auto row_size = result->get_size() / batch_size;
+        const auto output = result->data();
+        for (; num_satisfied < batch_size; ++num_satisfied)
+        {
+            const auto row = output + num_satisfied * row_size;
+            batch[num_satisfied]->result.set_value(std::vector<float>(row, row + row_size));
+        }
+    }
+    catch (...)
+    {
+        if (!recorded)
+        {
+            record(batch);
+        }
+        for (auto i = num_satisfied; i < batch_size; ++i)
+        {
+            batch[i]->result.set_exception(std::current_exception());
+        }
+    }
+}
+
+void InferenceServer::record(const Batch& batch)
+{
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_num_requests += batch.size();
+    ++m_num_batches;
+    for (const auto& request : batch)
+    {
+        const auto latency = std::chrono::duration<double, std::milli>(now - request->submitted).count();
+        if (m_latencies_ms.size() < m_params.max_latency_samples)
+        {
+            m_latencies_ms.push_back(latency);
+        }
+        else
+        {
+            m_latencies_ms[m_next_latency] = latency;
+        }
+        m_next_latency = (m_next_latency + 1u) % m_params.max_latency_samples;
+    }
+}
+
+InferenceServerStats InferenceServer::get_stats() const
+{
+    InferenceServerStats stats;
+    std::vector<double> latencies_ms;
+    Clock::time_point start;
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        stats.num_requests = m_num_requests;
+        stats.num_batches = m_num_batches;
+        latencies_ms = m_latencies_ms;
+        start = m_stats_start;
+    }
+
+    if (stats.num_batches > 0u)
+    {
+        stats.mean_batch_size = static_cast<double>(stats.num_requests) / static_cast<double>(stats.num_batches);
+    }
+    const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (seconds > 0.0)
+    {
+        stats.throughput = static_cast<double>(stats.num_requests) / seconds;
+    }
+
+    auto percentile = [&latencies_ms](double fraction)
+    {
+        const auto index = static_cast<size_t>(fraction * static_cast<double>(latencies_ms.size() - 1u) + 0.5);
+        std::nth_element(latencies_ms.begin(), latencies_ms.begin() + index, latencies_ms.end());
+        return latencies_ms[index];
+    };
+    if (!latencies_ms.empty())
+    {
+        stats.p50_latency_ms = percentile(0.5);
+        stats.p99_latency_ms = percentile(0.99);
+    }
+    return stats;
+}
+
+void InferenceServer::reset_stats()
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_stats_start = Clock::now();
+    m_num_requests = 0u;
+    m_num_batches = 0u;
+    m_latencies_ms.clear();
+    m_next_latency = 0u;
+}
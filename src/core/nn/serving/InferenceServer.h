@@ -0,0 +1,120 @@
+#ifndef INFERENCE_SERVER_H
+#define INFERENCE_SERVER_H
+
+#include "LockFreeQueue.h"
+#include "../model/Model.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct InferenceServerParams
+{
+    std::vector<size_t>         sample_dims;                // one request, without the batch dimension
+    size_t                      max_batch_size = 8u;
+    std::chrono::microseconds   max_queue_delay{2000};      // the oldest request waits at most this long for a fuller batch
+    size_t                      num_executors = 2u;
+    size_t                      max_latency_samples = 65536u;   // latencies kept for the percentiles, the newest ones
+};
+
+struct InferenceServerStats
+{
+    size_t  num_requests = 0u;      // completed, including failed ones
+    size_t  num_batches = 0u;
+    double  mean_batch_size = 0.0;
+    double  p50_latency_ms = 0.0;   // from submit until the result is set
+    double  p99_latency_ms = 0.0;
+    double  throughput = 0.0;       // requests per second since the start or the last reset_stats
+};
+
+/*
+* @brief  serves single-sample requests by running them through a Model in dynamic batches
+* @note   clients submit from any thread into a lock-free queue. A batcher thread drains it whenever an
+*         executor is idle: it dispatches once max_batch_size requests are waiting or the oldest one has
+*         waited max_queue_delay, so batches grow by themselves while the executors are busy.
+*         Every executor thread runs clones of the model (see Model::clone) that share its layers and
+*         weights and own only their activation arenas, one clone per batch size so none is replanned.
+*         Row i of the batch output is the result of request i
+*/
+class InferenceServer
+{
+public:
+    using TensorFactory = std::function<Tensor<float>*()>;
+
+    // model must already be loaded (to_host / to_device) and must outlive the server;
+    // tensor_factory makes the batch tensors, e.g. TensorOpenCL for a model on the device
+    InferenceServer(const Model& model, const InferenceServerParams& params,
+                    const TensorFactory& tensor_factory = default_tensor_factory);
+    // finishes the queued requests
+    virtual ~InferenceServer();
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // input holds one sample of params.sample_dims; model errors are rethrown by the future
+    virtual std::future<std::vector<float>> submit(std::vector<float> input);
+    // runs the queued requests and stops the threads, submit throws afterwards
+    virtual void stop();
+    virtual InferenceServerStats get_stats() const;
+    virtual void reset_stats();
+
+    static Tensor<float>* default_tensor_factory();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request
+    {
+        std::vector<float>              input;
+        std::promise<std::vector<float>> result;
+        Clock::time_point               submitted;
+    };
+    using Batch = std::vector<std::unique_ptr<Request>>;
+
+    void run_batcher();
+    void run_executor();
+    void execute_batch(Batch& batch, std::vector<std::unique_ptr<Model>>& models, Tensor<float>* input, Tensor<float>* result);
+    // moves queued requests into pending, up to the batch size
+    size_t pop_requests(Batch& pending);
+    // pop_requests, but if nothing was queued sleeps until a request is submitted or deadline passes
+    void collect_requests(Batch& pending, Clock::time_point deadline);
+    // counts a finished batch and the latencies of its requests
+    void record(const Batch& batch);
+
+    const Model&                    m_model;
+    InferenceServerParams           m_params;
+    TensorFactory                   m_tensor_factory;
+    size_t                          m_sample_size = 0u;
+
+    LockFreeQueue<Request*>         m_requests;
+    std::atomic<bool>               m_batcher_sleeping{false};
+    std::mutex                      m_request_mutex;    // only to sleep on, the queue needs no lock
+    std::condition_variable         m_request_available;
+
+    std::deque<Batch>               m_batches;          // dispatched, not yet taken by an executor
+    size_t                          m_idle_executors = 0u;
+    bool                            m_batcher_done = false;
+    std::mutex                      m_batch_mutex;
+    std::condition_variable         m_batch_available;
+    std::condition_variable         m_executor_idle;
+
+    std::atomic<bool>               m_stopping{false};
+    std::thread                     m_batcher;
+    std::vector<std::thread>        m_executors;
+
+    mutable std::mutex              m_stats_mutex;
+    Clock::time_point               m_stats_start;
+    size_t                          m_num_requests = 0u;
+    size_t                          m_num_batches = 0u;
+    std::vector<double>             m_latencies_ms;     // ring of the newest max_latency_samples
+    size_t                          m_next_latency = 0u;
+};
+
+#endif  // INFERENCE_SERVER_H
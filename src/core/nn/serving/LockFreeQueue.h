@@ -0,0 +1,80 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/*
+* @brief  unbounded multi-producer single-consumer FIFO (Vyukov's intrusive MPSC queue)
+* @note   push is one atomic exchange and never blocks or retries, so any number of client threads
+*         can enqueue at once. Only one thread may pop. A push that has swapped the head but not yet
+*         linked its node is invisible to pop for that moment, pop then reports an empty queue
+*/
+template<typename DATA_T>
+class LockFreeQueue
+{
+public:
+    LockFreeQueue();
+    virtual ~LockFreeQueue();
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    virtual void push(DATA_T value);
+    // false if the queue is empty, consumer thread only
+    virtual bool pop(DATA_T& value);
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        DATA_T             value{};
+    };
+
+    std::atomic<Node*> m_head;  // last pushed node, producers swap it
+    Node*              m_tail;  // the node before the next one to pop, starts as an empty stub
+};
+
+template<typename DATA_T>
+LockFreeQueue<DATA_T>::LockFreeQueue()
+{
+    auto stub = new Node();
+    m_head.store(stub);
+    m_tail = stub;
+}
+
+template<typename DATA_T>
+LockFreeQueue<DATA_T>::~LockFreeQueue()
+{
+    DATA_T value;
+    while (pop(value))
+    {
+    }
+    delete m_tail;
+}
+
+template<typename DATA_T>
+void LockFreeQueue<DATA_T>::push(DATA_T value)
+{
+    auto node = new Node();
+    node->value = std::move(value);
+    const auto previous = m_head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+template<typename DATA_T>
+bool LockFreeQueue<DATA_T>::pop(DATA_T& value)
+{
+    const auto next = m_tail->next.load(std::memory_order_acquire);
+    if (!next)
+    {
+        return false;
+    }
+    // next becomes the new stub, its value is moved out
+    value = std::move(next->value);
+    delete m_tail;
+    m_tail = next;
+    return true;
+}
+
+#endif  // LOCK_FREE_QUEUE_H
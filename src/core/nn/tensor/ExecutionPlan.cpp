@@ -0,0 +1,334 @@
+#include "ExecutionPlan.h"
+#include "TensorOpenCL.h"
+#include "OpenCLKernelCache.h"
+
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+thread_local ExecutionPlan* ExecutionPlan::s_recording = nullptr;
+
+ExecutionPlan::ExecutionPlan()
+{
+}
+
+ExecutionPlan::~ExecutionPlan()
+{
+    if (s_recording == this)
+    {
+        s_recording = nullptr;
+    }
+    // the kernels may still be running with their arguments
+    if (m_last_event)
+    {
+        clWaitForEvents(1, &m_last_event);
+        clReleaseEvent(m_last_event);
+    }
+    release_kernels();
+}
+
+ExecutionPlan* ExecutionPlan::set_recording(ExecutionPlan* plan)
+{
+    const auto previous = s_recording;
+    s_recording = plan;
+    return previous;
+}
+
+void ExecutionPlan::record_arg(cl_kernel kernel, cl_uint index, size_t size, const void* value)
+{
+    auto& arg = m_args[kernel][index];
+    arg.size = size;
+    if (value)
+    {
+        const auto bytes = static_cast<const unsigned char*>(value);
+        arg.value.assign(bytes, bytes + size);
+    }
+    else
+    {
+        arg.value.clear();
+    }
+}
+
+void ExecutionPlan::record_launch(cl_kernel kernel, cl_command_queue queue, cl_uint work_dim, const size_t* global_size,
+                                  const size_t* local_size)
+{
+    if (m_finished)
+    {
+        return;
+    }
+    if (m_queue && queue != m_queue)
+    {
+        fail("launches on more than one queue");
+    }
+    m_queue = queue;
+    if (work_dim == 0u || work_dim > 3u)
+    {
+        fail("a launch of " + std::to_string(work_dim) + " dimensions");
+        return;
+    }
+
+    Launch launch;
+    launch.source = kernel;
+    launch.work_dim = work_dim;
+    launch.has_local_size = local_size != nullptr;
+    for (auto i = 0u; i < work_dim; ++i)
+    {
+        launch.global_size[i] = global_size[i];
+        launch.local_size[i] = local_size ? local_size[i] : 0u;
+    }
+    launch.args = m_args[kernel];
+    m_launches.push_back(std::move(launch));
+}
+
+void ExecutionPlan::record_unsupported(const std::string& command)
+{
+    if (!m_finished)
+    {
+        fail(command + " can't be replayed");
+    }
+}
+
+void ExecutionPlan::fail(const std::string& failure)
+{
+    if (m_failure.empty())
+    {
+        m_failure = failure;
+    }
+}
+
+bool ExecutionPlan::finish(const TensorOpenCL<float>* input, const TensorOpenCL<float>* result)
+{
+    if (m_finished)
+    {
+        return is_replayable();
+    }
+    m_finished = true;
+    m_args.clear();
+    if (!input || !result)
+    {
+        fail("the input or result is not an OpenCL tensor");
+    }
+    else if (m_launches.empty())
+    {
+        fail("nothing was launched");
+    }
+    if (!m_failure.empty())
+    {
+        return false;
+    }
+
+    cl_command_queue_properties properties = 0;
+    if (clGetCommandQueueInfo(m_queue, CL_QUEUE_PROPERTIES, sizeof(properties), &properties, NULL) == CL_SUCCESS)
+    {
+        m_in_order = (properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) == 0;
+    }
+    else
+    {
+        m_in_order = false;
+    }
+    m_input_dims = input->get_dims();
+    m_result_dims = result->get_dims();
+    m_bound_input = input->m_device_data;
+    m_bound_result = result->m_device_data;
+
+    auto& cache = OpenCLKernelCache::instance();
+    for (auto i = 0u; i < m_launches.size(); ++i)
+    {
+        auto& launch = m_launches[i];
+        char name[128] = {};
+        cl_uint num_args = 0u;
+        cl_int err = clGetKernelInfo(launch.source, CL_KERNEL_FUNCTION_NAME, sizeof(name) - 1u, name, NULL);
+        err |= clGetKernelInfo(launch.source, CL_KERNEL_PROGRAM, sizeof(cl_program), &launch.program, NULL);
+        err |= clGetKernelInfo(launch.source, CL_KERNEL_NUM_ARGS, sizeof(cl_uint), &num_args, NULL);
+        if (err != CL_SUCCESS)
+        {
+            fail("the launched kernels could not be queried");
+            break;
+        }
+        launch.name = name;
+        if (launch.args.size() != num_args || (num_args > 0u && launch.args.rbegin()->first + 1u != num_args))
+        {
+            // set before the recording started, its value is unknown
+            fail("not every argument of " + launch.name + " was recorded");
+            break;
+        }
+
+        // a kernel of the plan's own keeps its arguments between replays
+        launch.kernel = cache.acquire(launch.program, launch.name);
+        for (const auto& arg : launch.args)
+        {
+            const auto& value = arg.second.value;
+            err |= clSetKernelArg(launch.kernel, arg.first, arg.second.size, value.empty() ? NULL : value.data());
+            if (arg.second.size != sizeof(cl_mem) || value.empty())
+            {
+                continue;
+            }
+            if (m_bound_input && std::memcmp(value.data(), &m_bound_input, sizeof(cl_mem)) == 0)
+            {
+                m_bindings.push_back({i, arg.first, false});
+            }
+            else if (m_bound_result && std::memcmp(value.data(), &m_bound_result, sizeof(cl_mem)) == 0)
+            {
+                m_bindings.push_back({i, arg.first, true});
+            }
+        }
+        if (err != CL_SUCCESS)
+        {
+            fail("the arguments of " + launch.name + " could not be bound");
+            break;
+        }
+    }
+
+    if (!m_failure.empty())
+    {
+        release_kernels();
+        m_bindings.clear();
+        return false;
+    }
+
+    // the first replay overwrites the intermediates of the recorded run, which ends with the result's write.
+    // The event is retained under the lock, so a concurrent write to the result can't release it first
+    {
+        std::lock_guard<std::mutex> lock(result->m_events->mutex);
+        m_last_event = result->m_events->write_event;
+        if (m_last_event)
+        {
+            clRetainEvent(m_last_event);
+        }
+    }
+    return true;
+}
+
+bool ExecutionPlan::is_replayable() const
+{
+    return m_finished && m_failure.empty();
+}
+
+const std::string& ExecutionPlan::get_failure() const
+{
+    return m_failure;
+}
+
+size_t ExecutionPlan::get_num_launches() const
+{
+    return m_launches.size();
+}
+
+size_t ExecutionPlan::get_num_bindings() const
+{
+    return m_bindings.size();
+}
+
+void ExecutionPlan::bind(bool result, cl_mem buffer)
+{
+    for (const auto& binding : m_bindings)
+    {
+        if (binding.result == result)
+        {
+            if (clSetKernelArg(m_launches[binding.launch].kernel, binding.index, sizeof(cl_mem), &buffer) != CL_SUCCESS)
+            {
+                std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+                throw std::runtime_error("Couldn't rebind a kernel argument");
+            }
+        }
+    }
+}
+
+void ExecutionPlan::replay(const TensorOpenCL<float>* input, TensorOpenCL<float>* result)
+{
+    if (!is_replayable())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Execution plan is not replayable: " + m_failure);
+    }
+    if (input->get_dims() != m_input_dims)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input does not have the recorded dims");
+    }
+
+    result->allocate(m_result_dims);
+    if (input->m_device_data != m_bound_input)
+    {
+        m_bound_input = input->m_device_data;
+        bind(false, m_bound_input);
+    }
+    if (result->m_device_data != m_bound_result)
+    {
+        m_bound_result = result->m_device_data;
+        bind(true, m_bound_result);
+    }
+
+    thread_local std::vector<cl_event> wait_list;
+    wait_list.clear();
+    input->wait_for_write(wait_list);
+    result->wait_for_access(wait_list);
+    // the previous replay may still use the intermediates
+    if (m_last_event)
+    {
+        wait_list.push_back(m_last_event);
+    }
+
+    cl_event event = nullptr;
+    for (auto i = 0u; i < m_launches.size(); ++i)
+    {
+        const auto& launch = m_launches[i];
+        const auto last = i + 1u == m_launches.size();
+        cl_event launch_event = nullptr;
+        const auto err = clEnqueueNDRangeKernel(m_queue, launch.kernel, launch.work_dim, NULL, launch.global_size,
+                                                launch.has_local_size ? launch.local_size : NULL,
+                                                wait_list.size(), wait_list.empty() ? NULL : wait_list.data(),
+                                                m_in_order && !last ? NULL : &launch_event);
+        if (err != CL_SUCCESS)
+        {
+            if (event)
+            {
+                clReleaseEvent(event);
+            }
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::runtime_error("Couldn't replay the " + launch.name + " kernel");
+        }
+
+        // an in-order queue orders the launches by itself
+        wait_list.clear();
+        if (event)
+        {
+            clReleaseEvent(event);
+        }
+        event = launch_event;
+        if (event && !m_in_order)
+        {
+            wait_list.push_back(event);
+        }
+    }
+
+    input->record_read(event);
+    result->record_write(event);
+    if (m_last_event)
+    {
+        clReleaseEvent(m_last_event);
+    }
+    m_last_event = event;
+}
+
+void ExecutionPlan::wait() const
+{
+    if (m_last_event)
+    {
+        clWaitForEvents(1, &m_last_event);
+    }
+}
+
+void ExecutionPlan::release_kernels()
+{
+    auto& cache = OpenCLKernelCache::instance();
+    for (auto& launch : m_launches)
+    {
+        if (launch.kernel)
+        {
+            cache.release(launch.program, launch.name, launch.kernel);
+            launch.kernel = nullptr;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef EXECUTION_PLAN_H
+#define EXECUTION_PLAN_H
+
+#include <CL/cl.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+template<typename DATA_T>
+class TensorOpenCL;
+
+/*
+* @brief  the kernel launches of one pass over device ops, recorded once and enqueued again without the ops
+* @note   while a plan records on a thread, TensorOpenCL reports every kernel argument and launch to it.
+*         finish leases a kernel of its own per launch from OpenCLKernelCache and binds the recorded
+*         arguments once, so replay only rebinds the arguments that were the recorded input or result
+*         buffer and enqueues the launches. Every other buffer the recording bound (weights, arena
+*         windows) must stay alive and unchanged while the plan is replayed.
+*         Transfers and copies can't be replayed; recording one makes the plan not replayable.
+*         The launches of one replay wait for the input, the previous readers of the result and the
+*         previous replay. On an in-order queue only the first launch waits and only the last one has an event
+*/
+class ExecutionPlan
+{
+public:
+    ExecutionPlan();
+    // waits for the last replay and returns the leased kernels
+    ~ExecutionPlan();
+
+    ExecutionPlan(const ExecutionPlan&) = delete;
+    ExecutionPlan& operator=(const ExecutionPlan&) = delete;
+
+    static ExecutionPlan* get_recording()
+    {
+        return s_recording;
+    }
+    // plan records the calling thread's launches from now on, nullptr stops; returns the previous plan
+    static ExecutionPlan* set_recording(ExecutionPlan* plan);
+
+    // hooks of TensorOpenCL; a nullptr value is a __local argument of size bytes
+    void record_arg(cl_kernel kernel, cl_uint index, size_t size, const void* value);
+    void record_launch(cl_kernel kernel, cl_command_queue queue, cl_uint work_dim, const size_t* global_size,
+                       const size_t* local_size);
+    // a command that can't be replayed, e.g. "a write"
+    void record_unsupported(const std::string& command);
+
+    // ends the recording of the launches between input and result, returns is_replayable()
+    bool finish(const TensorOpenCL<float>* input, const TensorOpenCL<float>* result);
+    bool is_replayable() const;
+    // why the plan is not replayable, empty if it is
+    const std::string& get_failure() const;
+    size_t get_num_launches() const;
+    // launches whose arguments replay rebinds to the input or the result
+    size_t get_num_bindings() const;
+
+    // input must have the recorded dims, result is allocated with the recorded result dims
+    void replay(const TensorOpenCL<float>* input, TensorOpenCL<float>* result);
+    // blocks until the last replay completed
+    void wait() const;
+
+private:
+    struct KernelArg
+    {
+        size_t                     size = 0u;
+        std::vector<unsigned char> value;           // empty for __local arguments
+    };
+
+    struct Launch
+    {
+        cl_kernel                  source = nullptr;    // the leased kernel that was recorded, not owned
+        cl_kernel                  kernel = nullptr;    // leased by the plan in finish
+        cl_program                 program = nullptr;
+        std::string                name;
+        cl_uint                    work_dim = 0u;
+        size_t                     global_size[3] = {0u, 0u, 0u};
+        size_t                     local_size[3] = {0u, 0u, 0u};
+        bool                       has_local_size = false;
+        std::map<cl_uint, KernelArg> args;
+    };
+
+    struct Binding
+    {
+        size_t  launch;
+        cl_uint index;
+        bool    result;     // the result buffer, the input buffer otherwise
+    };
+
+    void fail(const std::string& failure);
+    void release_kernels();
+    void bind(bool result, cl_mem buffer);
+
+private:
+    static thread_local ExecutionPlan*        s_recording;
+
+    std::map<cl_kernel, std::map<cl_uint, KernelArg>> m_args;   // latest arguments of every kernel while recording
+    std::vector<Launch>                       m_launches;
+    std::vector<Binding>                      m_bindings;
+    std::string                               m_failure;
+    bool                                      m_finished = false;
+
+    cl_command_queue                          m_queue = nullptr;
+    bool                                      m_in_order = true;
+    std::vector<size_t>                       m_input_dims;
+    std::vector<size_t>                       m_result_dims;
+    cl_mem                                    m_bound_input = nullptr;
+    cl_mem                                    m_bound_result = nullptr;
+    cl_event                                  m_last_event = nullptr;
+};
+
+#endif  // EXECUTION_PLAN_H
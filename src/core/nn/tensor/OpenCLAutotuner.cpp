@@ -0,0 +1,228 @@
+#include "OpenCLAutotuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+OpenCLAutotuner& OpenCLAutotuner::instance()
+{
+    static OpenCLAutotuner autotuner;
+    return autotuner;
+}
+
+const OpenCLDeviceInfo& OpenCLAutotuner::get_device_info(cl_command_queue queue)
+{
+    cl_device_id device = nullptr;
+    cl_int err = clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(device), &device, NULL);
+    if (err != CL_SUCCESS)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't query the device of the queue");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_devices.find(device);
+    if (it != m_devices.end())
+    {
+        return it->second;
+    }
+
+    OpenCLDeviceInfo info;
+    char name[256] = {};
+    cl_uint compute_units = 1u;
+    cl_ulong local_mem_size = 0u;
+    err  = clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name) - 1u, name, NULL);
+    err |= clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(info.max_work_group_size), &info.max_work_group_size, NULL);
+    err |= clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(compute_units), &compute_units, NULL);
+    err |= clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(local_mem_size), &local_mem_size, NULL);
+    if (err != CL_SUCCESS)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't query the device limits");
+    }
+    info.name = name;
+    info.compute_units = std::max<size_t>(compute_units, 1u);
+    info.local_mem_size = local_mem_size;
+
+    return m_devices.emplace(device, info).first->second;
+}
+
+size_t OpenCLAutotuner::get_max_work_group_size(cl_command_queue queue, cl_kernel kernel)
+{
+    const auto device_limit = get_device_info(queue).max_work_group_size;
+
+    cl_device_id device = nullptr;
+    size_t kernel_limit = device_limit;
+    cl_int err = clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(device), &device, NULL);
+    err |= clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernel_limit), &kernel_limit, NULL);
+    if (err != CL_SUCCESS)
+    {
+        // the device limit is still an upper bound
+        return device_limit;
+    }
+    return std::min(device_limit, kernel_limit);
+}
+
+void OpenCLAutotuner::set_enabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_enabled = enabled;
+}
+
+bool OpenCLAutotuner::is_enabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_enabled;
+}
+
+void OpenCLAutotuner::set_cache_path(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cache_path = path;
+    }
+    load(path);
+}
+
+std::string OpenCLAutotuner::get_cache_path() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cache_path;
+}
+
+void OpenCLAutotuner::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_choices.clear();
+    m_cache_path.clear();
+    m_num_tuned = 0u;
+}
+
+size_t OpenCLAutotuner::select(const std::string& device, const std::string& kernel_name, const std::string& shape_class,
+                               const std::vector<size_t>& candidates, size_t fallback, const std::function<void(size_t)>& run)
+{
+    const auto key = Key(device, kernel_name, shape_class);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_choices.find(key);
+        if (it != m_choices.end() &&
+            std::find(candidates.begin(), candidates.end(), it->second) != candidates.end())
+        {
+            return it->second;
+        }
+        if (!m_enabled || candidates.size() < 2u || !run)
+        {
+            return fallback;
+        }
+    }
+
+    // tuning blocks on the device, so the lock isn't held meanwhile;
+    // two threads tuning the same key just both store the same kind of answer
+    auto best_value = fallback;
+    auto best_time = std::numeric_limits<double>::max();
+    for (const auto candidate : candidates)
+    {
+        // the first run warms up caches and lazy compilation
+        run(candidate);
+        auto candidate_time = std::numeric_limits<double>::max();
+        for (auto i = 0u; i < NUM_TIMED_RUNS; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            run(candidate);
+            const auto stop = std::chrono::steady_clock::now();
+            candidate_time = std::min(candidate_time, std::chrono::duration<double>(stop - start).count());
+        }
+        if (candidate_time < best_time)
+        {
+            best_time = candidate_time;
+            best_value = candidate;
+        }
+    }
+
+    store(device, kernel_name, shape_class, best_value);
+    return best_value;
+}
+
+size_t OpenCLAutotuner::get_num_tuned() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_tuned;
+}
+
+std::string OpenCLAutotuner::get_shape_class(std::initializer_list<size_t> dims)
+{
+    std::string shape_class;
+    for (const auto dim : dims)
+    {
+        auto log2 = 0u;
+        while ((size_t{1} << log2) < dim)
+        {
+            ++log2;
+        }
+        if (!shape_class.empty())
+        {
+            shape_class += 'x';
+        }
+        shape_class += std::to_string(log2);
+    }
+    return shape_class;
+}
+
+size_t OpenCLAutotuner::round_up(size_t value, size_t multiple)
+{
+    return (value + multiple - 1u) / multiple * multiple;
+}
+
+void OpenCLAutotuner::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        // nothing tuned yet
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        std::string device, kernel_name, shape_class, value;
+        if (std::getline(fields, device, '\t') && std::getline(fields, kernel_name, '\t') &&
+            std::getline(fields, shape_class, '\t') && std::getline(fields, value))
+        {
+            try
+            {
+                // later lines win, they were tuned more recently
+                m_choices[Key(device, kernel_name, shape_class)] = std::stoul(value);
+            }
+            catch (const std::exception&)
+            {
+                std::cerr << "Skipping malformed autotuner entry: " << line << std::endl;
+            }
+        }
+    }
+}
+
+void OpenCLAutotuner::store(const std::string& device, const std::string& kernel_name, const std::string& shape_class, size_t value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_choices[Key(device, kernel_name, shape_class)] = value;
+    ++m_num_tuned;
+
+    if (m_cache_path.empty())
+    {
+        return;
+    }
+    std::ofstream file(m_cache_path, std::ios::app);
+    if (!file)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't open the autotuner cache " + m_cache_path);
+    }
+    file << device << '\t' << kernel_name << '\t' << shape_class << '\t' << value << '\n';
+}
@@ -0,0 +1,86 @@
+#ifndef OPENCL_AUTOTUNER_H
+#define OPENCL_AUTOTUNER_H
+
+#include <CL/cl.h>
+
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/*
+* @brief  limits of the device behind a command queue, used to size NDRanges
+*/
+struct OpenCLDeviceInfo
+{
+    std::string name;
+    size_t      max_work_group_size = 1u;
+    size_t      compute_units = 1u;
+    size_t      local_mem_size = 0u;
+};
+
+/*
+* @brief  process-wide per-device choice of launch parameters (work-group or tile sizes)
+* @note   a choice is keyed by device name, kernel name and shape class, so one tuning run
+*         covers every shape whose dims fall in the same power-of-two buckets.
+*         Lookups always go through the cache; benchmarking unknown keys is opt-in since it
+*         blocks on the queue. Winners are appended to the cache file, one tab-separated
+*         "device, kernel, shape class, value" line per entry, and read back on the next run.
+*/
+class OpenCLAutotuner
+{
+public:
+    static OpenCLAutotuner& instance();
+
+    OpenCLAutotuner(const OpenCLAutotuner&) = delete;
+    OpenCLAutotuner& operator=(const OpenCLAutotuner&) = delete;
+
+    // queried once per device and kept for the lifetime of the process
+    const OpenCLDeviceInfo& get_device_info(cl_command_queue queue);
+    // the smaller of the device limit and what the compiled kernel supports
+    size_t get_max_work_group_size(cl_command_queue queue, cl_kernel kernel);
+
+    void set_enabled(bool enabled);
+    bool is_enabled() const;
+    // loads the entries already in the file, later winners are appended to it
+    void set_cache_path(const std::string& path);
+    std::string get_cache_path() const;
+    void clear();
+
+    /*
+    * @brief  returns the cached value for the key, tuning it first when enabled
+    * @note   run must launch the kernel with the given candidate and wait for it to finish;
+    *         without a cached value and with tuning disabled, fallback is returned untouched.
+    */
+    size_t select(const std::string& device, const std::string& kernel_name, const std::string& shape_class,
+                  const std::vector<size_t>& candidates, size_t fallback, const std::function<void(size_t)>& run);
+
+    size_t get_num_tuned() const;
+
+    // "4x7" for dims whose ceil(log2) are 4 and 7
+    static std::string get_shape_class(std::initializer_list<size_t> dims);
+    static size_t round_up(size_t value, size_t multiple);
+
+    static constexpr size_t NUM_TIMED_RUNS = 3u;
+
+private:
+    OpenCLAutotuner() = default;
+
+    void load(const std::string& path);
+    void store(const std::string& device, const std::string& kernel_name, const std::string& shape_class, size_t value);
+
+private:
+    using Key = std::tuple<std::string, std::string, std::string>;
+
+    mutable std::mutex                        m_mutex;
+    std::map<cl_device_id, OpenCLDeviceInfo>  m_devices;
+    std::map<Key, size_t>                     m_choices;
+    std::string                               m_cache_path;
+    bool                                      m_enabled = false;
+    size_t                                    m_num_tuned = 0u;
+};
+
+#endif  // OPENCL_AUTOTUNER_H
@@ -0,0 +1,227 @@
+#include "OpenCLBufferPool.h"
+
+#include <iostream>
+#include <stdexcept>
+
+OpenCLBufferPool& OpenCLBufferPool::instance()
+{
+    static OpenCLBufferPool pool;
+    return pool;
+}
+
+OpenCLBufferPool::~OpenCLBufferPool()
+{
+    clear();
+}
+
+size_t OpenCLBufferPool::get_size_class(size_t size_in_bytes)
+{
+    size_t size_class = MIN_SIZE_CLASS;
+    while (size_class < size_in_bytes)
+    {
+        size_class <<= 1u;
+    }
+    return size_class;
+}
+
+cl_mem OpenCLBufferPool::acquire(cl_context context, cl_command_queue queue, size_t size_in_bytes, size_t& capacity_in_bytes)
+{
+    capacity_in_bytes = get_size_class(size_in_bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_idle.find(Key(context, capacity_in_bytes));
+        if (it != m_idle.end())
+        {
+            auto& entries = it->second;
+            // most recently released first, it is the most likely to be hot in the cache
+            for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry)
+            {
+                if (is_ready(*entry, queue))
+                {
+                    const auto buffer = entry->buffer;
+                    if (entry->ready)
+                    {
+                        clReleaseEvent(entry->ready);
+                    }
+                    if (entry->queue)
+                    {
+                        clReleaseCommandQueue(entry->queue);
+                    }
+                    entries.erase(std::next(entry).base());
+                    m_idle_bytes -= capacity_in_bytes;
+                    ++m_num_hits;
+                    return buffer;
+                }
+            }
+        }
+        ++m_num_misses;
+    }
+
+    // allocating is slow, don't hold the lock meanwhile
+    cl_int err = CL_SUCCESS;
+    const auto buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, capacity_in_bytes, NULL, &err);
+    if (err != CL_SUCCESS || !buffer)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't create device buffer");
+    }
+    return buffer;
+}
+
+void OpenCLBufferPool::release(cl_context context, cl_command_queue queue, cl_mem buffer, size_t capacity_in_bytes)
+{
+    auto entry = Entry{buffer, queue, false, nullptr};
+    if (queue)
+    {
+        // held until the entry goes, so is_ready never compares against a freed queue's handle
+        clRetainCommandQueue(queue);
+        cl_command_queue_properties properties = 0u;
+        clGetCommandQueueInfo(queue, CL_QUEUE_PROPERTIES, sizeof(properties), &properties, NULL);
+        entry.in_order = !(properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+        if (clEnqueueMarkerWithWaitList(queue, 0u, NULL, &entry.ready) != CL_SUCCESS)
+        {
+            entry.ready = nullptr;
+            clFinish(queue);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_idle_bytes + capacity_in_bytes > m_high_water_mark)
+    {
+        // make room by dropping idle buffers, or drop this one if it alone is too large
+        trim_locked(m_high_water_mark > capacity_in_bytes ? m_high_water_mark - capacity_in_bytes : 0u);
+        if (m_idle_bytes + capacity_in_bytes > m_high_water_mark)
+        {
+            free_entry(entry);
+            return;
+        }
+    }
+    m_idle[Key(context, capacity_in_bytes)].emplace_back(entry);
+    m_idle_bytes += capacity_in_bytes;
+}
+
+void OpenCLBufferPool::set_high_water_mark(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_high_water_mark = bytes;
+    trim_locked(bytes);
+}
+
+size_t OpenCLBufferPool::get_high_water_mark() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_high_water_mark;
+}
+
+void OpenCLBufferPool::trim(size_t max_idle_bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    trim_locked(max_idle_bytes);
+}
+
+void OpenCLBufferPool::trim_locked(size_t max_idle_bytes)
+{
+    // size classes are the second part of the key, so walk every context's largest buffers first
+    while (m_idle_bytes > max_idle_bytes)
+    {
+        auto largest = m_idle.end();
+        for (auto it = m_idle.begin(); it != m_idle.end(); ++it)
+        {
+            if (!it->second.empty() && (largest == m_idle.end() || it->first.second > largest->first.second))
+            {
+                largest = it;
+            }
+        }
+        if (largest == m_idle.end())
+        {
+            break;
+        }
+        free_entry(largest->second.front());
+        largest->second.erase(largest->second.begin());
+        m_idle_bytes -= largest->first.second;
+        if (largest->second.empty())
+        {
+            m_idle.erase(largest);
+        }
+    }
+}
+
+void OpenCLBufferPool::release_context(cl_context context)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_idle.begin(); it != m_idle.end();)
+    {
+        if (it->first.first == context)
+        {
+            for (auto& entry : it->second)
+            {
+                free_entry(entry);
+                m_idle_bytes -= it->first.second;
+            }
+            it = m_idle.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void OpenCLBufferPool::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& idle : m_idle)
+    {
+        for (auto& entry : idle.second)
+        {
+            free_entry(entry);
+        }
+    }
+    m_idle.clear();
+    m_idle_bytes = 0u;
+}
+
+size_t OpenCLBufferPool::get_num_hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_hits;
+}
+
+size_t OpenCLBufferPool::get_num_misses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_misses;
+}
+
+size_t OpenCLBufferPool::get_idle_bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_idle_bytes;
+}
+
+bool OpenCLBufferPool::is_ready(const Entry& entry, cl_command_queue queue)
+{
+    if (!entry.ready || (entry.in_order && entry.queue == queue))
+    {
+        return true;
+    }
+    cl_int status = CL_COMPLETE + 1;
+    clGetEventInfo(entry.ready, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL);
+    return status == CL_COMPLETE;
+}
+
+void OpenCLBufferPool::free_entry(Entry& entry)
+{
+    // clReleaseMemObject defers the actual free until commands using the buffer are done
+    if (entry.ready)
+    {
+        clReleaseEvent(entry.ready);
+        entry.ready = nullptr;
+    }
+    if (entry.queue)
+    {
+        clReleaseCommandQueue(entry.queue);
+        entry.queue = nullptr;
+    }
+    clReleaseMemObject(entry.buffer);
+}
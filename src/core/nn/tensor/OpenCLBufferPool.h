@@ -0,0 +1,75 @@
+#ifndef OPENCL_BUFFER_POOL_H
+#define OPENCL_BUFFER_POOL_H
+
+#include <CL/cl.h>
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+* @brief  process-wide pool of device buffers, per context and power-of-two size class
+* @note   a released buffer may still be used by commands in flight. It is handed out again
+*         right away on the in-order queue that released it, since later commands run after
+*         the earlier ones; any other queue waits until a marker enqueued at release completed.
+*         Idle bytes above the high-water mark are freed instead of pooled.
+*/
+class OpenCLBufferPool
+{
+public:
+    static OpenCLBufferPool& instance();
+
+    OpenCLBufferPool(const OpenCLBufferPool&) = delete;
+    OpenCLBufferPool& operator=(const OpenCLBufferPool&) = delete;
+    ~OpenCLBufferPool();
+
+    // returns a buffer of at least size_in_bytes, capacity_in_bytes is its size class
+    cl_mem acquire(cl_context context, cl_command_queue queue, size_t size_in_bytes, size_t& capacity_in_bytes);
+    void release(cl_context context, cl_command_queue queue, cl_mem buffer, size_t capacity_in_bytes);
+
+    void set_high_water_mark(size_t bytes);
+    size_t get_high_water_mark() const;
+    // frees idle buffers, largest first, until at most max_idle_bytes stay pooled
+    void trim(size_t max_idle_bytes = 0u);
+    // frees every idle buffer of context and drops the pool's hold on its queues, call before clReleaseContext
+    void release_context(cl_context context);
+    void clear();
+
+    size_t get_num_hits() const;
+    size_t get_num_misses() const;
+    size_t get_idle_bytes() const;
+
+    // smallest power of two that holds size_in_bytes, at least MIN_SIZE_CLASS
+    static size_t get_size_class(size_t size_in_bytes);
+
+    static constexpr size_t MIN_SIZE_CLASS = 64u;
+    static constexpr size_t DEFAULT_HIGH_WATER_MARK = size_t{256} << 20;
+
+private:
+    OpenCLBufferPool() = default;
+
+    struct Entry
+    {
+        cl_mem           buffer;
+        cl_command_queue queue;      // queue that released the buffer, retained by the entry
+        bool             in_order;   // whether that queue executes commands in order
+        cl_event         ready;      // completes once the commands enqueued before release are done
+    };
+
+    static bool is_ready(const Entry& entry, cl_command_queue queue);
+    static void free_entry(Entry& entry);
+    void trim_locked(size_t max_idle_bytes);
+
+private:
+    using Key = std::pair<cl_context, size_t>;
+
+    mutable std::mutex              m_mutex;
+    std::map<Key, std::vector<Entry>> m_idle;
+    size_t                          m_idle_bytes = 0u;
+    size_t                          m_high_water_mark = DEFAULT_HIGH_WATER_MARK;
+    size_t                          m_num_hits = 0u;
+    size_t                          m_num_misses = 0u;
+};
+
+#endif  // OPENCL_BUFFER_POOL_H
@@ -0,0 +1,106 @@
+#include "OpenCLKernelCache.h"
+
+#include <iostream>
+#include <stdexcept>
+
+OpenCLKernelCache& OpenCLKernelCache::instance()
+{
+    static OpenCLKernelCache cache;
+    return cache;
+}
+
+OpenCLKernelCache::~OpenCLKernelCache()
+{
+    clear();
+}
+
+cl_kernel OpenCLKernelCache::acquire(cl_program program, const std::string& name)
+{
+    const auto key = Key(program, name);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& idle = m_idle[key];
+        if (!idle.empty())
+        {
+            const auto kernel = idle.back();
+            idle.pop_back();
+            return kernel;
+        }
+    }
+
+    // creating a kernel is slow, don't hold the lock meanwhile
+    cl_int err = CL_SUCCESS;
+    const auto kernel = clCreateKernel(program, name.c_str(), &err);
+    if (err != CL_SUCCESS || !kernel)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't create the " + name + " kernel");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_created[key].emplace_back(kernel);
+    ++m_num_created;
+    return kernel;
+}
+
+void OpenCLKernelCache::release(cl_program program, const std::string& name, cl_kernel kernel)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle[Key(program, name)].emplace_back(kernel);
+}
+
+void OpenCLKernelCache::release_program(cl_program program)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_created.begin(); it != m_created.end();)
+    {
+        if (it->first.first == program)
+        {
+            for (auto kernel : it->second)
+            {
+                clReleaseKernel(kernel);
+            }
+            m_idle.erase(it->first);
+            it = m_created.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void OpenCLKernelCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : m_created)
+    {
+        for (auto kernel : entry.second)
+        {
+            clReleaseKernel(kernel);
+        }
+    }
+    m_created.clear();
+    m_idle.clear();
+}
+
+size_t OpenCLKernelCache::get_num_created() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_created;
+}
+
+OpenCLKernel::OpenCLKernel(cl_program program, const char* name):
+    m_program(program), m_name(name), m_kernel(OpenCLKernelCache::instance().acquire(program, m_name))
+{
+}
+
+OpenCLKernel::~OpenCLKernel()
+{
+    OpenCLKernelCache::instance().release(m_program, m_name, m_kernel);
+}
+
+cl_kernel OpenCLKernel::get() const
+{
+    return m_kernel;
+}
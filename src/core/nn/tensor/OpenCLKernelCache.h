@@ -0,0 +1,71 @@
+#ifndef OPENCL_KERNEL_CACHE_H
+#define OPENCL_KERNEL_CACHE_H
+
+#include <CL/cl.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+* @brief  process-wide registry of cl_kernel objects, created once per program and kernel name
+* @note   clSetKernelArg on a kernel shared between threads is not thread-safe, so kernels are
+*         leased: a lease has exclusive use of its kernel until it goes out of scope.
+*         Arguments are captured by clEnqueueNDRangeKernel, so a kernel can be returned right
+*         after it is enqueued. A single-threaded caller reuses one kernel per name, concurrent
+*         callers get one kernel per name per concurrent lease.
+*/
+class OpenCLKernelCache
+{
+public:
+    static OpenCLKernelCache& instance();
+
+    OpenCLKernelCache(const OpenCLKernelCache&) = delete;
+    OpenCLKernelCache& operator=(const OpenCLKernelCache&) = delete;
+    ~OpenCLKernelCache();
+
+    // returns an idle kernel, creating one only if all existing ones are leased
+    cl_kernel acquire(cl_program program, const std::string& name);
+    void release(cl_program program, const std::string& name, cl_kernel kernel);
+
+    // releases every kernel of program, call before clReleaseProgram
+    void release_program(cl_program program);
+    void clear();
+
+    // number of clCreateKernel calls so far
+    size_t get_num_created() const;
+
+private:
+    OpenCLKernelCache() = default;
+
+private:
+    using Key = std::pair<cl_program, std::string>;
+
+    mutable std::mutex                     m_mutex;
+    std::map<Key, std::vector<cl_kernel>>  m_idle;      // kernels ready to be leased
+    std::map<Key, std::vector<cl_kernel>>  m_created;   // every kernel, for teardown
+    size_t                                 m_num_created = 0u;
+};
+
+/*
+* @brief  RAII lease of a cached kernel
+*/
+class OpenCLKernel
+{
+public:
+    OpenCLKernel(cl_program program, const char* name);
+    OpenCLKernel(const OpenCLKernel&) = delete;
+    OpenCLKernel& operator=(const OpenCLKernel&) = delete;
+    ~OpenCLKernel();
+
+    cl_kernel get() const;
+
+private:
+    cl_program  m_program;
+    std::string m_name;
+    cl_kernel   m_kernel;
+};
+
+#endif  // OPENCL_KERNEL_CACHE_H
@@ -1,498 +1,1493 @@
-#ifndef TENSOR_H
-#define TENSOR_H
-
-#include "../common.h"
-
-#include <vector>
-#include <iostream>
-#include <string>
-#include <sstream>
-#include <numeric>
-#include <algorithm>
-#include <memory>
-
-template<typename DATA_T>
-class Tensor
-{
-public:
-    Tensor(const Tensor<DATA_T>& other);
-    Tensor();
-    virtual ~Tensor() = default;
-
-    virtual PLATFORM get_platform() const;
-    virtual size_t get_size() const;
-    virtual const std::vector<size_t>& get_dims() const;
-
-    template<typename... Args>
-    const DATA_T& operator()(Args... indices) const
-    {
-        if (!is_indices_valid(std::forward<Args>(indices)...))
-        {
-            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-            throw std::invalid_argument("Passed indices are not valid");
-        }
-        const auto indices_vec = std::vector<size_t>({static_cast<size_t>(indices)...});
-        const auto index = calculate_index(indices_vec);
-        return  m_host_data[index];      
-    }
-    template<typename... Args>
-    DATA_T& operator()(Args... indices)
-    {
-        if (!is_indices_valid(std::forward<Args>(indices)...))
-        {
-            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-            throw std::invalid_argument("Passed indices are not valid");
-        }
-        const auto indices_vec = std::vector<size_t>({static_cast<size_t>(indices)...});
-        const auto index = calculate_index(indices_vec);
-        return  m_host_data[index];      
-    }
-
-    virtual void set_host_data(const std::vector<DATA_T>& h_data);
-    virtual void set_dims(const std::vector<size_t>& dims);
-    virtual void load_to_device();
-    virtual void load_to_host();
-
-    // operations
-    virtual void add(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
-    virtual void multiply(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
-
-    // activations
-    virtual void relu(Tensor<DATA_T>* result) const;
-    virtual void argmax(Tensor<DATA_T>* result) const;
-
-    virtual std::string to_string(bool platform=true, bool dim=true, bool total_size=true, bool data=false) const;
-    virtual Tensor<DATA_T>* clone() const;
-    virtual void swap(Tensor<DATA_T>* other_ptr);
-
-protected:
-    virtual void add_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
-    virtual void multiply_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
-    virtual void relu_on_host(Tensor<DATA_T>* result) const;
-    virtual void argmax_on_host(Tensor<DATA_T>* result) const;
-    virtual void add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
-    virtual void multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
-    virtual void relu_on_device(Tensor<DATA_T>* result) const;
-    virtual void argmax_on_device(Tensor<DATA_T>* result) const;
-
-    virtual bool is_operation_valid(const Tensor<DATA_T>* left, const Tensor<DATA_T>* right, const Tensor<DATA_T>* result, PLATFORM platform) const;
-private:
-    size_t calculate_index(const std::vector<size_t>& indices) const;
-    template<typename... Args>
-    bool is_indices_valid(Args... indices) const
-    {
-        return (sizeof...(indices) == m_dims.size());
-    }
-
-public:
-protected:
-    std::vector<DATA_T> m_host_data;                        // vector on the host side
-    std::vector<size_t> m_dims;                             // number of dimensions
-    size_t              m_size;                             // number of elements
-    PLATFORM            m_platform = PLATFORM::UNKNOWN;     // which device data is loaded to
-private:
-};
-
-template<typename DATA_T>
-Tensor<DATA_T>::Tensor(): m_host_data({}), m_dims({}), m_size(0), m_platform(PLATFORM::UNKNOWN)
-{
-}
-
-template<typename DATA_T>
-Tensor<DATA_T>::Tensor(const Tensor<DATA_T>& other)
-{
-    m_host_data = other.m_host_data;
-    m_dims      = other.m_dims;
-    m_size      = other.m_size;
-    m_platform  = other.m_platform;
-}
-
-template<typename DATA_T>
-Tensor<DATA_T>* Tensor<DATA_T>::clone() const
-{
-    return new Tensor<DATA_T>(*this);
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::swap(Tensor<DATA_T>* other_ptr)
-{
-    std::swap(m_host_data, other_ptr->m_host_data);
-    std::swap(m_dims, other_ptr->m_dims);
-    std::swap(m_size, other_ptr->m_size);
-    std::swap(m_platform, other_ptr->m_platform);
-}
-
-template<typename DATA_T>
-PLATFORM Tensor<DATA_T>::get_platform() const
-{
-    return m_platform;
-}
-
-template<typename DATA_T>
-size_t Tensor<DATA_T>::get_size() const
-{
-    return m_size;
-}
-
-template<typename DATA_T>
-const std::vector<size_t>& Tensor<DATA_T>::get_dims() const
-{
-    return m_dims;
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::set_dims(const std::vector<size_t>& dims)
-{
-    m_dims = dims;
-    m_size = std::accumulate(dims.cbegin(), dims.cend(), 1u, std::multiplies<size_t>());
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::set_host_data(const std::vector<DATA_T>& flattened_data)
-{
-    m_platform = PLATFORM::HOST;
-    m_host_data = flattened_data;
-    m_size = flattened_data.size();
-
-    size_t num_elements_from_dim = m_dims.empty() ? 0 : std::accumulate(m_dims.cbegin(), m_dims.cend(), 1u, std::multiplies<size_t>());
-    // if m_dims is empty or old
-    if (num_elements_from_dim != m_size)
-    {
-        // assume data is 1D
-        m_dims = {m_size, 1u};
-    }
-}
-
-template<typename DATA_T>
-bool Tensor<DATA_T>::is_operation_valid(const Tensor<DATA_T>* left, const Tensor<DATA_T>* right, const Tensor<DATA_T>* result, PLATFORM platform) const
-{
-    const auto this_plat   = left->get_platform();
-    const auto result_plat = result->get_platform();
-
-    if (!(this_plat == result_plat && this_plat == platform))
-    {
-        return false;
-    }
-
-    if (right != nullptr)
-    {
-        const auto other_plat  = right->get_platform();
-        if (this_plat != other_plat)
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::add(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    if (!is_operation_valid(this, other, result, m_platform))
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Not all tensors are on the same platform");
-    }
-    
-    // check if dimensions are valid
-    const auto other_dims = other->get_dims(); 
-    if (!(m_dims.size() == 2 && other_dims.size() == 2 && m_dims[0] == other_dims[0] && m_dims[1] == other_dims[1]))
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Invalid dimensions");
-    }
-
-    result->set_dims(m_dims);
-
-    switch (m_platform)
-    {
-        case PLATFORM::HOST:
-            add_on_host(other, result);
-            break;
-        case PLATFORM::DEVICE:
-            add_on_device(other, result);
-            break;
-        default:
-            std::cerr << "Unsupported platform!";
-    }
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::multiply(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    if (!is_operation_valid(this, other, result, m_platform))
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Not all tensors are on the same platform");
-    }
-    
-    // check if dimensions are valid
-    const auto other_dims = other->get_dims(); 
-    if (!(m_dims.size() == 2 && other_dims.size() == 2 && m_dims[1] == other_dims[0]))
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Invalid dimensions");
-    }
-
-    result->set_dims({m_dims[0], other_dims[1]});
-
-    switch (m_platform)
-    {
-        case PLATFORM::HOST:
-            multiply_on_host(other, result);
-            break;
-        case PLATFORM::DEVICE:
-            multiply_on_device(other, result);
-            break;
-        default:
-            std::cerr << "Unsupported platform!";
-    }
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::relu(Tensor<DATA_T>* result) const
-{
-    if (!is_operation_valid(this, nullptr, result, m_platform))
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Not all tensors are on the same platform");
-    }
-
-    result->set_dims(m_dims);
-
-    switch (m_platform)
-    {
-        case PLATFORM::HOST:
-            relu_on_host(result);
-            break;
-        case PLATFORM::DEVICE:
-            relu_on_device(result);
-            break;
-        default:
-            std::cerr << "Unsupported platform!";
-    }
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::argmax(Tensor<DATA_T>* result) const
-{
-    if (!is_operation_valid(this, nullptr, result, m_platform))
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Not all tensors are on the same platform");
-    }
-
-    // at least one of the dimensions must be one
-    if (!(m_dims[0] == 1 || m_dims[1] == 1))
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::invalid_argument("Input must be a vector");
-    }
-
-
-    result->set_dims({1, 1});
-
-    switch (m_platform)
-    {
-        case PLATFORM::HOST:
-            argmax_on_host(result);
-            break;
-        case PLATFORM::DEVICE:
-            argmax_on_device(result);
-            break;
-        default:
-            std::cerr << "Unsupported platform!";
-    }
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::add_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    // std::transform(m_host_data.begin(), m_host_data.begin() + get_size(), other->m_host_data.begin(), result->m_host_data.begin(), std::plus<DATA_T>());
-    for (auto i = 0u; i < m_dims[0]; ++i)
-    {
-        for (auto j = 0u; j < m_dims[1]; ++j)
-        {
-            (*result)(i, j) = (*this)(i, j) + (*other)(i, j);
-        }
-    }
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::multiply_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    for (auto i = 0u; i < m_dims[0]; ++i)
-    {
-        for (auto j = 0u; j < other->m_dims[1]; ++j)
-        {
-            DATA_T sum = static_cast<DATA_T>(0);
-            for (auto k = 0u; k < m_dims[1]; ++k)
-            {
-                sum += (*this)(i, k) * (*other)(k, j);
-            }
-            (*result)(i, j) = sum;
-        }
-    }
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    // to be overwritten by derived classes if needed
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    // to be overwritten by derived classes if needed
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::relu_on_host(Tensor<DATA_T>* result) const
-{
-    for (auto i = 0u; i < m_dims[0]; ++i)
-    {
-        for (auto j = 0u; j < m_dims[1]; ++j)
-        {
-            (*result)(i, j) = std::max(static_cast<DATA_T>(0), (*this)(i, j));
-        }
-    }
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::relu_on_device(Tensor<DATA_T>* result) const
-{
-    // to be overwritten by derived classes if needed
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::argmax_on_host(Tensor<DATA_T>* result) const
-{
-    const auto max_iter = std::max_element(m_host_data.begin(), m_host_data.begin() + m_size);
-    (*result)(0, 0) = std::distance(m_host_data.begin(), max_iter);
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::argmax_on_device(Tensor<DATA_T>* result) const
-{
-    // to be overwritten by derived classes if needed
-}
-
-template<typename DATA_T>
-std::string Tensor<DATA_T>::to_string(bool platform, bool dim, bool total_size, bool data) const
-{
-    std::ostringstream oss;
-
-    if (platform)
-    {
-        oss << "platform: ";
-        switch (m_platform)
-        {
-            case PLATFORM::HOST:
-                oss << "Host";
-                break;
-            case PLATFORM::DEVICE:
-                oss << "Device";
-                break;
-            default:
-                oss << "Unknown";
-                break;
-        }
-        oss << " ";
-    }
-
-    if (dim)
-    {
-        oss << "dim: {";
-        for (auto i = 0; i < m_dims.size(); ++i)
-        {
-            oss << m_dims[i];
-            if (i != m_dims.size() - 1)
-            {
-                oss << ", ";
-            }
-        }
-        oss << "} ";
-    }
-
-    if (total_size)
-    {
-        oss << "size: " << m_size << " ";
-    }
-
-    if (data)
-    {
-        oss << "host data: ";
-        if (m_platform != PLATFORM::HOST)
-        {
-            oss << "not on host. ";
-        }
-        else if (m_dims.size() > 2)
-        {
-            oss << "only matrix data is supported.";
-        }
-        else
-        {
-            oss << "{";
-            for (auto i = 0u; i < m_dims[0]; ++i)
-            {
-                oss << "{";
-                for (auto j = 0u; j < m_dims[1]; ++j)
-                {
-                    oss << (*this)(i, j);
-                    if (j != m_dims[1] - 1)
-                    {
-                        oss << ", ";
-                    }
-                }
-                oss << "}";
-                if (i != m_dims[0] - 1)
-                {
-                    oss << ", ";
-                }
-            }
-            oss << "}";
-        }
-    }
-
-    if (platform || dim || total_size || data)
-    {
-        oss << "\n";
-    }
-
-    return oss.str();
-}
-
-template<typename DATA_T>
-size_t Tensor<DATA_T>::calculate_index(const std::vector<size_t>& indices) const
-{
-    // Start with 0 index.
-    size_t idx = 0;
-    
-    // Calculate the flattened index from multi-dimensional indices.
-    for (auto i = 0u; i < indices.size(); ++i)
-    {
-        // Add the current index, scaled by the product of the subsequent dimensions.
-        size_t scale = 1;
-        for (auto j = i + 1; j < m_dims.size(); ++j)
-        {
-            scale *= m_dims[j];
-        }
-        idx += indices[i] * scale;
-    }
-    return idx;
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::load_to_host()
-{
-    m_platform = PLATFORM::HOST;
-}
-
-template<typename DATA_T>
-void Tensor<DATA_T>::load_to_device()
-{
-    m_platform = PLATFORM::DEVICE;
-}
-
+#ifndef TENSOR_H
+#define TENSOR_H
+
+#include "../common.h"
+#include "../kernels/Gemm.h"
+#include "../kernels/Winograd.h"
+#include "../kernels/GemmInt8.h"
+#include "../kernels/GemmHalf.h"
+#include "../kernels/Elementwise.h"
+#include "../kernels/ThreadPool.h"
+#include "TensorView.h"
+
+#include <vector>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <numeric>
+#include <algorithm>
+#include <memory>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+
+template<typename DATA_T>
+class Tensor
+{
+public:
+    Tensor(const Tensor<DATA_T>& other);
+    Tensor();
+    virtual ~Tensor() = default;
+
+    virtual PLATFORM get_platform() const;
+    virtual size_t get_size() const;
+    virtual const std::vector<size_t>& get_dims() const;
+
+    template<typename... Args>
+    const DATA_T& operator()(Args... indices) const
+    {
+        if (!is_indices_valid(std::forward<Args>(indices)...))
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::invalid_argument("Passed indices are not valid");
+        }
+        return  data()[calculate_index(indices...)];
+    }
+    template<typename... Args>
+    DATA_T& operator()(Args... indices)
+    {
+        if (!is_indices_valid(std::forward<Args>(indices)...))
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::invalid_argument("Passed indices are not valid");
+        }
+        return  data()[calculate_index(indices...)];
+    }
+
+    // allocation-free access to the host data, RANK must match the number of dimensions
+    template<size_t RANK>
+    TensorView<DATA_T, RANK> view();
+    template<size_t RANK>
+    TensorView<const DATA_T, RANK> view() const;
+    virtual DATA_T* data();
+    virtual const DATA_T* data() const;
+
+    virtual void set_host_data(const std::vector<DATA_T>& h_data);
+    // zero-copy: point the host data at memory owned by someone else (e.g. a mapped model file)
+    // owner keeps that memory alive for as long as this tensor or any of its copies use it
+    virtual void set_external_host_data(DATA_T* h_data, size_t size, std::shared_ptr<void> owner);
+    virtual bool is_host_data_external() const;
+    virtual void set_dims(const std::vector<size_t>& dims);
+    virtual void load_to_device();
+    virtual void load_to_host();
+    // non-blocking transfers where the platform supports them, the host data must stay untouched
+    // until wait() returns; the defaults are the blocking transfers
+    virtual void load_to_device_async();
+    virtual void load_to_host_async();
+    // blocks until pending transfers and ops that write this tensor are done
+    virtual void wait() const;
+    // blocking copies between tensors on different platforms: this tensor's data into a host result,
+    // and a host source into this tensor on its platform. The dims follow the source
+    virtual void copy_to_host(Tensor<DATA_T>* result) const;
+    virtual void copy_from_host(const Tensor<DATA_T>* source);
+
+    // operations
+    // other is either the same shape or a {1, N} row that is broadcast over every row
+    virtual void add(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    virtual void multiply(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    // this * transpose(other), for weights stored as {out, in} like TFLite does
+    virtual void multiply_transposed(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    // fused this * weight + bias (+ relu) in a single pass over the result
+    virtual void dense(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                       bool transpose_weight = false, bool relu = false) const;
+    // dense with 16-bit weights stored as {out, in} (see GemmHalfHost), widened to fp32 while they are read
+    virtual void half_dense(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                            Tensor<DATA_T>* result, bool relu = false) const;
+    // unfolds the convolution windows of an NHWC tensor into the rows of a
+    // {batch * out_h * out_w, kernel_h * kernel_w * channels} matrix, padding reads as zero
+    virtual void im2col(const Conv2DParams& params, Tensor<DATA_T>* result) const;
+    // 3x3 stride-1 convolution of an NHWC tensor via Winograd F(2x2, 3x3), weight holds the transformed
+    // filters as {16 * in_channels, out_channels} (see WinogradHost::transform_filter); scratch is resized
+    // to {16 * tiles, in_channels + out_channels}
+    virtual void winograd_conv2d(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                 Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu = false) const;
+    // int8 GEMM of a float {m, k} tensor, quantized while it is read, and transpose(weight), weight is {n, k}.
+    // requant is {3, n}: the bias with the input zero point folded in, then the multipliers and the shifts
+    // of GemmInt8Epilogue. The result is written dequantized (see GemmInt8Epilogue)
+    virtual void quantized_dense(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant, const QuantizedGemmParams& params,
+                                 Tensor<DATA_T>* result) const;
+    // max or average over the windows of an NHWC tensor, taps in the padding are left out
+    virtual void pool2d(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const;
+    // zero-copy: result becomes a view of this tensor's data with other dims of the same size, on this
+    // tensor's platform. It stays valid for as long as this tensor keeps its data
+    virtual void reshape(const std::vector<size_t>& dims, Tensor<DATA_T>* result) const;
+
+    // activations
+    virtual void relu(Tensor<DATA_T>* result) const;
+    // one index per row of a {batch, N} matrix, a single index for a column vector
+    virtual void argmax(Tensor<DATA_T>* result) const;
+    // normalized exponentials of every row of a {batch, N} matrix, of a column vector as a whole
+    virtual void softmax(Tensor<DATA_T>* result) const;
+
+    virtual std::string to_string(bool platform=true, bool dim=true, bool total_size=true, bool data=false) const;
+    virtual Tensor<DATA_T>* clone() const;
+    virtual void swap(Tensor<DATA_T>* other_ptr);
+
+    // memory planning: a data-less tensor of the same kind, an arena allocation on the current
+    // platform, and windows into an arena that ops then write in place
+    virtual Tensor<DATA_T>* create_empty() const;
+    // the same for the element types of quantized weights and their requantization data
+    virtual Tensor<int8_t>* create_empty_int8() const;
+    virtual Tensor<int32_t>* create_empty_int32() const;
+    // and for fp16 / bf16 weights
+    virtual Tensor<uint16_t>* create_empty_uint16() const;
+    virtual void allocate(const std::vector<size_t>& dims);
+    virtual void alias(Tensor<DATA_T>* arena, size_t offset, const std::vector<size_t>& dims);
+    // offsets into an arena must be multiples of this many elements
+    virtual size_t get_alignment() const;
+
+protected:
+    virtual void add_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    virtual void multiply_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    virtual void multiply_transposed_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    virtual void dense_on_host(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                               bool transpose_weight, bool relu) const;
+    virtual void half_dense_on_host(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                                    Tensor<DATA_T>* result, bool relu) const;
+    virtual void im2col_on_host(const Conv2DParams& params, Tensor<DATA_T>* result) const;
+    virtual void winograd_conv2d_on_host(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                         Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu) const;
+    virtual void quantized_dense_on_host(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant,
+                                         const QuantizedGemmParams& params, Tensor<DATA_T>* result) const;
+    virtual void pool2d_on_host(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const;
+    virtual void reshape_on_host(Tensor<DATA_T>* result) const;
+    virtual void relu_on_host(Tensor<DATA_T>* result) const;
+    virtual void argmax_on_host(Tensor<DATA_T>* result) const;
+    virtual void softmax_on_host(Tensor<DATA_T>* result) const;
+    virtual void add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    virtual void multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    virtual void multiply_transposed_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const;
+    virtual void dense_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                                 bool transpose_weight, bool relu) const;
+    virtual void half_dense_on_device(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                                      Tensor<DATA_T>* result, bool relu) const;
+    virtual void im2col_on_device(const Conv2DParams& params, Tensor<DATA_T>* result) const;
+    virtual void winograd_conv2d_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                           Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu) const;
+    virtual void quantized_dense_on_device(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant,
+                                           const QuantizedGemmParams& params, Tensor<DATA_T>* result) const;
+    virtual void pool2d_on_device(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const;
+    virtual void reshape_on_device(Tensor<DATA_T>* result) const;
+    virtual void relu_on_device(Tensor<DATA_T>* result) const;
+    virtual void argmax_on_device(Tensor<DATA_T>* result) const;
+    virtual void softmax_on_device(Tensor<DATA_T>* result) const;
+    // m_size elements between the device data and host memory
+    virtual void read_on_device(DATA_T* h_data) const;
+    virtual void write_on_device(const DATA_T* h_data);
+
+    // makes the host buffer hold size elements, external data is written in place if it is large
+    // enough (arena windows) and dropped otherwise
+    virtual void resize_host_data(size_t size);
+    // number of rows argmax and softmax reduce, a column vector is reduced as a whole
+    size_t get_argmax_rows() const;
+
+    virtual bool is_operation_valid(const Tensor<DATA_T>* left, const Tensor<DATA_T>* right, const Tensor<DATA_T>* result, PLATFORM platform) const;
+private:
+    template<typename... Args>
+    size_t calculate_index(Args... indices) const
+    {
+        size_t index = 0u;
+        size_t axis  = 0u;
+        ((index += static_cast<size_t>(indices) * m_strides[axis++]), ...);
+        return index;
+    }
+    void update_strides();
+    template<size_t RANK>
+    void check_view_rank() const;
+    template<typename... Args>
+    bool is_indices_valid(Args... indices) const
+    {
+        return (sizeof...(indices) == m_dims.size());
+    }
+
+public:
+protected:
+    std::vector<DATA_T> m_host_data;                        // vector on the host side
+    DATA_T*             m_external_data = nullptr;          // non-owning host data, used instead of m_host_data if set
+    std::shared_ptr<void> m_external_owner;                 // keeps m_external_data alive
+    size_t              m_external_size = 0u;               // number of elements behind m_external_data
+    std::vector<size_t> m_dims;                             // number of dimensions
+    std::vector<size_t> m_strides;                          // row-major strides, cached from m_dims
+    size_t              m_size;                             // number of elements
+    PLATFORM            m_platform = PLATFORM::UNKNOWN;     // which device data is loaded to
+private:
+};
+
+template<typename DATA_T>
+Tensor<DATA_T>::Tensor(): m_host_data({}), m_dims({}), m_strides({}), m_size(0), m_platform(PLATFORM::UNKNOWN)
+{
+}
+
+template<typename DATA_T>
+Tensor<DATA_T>::Tensor(const Tensor<DATA_T>& other)
+{
+    m_host_data = other.m_host_data;
+    m_external_data  = other.m_external_data;
+    m_external_owner = other.m_external_owner;
+    m_external_size  = other.m_external_size;
+    m_dims      = other.m_dims;
+    m_strides   = other.m_strides;
+    m_size      = other.m_size;
+    m_platform  = other.m_platform;
+}
+
+template<typename DATA_T>
+Tensor<DATA_T>* Tensor<DATA_T>::clone() const
+{
+    return new Tensor<DATA_T>(*this);
+}
+
+template<typename DATA_T>
+Tensor<DATA_T>* Tensor<DATA_T>::create_empty() const
+{
+    return new Tensor<DATA_T>();
+}
+
+template<typename DATA_T>
+Tensor<int8_t>* Tensor<DATA_T>::create_empty_int8() const
+{
+    return new Tensor<int8_t>();
+}
+
+template<typename DATA_T>
+Tensor<int32_t>* Tensor<DATA_T>::create_empty_int32() const
+{
+    return new Tensor<int32_t>();
+}
+
+template<typename DATA_T>
+Tensor<uint16_t>* Tensor<DATA_T>::create_empty_uint16() const
+{
+    return new Tensor<uint16_t>();
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::allocate(const std::vector<size_t>& dims)
+{
+    set_dims(dims);
+    resize_host_data(m_size);
+    m_platform = PLATFORM::HOST;
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::alias(Tensor<DATA_T>* arena, size_t offset, const std::vector<size_t>& dims)
+{
+    set_dims(dims);
+    if (offset + m_size > arena->get_size())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::out_of_range("Alias does not fit into the arena");
+    }
+    // the arena outlives its windows, so no owner is needed
+    set_external_host_data(arena->data() + offset, m_size, nullptr);
+}
+
+template<typename DATA_T>
+size_t Tensor<DATA_T>::get_alignment() const
+{
+    // one cache line
+    return std::max<size_t>(64u / sizeof(DATA_T), 1u);
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::swap(Tensor<DATA_T>* other_ptr)
+{
+    std::swap(m_host_data, other_ptr->m_host_data);
+    std::swap(m_external_data, other_ptr->m_external_data);
+    std::swap(m_external_owner, other_ptr->m_external_owner);
+    std::swap(m_external_size, other_ptr->m_external_size);
+    std::swap(m_dims, other_ptr->m_dims);
+    std::swap(m_strides, other_ptr->m_strides);
+    std::swap(m_size, other_ptr->m_size);
+    std::swap(m_platform, other_ptr->m_platform);
+}
+
+template<typename DATA_T>
+PLATFORM Tensor<DATA_T>::get_platform() const
+{
+    return m_platform;
+}
+
+template<typename DATA_T>
+size_t Tensor<DATA_T>::get_size() const
+{
+    return m_size;
+}
+
+template<typename DATA_T>
+const std::vector<size_t>& Tensor<DATA_T>::get_dims() const
+{
+    return m_dims;
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::set_dims(const std::vector<size_t>& dims)
+{
+    m_dims = dims;
+    m_size = std::accumulate(dims.cbegin(), dims.cend(), size_t{1}, std::multiplies<size_t>());
+    update_strides();
+}
+
+template<typename DATA_T>
+size_t Tensor<DATA_T>::get_argmax_rows() const
+{
+    return m_dims[1] == 1 ? 1u : m_dims[0];
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::update_strides()
+{
+    m_strides.resize(m_dims.size());
+    size_t stride = 1u;
+    for (auto axis = m_dims.size(); axis-- > 0u;)
+    {
+        m_strides[axis] = stride;
+        stride *= m_dims[axis];
+    }
+}
+
+template<typename DATA_T>
+DATA_T* Tensor<DATA_T>::data()
+{
+    return m_external_data ? m_external_data : m_host_data.data();
+}
+
+template<typename DATA_T>
+const DATA_T* Tensor<DATA_T>::data() const
+{
+    return m_external_data ? m_external_data : m_host_data.data();
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::resize_host_data(size_t size)
+{
+    if (m_external_data && size <= m_external_size)
+    {
+        return;
+    }
+    m_external_data = nullptr;
+    m_external_owner.reset();
+    m_external_size = 0u;
+    m_host_data.resize(size);
+}
+
+template<typename DATA_T>
+template<size_t RANK>
+void Tensor<DATA_T>::check_view_rank() const
+{
+    if (m_dims.size() != RANK)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("View rank does not match the tensor dimensions");
+    }
+}
+
+template<typename DATA_T>
+template<size_t RANK>
+TensorView<DATA_T, RANK> Tensor<DATA_T>::view()
+{
+    check_view_rank<RANK>();
+    std::array<size_t, RANK> dims{};
+    std::copy(m_dims.cbegin(), m_dims.cend(), dims.begin());
+    return TensorView<DATA_T, RANK>(data(), dims);
+}
+
+template<typename DATA_T>
+template<size_t RANK>
+TensorView<const DATA_T, RANK> Tensor<DATA_T>::view() const
+{
+    check_view_rank<RANK>();
+    std::array<size_t, RANK> dims{};
+    std::copy(m_dims.cbegin(), m_dims.cend(), dims.begin());
+    return TensorView<const DATA_T, RANK>(data(), dims);
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::set_host_data(const std::vector<DATA_T>& flattened_data)
+{
+    m_platform = PLATFORM::HOST;
+    m_external_data = nullptr;
+    m_external_owner.reset();
+    m_external_size = 0u;
+    m_host_data = flattened_data;
+    m_size = flattened_data.size();
+
+    size_t num_elements_from_dim = m_dims.empty() ? 0 : std::accumulate(m_dims.cbegin(), m_dims.cend(), size_t{1}, std::multiplies<size_t>());
+    // if m_dims is empty or old
+    if (num_elements_from_dim != m_size)
+    {
+        // assume data is 1D
+        m_dims = {m_size, 1u};
+        update_strides();
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::set_external_host_data(DATA_T* h_data, size_t size, std::shared_ptr<void> owner)
+{
+    m_platform = PLATFORM::HOST;
+    m_host_data.clear();
+    m_host_data.shrink_to_fit();
+    m_external_data  = h_data;
+    m_external_owner = std::move(owner);
+    m_external_size  = size;
+    m_size = size;
+
+    size_t num_elements_from_dim = m_dims.empty() ? 0 : std::accumulate(m_dims.cbegin(), m_dims.cend(), size_t{1}, std::multiplies<size_t>());
+    if (num_elements_from_dim != m_size)
+    {
+        m_dims = {m_size, 1u};
+        update_strides();
+    }
+}
+
+template<typename DATA_T>
+bool Tensor<DATA_T>::is_host_data_external() const
+{
+    return m_external_data != nullptr;
+}
+
+template<typename DATA_T>
+bool Tensor<DATA_T>::is_operation_valid(const Tensor<DATA_T>* left, const Tensor<DATA_T>* right, const Tensor<DATA_T>* result, PLATFORM platform) const
+{
+    const auto this_plat   = left->get_platform();
+    const auto result_plat = result->get_platform();
+
+    if (!(this_plat == result_plat && this_plat == platform))
+    {
+        return false;
+    }
+
+    if (right != nullptr)
+    {
+        const auto other_plat  = right->get_platform();
+        if (this_plat != other_plat)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::add(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, other, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+    
+    // check if dimensions are valid, a single row is broadcast over the batch
+    const auto other_dims = other->get_dims(); 
+    if (!(m_dims.size() == 2 && other_dims.size() == 2 && m_dims[1] == other_dims[1] &&
+          (m_dims[0] == other_dims[0] || other_dims[0] == 1)))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Invalid dimensions");
+    }
+
+    result->set_dims(m_dims);
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            add_on_host(other, result);
+            break;
+        case PLATFORM::DEVICE:
+            add_on_device(other, result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::multiply(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, other, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+    
+    // check if dimensions are valid
+    const auto other_dims = other->get_dims(); 
+    if (!(m_dims.size() == 2 && other_dims.size() == 2 && m_dims[1] == other_dims[0]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Invalid dimensions");
+    }
+
+    result->set_dims({m_dims[0], other_dims[1]});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            multiply_on_host(other, result);
+            break;
+        case PLATFORM::DEVICE:
+            multiply_on_device(other, result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::multiply_transposed(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, other, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    // check if dimensions are valid
+    const auto other_dims = other->get_dims();
+    if (!(m_dims.size() == 2 && other_dims.size() == 2 && m_dims[1] == other_dims[1]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Invalid dimensions");
+    }
+
+    result->set_dims({m_dims[0], other_dims[0]});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            multiply_transposed_on_host(other, result);
+            break;
+        case PLATFORM::DEVICE:
+            multiply_transposed_on_device(other, result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::dense(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                           bool transpose_weight, bool relu) const
+{
+    if (!is_operation_valid(this, weight, result, m_platform) || bias->get_platform() != m_platform)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    // check if dimensions are valid
+    const auto weight_dims = weight->get_dims();
+    const auto inner_dim   = transpose_weight ? 1u : 0u;
+    const auto num_outputs = transpose_weight ? weight_dims[0] : weight_dims[1];
+    if (!(m_dims.size() == 2 && weight_dims.size() == 2 && m_dims[1] == weight_dims[inner_dim] && bias->get_size() == num_outputs))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Invalid dimensions");
+    }
+
+    result->set_dims({m_dims[0], num_outputs});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            dense_on_host(weight, bias, result, transpose_weight, relu);
+            break;
+        case PLATFORM::DEVICE:
+            dense_on_device(weight, bias, result, transpose_weight, relu);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::half_dense(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                                Tensor<DATA_T>* result, bool relu) const
+{
+    if (weight->get_platform() != m_platform || bias->get_platform() != m_platform || result->get_platform() != m_platform)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+    if (format != WEIGHT_FORMAT::FP16 && format != WEIGHT_FORMAT::BF16)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("16-bit weights must be FP16 or BF16");
+    }
+
+    // check if dimensions are valid
+    const auto& weight_dims = weight->get_dims();
+    if (!(m_dims.size() == 2 && weight_dims.size() == 2 && m_dims[1] == weight_dims[1] && bias->get_size() == weight_dims[0]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Invalid dimensions");
+    }
+
+    result->set_dims({m_dims[0], weight_dims[0]});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            half_dense_on_host(weight, format, bias, result, relu);
+            break;
+        case PLATFORM::DEVICE:
+            half_dense_on_device(weight, format, bias, result, relu);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::im2col(const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, nullptr, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    if (m_dims.size() != 4 || params.out_h == 0 || params.out_w == 0 || params.stride_h == 0 || params.stride_w == 0)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be an NHWC tensor and the output must not be empty");
+    }
+
+    result->set_dims({m_dims[0] * params.out_h * params.out_w, params.kernel_h * params.kernel_w * m_dims[3]});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            im2col_on_host(params, result);
+            break;
+        case PLATFORM::DEVICE:
+            im2col_on_device(params, result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::winograd_conv2d(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                     Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu) const
+{
+    if (!is_operation_valid(this, weight, result, m_platform) || bias->get_platform() != m_platform ||
+        scratch->get_platform() != m_platform)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    // check if dimensions are valid
+    const auto& weight_dims = weight->get_dims();
+    if (!(m_dims.size() == 4 && params.kernel_h == 3 && params.kernel_w == 3 && params.stride_h == 1 && params.stride_w == 1 &&
+          params.dilation_h == 1 && params.dilation_w == 1 && params.out_h > 0 && params.out_w > 0 &&
+          weight_dims.size() == 2 && weight_dims[0] == WinogradHost<DATA_T>::NUM_XI * m_dims[3] &&
+          bias->get_size() == weight_dims[1]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Invalid dimensions");
+    }
+
+    const auto num_tiles = m_dims[0] * ((params.out_h + 1) / 2) * ((params.out_w + 1) / 2);
+    scratch->set_dims({WinogradHost<DATA_T>::NUM_XI * num_tiles, m_dims[3] + weight_dims[1]});
+    result->set_dims({m_dims[0], params.out_h, params.out_w, weight_dims[1]});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            winograd_conv2d_on_host(weight, bias, params, scratch, result, relu);
+            break;
+        case PLATFORM::DEVICE:
+            winograd_conv2d_on_device(weight, bias, params, scratch, result, relu);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::quantized_dense(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant, const QuantizedGemmParams& params,
+                                     Tensor<DATA_T>* result) const
+{
+    if (weight->get_platform() != m_platform || requant->get_platform() != m_platform || result->get_platform() != m_platform)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    // check if dimensions are valid
+    const auto& weight_dims = weight->get_dims();
+    const auto& requant_dims = requant->get_dims();
+    if (!(m_dims.size() == 2 && weight_dims.size() == 2 && m_dims[1] == weight_dims[1] &&
+          requant_dims.size() == 2 && requant_dims[0] == 3 && requant_dims[1] == weight_dims[0]))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Invalid dimensions");
+    }
+
+    result->set_dims({m_dims[0], weight_dims[0]});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            quantized_dense_on_host(weight, requant, params, result);
+            break;
+        case PLATFORM::DEVICE:
+            quantized_dense_on_device(weight, requant, params, result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::pool2d(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, nullptr, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    if (m_dims.size() != 4 || params.out_h == 0 || params.out_w == 0 || params.stride_h == 0 || params.stride_w == 0 ||
+        params.dilation_h != 1 || params.dilation_w != 1)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be an NHWC tensor, the output must not be empty and windows can't be dilated");
+    }
+
+    result->set_dims({m_dims[0], params.out_h, params.out_w, m_dims[3]});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            pool2d_on_host(pooling, params, result);
+            break;
+        case PLATFORM::DEVICE:
+            pool2d_on_device(pooling, params, result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::reshape(const std::vector<size_t>& dims, Tensor<DATA_T>* result) const
+{
+    // result may be on any platform, it becomes a view on this one
+    if (std::accumulate(dims.cbegin(), dims.cend(), size_t{1}, std::multiplies<size_t>()) != m_size)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Reshape must keep the number of elements");
+    }
+
+    result->set_dims(dims);
+    if (result == this)
+    {
+        return;
+    }
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            reshape_on_host(result);
+            break;
+        case PLATFORM::DEVICE:
+            reshape_on_device(result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::relu(Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, nullptr, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    result->set_dims(m_dims);
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            relu_on_host(result);
+            break;
+        case PLATFORM::DEVICE:
+            relu_on_device(result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::argmax(Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, nullptr, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    if (m_dims.size() != 2)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be a matrix");
+    }
+
+    // every row of the batch is reduced on its own
+    result->set_dims({get_argmax_rows(), 1});
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            argmax_on_host(result);
+            break;
+        case PLATFORM::DEVICE:
+            argmax_on_device(result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::softmax(Tensor<DATA_T>* result) const
+{
+    if (!is_operation_valid(this, nullptr, result, m_platform))
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Not all tensors are on the same platform");
+    }
+
+    if (m_dims.size() != 2)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Input must be a matrix");
+    }
+
+    result->set_dims(m_dims);
+
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            softmax_on_host(result);
+            break;
+        case PLATFORM::DEVICE:
+            softmax_on_device(result);
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::add_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    result->resize_host_data(m_size);
+
+    // all three tensors are dense, so they can be walked as flat spans
+    const auto lhs = view<2>();
+    const auto rhs = other->template view<2>();
+    const auto out = result->template view<2>();
+    // a row broadcast, e.g. a bias added to every sample of a batch, adds rhs once per row
+    const auto rows = rhs.dim(0) == lhs.dim(0) ? 1u : lhs.dim(0);
+    const auto length = lhs.size() / rows;
+    if constexpr (std::is_same<DATA_T, float>::value)
+    {
+        // large adds are split across the thread pool, whole rows at a time when rhs is broadcast
+        const auto pool = ThreadPool::get_default();
+        if (rows == 1u)
+        {
+            pool->parallel_for(0u, length, ElementwiseHost::PARALLEL_GRAIN, [&](size_t first, size_t last)
+            {
+                ElementwiseHost::add(lhs.data() + first, rhs.data() + first, out.data() + first, last - first);
+            });
+        }
+        else
+        {
+            pool->parallel_for(0u, rows, std::max<size_t>(1u, ElementwiseHost::PARALLEL_GRAIN / length), [&](size_t first, size_t last)
+            {
+                for (auto row = first; row < last; ++row)
+                {
+                    ElementwiseHost::add(lhs.data() + row * length, rhs.data(), out.data() + row * length, length);
+                }
+            });
+        }
+    }
+    else
+    {
+        for (auto row = 0u; row < rows; ++row)
+        {
+            std::transform(lhs.data() + row * length, lhs.data() + (row + 1) * length, rhs.data(), out.data() + row * length,
+                           std::plus<DATA_T>());
+        }
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::multiply_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    result->resize_host_data(m_dims[0] * other->m_dims[1]);
+
+    const auto lhs = view<2>();
+    const auto rhs = other->template view<2>();
+    const auto out = result->template view<2>();
+    GemmHost<DATA_T>::multiply(lhs.dim(0), rhs.dim(1), lhs.dim(1),
+                               {lhs.data(), lhs.stride(0), lhs.stride(1)},
+                               {rhs.data(), rhs.stride(0), rhs.stride(1)},
+                               out.data(), out.stride(0));
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::multiply_transposed_on_host(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    result->resize_host_data(m_dims[0] * other->m_dims[0]);
+
+    // same GEMM, B is read through a transposed view instead of being copied
+    const auto lhs = view<2>();
+    const auto rhs = other->template view<2>().transpose(0, 1);
+    const auto out = result->template view<2>();
+    GemmHost<DATA_T>::multiply(lhs.dim(0), rhs.dim(1), lhs.dim(1),
+                               {lhs.data(), lhs.stride(0), lhs.stride(1)},
+                               {rhs.data(), rhs.stride(0), rhs.stride(1)},
+                               out.data(), out.stride(0));
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::dense_on_host(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                                   bool transpose_weight, bool relu) const
+{
+    const auto lhs = view<2>();
+    const auto rhs = transpose_weight ? weight->template view<2>().transpose(0, 1) : weight->template view<2>();
+    result->resize_host_data(lhs.dim(0) * rhs.dim(1));
+    const auto out = result->template view<2>();
+
+    GemmEpilogue<DATA_T> epilogue;
+    epilogue.bias = bias->data();
+    epilogue.relu = relu;
+    GemmHost<DATA_T>::multiply(lhs.dim(0), rhs.dim(1), lhs.dim(1),
+                               {lhs.data(), lhs.stride(0), lhs.stride(1)},
+                               {rhs.data(), rhs.stride(0), rhs.stride(1)},
+                               out.data(), out.stride(0), 0, epilogue);
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::half_dense_on_host(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                                        Tensor<DATA_T>* result, bool relu) const
+{
+    if constexpr (std::is_same<DATA_T, float>::value)
+    {
+        const auto num_outputs = weight->get_dims()[0];
+        result->resize_host_data(m_dims[0] * num_outputs);
+
+        GemmEpilogue<float> epilogue;
+        epilogue.bias = bias->data();
+        epilogue.relu = relu;
+        GemmHalfHost::multiply(m_dims[0], num_outputs, m_dims[1], data(), m_dims[1], weight->data(), format,
+                               result->data(), num_outputs, epilogue);
+    }
+    else
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("16-bit weights are only multiplied with float inputs");
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::multiply_transposed_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::dense_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                                     bool transpose_weight, bool relu) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::im2col_on_host(const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    result->resize_host_data(result->get_size());
+
+    const auto in  = view<4>();
+    const auto out = result->template view<2>();
+    const auto channels = in.dim(3);
+    for (auto n = 0u; n < in.dim(0); ++n)
+    {
+        for (auto oh = 0u; oh < params.out_h; ++oh)
+        {
+            for (auto ow = 0u; ow < params.out_w; ++ow)
+            {
+                // one row per output pixel, its channels stay contiguous so every tap is a single copy
+                auto out_ptr = &out((n * params.out_h + oh) * params.out_w + ow, 0);
+                for (auto kh = 0u; kh < params.kernel_h; ++kh)
+                {
+                    // unsigned wrap-around turns taps above or left of the input into out-of-range ones
+                    const size_t ih = oh * params.stride_h + kh * params.dilation_h - params.pad_top;
+                    for (auto kw = 0u; kw < params.kernel_w; ++kw, out_ptr += channels)
+                    {
+                        const size_t iw = ow * params.stride_w + kw * params.dilation_w - params.pad_left;
+                        if (ih < in.dim(1) && iw < in.dim(2))
+                        {
+                            std::copy_n(&in(n, ih, iw, 0), channels, out_ptr);
+                        }
+                        else
+                        {
+                            std::fill_n(out_ptr, channels, static_cast<DATA_T>(0));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::winograd_conv2d_on_host(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                             Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu) const
+{
+    scratch->resize_host_data(scratch->get_size());
+    result->resize_host_data(result->get_size());
+
+    GemmEpilogue<DATA_T> epilogue;
+    epilogue.bias = bias->data();
+    epilogue.relu = relu;
+    WinogradHost<DATA_T>::convolve(data(), m_dims[0], m_dims[1], m_dims[2], m_dims[3],
+                                   weight->data(), weight->get_dims()[1], params.pad_top, params.pad_left,
+                                   params.out_h, params.out_w, scratch->data(), result->data(), epilogue);
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::winograd_conv2d_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                               Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::half_dense_on_device(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                                          Tensor<DATA_T>* result, bool relu) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::im2col_on_device(const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::quantized_dense_on_host(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant,
+                                             const QuantizedGemmParams& params, Tensor<DATA_T>* result) const
+{
+    if constexpr (std::is_same<DATA_T, float>::value)
+    {
+        const auto num_outputs = weight->get_dims()[0];
+        result->resize_host_data(m_dims[0] * num_outputs);
+
+        GemmInt8Epilogue epilogue;
+        epilogue.bias = requant->data();
+        epilogue.multiplier = requant->data() + num_outputs;
+        epilogue.shift = requant->data() + 2 * num_outputs;
+        epilogue.output_zero_point = params.output_zero_point;
+        epilogue.activation_min = params.activation_min;
+        epilogue.activation_max = params.activation_max;
+        epilogue.output_scale = params.output_scale;
+        GemmInt8Host::multiply(m_dims[0], num_outputs, m_dims[1], data(), m_dims[1], params.input_scale, params.input_zero_point,
+                               weight->data(), result->data(), num_outputs, epilogue);
+    }
+    else
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Quantized GEMMs read float inputs");
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::quantized_dense_on_device(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant,
+                                               const QuantizedGemmParams& params, Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::pool2d_on_host(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    result->resize_host_data(result->get_size());
+
+    const auto in  = view<4>();
+    const auto out = result->template view<4>();
+    const auto channels = in.dim(3);
+    for (auto n = 0u; n < in.dim(0); ++n)
+    {
+        for (auto oh = 0u; oh < params.out_h; ++oh)
+        {
+            // the window clamped to the input, so no tap has to be tested
+            const auto h_start = static_cast<long>(oh * params.stride_h) - static_cast<long>(params.pad_top);
+            const auto h_begin = static_cast<size_t>(std::max(h_start, 0l));
+            const auto h_end   = static_cast<size_t>(std::min(h_start + static_cast<long>(params.kernel_h), static_cast<long>(in.dim(1))));
+            for (auto ow = 0u; ow < params.out_w; ++ow)
+            {
+                const auto w_start = static_cast<long>(ow * params.stride_w) - static_cast<long>(params.pad_left);
+                const auto w_begin = static_cast<size_t>(std::max(w_start, 0l));
+                const auto w_end   = static_cast<size_t>(std::min(w_start + static_cast<long>(params.kernel_w), static_cast<long>(in.dim(2))));
+
+                // channels are contiguous in NHWC, every tap is one vectorizable pass over them
+                const auto out_ptr = &out(n, oh, ow, 0);
+                if (pooling == POOLING::MAX)
+                {
+                    std::fill_n(out_ptr, channels, std::numeric_limits<DATA_T>::lowest());
+                    for (auto ih = h_begin; ih < h_end; ++ih)
+                    {
+                        for (auto iw = w_begin; iw < w_end; ++iw)
+                        {
+                            const auto in_ptr = &in(n, ih, iw, 0);
+                            for (auto c = 0u; c < channels; ++c)
+                            {
+                                out_ptr[c] = in_ptr[c] > out_ptr[c] ? in_ptr[c] : out_ptr[c];
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    std::fill_n(out_ptr, channels, static_cast<DATA_T>(0));
+                    for (auto ih = h_begin; ih < h_end; ++ih)
+                    {
+                        for (auto iw = w_begin; iw < w_end; ++iw)
+                        {
+                            const auto in_ptr = &in(n, ih, iw, 0);
+                            for (auto c = 0u; c < channels; ++c)
+                            {
+                                out_ptr[c] += in_ptr[c];
+                            }
+                        }
+                    }
+                    const auto scale = static_cast<DATA_T>(1) / static_cast<DATA_T>((h_end - h_begin) * (w_end - w_begin));
+                    for (auto c = 0u; c < channels; ++c)
+                    {
+                        out_ptr[c] *= scale;
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::pool2d_on_device(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::reshape_on_host(Tensor<DATA_T>* result) const
+{
+    // external data that is shared with the view keeps its owner
+    result->set_external_host_data(const_cast<DATA_T*>(data()), m_size, m_external_owner);
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::reshape_on_device(Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::relu_on_host(Tensor<DATA_T>* result) const
+{
+    result->resize_host_data(m_size);
+
+    // elementwise, so any rank is walked as a flat span
+    const auto in  = data();
+    const auto out = result->data();
+    if constexpr (std::is_same<DATA_T, float>::value)
+    {
+        ThreadPool::get_default()->parallel_for(0u, m_size, ElementwiseHost::PARALLEL_GRAIN, [&](size_t first, size_t last)
+        {
+            ElementwiseHost::relu(in + first, out + first, last - first);
+        });
+    }
+    else
+    {
+        std::transform(in, in + m_size, out, [](DATA_T value) { return std::max(static_cast<DATA_T>(0), value); });
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::relu_on_device(Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::argmax_on_host(Tensor<DATA_T>* result) const
+{
+    const auto num_rows = get_argmax_rows();
+    result->resize_host_data(num_rows);
+
+    const auto row_size = m_size / num_rows;
+    const auto in = view<2>().template reshape<2>({num_rows, row_size});
+    const auto out = result->template view<2>();
+    // rows are independent, a large batch splits them across the thread pool
+    ThreadPool::get_default()->parallel_for(0u, num_rows, std::max<size_t>(1u, ElementwiseHost::PARALLEL_GRAIN / std::max<size_t>(row_size, 1u)),
+                                            [&](size_t first, size_t last)
+    {
+        for (auto row = first; row < last; ++row)
+        {
+            const auto in_row = in.slice(0, row, row + 1);
+            if constexpr (std::is_same<DATA_T, float>::value)
+            {
+                out(row, 0) = static_cast<DATA_T>(ElementwiseHost::argmax(in_row.data(), in_row.size()));
+            }
+            else
+            {
+                const auto max_iter = std::max_element(in_row.begin(), in_row.end());
+                out(row, 0) = static_cast<DATA_T>(std::distance(in_row.begin(), max_iter));
+            }
+        }
+    });
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::argmax_on_device(Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::softmax_on_host(Tensor<DATA_T>* result) const
+{
+    result->resize_host_data(m_size);
+
+    const auto num_rows = get_argmax_rows();
+    const auto row_size = m_size / num_rows;
+    const auto in = view<2>().template reshape<2>({num_rows, row_size});
+    const auto out = result->template view<2>().template reshape<2>({num_rows, row_size});
+    ThreadPool::get_default()->parallel_for(0u, num_rows, std::max<size_t>(1u, ElementwiseHost::PARALLEL_GRAIN / std::max<size_t>(row_size, 1u)),
+                                            [&](size_t first, size_t last)
+    {
+        for (auto row = first; row < last; ++row)
+        {
+            const auto in_row = in.slice(0, row, row + 1);
+            const auto out_row = out.slice(0, row, row + 1);
+            // the row's maximum is subtracted first, so that exp cannot overflow
+            const auto max_value = *std::max_element(in_row.begin(), in_row.end());
+            DATA_T sum = 0;
+            std::transform(in_row.begin(), in_row.end(), out_row.begin(), [&](DATA_T value)
+            {
+                const auto exp_value = static_cast<DATA_T>(std::exp(value - max_value));
+                sum += exp_value;
+                return exp_value;
+            });
+            std::transform(out_row.begin(), out_row.end(), out_row.begin(), [&](DATA_T value) { return value / sum; });
+        }
+    });
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::softmax_on_device(Tensor<DATA_T>* result) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+std::string Tensor<DATA_T>::to_string(bool platform, bool dim, bool total_size, bool data) const
+{
+    std::ostringstream oss;
+
+    if (platform)
+    {
+        oss << "platform: ";
+        switch (m_platform)
+        {
+            case PLATFORM::HOST:
+                oss << "Host";
+                break;
+            case PLATFORM::DEVICE:
+                oss << "Device";
+                break;
+            default:
+                oss << "Unknown";
+                break;
+        }
+        oss << " ";
+    }
+
+    if (dim)
+    {
+        oss << "dim: {";
+        for (auto i = 0; i < m_dims.size(); ++i)
+        {
+            oss << m_dims[i];
+            if (i != m_dims.size() - 1)
+            {
+                oss << ", ";
+            }
+        }
+        oss << "} ";
+    }
+
+    if (total_size)
+    {
+        oss << "size: " << m_size << " ";
+    }
+
+    if (data)
+    {
+        oss << "host data: ";
+        if (m_platform != PLATFORM::HOST)
+        {
+            oss << "not on host. ";
+        }
+        else if (m_dims.size() != 2)
+        {
+            oss << "only matrix data is supported.";
+        }
+        else
+        {
+            const auto matrix = view<2>();
+            oss << "{";
+            for (auto i = 0u; i < m_dims[0]; ++i)
+            {
+                oss << "{";
+                for (auto j = 0u; j < m_dims[1]; ++j)
+                {
+                    oss << matrix(i, j);
+                    if (j != m_dims[1] - 1)
+                    {
+                        oss << ", ";
+                    }
+                }
+                oss << "}";
+                if (i != m_dims[0] - 1)
+                {
+                    oss << ", ";
+                }
+            }
+            oss << "}";
+        }
+    }
+
+    if (platform || dim || total_size || data)
+    {
+        oss << "\n";
+    }
+
+    return oss.str();
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::load_to_host()
+{
+    m_platform = PLATFORM::HOST;
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::load_to_device()
+{
+    m_platform = PLATFORM::DEVICE;
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::load_to_host_async()
+{
+    load_to_host();
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::load_to_device_async()
+{
+    load_to_device();
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::wait() const
+{
+    // host ops are synchronous
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::copy_to_host(Tensor<DATA_T>* result) const
+{
+    if (result->get_platform() != PLATFORM::HOST)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Result is not on the host");
+    }
+
+    result->set_dims(m_dims);
+    result->resize_host_data(m_size);
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            std::copy(data(), data() + m_size, result->data());
+            break;
+        case PLATFORM::DEVICE:
+            read_on_device(result->data());
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::copy_from_host(const Tensor<DATA_T>* source)
+{
+    if (source->get_platform() != PLATFORM::HOST)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Source is not on the host");
+    }
+
+    set_dims(source->get_dims());
+    switch (m_platform)
+    {
+        case PLATFORM::HOST:
+            resize_host_data(m_size);
+            std::copy(source->data(), source->data() + m_size, data());
+            break;
+        case PLATFORM::DEVICE:
+            write_on_device(source->data());
+            break;
+        default:
+            std::cerr << "Unsupported platform!";
+    }
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::read_on_device(DATA_T* h_data) const
+{
+    // to be overwritten by derived classes if needed
+}
+
+template<typename DATA_T>
+void Tensor<DATA_T>::write_on_device(const DATA_T* h_data)
+{
+    // to be overwritten by derived classes if needed
+}
+
 #endif  // TENSOR_H
\ No newline at end of file
@@ -1,288 +1,1426 @@
-#ifndef TENSOR_OPENCL_H
-#define TENSOR_OPENCL_H
-
-#include "Tensor.h"
-
-#include <CL/cl.h>
-
-#define CHECK_CL_ERROR(err, msg) assert(err == CL_SUCCESS && msg)
-
-template<typename DATA_T>
-class TensorOpenCL : public Tensor<DATA_T>
-{
-public:
-    TensorOpenCL(const TensorOpenCL& other);
-    TensorOpenCL(const cl_program& program, const cl_command_queue& queue, const cl_context& context);
-    virtual ~TensorOpenCL();
-
-    virtual void load_to_device() override;
-    virtual void load_to_host() override;
-
-    virtual Tensor<DATA_T>* clone() const override;
-    virtual void swap(Tensor<DATA_T>* other_ptr) override;
-
-protected:
-    virtual void add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const override;
-    virtual void multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const override;
-    virtual void relu_on_device(Tensor<DATA_T>* result) const override;
-    virtual void argmax_on_device(Tensor<DATA_T>* result) const override;
-
-
-private:
-    void release_device_data();
-
-private:
-    cl_mem m_device_data = nullptr;
-    cl_program m_program;
-    cl_command_queue m_queue;
-    cl_context m_context;
-    mutable cl_int m_err = CL_SUCCESS;
-};
-
-template<typename DATA_T>
-TensorOpenCL<DATA_T>::TensorOpenCL(const TensorOpenCL<DATA_T>& other): Tensor<DATA_T>(other)
-{
-    m_program = other.m_program;
-    m_queue   = other.m_queue;
-    m_context = other.m_context;
-
-    // if other has data on the GPU side
-    // make a deep copy of the device data instead of pointing other.m_device_data
-    if (other.get_platform() == PLATFORM::DEVICE)
-    {
-        m_device_data = clCreateBuffer(m_context, CL_MEM_READ_WRITE, m_size * sizeof(DATA_T), nullptr, &m_err);
-        CHECK_CL_ERROR(m_err, "Couldn't allocate device buffer");
-
-        m_err = clEnqueueCopyBuffer(m_queue, other.m_device_data, m_device_data,
-                                            0, 0, m_size * sizeof(DATA_T), 0, nullptr, nullptr);
-        CHECK_CL_ERROR(m_err, "Couldn't copy device buffer");
-    }
-}
-
-template<typename DATA_T>
-TensorOpenCL<DATA_T>::TensorOpenCL(const cl_program& program, const cl_command_queue& queue, const cl_context& context): Tensor<DATA_T>()
-{
-    m_queue = queue;
-    m_program = program;
-    m_context = context;
-}
-
-template<typename DATA_T>
-TensorOpenCL<DATA_T>::~TensorOpenCL()
-{
-    // release resources
-    release_device_data();
-}
-
-template<typename DATA_T>
-Tensor<DATA_T>* TensorOpenCL<DATA_T>::clone() const
-{
-    return new TensorOpenCL<DATA_T>(*this);
-}
-
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::swap(Tensor<DATA_T>* other_ptr)
-{
-    auto other_ptr_opencl = dynamic_cast<TensorOpenCL<DATA_T>*>(other_ptr);
-    if (!other_ptr_opencl)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Couldn't cast to TensorOpenCL");
-    }
-
-    this->Tensor<DATA_T>::swap(other_ptr_opencl);
-    std::swap(m_device_data, other_ptr_opencl->m_device_data);
-    std::swap(m_program, other_ptr_opencl->m_program);
-    std::swap(m_queue, other_ptr_opencl->m_queue);
-    std::swap(m_context, other_ptr_opencl->m_context);
-}
-
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::release_device_data()
-{
-    if (m_device_data)
-    {
-        m_err = clReleaseMemObject(m_device_data);
-        CHECK_CL_ERROR(m_err, "Couldn't release device buffer");
-    }
-}
-
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::load_to_host()
-{
-    if (m_platform != PLATFORM::HOST)
-    {
-        const auto size_in_byte = m_size * sizeof(DATA_T);
-        m_err = clEnqueueReadBuffer(m_queue, m_device_data, CL_TRUE, 0, size_in_byte, m_host_data.data(), 0, NULL, NULL);
-        CHECK_CL_ERROR(m_err, "Couldn't write device data back to host");
-
-        Tensor<DATA_T>::load_to_host();
-    }
-}
-
-// this function re-allocates a gpu buffer
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::load_to_device()
-{
-    if (m_platform != PLATFORM::DEVICE)
-    {
-        release_device_data();
-
-        // todo: not all buffers need to be read/write
-        // host data cannot be empty
-
-        const auto size_in_byte = m_size * sizeof(DATA_T);
-
-        m_device_data = clCreateBuffer(m_context, CL_MEM_READ_WRITE, size_in_byte, NULL, &m_err);
-        CHECK_CL_ERROR(m_err, "Couldn't create device buffer");
-
-        // transfer data from host to device
-        m_err = clEnqueueWriteBuffer(m_queue, m_device_data, CL_TRUE, 0, size_in_byte, m_host_data.data(), 0, NULL, NULL);
-        CHECK_CL_ERROR(m_err, "Couldn't write host data to device buffer");
-
-        if (!m_device_data)
-        {
-            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-            throw std::runtime_error("device buffer is null");
-        }
-
-        Tensor<DATA_T>::load_to_device();
-    }
-}
-
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    auto other_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(other);
-    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
-
-    if (!other_ptr || !result_ptr)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Couldn't cast to TensorOpenCL");
-    }
-
-    // create kernel
-    cl_kernel kernel = clCreateKernel(m_program, "matSum", &m_err);
-    CHECK_CL_ERROR(m_err, "Couldn't create the matSum kernel");
-
-    // set kernel args
-    m_err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &m_device_data);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
-    m_err = clSetKernelArg(kernel, 1, sizeof(cl_mem), &(other_ptr->m_device_data));
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
-    m_err = clSetKernelArg(kernel, 2, sizeof(cl_mem), &(result_ptr->m_device_data));
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
-    m_err = clSetKernelArg(kernel, 3, sizeof(m_size), &m_size);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
-
-    size_t global_size = 32u;
-
-    // enqueue the kernel for execution
-    m_err = clEnqueueNDRangeKernel(m_queue, kernel, 1, NULL, &global_size, NULL, 0, NULL, NULL);
-    CHECK_CL_ERROR(m_err, "Couldn't launch the matSum kernel");
-}
-
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
-{
-    auto other_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(other);
-    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
-
-    if (!other_ptr || !result_ptr)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Couldn't cast to TensorOpenCL");
-    }
-
-    const auto other_dims = other_ptr->get_dims();
-
-    // create kernel
-    cl_kernel kernel = clCreateKernel(m_program, "gemm", &m_err);
-    CHECK_CL_ERROR(m_err, "Couldn't create the matSum kernel");
-
-    // set kernel args
-    m_err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &m_device_data);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
-    m_err = clSetKernelArg(kernel, 1, sizeof(cl_mem), &(other_ptr->m_device_data));
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
-    m_err = clSetKernelArg(kernel, 2, sizeof(cl_mem), &(result_ptr->m_device_data));
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
-    m_err = clSetKernelArg(kernel, 3, sizeof(m_size), &m_dims[0]);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
-    m_err = clSetKernelArg(kernel, 4, sizeof(m_size), &m_dims[1]);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 5");
-    m_err = clSetKernelArg(kernel, 5, sizeof(m_size), &other_dims[1]);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 6");
-
-    size_t global_size[] = {32u, 32u};
-    size_t local_size[] = {16u, 16u};
-
-    // enqueue the kernel for execution
-    m_err = clEnqueueNDRangeKernel(m_queue, kernel, 1, NULL, global_size, local_size, 0, NULL, NULL);
-    CHECK_CL_ERROR(m_err, "Couldn't launch the gemm kernel");
-}
-
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::relu_on_device(Tensor<DATA_T>* result) const
-{
-    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
-
-    if (!result_ptr)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Couldn't cast to TensorOpenCL");
-    }
-
-    // create kernel
-    cl_kernel kernel = clCreateKernel(m_program, "matRelu", &m_err);
-    CHECK_CL_ERROR(m_err, "Couldn't create the matRelu kernel");
-
-    // set kernel args
-    m_err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &m_device_data);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
-    m_err = clSetKernelArg(kernel, 1, sizeof(cl_mem), &(result_ptr->m_device_data));
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
-    m_err = clSetKernelArg(kernel, 2, sizeof(m_size), &m_size);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
-
-    size_t global_size = 32u;
-
-    // enqueue the kernel for execution
-    m_err = clEnqueueNDRangeKernel(m_queue, kernel, 1, NULL, &global_size, NULL, 0, NULL, NULL);
-    CHECK_CL_ERROR(m_err, "Couldn't launch the matRelu kernel");
-}
-
-template<typename DATA_T>
-void TensorOpenCL<DATA_T>::argmax_on_device(Tensor<DATA_T>* result) const
-{
-    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
-
-    if (!result_ptr)
-    {
-        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
-        throw std::runtime_error("Couldn't cast to TensorOpenCL");
-    }
-
-    // create kernel
-    cl_kernel kernel = clCreateKernel(m_program, "matArgMax", &m_err);
-    CHECK_CL_ERROR(m_err, "Couldn't create the matArgMax kernel");
-
-    // set kernel args
-    m_err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &m_device_data);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
-    // change the order of the second and the third arguments if max is neeeded instead of argmax
-    m_err = clSetKernelArg(kernel, 1, sizeof(cl_mem), &(result_ptr->m_device_data));
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
-    m_err = clSetKernelArg(kernel, 2, sizeof(m_size), &m_size);
-    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
-
-    size_t global_size = 32u;
-    size_t local_size  = 16u;
-
-    // enqueue the kernel for execution
-    m_err = clEnqueueNDRangeKernel(m_queue, kernel, 1, NULL, &global_size, &local_size, 0, NULL, NULL);
-    CHECK_CL_ERROR(m_err, "Couldn't launch the matArgMax kernel");
-}
-
+#ifndef TENSOR_OPENCL_H
+#define TENSOR_OPENCL_H
+
+#include "Tensor.h"
+#include "OpenCLKernelCache.h"
+#include "OpenCLBufferPool.h"
+#include "OpenCLAutotuner.h"
+#include "ExecutionPlan.h"
+#include "../profiling/Profiler.h"
+
+#include <CL/cl.h>
+
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// throws in every build type, Release defines NDEBUG and an assert would go on with invalid handles
+#define CHECK_CL_ERROR(err, msg)                                                                            \
+    do                                                                                                      \
+    {                                                                                                       \
+        if ((err) != CL_SUCCESS)                                                                            \
+        {                                                                                                   \
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;                                         \
+            throw std::runtime_error(std::string(msg) + " (OpenCL error " + std::to_string(err) + ")");     \
+        }                                                                                                   \
+    } while (0)
+
+// must match the tile and work-group limits in kernels.clh
+#define GEMM_TILE_DIM 16
+#define GEMM_MIN_LOCAL_DIM 4
+#define DENSE_TILE_DIM 16
+#define ARGMAX_MAX_LOCAL_SIZE 256
+#define SOFTMAX_MAX_LOCAL_SIZE 256
+#define DENSE_HALF_MAX_LOCAL_SIZE 256
+
+// work-group sizes tried for the grid-stride elementwise kernels, the first fitting one is the default
+#define ELEMENTWISE_LOCAL_SIZES {128u, 64u, 256u, 32u}
+// grid-stride kernels launch at most this many work-groups per compute unit
+#define ELEMENTWISE_GROUPS_PER_CU 8
+
+// completed read events are dropped once this many are tracked
+#define MAX_TRACKED_READS 8
+
+template<typename DATA_T>
+class TensorOpenCL : public Tensor<DATA_T>
+{
+public:
+    TensorOpenCL(const TensorOpenCL& other);
+    TensorOpenCL(const cl_program& program, const cl_command_queue& queue, const cl_context& context);
+    virtual ~TensorOpenCL();
+
+    virtual void load_to_device() override;
+    virtual void load_to_host() override;
+    virtual void load_to_device_async() override;
+    virtual void load_to_host_async() override;
+    virtual void wait() const override;
+
+    virtual Tensor<DATA_T>* clone() const override;
+    virtual void swap(Tensor<DATA_T>* other_ptr) override;
+
+    virtual Tensor<DATA_T>* create_empty() const override;
+    virtual Tensor<int8_t>* create_empty_int8() const override;
+    virtual Tensor<int32_t>* create_empty_int32() const override;
+    virtual Tensor<uint16_t>* create_empty_uint16() const override;
+    virtual void allocate(const std::vector<size_t>& dims) override;
+    // windows are sub-buffers of the arena's device buffer
+    virtual void alias(Tensor<DATA_T>* arena, size_t offset, const std::vector<size_t>& dims) override;
+    virtual size_t get_alignment() const override;
+
+    virtual cl_mem get_device_data() const;
+    virtual cl_program get_program() const;
+    virtual cl_command_queue get_queue() const;
+    virtual cl_context get_context() const;
+
+protected:
+    virtual void add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const override;
+    virtual void multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const override;
+    virtual void multiply_transposed_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const override;
+    virtual void dense_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                                 bool transpose_weight, bool relu) const override;
+    // weights are read as 16-bit values in place, both formats share one kernel
+    virtual void half_dense_on_device(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                                      Tensor<DATA_T>* result, bool relu) const override;
+    virtual void im2col_on_device(const Conv2DParams& params, Tensor<DATA_T>* result) const override;
+    virtual void winograd_conv2d_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                           Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu) const override;
+    // weight and requant are constants uploaded by blocking writes, so only the input and result are chained
+    virtual void quantized_dense_on_device(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant,
+                                           const QuantizedGemmParams& params, Tensor<DATA_T>* result) const override;
+    virtual void pool2d_on_device(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const override;
+    // the view retains the device buffer and shares its event history
+    virtual void reshape_on_device(Tensor<DATA_T>* result) const override;
+    virtual void relu_on_device(Tensor<DATA_T>* result) const override;
+    virtual void argmax_on_device(Tensor<DATA_T>* result) const override;
+    virtual void softmax_on_device(Tensor<DATA_T>* result) const override;
+    // blocking, chained like transfers
+    virtual void read_on_device(DATA_T* h_data) const override;
+    virtual void write_on_device(const DATA_T* h_data) override;
+
+
+private:
+    void release_device_data();
+    // grows the device buffer to hold m_size elements, for tensors used as op outputs
+    // whose shape changes with the batch size; the old contents are not preserved
+    void ensure_device_capacity();
+
+    // every command on m_device_data is chained through events, so ops stay ordered on an
+    // out-of-order queue: reads wait for the last write, writes wait for it and every read since
+    void wait_for_write(std::vector<cl_event>& wait_list) const;
+    void wait_for_access(std::vector<cl_event>& wait_list) const;
+    void record_read(cl_event event) const;
+    void record_write(cl_event event);
+    void release_events();
+    // clSetKernelArg, also reported to the plan recording on this thread
+    cl_int set_kernel_arg(cl_kernel kernel, cl_uint index, size_t size, const void* value) const;
+    // every buffer the kernel reads is listed, other_inputs are those of another element type such as int8 weights
+    template<typename... OTHER_T>
+    void enqueue_kernel(cl_kernel kernel, cl_uint work_dim, const size_t* global_size, const size_t* local_size,
+                        std::initializer_list<const TensorOpenCL<DATA_T>*> inputs, TensorOpenCL<DATA_T>* output,
+                        const TensorOpenCL<OTHER_T>*... other_inputs) const;
+    void transfer(bool to_device, bool blocking);
+
+    // launch geometry comes from the tensor dims and the device limits; where several values fit,
+    // the autotuner picks one per device and shape class. launch is run once with the pick.
+    // An op writing one of its own inputs is never tuned, since repeating it changes the result
+    void launch_tuned(const char* kernel_name, const std::string& shape_class, const std::vector<size_t>& candidates,
+                      bool in_place, const std::function<void(size_t)>& launch) const;
+    // work-group sizes from sizes that fit both the device and kernel
+    std::vector<size_t> get_local_size_candidates(cl_kernel kernel, std::initializer_list<size_t> sizes) const;
+    void check_local_mem(size_t bytes, const char* kernel_name) const;
+    void launch_elementwise(cl_kernel kernel, const char* kernel_name, size_t length,
+                            std::initializer_list<const TensorOpenCL<DATA_T>*> inputs, TensorOpenCL<DATA_T>* output) const;
+
+    // replays chain through the event history of the input and result
+    friend class ExecutionPlan;
+    // kernels chain through the event history of inputs with another element type
+    template<typename> friend class TensorOpenCL;
+
+protected:
+    using Tensor<DATA_T>::m_host_data;
+    using Tensor<DATA_T>::m_dims;
+    using Tensor<DATA_T>::m_size;
+    using Tensor<DATA_T>::m_platform;
+
+private:
+    cl_mem m_device_data = nullptr;
+    size_t m_device_capacity = 0u;     // number of elements m_device_data can hold
+    bool m_device_data_pooled = false; // drawn from OpenCLBufferPool, otherwise a sub-buffer
+    // event history of m_device_data; views made by reshape share it with the tensor they view,
+    // so commands on either of them are ordered against both. Clones of a model share the weights,
+    // whose reads are recorded by every executing clone, hence the mutex
+    struct BufferEvents
+    {
+        std::mutex mutex;
+        cl_event write_event = nullptr;         // last command that wrote the buffer
+        std::vector<cl_event> read_events;      // commands that read it since write_event
+        ~BufferEvents();
+    };
+    std::shared_ptr<BufferEvents> m_events = std::make_shared<BufferEvents>();
+    cl_event m_host_event = nullptr;    // pending non-blocking read into the host data
+    cl_program m_program;
+    cl_command_queue m_queue;
+    cl_context m_context;
+    mutable cl_int m_err = CL_SUCCESS;
+};
+
+template<typename DATA_T>
+TensorOpenCL<DATA_T>::TensorOpenCL(const TensorOpenCL<DATA_T>& other): Tensor<DATA_T>(other)
+{
+    m_program = other.m_program;
+    m_queue   = other.m_queue;
+    m_context = other.m_context;
+
+    // if other has data on the GPU side
+    // make a deep copy of the device data instead of pointing other.m_device_data
+    if (other.get_platform() == PLATFORM::DEVICE)
+    {
+        ensure_device_capacity();
+
+        std::vector<cl_event> wait_list;
+        other.wait_for_write(wait_list);
+        cl_event event = nullptr;
+        const auto enqueue_us = Profiler::is_enabled() ? Profiler::instance().now_us() : 0.0;
+        m_err = clEnqueueCopyBuffer(m_queue, other.m_device_data, m_device_data, 0, 0, m_size * sizeof(DATA_T),
+                                    wait_list.size(), wait_list.empty() ? NULL : wait_list.data(), &event);
+        CHECK_CL_ERROR(m_err, "Couldn't copy device buffer");
+        if (auto plan = ExecutionPlan::get_recording())
+        {
+            plan->record_unsupported("a copy");
+        }
+        if (Profiler::is_enabled())
+        {
+            Profiler::instance().record_event(event, "copy", PROFILE_CATEGORY::TRANSFER, m_size * sizeof(DATA_T), enqueue_us);
+        }
+        other.record_read(event);
+        record_write(event);
+        if (event)
+        {
+            clReleaseEvent(event);
+        }
+    }
+}
+
+template<typename DATA_T>
+TensorOpenCL<DATA_T>::TensorOpenCL(const cl_program& program, const cl_command_queue& queue, const cl_context& context): Tensor<DATA_T>()
+{
+    m_queue = queue;
+    m_program = program;
+    m_context = context;
+}
+
+template<typename DATA_T>
+TensorOpenCL<DATA_T>::~TensorOpenCL()
+{
+    // a pending non-blocking read still writes into the host data
+    if (m_host_event)
+    {
+        clWaitForEvents(1, &m_host_event);
+    }
+
+    // release resources
+    release_device_data();
+}
+
+template<typename DATA_T>
+Tensor<DATA_T>* TensorOpenCL<DATA_T>::clone() const
+{
+    return new TensorOpenCL<DATA_T>(*this);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::swap(Tensor<DATA_T>* other_ptr)
+{
+    auto other_ptr_opencl = dynamic_cast<TensorOpenCL<DATA_T>*>(other_ptr);
+    if (!other_ptr_opencl)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+
+    this->Tensor<DATA_T>::swap(other_ptr_opencl);
+    std::swap(m_device_data, other_ptr_opencl->m_device_data);
+    std::swap(m_device_capacity, other_ptr_opencl->m_device_capacity);
+    std::swap(m_device_data_pooled, other_ptr_opencl->m_device_data_pooled);
+    std::swap(m_events, other_ptr_opencl->m_events);
+    std::swap(m_host_event, other_ptr_opencl->m_host_event);
+    std::swap(m_program, other_ptr_opencl->m_program);
+    std::swap(m_queue, other_ptr_opencl->m_queue);
+    std::swap(m_context, other_ptr_opencl->m_context);
+}
+
+template<typename DATA_T>
+Tensor<DATA_T>* TensorOpenCL<DATA_T>::create_empty() const
+{
+    return new TensorOpenCL<DATA_T>(m_program, m_queue, m_context);
+}
+
+template<typename DATA_T>
+Tensor<int8_t>* TensorOpenCL<DATA_T>::create_empty_int8() const
+{
+    return new TensorOpenCL<int8_t>(m_program, m_queue, m_context);
+}
+
+template<typename DATA_T>
+Tensor<int32_t>* TensorOpenCL<DATA_T>::create_empty_int32() const
+{
+    return new TensorOpenCL<int32_t>(m_program, m_queue, m_context);
+}
+
+template<typename DATA_T>
+Tensor<uint16_t>* TensorOpenCL<DATA_T>::create_empty_uint16() const
+{
+    return new TensorOpenCL<uint16_t>(m_program, m_queue, m_context);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::allocate(const std::vector<size_t>& dims)
+{
+    this->set_dims(dims);
+    ensure_device_capacity();
+    m_platform = PLATFORM::DEVICE;
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::alias(Tensor<DATA_T>* arena, size_t offset, const std::vector<size_t>& dims)
+{
+    auto arena_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(arena);
+    if (!arena_ptr || !arena_ptr->m_device_data)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Arena is not an allocated TensorOpenCL");
+    }
+
+    this->set_dims(dims);
+    if (offset + m_size > arena_ptr->m_device_capacity)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::out_of_range("Alias does not fit into the arena");
+    }
+
+    // a sub-buffer holds a reference to its parent, releasing it never frees the arena
+    release_device_data();
+    cl_buffer_region region = {offset * sizeof(DATA_T), m_size * sizeof(DATA_T)};
+    m_device_data = clCreateSubBuffer(arena_ptr->m_device_data, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &m_err);
+    CHECK_CL_ERROR(m_err, "Couldn't create a sub-buffer of the arena");
+    if (!m_device_data)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("device buffer is null");
+    }
+    m_device_capacity = m_size;
+    m_platform = PLATFORM::DEVICE;
+}
+
+template<typename DATA_T>
+size_t TensorOpenCL<DATA_T>::get_alignment() const
+{
+    // sub-buffer origins must be aligned to CL_DEVICE_MEM_BASE_ADDR_ALIGN, which is given in bits
+    cl_device_id device = nullptr;
+    m_err = clGetCommandQueueInfo(m_queue, CL_QUEUE_DEVICE, sizeof(cl_device_id), &device, NULL);
+    CHECK_CL_ERROR(m_err, "Couldn't query the queue's device");
+    cl_uint align_bits = 0u;
+    m_err = clGetDeviceInfo(device, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &align_bits, NULL);
+    CHECK_CL_ERROR(m_err, "Couldn't query the base address alignment");
+    return std::max<size_t>(align_bits / 8u / sizeof(DATA_T), Tensor<DATA_T>::get_alignment());
+}
+
+template<typename DATA_T>
+cl_mem TensorOpenCL<DATA_T>::get_device_data() const
+{
+    return m_device_data;
+}
+
+template<typename DATA_T>
+cl_program TensorOpenCL<DATA_T>::get_program() const
+{
+    return m_program;
+}
+
+template<typename DATA_T>
+cl_command_queue TensorOpenCL<DATA_T>::get_queue() const
+{
+    return m_queue;
+}
+
+template<typename DATA_T>
+cl_context TensorOpenCL<DATA_T>::get_context() const
+{
+    return m_context;
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::release_device_data()
+{
+    if (m_device_data)
+    {
+        if (m_device_data_pooled)
+        {
+            OpenCLBufferPool::instance().release(m_context, m_queue, m_device_data, m_device_capacity * sizeof(DATA_T));
+        }
+        else
+        {
+            // also runs in the destructor, so it reports instead of throwing
+            m_err = clReleaseMemObject(m_device_data);
+            if (m_err != CL_SUCCESS)
+            {
+                std::cerr <<  __FILE__ << ": "<< __LINE__ << " Couldn't release device buffer" << std::endl;
+            }
+        }
+        m_device_data = nullptr;
+        m_device_capacity = 0u;
+        m_device_data_pooled = false;
+    }
+    release_events();
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::ensure_device_capacity()
+{
+    if (m_device_data && m_device_capacity >= m_size)
+    {
+        return;
+    }
+
+    release_device_data();
+    size_t capacity_in_bytes = 0u;
+    m_device_data = OpenCLBufferPool::instance().acquire(m_context, m_queue, m_size * sizeof(DATA_T), capacity_in_bytes);
+    m_device_capacity = capacity_in_bytes / sizeof(DATA_T);
+    m_device_data_pooled = true;
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::load_to_host()
+{
+    if (m_platform != PLATFORM::HOST)
+    {
+        transfer(false, true);
+        Tensor<DATA_T>::load_to_host();
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::load_to_device()
+{
+    if (m_platform != PLATFORM::DEVICE)
+    {
+        transfer(true, true);
+        Tensor<DATA_T>::load_to_device();
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::load_to_host_async()
+{
+    if (m_platform != PLATFORM::HOST)
+    {
+        transfer(false, false);
+        Tensor<DATA_T>::load_to_host();
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::load_to_device_async()
+{
+    if (m_platform != PLATFORM::DEVICE)
+    {
+        transfer(true, false);
+        Tensor<DATA_T>::load_to_device();
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::wait() const
+{
+    cl_event events[2];
+    cl_uint num_events = 0u;
+    {
+        std::lock_guard<std::mutex> lock(m_events->mutex);
+        if (m_events->write_event)
+        {
+            events[num_events++] = m_events->write_event;
+        }
+    }
+    if (m_host_event)
+    {
+        events[num_events++] = m_host_event;
+    }
+    if (num_events > 0u)
+    {
+        m_err = clWaitForEvents(num_events, events);
+        CHECK_CL_ERROR(m_err, "Couldn't wait for the tensor's events");
+    }
+}
+
+// uploads reuse the current device buffer if it is large enough, otherwise draw one from the pool
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::transfer(bool to_device, bool blocking)
+{
+    // todo: not all buffers need to be read/write
+    // host data cannot be empty
+    const auto size_in_byte = m_size * sizeof(DATA_T);
+    const cl_bool blocking_flag = blocking ? CL_TRUE : CL_FALSE;
+
+    thread_local std::vector<cl_event> wait_list;
+    wait_list.clear();
+    cl_event event = nullptr;
+    const auto enqueue_us = Profiler::is_enabled() ? Profiler::instance().now_us() : 0.0;
+    if (auto plan = ExecutionPlan::get_recording())
+    {
+        plan->record_unsupported(to_device ? "a write" : "a read");
+    }
+    if (to_device)
+    {
+        ensure_device_capacity();
+        if (!m_device_data)
+        {
+            std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+            throw std::runtime_error("device buffer is null");
+        }
+
+        // the upload overwrites the buffer, so it waits for everyone still using it
+        wait_for_access(wait_list);
+        m_err = clEnqueueWriteBuffer(m_queue, m_device_data, blocking_flag, 0, size_in_byte, this->data(),
+                                     wait_list.size(), wait_list.empty() ? NULL : wait_list.data(), &event);
+        CHECK_CL_ERROR(m_err, "Couldn't write host data to device buffer");
+        if (Profiler::is_enabled())
+        {
+            Profiler::instance().record_event(event, "write", PROFILE_CATEGORY::TRANSFER, size_in_byte, enqueue_us);
+        }
+        record_write(event);
+    }
+    else
+    {
+        this->resize_host_data(m_size);
+        wait_for_write(wait_list);
+        m_err = clEnqueueReadBuffer(m_queue, m_device_data, blocking_flag, 0, size_in_byte, this->data(),
+                                    wait_list.size(), wait_list.empty() ? NULL : wait_list.data(), &event);
+        CHECK_CL_ERROR(m_err, "Couldn't write device data back to host");
+        if (Profiler::is_enabled())
+        {
+            Profiler::instance().record_event(event, "read", PROFILE_CATEGORY::TRANSFER, size_in_byte, enqueue_us);
+        }
+        record_read(event);
+        if (m_host_event)
+        {
+            clReleaseEvent(m_host_event);
+        }
+        m_host_event = event;
+        event = nullptr;
+    }
+
+    if (event)
+    {
+        clReleaseEvent(event);
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::read_on_device(DATA_T* h_data) const
+{
+    const auto size_in_byte = m_size * sizeof(DATA_T);
+    thread_local std::vector<cl_event> wait_list;
+    wait_list.clear();
+    wait_for_write(wait_list);
+    cl_event event = nullptr;
+    const auto enqueue_us = Profiler::is_enabled() ? Profiler::instance().now_us() : 0.0;
+    if (auto plan = ExecutionPlan::get_recording())
+    {
+        plan->record_unsupported("a read");
+    }
+    m_err = clEnqueueReadBuffer(m_queue, m_device_data, CL_TRUE, 0, size_in_byte, h_data,
+                                wait_list.size(), wait_list.empty() ? NULL : wait_list.data(), &event);
+    CHECK_CL_ERROR(m_err, "Couldn't read device data to the host");
+    if (Profiler::is_enabled())
+    {
+        Profiler::instance().record_event(event, "read", PROFILE_CATEGORY::TRANSFER, size_in_byte, enqueue_us);
+    }
+    record_read(event);
+    if (event)
+    {
+        clReleaseEvent(event);
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::write_on_device(const DATA_T* h_data)
+{
+    const auto size_in_byte = m_size * sizeof(DATA_T);
+    ensure_device_capacity();
+    if (!m_device_data)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("device buffer is null");
+    }
+
+    thread_local std::vector<cl_event> wait_list;
+    wait_list.clear();
+    wait_for_access(wait_list);
+    cl_event event = nullptr;
+    const auto enqueue_us = Profiler::is_enabled() ? Profiler::instance().now_us() : 0.0;
+    if (auto plan = ExecutionPlan::get_recording())
+    {
+        plan->record_unsupported("a write");
+    }
+    m_err = clEnqueueWriteBuffer(m_queue, m_device_data, CL_TRUE, 0, size_in_byte, h_data,
+                                 wait_list.size(), wait_list.empty() ? NULL : wait_list.data(), &event);
+    CHECK_CL_ERROR(m_err, "Couldn't write host data to the device buffer");
+    if (Profiler::is_enabled())
+    {
+        Profiler::instance().record_event(event, "write", PROFILE_CATEGORY::TRANSFER, size_in_byte, enqueue_us);
+    }
+    record_write(event);
+    if (event)
+    {
+        clReleaseEvent(event);
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::wait_for_write(std::vector<cl_event>& wait_list) const
+{
+    std::lock_guard<std::mutex> lock(m_events->mutex);
+    if (m_events->write_event)
+    {
+        wait_list.emplace_back(m_events->write_event);
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::wait_for_access(std::vector<cl_event>& wait_list) const
+{
+    wait_for_write(wait_list);
+    std::lock_guard<std::mutex> lock(m_events->mutex);
+    wait_list.insert(wait_list.end(), m_events->read_events.cbegin(), m_events->read_events.cend());
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::record_read(cl_event event) const
+{
+    if (!event)
+    {
+        return;
+    }
+
+    // weights are read by every execute and never written, so drop the reads that are done
+    std::lock_guard<std::mutex> lock(m_events->mutex);
+    auto& read_events = m_events->read_events;
+    if (read_events.size() >= MAX_TRACKED_READS)
+    {
+        auto end = std::remove_if(read_events.begin(), read_events.end(), [](cl_event read_event)
+        {
+            cl_int status = CL_COMPLETE + 1;
+            clGetEventInfo(read_event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL);
+            if (status == CL_COMPLETE)
+            {
+                clReleaseEvent(read_event);
+                return true;
+            }
+            return false;
+        });
+        read_events.erase(end, read_events.end());
+    }
+
+    clRetainEvent(event);
+    read_events.emplace_back(event);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::record_write(cl_event event)
+{
+    // the write waited for every earlier access, so waiting for it alone covers them
+    std::lock_guard<std::mutex> lock(m_events->mutex);
+    for (auto read_event : m_events->read_events)
+    {
+        clReleaseEvent(read_event);
+    }
+    m_events->read_events.clear();
+    if (m_events->write_event)
+    {
+        clReleaseEvent(m_events->write_event);
+    }
+    m_events->write_event = event;
+    if (event)
+    {
+        clRetainEvent(event);
+    }
+}
+
+template<typename DATA_T>
+TensorOpenCL<DATA_T>::BufferEvents::~BufferEvents()
+{
+    for (auto read_event : read_events)
+    {
+        clReleaseEvent(read_event);
+    }
+    if (write_event)
+    {
+        clReleaseEvent(write_event);
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::release_events()
+{
+    // views of the buffer keep its history, this tensor starts a new one
+    if (m_events.use_count() > 1)
+    {
+        m_events = std::make_shared<BufferEvents>();
+    }
+    else
+    {
+        record_write(nullptr);
+    }
+    if (m_host_event)
+    {
+        clReleaseEvent(m_host_event);
+        m_host_event = nullptr;
+    }
+}
+
+template<typename DATA_T>
+cl_int TensorOpenCL<DATA_T>::set_kernel_arg(cl_kernel kernel, cl_uint index, size_t size, const void* value) const
+{
+    if (auto plan = ExecutionPlan::get_recording())
+    {
+        plan->record_arg(kernel, index, size, value);
+    }
+    return clSetKernelArg(kernel, index, size, value);
+}
+
+template<typename DATA_T>
+template<typename... OTHER_T>
+void TensorOpenCL<DATA_T>::enqueue_kernel(cl_kernel kernel, cl_uint work_dim, const size_t* global_size, const size_t* local_size,
+                                          std::initializer_list<const TensorOpenCL<DATA_T>*> inputs, TensorOpenCL<DATA_T>* output,
+                                          const TensorOpenCL<OTHER_T>*... other_inputs) const
+{
+    thread_local std::vector<cl_event> wait_list;
+    wait_list.clear();
+    for (auto input : inputs)
+    {
+        input->wait_for_write(wait_list);
+    }
+    (other_inputs->wait_for_write(wait_list), ...);
+    output->wait_for_access(wait_list);
+
+    cl_event event = nullptr;
+    const auto enqueue_us = Profiler::is_enabled() ? Profiler::instance().now_us() : 0.0;
+    m_err = clEnqueueNDRangeKernel(m_queue, kernel, work_dim, NULL, global_size, local_size,
+                                   wait_list.size(), wait_list.empty() ? NULL : wait_list.data(), &event);
+    CHECK_CL_ERROR(m_err, "Couldn't launch the kernel");
+    if (auto plan = ExecutionPlan::get_recording())
+    {
+        plan->record_launch(kernel, m_queue, work_dim, global_size, local_size);
+    }
+    if (Profiler::is_enabled())
+    {
+        Profiler::instance().record_event(event, Profiler::get_kernel_name(kernel), PROFILE_CATEGORY::KERNEL, 0u, enqueue_us);
+    }
+
+    for (auto input : inputs)
+    {
+        input->record_read(event);
+    }
+    (other_inputs->record_read(event), ...);
+    output->record_write(event);
+    if (event)
+    {
+        clReleaseEvent(event);
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::launch_tuned(const char* kernel_name, const std::string& shape_class, const std::vector<size_t>& candidates,
+                                        bool in_place, const std::function<void(size_t)>& launch) const
+{
+    if (candidates.empty())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error(std::string("The device can't run the ") + kernel_name + " kernel");
+    }
+
+    auto& autotuner = OpenCLAutotuner::instance();
+    std::function<void(size_t)> run;
+    if (!in_place)
+    {
+        run = [this, &launch](size_t candidate)
+        {
+            // trial launches are not part of a recorded plan
+            const auto plan = ExecutionPlan::set_recording(nullptr);
+            launch(candidate);
+            clFinish(m_queue);
+            ExecutionPlan::set_recording(plan);
+        };
+    }
+    launch(autotuner.select(autotuner.get_device_info(m_queue).name, kernel_name, shape_class,
+                            candidates, candidates.front(), run));
+}
+
+template<typename DATA_T>
+std::vector<size_t> TensorOpenCL<DATA_T>::get_local_size_candidates(cl_kernel kernel, std::initializer_list<size_t> sizes) const
+{
+    const auto max_work_group_size = OpenCLAutotuner::instance().get_max_work_group_size(m_queue, kernel);
+    std::vector<size_t> candidates;
+    for (const auto size : sizes)
+    {
+        if (size <= max_work_group_size)
+        {
+            candidates.emplace_back(size);
+        }
+    }
+    return candidates;
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::check_local_mem(size_t bytes, const char* kernel_name) const
+{
+    if (OpenCLAutotuner::instance().get_device_info(m_queue).local_mem_size < bytes)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error(std::string("Not enough local memory for the ") + kernel_name + " kernel");
+    }
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::launch_elementwise(cl_kernel kernel, const char* kernel_name, size_t length,
+                                              std::initializer_list<const TensorOpenCL<DATA_T>*> inputs, TensorOpenCL<DATA_T>* output) const
+{
+    const auto compute_units = OpenCLAutotuner::instance().get_device_info(m_queue).compute_units;
+    bool in_place = false;
+    for (auto input : inputs)
+    {
+        in_place = in_place || input == output;
+    }
+
+    launch_tuned(kernel_name, OpenCLAutotuner::get_shape_class({length}),
+                 get_local_size_candidates(kernel, ELEMENTWISE_LOCAL_SIZES), in_place,
+                 [&](size_t local_size)
+                 {
+                     // enough work-items to cover the tensor, the kernels stride over the rest
+                     size_t global_size = std::min(OpenCLAutotuner::round_up(length, local_size),
+                                                   local_size * compute_units * ELEMENTWISE_GROUPS_PER_CU);
+                     enqueue_kernel(kernel, 1, &global_size, &local_size, inputs, output);
+                 });
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::add_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    auto other_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(other);
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!other_ptr || !result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // a single row on the right is broadcast over every row of the batch
+    const bool broadcast = other_ptr->get_dims()[0] != m_dims[0];
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, broadcast ? "matSumRowBroadcast" : "matSum");
+    cl_kernel kernel = cached_kernel.get();
+
+    const cl_uint length = m_size;
+    const cl_uint cols = m_dims[1];
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(other_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_uint), &length);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+    if (broadcast)
+    {
+        m_err = set_kernel_arg(kernel, 4, sizeof(cl_uint), &cols);
+        CHECK_CL_ERROR(m_err, "Couldn't set arg 5");
+    }
+
+    // enqueue the kernel for execution
+    launch_elementwise(kernel, broadcast ? "matSumRowBroadcast" : "matSum", m_size, {this, other_ptr}, result_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::multiply_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    auto other_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(other);
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!other_ptr || !result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    const auto other_dims = other_ptr->get_dims();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "gemm");
+    cl_kernel kernel = cached_kernel.get();
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(other_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    const cl_uint l_dim_0 = m_dims[0];
+    const cl_uint l_dim_1 = m_dims[1];
+    const cl_uint r_dim_1 = other_dims[1];
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_uint), &l_dim_0);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+    m_err = set_kernel_arg(kernel, 4, sizeof(cl_uint), &l_dim_1);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 5");
+    m_err = set_kernel_arg(kernel, 5, sizeof(cl_uint), &r_dim_1);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 6");
+
+    check_local_mem(2u * GEMM_TILE_DIM * GEMM_TILE_DIM * sizeof(float), "gemm");
+
+    // square work-groups of local_dim^2 work-items, one per output tile
+    const auto max_work_group_size = OpenCLAutotuner::instance().get_max_work_group_size(m_queue, kernel);
+    std::vector<size_t> candidates;
+    for (size_t local_dim = GEMM_TILE_DIM; local_dim >= GEMM_MIN_LOCAL_DIM; local_dim /= 2u)
+    {
+        if (local_dim * local_dim <= max_work_group_size)
+        {
+            candidates.emplace_back(local_dim);
+        }
+    }
+
+    // enqueue the kernel for execution
+    launch_tuned("gemm", OpenCLAutotuner::get_shape_class({l_dim_0, l_dim_1, r_dim_1}), candidates,
+                 this == result_ptr || other_ptr == result_ptr,
+                 [&](size_t local_dim)
+                 {
+                     size_t global_size[] = {(r_dim_1 + GEMM_TILE_DIM - 1u) / GEMM_TILE_DIM * local_dim,
+                                             (l_dim_0 + GEMM_TILE_DIM - 1u) / GEMM_TILE_DIM * local_dim};
+                     size_t local_size[] = {local_dim, local_dim};
+                     enqueue_kernel(kernel, 2, global_size, local_size, {this, other_ptr}, result_ptr);
+                 });
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::multiply_transposed_on_device(const Tensor<DATA_T>* other, Tensor<DATA_T>* result) const
+{
+    auto other_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(other);
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!other_ptr || !result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    const auto other_dims = other_ptr->get_dims();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "matMulTransB");
+    cl_kernel kernel = cached_kernel.get();
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(other_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    const cl_uint l_dim_0 = m_dims[0];
+    const cl_uint l_dim_1 = m_dims[1];
+    const cl_uint r_dim_0 = other_dims[0];
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_uint), &l_dim_0);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+    m_err = set_kernel_arg(kernel, 4, sizeof(cl_uint), &l_dim_1);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 5");
+    m_err = set_kernel_arg(kernel, 5, sizeof(cl_uint), &r_dim_0);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 6");
+
+    // one work-item per output element, the runtime picks the work-group size
+    size_t global_size[] = {r_dim_0, l_dim_0};
+
+    // enqueue the kernel for execution
+    enqueue_kernel(kernel, 2, global_size, NULL, {this, other_ptr}, result_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::dense_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, Tensor<DATA_T>* result,
+                                           bool transpose_weight, bool relu) const
+{
+    auto weight_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(weight);
+    auto bias_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(bias);
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!weight_ptr || !bias_ptr || !result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, relu ? "gemmBiasRelu" : "gemmBias");
+    cl_kernel kernel = cached_kernel.get();
+
+    const auto& result_dims = result_ptr->get_dims();
+    const cl_uint l_dim_0 = m_dims[0];
+    const cl_uint l_dim_1 = m_dims[1];
+    const cl_uint r_dim_1 = result_dims[1];
+    const cl_uint r_transposed = transpose_weight ? 1u : 0u;
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(weight_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_mem), &(bias_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+    m_err = set_kernel_arg(kernel, 4, sizeof(cl_uint), &l_dim_0);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 5");
+    m_err = set_kernel_arg(kernel, 5, sizeof(cl_uint), &l_dim_1);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 6");
+    m_err = set_kernel_arg(kernel, 6, sizeof(cl_uint), &r_dim_1);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 7");
+    m_err = set_kernel_arg(kernel, 7, sizeof(cl_uint), &r_transposed);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 8");
+
+    // the tiles are loaded by one work-item per element, so the work-group size is fixed
+    if (OpenCLAutotuner::instance().get_max_work_group_size(m_queue, kernel) < DENSE_TILE_DIM * DENSE_TILE_DIM)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("The device can't run the dense kernel, it needs work-groups of "
+                                 + std::to_string(DENSE_TILE_DIM * DENSE_TILE_DIM));
+    }
+    check_local_mem(2u * DENSE_TILE_DIM * DENSE_TILE_DIM * sizeof(float), "dense");
+
+    // one work-item per output element, rounded up to whole tiles
+    size_t global_size[] = {OpenCLAutotuner::round_up(r_dim_1, DENSE_TILE_DIM), OpenCLAutotuner::round_up(l_dim_0, DENSE_TILE_DIM)};
+    size_t local_size[] = {DENSE_TILE_DIM, DENSE_TILE_DIM};
+
+    // enqueue the kernel for execution
+    enqueue_kernel(kernel, 2, global_size, local_size, {this, weight_ptr, bias_ptr}, result_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::half_dense_on_device(const Tensor<uint16_t>* weight, WEIGHT_FORMAT format, const Tensor<DATA_T>* bias,
+                                                Tensor<DATA_T>* result, bool relu) const
+{
+    auto weight_ptr = dynamic_cast<const TensorOpenCL<uint16_t>*>(weight);
+    auto bias_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(bias);
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!weight_ptr || !bias_ptr || !result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "denseHalf");
+    cl_kernel kernel = cached_kernel.get();
+
+    const cl_uint rows = m_dims[0];
+    const cl_uint inner = m_dims[1];
+    const cl_uint cols = weight_ptr->get_dims()[0];
+    const cl_uint is_bf16 = format == WEIGHT_FORMAT::BF16 ? 1u : 0u;
+    const cl_uint apply_relu = relu ? 1u : 0u;
+    const cl_mem weight_data = weight_ptr->get_device_data();
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &weight_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_mem), &(bias_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+    m_err = set_kernel_arg(kernel, 4, sizeof(cl_uint), &rows);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 5");
+    m_err = set_kernel_arg(kernel, 5, sizeof(cl_uint), &inner);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 6");
+    m_err = set_kernel_arg(kernel, 6, sizeof(cl_uint), &cols);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 7");
+    m_err = set_kernel_arg(kernel, 7, sizeof(cl_uint), &is_bf16);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 8");
+    m_err = set_kernel_arg(kernel, 8, sizeof(cl_uint), &apply_relu);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 9");
+
+    check_local_mem(DENSE_HALF_MAX_LOCAL_SIZE * sizeof(float), "denseHalf");
+
+    // one work-group per output column, the reduction needs a power-of-two local size.
+    // The fp16 weights are chained like the input and bias
+    launch_tuned("denseHalf", OpenCLAutotuner::get_shape_class({rows, inner, cols}),
+                 get_local_size_candidates(kernel, {64u, 128u, 256u, 32u}), false,
+                 [&](size_t local_size)
+                 {
+                     size_t global_size = cols * local_size;
+                     enqueue_kernel(kernel, 1, &global_size, &local_size, {this, bias_ptr}, result_ptr, weight_ptr);
+                 });
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::im2col_on_device(const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "im2col");
+    cl_kernel kernel = cached_kernel.get();
+
+    const size_t length = result_ptr->get_size();
+    const cl_uint args[] = {static_cast<cl_uint>(m_dims[1]), static_cast<cl_uint>(m_dims[2]), static_cast<cl_uint>(m_dims[3]),
+                            static_cast<cl_uint>(params.kernel_h), static_cast<cl_uint>(params.kernel_w),
+                            static_cast<cl_uint>(params.stride_h), static_cast<cl_uint>(params.stride_w),
+                            static_cast<cl_uint>(params.dilation_h), static_cast<cl_uint>(params.dilation_w),
+                            static_cast<cl_uint>(params.pad_top), static_cast<cl_uint>(params.pad_left),
+                            static_cast<cl_uint>(params.out_h), static_cast<cl_uint>(params.out_w),
+                            static_cast<cl_uint>(length)};
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    for (cl_uint i = 0u; i < sizeof(args) / sizeof(args[0]); ++i)
+    {
+        m_err = set_kernel_arg(kernel, i + 2u, sizeof(cl_uint), &args[i]);
+        CHECK_CL_ERROR(m_err, "Couldn't set a geometry arg");
+    }
+
+    // enqueue the kernel for execution
+    launch_elementwise(kernel, "im2col", length, {this}, result_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::winograd_conv2d_on_device(const Tensor<DATA_T>* weight, const Tensor<DATA_T>* bias, const Conv2DParams& params,
+                                                     Tensor<DATA_T>* scratch, Tensor<DATA_T>* result, bool relu) const
+{
+    auto weight_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(weight);
+    auto bias_ptr = dynamic_cast<const TensorOpenCL<DATA_T>*>(bias);
+    auto scratch_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(scratch);
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!weight_ptr || !bias_ptr || !scratch_ptr || !result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    scratch_ptr->ensure_device_capacity();
+    result_ptr->ensure_device_capacity();
+
+    const cl_uint in_h = m_dims[1];
+    const cl_uint in_w = m_dims[2];
+    const cl_uint in_channels = m_dims[3];
+    const cl_uint out_channels = weight_ptr->get_dims()[1];
+    const cl_uint out_h = params.out_h;
+    const cl_uint out_w = params.out_w;
+    const cl_uint pad_top = params.pad_top;
+    const cl_uint pad_left = params.pad_left;
+    const cl_uint tiles_h = (out_h + 1u) / 2u;
+    const cl_uint tiles_w = (out_w + 1u) / 2u;
+    const cl_uint num_tiles = m_dims[0] * tiles_h * tiles_w;
+    const cl_uint apply_relu = relu ? 1u : 0u;
+
+    {
+        // input transform into the scratch tensor, the products are never stored on the device
+        const OpenCLKernel cached_kernel(m_program, "winogradInputTransform");
+        cl_kernel kernel = cached_kernel.get();
+
+        m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+        CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+        m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(scratch_ptr->m_device_data));
+        CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+        const cl_uint args[] = {in_h, in_w, in_channels, pad_top, pad_left, tiles_h, tiles_w, num_tiles};
+        for (cl_uint i = 0u; i < sizeof(args) / sizeof(args[0]); ++i)
+        {
+            m_err = set_kernel_arg(kernel, i + 2u, sizeof(cl_uint), &args[i]);
+            CHECK_CL_ERROR(m_err, "Couldn't set a geometry arg");
+        }
+
+        launch_elementwise(kernel, "winogradInputTransform", num_tiles * in_channels, {this}, scratch_ptr);
+    }
+
+    // products, output transform, bias and relu in one pass
+    const OpenCLKernel cached_kernel(m_program, "winogradOutputTransform");
+    cl_kernel kernel = cached_kernel.get();
+
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &(scratch_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(weight_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_mem), &(bias_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+    const cl_uint args[] = {in_channels, out_channels, tiles_h, tiles_w, num_tiles, out_h, out_w, apply_relu};
+    for (cl_uint i = 0u; i < sizeof(args) / sizeof(args[0]); ++i)
+    {
+        m_err = set_kernel_arg(kernel, i + 4u, sizeof(cl_uint), &args[i]);
+        CHECK_CL_ERROR(m_err, "Couldn't set a geometry arg");
+    }
+
+    // enqueue the kernel for execution
+    launch_elementwise(kernel, "winogradOutputTransform", num_tiles * out_channels,
+                       {scratch_ptr, weight_ptr, bias_ptr}, result_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::quantized_dense_on_device(const Tensor<int8_t>* weight, const Tensor<int32_t>* requant,
+                                                     const QuantizedGemmParams& params, Tensor<DATA_T>* result) const
+{
+    auto weight_ptr = dynamic_cast<const TensorOpenCL<int8_t>*>(weight);
+    auto requant_ptr = dynamic_cast<const TensorOpenCL<int32_t>*>(requant);
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!weight_ptr || !requant_ptr || !result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "denseInt8");
+    cl_kernel kernel = cached_kernel.get();
+
+    const cl_uint rows = m_dims[0];
+    const cl_uint inner = m_dims[1];
+    const cl_uint cols = weight_ptr->get_dims()[0];
+    const cl_mem weight_data = weight_ptr->get_device_data();
+    const cl_mem requant_data = requant_ptr->get_device_data();
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &weight_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_mem), &requant_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+    m_err = set_kernel_arg(kernel, 4, sizeof(cl_uint), &rows);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 5");
+    m_err = set_kernel_arg(kernel, 5, sizeof(cl_uint), &inner);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 6");
+    m_err = set_kernel_arg(kernel, 6, sizeof(cl_uint), &cols);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 7");
+    m_err = set_kernel_arg(kernel, 7, sizeof(float), &params.input_scale);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 8");
+    m_err = set_kernel_arg(kernel, 8, sizeof(cl_int), &params.input_zero_point);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 9");
+    m_err = set_kernel_arg(kernel, 9, sizeof(float), &params.output_scale);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 10");
+    m_err = set_kernel_arg(kernel, 10, sizeof(cl_int), &params.output_zero_point);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 11");
+    m_err = set_kernel_arg(kernel, 11, sizeof(cl_int), &params.activation_min);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 12");
+    m_err = set_kernel_arg(kernel, 12, sizeof(cl_int), &params.activation_max);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 13");
+
+    // same tiling as the float dense kernel, so the work-group size is fixed too
+    if (OpenCLAutotuner::instance().get_max_work_group_size(m_queue, kernel) < DENSE_TILE_DIM * DENSE_TILE_DIM)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("The device can't run the denseInt8 kernel, it needs work-groups of "
+                                 + std::to_string(DENSE_TILE_DIM * DENSE_TILE_DIM));
+    }
+    check_local_mem(2u * DENSE_TILE_DIM * DENSE_TILE_DIM * sizeof(cl_int), "denseInt8");
+
+    // one work-item per output element, rounded up to whole tiles
+    size_t global_size[] = {OpenCLAutotuner::round_up(cols, DENSE_TILE_DIM), OpenCLAutotuner::round_up(rows, DENSE_TILE_DIM)};
+    size_t local_size[] = {DENSE_TILE_DIM, DENSE_TILE_DIM};
+
+    // enqueue the kernel for execution, the int8 weights and requant table are read too
+    enqueue_kernel(kernel, 2, global_size, local_size, {this}, result_ptr, weight_ptr, requant_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::pool2d_on_device(POOLING pooling, const Conv2DParams& params, Tensor<DATA_T>* result) const
+{
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "pool2d");
+    cl_kernel kernel = cached_kernel.get();
+
+    const size_t length = result_ptr->get_size();
+    const cl_uint args[] = {static_cast<cl_uint>(m_dims[1]), static_cast<cl_uint>(m_dims[2]), static_cast<cl_uint>(m_dims[3]),
+                            static_cast<cl_uint>(params.kernel_h), static_cast<cl_uint>(params.kernel_w),
+                            static_cast<cl_uint>(params.stride_h), static_cast<cl_uint>(params.stride_w),
+                            static_cast<cl_uint>(params.pad_top), static_cast<cl_uint>(params.pad_left),
+                            static_cast<cl_uint>(params.out_h), static_cast<cl_uint>(params.out_w),
+                            pooling == POOLING::AVERAGE ? 1u : 0u, static_cast<cl_uint>(length)};
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    for (cl_uint i = 0u; i < sizeof(args) / sizeof(args[0]); ++i)
+    {
+        m_err = set_kernel_arg(kernel, i + 2u, sizeof(cl_uint), &args[i]);
+        CHECK_CL_ERROR(m_err, "Couldn't set a geometry arg");
+    }
+
+    // enqueue the kernel for execution
+    launch_elementwise(kernel, "pool2d", length, {this}, result_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::reshape_on_device(Tensor<DATA_T>* result) const
+{
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    // a retained buffer is released, never returned to the pool, when the view lets go of it
+    result_ptr->release_device_data();
+    m_err = clRetainMemObject(m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't retain the device buffer");
+    result_ptr->m_device_data = m_device_data;
+    result_ptr->m_device_capacity = m_size;
+    result_ptr->m_device_data_pooled = false;
+    result_ptr->m_events = m_events;
+    result_ptr->m_platform = PLATFORM::DEVICE;
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::relu_on_device(Tensor<DATA_T>* result) const
+{
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "matRelu");
+    cl_kernel kernel = cached_kernel.get();
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    const cl_uint length = m_size;
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_uint), &length);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+
+    // enqueue the kernel for execution
+    launch_elementwise(kernel, "matRelu", m_size, {this}, result_ptr);
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::argmax_on_device(Tensor<DATA_T>* result) const
+{
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "matArgMax");
+    cl_kernel kernel = cached_kernel.get();
+
+    const cl_uint rows = this->get_argmax_rows();
+    const cl_uint cols = m_size / rows;
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_uint), &rows);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_uint), &cols);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+
+    check_local_mem(ARGMAX_MAX_LOCAL_SIZE * (sizeof(float) + sizeof(cl_uint)), "matArgMax");
+
+    // one work-group per row, the reduction needs a power-of-two local size
+    launch_tuned("matArgMax", OpenCLAutotuner::get_shape_class({rows, cols}),
+                 get_local_size_candidates(kernel, {64u, 128u, 256u, 32u}), this == result_ptr,
+                 [&](size_t local_size)
+                 {
+                     size_t global_size = rows * local_size;
+                     enqueue_kernel(kernel, 1, &global_size, &local_size, {this}, result_ptr);
+                 });
+}
+
+template<typename DATA_T>
+void TensorOpenCL<DATA_T>::softmax_on_device(Tensor<DATA_T>* result) const
+{
+    auto result_ptr = dynamic_cast<TensorOpenCL<DATA_T>*>(result);
+
+    if (!result_ptr)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::runtime_error("Couldn't cast to TensorOpenCL");
+    }
+    result_ptr->ensure_device_capacity();
+
+    // lease a cached kernel, it goes back to the cache once enqueued
+    const OpenCLKernel cached_kernel(m_program, "matSoftmax");
+    cl_kernel kernel = cached_kernel.get();
+
+    const cl_uint rows = this->get_argmax_rows();
+    const cl_uint cols = m_size / rows;
+
+    // set kernel args
+    m_err = set_kernel_arg(kernel, 0, sizeof(cl_mem), &m_device_data);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 1");
+    m_err = set_kernel_arg(kernel, 1, sizeof(cl_mem), &(result_ptr->m_device_data));
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 2");
+    m_err = set_kernel_arg(kernel, 2, sizeof(cl_uint), &rows);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 3");
+    m_err = set_kernel_arg(kernel, 3, sizeof(cl_uint), &cols);
+    CHECK_CL_ERROR(m_err, "Couldn't set arg 4");
+
+    check_local_mem(SOFTMAX_MAX_LOCAL_SIZE * sizeof(float), "matSoftmax");
+
+    // one work-group per row like argmax; a trial of an in-place softmax must not run on its own output
+    launch_tuned("matSoftmax", OpenCLAutotuner::get_shape_class({rows, cols}),
+                 get_local_size_candidates(kernel, {64u, 128u, 256u, 32u}), this == result_ptr,
+                 [&](size_t local_size)
+                 {
+                     size_t global_size = rows * local_size;
+                     enqueue_kernel(kernel, 1, &global_size, &local_size, {this}, result_ptr);
+                 });
+}
+
 #endif  // TENSOR_OPENCL_H
\ No newline at end of file
@@ -0,0 +1,200 @@
+#ifndef TENSOR_VIEW_H
+#define TENSOR_VIEW_H
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+* @brief  non-owning, strided window over host memory with a compile-time rank
+* @note   strides are cached at construction, so element access is RANK multiply-adds
+*         and never allocates. Use TensorView<const DATA_T, RANK> for read-only access.
+*         slice, transpose and reshape return new views over the same memory.
+*/
+template<typename DATA_T, size_t RANK>
+class TensorView
+{
+    static_assert(RANK > 0, "TensorView needs at least one dimension");
+
+public:
+    TensorView(DATA_T* data, const std::array<size_t, RANK>& dims);
+    TensorView(DATA_T* data, const std::array<size_t, RANK>& dims, const std::array<size_t, RANK>& strides);
+
+    // allow TensorView<T, R> -> TensorView<const T, R>
+    template<typename OTHER_T, typename = std::enable_if_t<std::is_convertible<OTHER_T*, DATA_T*>::value>>
+    TensorView(const TensorView<OTHER_T, RANK>& other): TensorView(other.data(), other.get_dims(), other.get_strides())
+    {
+    }
+
+    template<typename... Args>
+    DATA_T& operator()(Args... indices) const
+    {
+        static_assert(sizeof...(Args) == RANK, "Number of indices must match the rank of the view");
+        size_t index = 0u;
+        size_t axis  = 0u;
+        ((index += static_cast<size_t>(indices) * m_strides[axis++]), ...);
+        return m_data[index];
+    }
+
+    DATA_T* data() const;
+    size_t size() const;
+    size_t dim(size_t axis) const;
+    size_t stride(size_t axis) const;
+    const std::array<size_t, RANK>& get_dims() const;
+    const std::array<size_t, RANK>& get_strides() const;
+    bool is_contiguous() const;
+
+    // contiguous span access, only valid when is_contiguous() holds
+    DATA_T* begin() const;
+    DATA_T* end() const;
+
+    TensorView<DATA_T, RANK> slice(size_t axis, size_t begin, size_t end) const;
+    TensorView<DATA_T, RANK> transpose(size_t axis0, size_t axis1) const;
+    template<size_t NEW_RANK>
+    TensorView<DATA_T, NEW_RANK> reshape(const std::array<size_t, NEW_RANK>& dims) const;
+
+private:
+    DATA_T*                  m_data;
+    std::array<size_t, RANK> m_dims;
+    std::array<size_t, RANK> m_strides;
+};
+
+template<typename DATA_T, size_t RANK>
+TensorView<DATA_T, RANK>::TensorView(DATA_T* data, const std::array<size_t, RANK>& dims): m_data(data), m_dims(dims)
+{
+    // row-major: the last dimension is contiguous
+    size_t stride = 1u;
+    for (auto axis = RANK; axis-- > 0u;)
+    {
+        m_strides[axis] = stride;
+        stride *= m_dims[axis];
+    }
+}
+
+template<typename DATA_T, size_t RANK>
+TensorView<DATA_T, RANK>::TensorView(DATA_T* data, const std::array<size_t, RANK>& dims, const std::array<size_t, RANK>& strides):
+    m_data(data), m_dims(dims), m_strides(strides)
+{
+}
+
+template<typename DATA_T, size_t RANK>
+DATA_T* TensorView<DATA_T, RANK>::data() const
+{
+    return m_data;
+}
+
+template<typename DATA_T, size_t RANK>
+size_t TensorView<DATA_T, RANK>::size() const
+{
+    size_t size = 1u;
+    for (const auto dim : m_dims)
+    {
+        size *= dim;
+    }
+    return size;
+}
+
+template<typename DATA_T, size_t RANK>
+size_t TensorView<DATA_T, RANK>::dim(size_t axis) const
+{
+    return m_dims[axis];
+}
+
+template<typename DATA_T, size_t RANK>
+size_t TensorView<DATA_T, RANK>::stride(size_t axis) const
+{
+    return m_strides[axis];
+}
+
+template<typename DATA_T, size_t RANK>
+const std::array<size_t, RANK>& TensorView<DATA_T, RANK>::get_dims() const
+{
+    return m_dims;
+}
+
+template<typename DATA_T, size_t RANK>
+const std::array<size_t, RANK>& TensorView<DATA_T, RANK>::get_strides() const
+{
+    return m_strides;
+}
+
+template<typename DATA_T, size_t RANK>
+bool TensorView<DATA_T, RANK>::is_contiguous() const
+{
+    size_t stride = 1u;
+    for (auto axis = RANK; axis-- > 0u;)
+    {
+        // dimensions of size one can have any stride
+        if (m_dims[axis] != 1u && m_strides[axis] != stride)
+        {
+            return false;
+        }
+        stride *= m_dims[axis];
+    }
+    return true;
+}
+
+template<typename DATA_T, size_t RANK>
+DATA_T* TensorView<DATA_T, RANK>::begin() const
+{
+    return m_data;
+}
+
+template<typename DATA_T, size_t RANK>
+DATA_T* TensorView<DATA_T, RANK>::end() const
+{
+    return m_data + size();
+}
+
+template<typename DATA_T, size_t RANK>
+TensorView<DATA_T, RANK> TensorView<DATA_T, RANK>::slice(size_t axis, size_t begin, size_t end) const
+{
+    if (axis >= RANK || begin > end || end > m_dims[axis])
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::out_of_range("Slice is out of the view's range");
+    }
+
+    auto dims = m_dims;
+    dims[axis] = end - begin;
+    return TensorView<DATA_T, RANK>(m_data + begin * m_strides[axis], dims, m_strides);
+}
+
+template<typename DATA_T, size_t RANK>
+TensorView<DATA_T, RANK> TensorView<DATA_T, RANK>::transpose(size_t axis0, size_t axis1) const
+{
+    if (axis0 >= RANK || axis1 >= RANK)
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::out_of_range("Transpose axis is out of range");
+    }
+
+    auto dims    = m_dims;
+    auto strides = m_strides;
+    std::swap(dims[axis0], dims[axis1]);
+    std::swap(strides[axis0], strides[axis1]);
+    return TensorView<DATA_T, RANK>(m_data, dims, strides);
+}
+
+template<typename DATA_T, size_t RANK>
+template<size_t NEW_RANK>
+TensorView<DATA_T, NEW_RANK> TensorView<DATA_T, RANK>::reshape(const std::array<size_t, NEW_RANK>& dims) const
+{
+    if (!is_contiguous())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Only contiguous views can be reshaped");
+    }
+
+    auto view = TensorView<DATA_T, NEW_RANK>(m_data, dims);
+    if (view.size() != size())
+    {
+        std::cerr <<  __FILE__ << ": "<< __LINE__ << std::endl;
+        throw std::invalid_argument("Reshape must preserve the number of elements");
+    }
+    return view;
+}
+
+#endif  // TENSOR_VIEW_H
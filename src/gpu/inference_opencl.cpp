@@ -0,0 +1,319 @@
+#include "inference_opencl.h"
+
+#include "nn/common.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/tensor/OpenCLKernelCache.h"
+#include "nn/tensor/OpenCLBufferPool.h"
+#include "kernels_source.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// part of the program cache key, so changing them never loads a stale binary
+#define KERNEL_BUILD_OPTIONS ""
+
+static std::string& program_cache_dir()
+{
+    static std::string dir = []()
+    {
+        if (const char* dir_from_env = std::getenv("OPENCL_PROGRAM_CACHE_DIR"))
+        {
+            return std::string(dir_from_env);
+        }
+        // per user: on CPU runtimes the binaries are native code, so a shared directory would run anyone's
+#ifdef _WIN32
+        const char* local_app_data = std::getenv("LOCALAPPDATA");
+        const auto cache_home = local_app_data && *local_app_data ? std::filesystem::path(local_app_data) : std::filesystem::path();
+#else
+        const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME");
+        const char* home = std::getenv("HOME");
+        const auto cache_home = xdg_cache_home && *xdg_cache_home ? std::filesystem::path(xdg_cache_home)
+                                : home && *home                   ? std::filesystem::path(home) / ".cache"
+                                                                  : std::filesystem::path();
+#endif
+        return cache_home.empty() ? std::string() : (cache_home / "parallel_ai_inference").string();
+    }();
+    return dir;
+}
+
+// a directory only the current user can write to, anything else is never read from or written to
+static bool is_private_directory(const std::string& dir)
+{
+#ifdef _WIN32
+    std::error_code err;
+    return std::filesystem::is_directory(dir, err);
+#else
+    struct stat info;
+    return lstat(dir.c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == geteuid() &&
+           (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+#endif
+}
+
+// creates dir with mode 0700 if it is missing
+static bool create_private_directory(const std::string& dir)
+{
+    std::error_code err;
+    std::filesystem::create_directories(std::filesystem::path(dir).parent_path(), err);
+#ifdef _WIN32
+    std::filesystem::create_directory(dir, err);
+#else
+    // fails if dir exists, which is checked below
+    mkdir(dir.c_str(), 0700);
+#endif
+    return is_private_directory(dir);
+}
+
+void set_program_cache_dir(const std::string& dir)
+{
+    program_cache_dir() = dir;
+}
+
+std::string get_program_cache_dir()
+{
+    return program_cache_dir();
+}
+
+static std::string get_device_string(cl_device_id device, cl_device_info param)
+{
+    size_t size = 0u;
+    clGetDeviceInfo(device, param, 0, NULL, &size);
+    std::string value(size, '\0');
+    clGetDeviceInfo(device, param, size, &value[0], NULL);
+    // drop the terminating null
+    return value.c_str();
+}
+
+// FNV-1a, only used to name cache files; the full key is stored in the file and compared on load
+static uint64_t hash_string(const std::string& value)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto c : value)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string get_program_cache_key(cl_device_id device, const std::string& kernel_source)
+{
+    char source_hash[17];
+    std::snprintf(source_hash, sizeof(source_hash), "%016llx", static_cast<unsigned long long>(hash_string(kernel_source)));
+    return get_device_string(device, CL_DEVICE_NAME) + "|" + get_device_string(device, CL_DEVICE_VERSION) + "|" +
+           get_device_string(device, CL_DRIVER_VERSION) + "|" + KERNEL_BUILD_OPTIONS + "|" + source_hash;
+}
+
+static std::string get_program_cache_path(const std::string& key)
+{
+    char file_name[32];
+    std::snprintf(file_name, sizeof(file_name), "%016llx.clbin", static_cast<unsigned long long>(hash_string(key)));
+    return (std::filesystem::path(get_program_cache_dir()) / file_name).string();
+}
+
+// cache file layout: the key, a null byte, then the binary
+static cl_program load_cached_program(const OpenCLRuntime& runtime, const std::string& key, const std::string& path)
+{
+    if (!is_private_directory(get_program_cache_dir()))
+    {
+        return nullptr;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return nullptr;
+    }
+    std::string stored_key;
+    std::getline(file, stored_key, '\0');
+    if (stored_key != key)
+    {
+        return nullptr;
+    }
+    const std::vector<unsigned char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (binary.empty())
+    {
+        return nullptr;
+    }
+
+    const unsigned char* binary_ptr = binary.data();
+    const size_t binary_size = binary.size();
+    cl_int binary_status = CL_SUCCESS;
+    cl_int err = CL_SUCCESS;
+    auto program = clCreateProgramWithBinary(runtime.context, 1, &runtime.device, &binary_size, &binary_ptr, &binary_status, &err);
+    if (err != CL_SUCCESS)
+    {
+        return nullptr;
+    }
+    if (binary_status != CL_SUCCESS)
+    {
+        clReleaseProgram(program);
+        return nullptr;
+    }
+    // binaries still need a build, but it doesn't compile anything
+    err = clBuildProgram(program, 1, &runtime.device, KERNEL_BUILD_OPTIONS, NULL, NULL);
+    if (err != CL_SUCCESS)
+    {
+        clReleaseProgram(program);
+        return nullptr;
+    }
+    return program;
+}
+
+static void store_cached_program(const OpenCLRuntime& runtime, const std::string& key, const std::string& path)
+{
+    size_t binary_size = 0u;
+    cl_int err = clGetProgramInfo(runtime.program, CL_PROGRAM_BINARY_SIZES, sizeof(binary_size), &binary_size, NULL);
+    if (err != CL_SUCCESS || binary_size == 0u)
+    {
+        return;
+    }
+    std::vector<unsigned char> binary(binary_size);
+    unsigned char* binary_ptr = binary.data();
+    err = clGetProgramInfo(runtime.program, CL_PROGRAM_BINARIES, sizeof(binary_ptr), &binary_ptr, NULL);
+    if (err != CL_SUCCESS)
+    {
+        return;
+    }
+
+    // write to a temporary file and rename it, so concurrent processes never read a partial binary
+    if (!create_private_directory(get_program_cache_dir()))
+    {
+        std::cerr << "The program cache " << get_program_cache_dir() << " is not a private directory, not caching" << std::endl;
+        return;
+    }
+    std::error_code fs_err;
+    const auto temp_path = path + ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream file(temp_path, std::ios::binary);
+        file.write(key.c_str(), key.size() + 1u);
+        file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+        if (!file)
+        {
+            std::cerr << "Couldn't write the program cache " << temp_path << std::endl;
+        }
+    }
+    std::filesystem::rename(temp_path, path, fs_err);
+    if (fs_err)
+    {
+        std::filesystem::remove(temp_path, fs_err);
+    }
+}
+
+OpenCLRuntime create_opencl_runtime(cl_command_queue_properties queue_properties, bool verbose)
+{
+    return create_opencl_runtime_from_source(KERNELS_SOURCE, queue_properties, verbose);
+}
+
+OpenCLRuntime create_opencl_runtime_from_source(const std::string& kernel_source, cl_command_queue_properties queue_properties, bool verbose)
+{
+    auto runtime = OpenCLRuntime();
+    cl_int err = CL_SUCCESS;
+
+    err = clGetPlatformIDs(1, &runtime.platform, NULL);
+    CHECK_CL_ERROR(err, "Couldn't get platform");
+
+    // set the device
+    err = clGetDeviceIDs(runtime.platform, CL_DEVICE_TYPE_GPU, 1, &runtime.device, NULL);
+    if (err == CL_SUCCESS)
+    {
+        // at least one OpenCL capable GPU exists
+        cl_ulong local_mem_size;
+        err = clGetDeviceInfo(runtime.device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &local_mem_size, nullptr);
+        CHECK_CL_ERROR(err, "Error querying device info.");
+        if (verbose)
+        {
+            std::cout << "GPU found" << std::endl;
+            std::cout << "Maximum local memory size per work group: " << local_mem_size / 1024 << " KB" << std::endl;
+        }
+    }
+    else
+    {
+        // default to CPU
+        err = clGetDeviceIDs(runtime.platform, CL_DEVICE_TYPE_CPU, 1, &runtime.device, NULL);
+        CHECK_CL_ERROR(err, "Couldn't find an OpenCL device");
+        if (verbose)
+        {
+            std::cout << "No GPU found, switched back to CPU" << std::endl;
+        }
+    }
+
+    runtime.context = clCreateContext(NULL, 1, &runtime.device, NULL, NULL, &err);
+    CHECK_CL_ERROR(err, "Couldn't create the context");
+    runtime.queue = clCreateCommandQueue(runtime.context, runtime.device, queue_properties, &err);
+    CHECK_CL_ERROR(err, "Couldn't create the queue");
+
+    // warm starts load the binary compiled by an earlier run
+    const auto cache_enabled = !get_program_cache_dir().empty();
+    const auto cache_key = cache_enabled ? get_program_cache_key(runtime.device, kernel_source) : std::string();
+    const auto cache_path = cache_enabled ? get_program_cache_path(cache_key) : std::string();
+    if (cache_enabled)
+    {
+        runtime.program = load_cached_program(runtime, cache_key, cache_path);
+        runtime.program_from_cache = runtime.program != nullptr;
+        if (runtime.program_from_cache)
+        {
+            if (verbose)
+            {
+                std::cout << "Loaded the kernels from " << cache_path << std::endl;
+            }
+            return runtime;
+        }
+    }
+
+    // create a program from kernel source code
+    const char* kernel_source_ptr = kernel_source.c_str();
+    runtime.program = clCreateProgramWithSource(runtime.context, 1, &kernel_source_ptr, NULL, &err);
+    CHECK_CL_ERROR(err, "Couldn't create the program");
+    // build the program
+    err = clBuildProgram(runtime.program, 1, &runtime.device, KERNEL_BUILD_OPTIONS, NULL, NULL);
+    if (verbose || err != CL_SUCCESS)
+    {
+        // print the build log
+        size_t log_size;
+        clGetProgramBuildInfo(runtime.program, runtime.device, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+        std::vector<char> log(log_size + 1, '\0');
+        clGetProgramBuildInfo(runtime.program, runtime.device, CL_PROGRAM_BUILD_LOG, log_size, log.data(), NULL);
+        std::cerr << "Build log:\n" << log.data() << std::endl;
+    }
+    CHECK_CL_ERROR(err, "Couldn't build the program");
+
+    if (cache_enabled)
+    {
+        store_cached_program(runtime, cache_key, cache_path);
+    }
+
+    return runtime;
+}
+
+void release_opencl_runtime(OpenCLRuntime& runtime)
+{
+    if (runtime.queue)
+    {
+        clFinish(runtime.queue);
+    }
+    if (runtime.program)
+    {
+        OpenCLKernelCache::instance().release_program(runtime.program);
+        clReleaseProgram(runtime.program);
+    }
+    if (runtime.queue)
+    {
+        clReleaseCommandQueue(runtime.queue);
+    }
+    if (runtime.context)
+    {
+        OpenCLBufferPool::instance().release_context(runtime.context);
+        clReleaseContext(runtime.context);
+    }
+    runtime = OpenCLRuntime();
+}
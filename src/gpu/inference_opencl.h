@@ -0,0 +1,36 @@
+#ifndef INFERENCE_OPENCL_H
+#define INFERENCE_OPENCL_H
+
+#include <CL/cl.h>
+
+#include <string>
+
+/*
+* @brief  the OpenCL objects every TensorOpenCL needs, created once per process
+*/
+struct OpenCLRuntime
+{
+    cl_platform_id   platform = nullptr;
+    cl_device_id     device   = nullptr;
+    cl_context       context  = nullptr;
+    cl_command_queue queue    = nullptr;
+    cl_program       program  = nullptr;
+    bool             program_from_cache = false;  // loaded from a cached binary instead of built from source
+};
+
+// picks the first GPU (or the CPU if there is none) and builds the kernels embedded at build time
+OpenCLRuntime create_opencl_runtime(cl_command_queue_properties queue_properties = 0, bool verbose = true);
+// same, but builds kernel_source instead, e.g. kernels being edited without rebuilding
+OpenCLRuntime create_opencl_runtime_from_source(const std::string& kernel_source, cl_command_queue_properties queue_properties = 0,
+                                                bool verbose = true);
+
+// compiled program binaries are cached in this directory, keyed by device, driver version, build options
+// and source hash. Defaults to $OPENCL_PROGRAM_CACHE_DIR, or parallel_ai_inference in $XDG_CACHE_HOME,
+// ~/.cache or %LOCALAPPDATA%; an empty path disables the cache. The directory is created with mode 0700
+// and only used while it is owned by the current user and nobody else can write to it
+void set_program_cache_dir(const std::string& dir);
+std::string get_program_cache_dir();
+// releases cached kernels, the program, the queue and the context
+void release_opencl_runtime(OpenCLRuntime& runtime);
+
+#endif  // INFERENCE_OPENCL_H
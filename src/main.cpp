@@ -1,128 +1,172 @@
-#include "nn/tensor/TensorOpenCL.h"
-#include "nn/model/Model.h"
-#include "nn/layer/Dense.h"
-#include "nn/layer/Activation.h"
-
-#include <CL/cl.h>
-#include <iostream>
-#include <cassert>
-
-int main(int argc, char** argv)
-{
-    std::cout << "Welcome to the Parallel AI Inference project" << std::endl;
-
-    // initialize OpenCL
-    cl_int err = CL_SUCCESS;
-    cl_platform_id platform_id;
-    cl_device_id device;
-    cl_context context;
-    cl_program program;
-    cl_command_queue queue;
-
-    err = clGetPlatformIDs(1, &platform_id, NULL); 
-    CHECK_CL_ERROR(err, "Couldn't get platform");
-
-    // set the device
-    err = clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_GPU, 1, &device, NULL);
-    if (err == CL_SUCCESS)
-    {
-        // at least one OpenCL capable GPU exists
-        std::cout << "GPU found" << std::endl;
-        // Query local memory size
-        cl_ulong localMemSize;
-        err = clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &localMemSize, nullptr);
-        CHECK_CL_ERROR(err, "Error querying device info.");
-        std::cout << "Maximum local memory size per work group: " << localMemSize / 1024 << " KB" << std::endl;
-    }
-    else
-    {
-        // default to CPU
-        clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_CPU, 1, &device, NULL);
-        std::cout << "No GPU found, switched back to CPU" << std::endl;
-    }
-    
-    context = clCreateContext(NULL, 1, &device, NULL, NULL, &err);
-    CHECK_CL_ERROR(err, "Couldn't create the context");
-    queue = clCreateCommandQueue(context, device, NULL, &err);
-    CHECK_CL_ERROR(err, "Couldn't create the queue");
-
-    // create a program from kernel source code
-    const auto file_name = "../src/gpu/kernels.clh";
-    const auto kernel_source_string = read_file(file_name);
-    const char* kernel_source = kernel_source_string.c_str();
-    program = clCreateProgramWithSource(context, 1, &kernel_source, NULL, &err);
-    CHECK_CL_ERROR(err, "Couldn't create the program");
-    // build the program
-    err = clBuildProgram(program, 1, &device, NULL, NULL, NULL);
-    // ****************** Start of Diagnostic Logs ******************
-    // Query the build log
-    size_t log_size;
-    clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
-    char *log = new char[log_size];
-    clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, log_size, log, NULL);
-    // Print the build log
-    std::cerr << "Build log:\n" << log << std::endl;
-    delete[] log;
-    // ****************** End of Diagnostic Logs ******************
-    CHECK_CL_ERROR(err, "Couldn't build the program"); 
-
-    auto input = new TensorOpenCL<float>(program, queue, context);
-    input->set_host_data({1.0f, 2.0f, 3.0f});
-    input->set_dims({1, 3});
-    input->load_to_device();
-
-    auto result = new TensorOpenCL<float>(program, queue, context);
-    result->set_host_data({0.0f, 0.0f, 0.0f,
-                           0.0f, 0.0f, 0.0f,
-                           0.0f, 0.0f, 0.0f});
-    result->set_dims({3, 3});
-    result->load_to_device();
-
-    // dense 1
-    auto weight1 = new TensorOpenCL<float>(program, queue, context);
-    weight1->set_host_data({3.0f, 2.0f, 1.0f,
-                            6.0f, 5.0f, 4.0f,
-                            2.0f, 3.0f, 4.0f});
-    weight1->set_dims({3, 3});
-
-    auto bias1  = new TensorOpenCL<float>(program, queue, context);
-    bias1->set_host_data({5.0f, 4.0f, 3.0f});
-    bias1->set_dims({1, 3});
-    
-    auto dense1 = new Dense();
-    dense1->set_weight(weight1);
-    dense1->set_bias(bias1);
-
-    // dense 2
-    auto weight2 = new TensorOpenCL<float>(program, queue, context);
-    weight2->set_host_data({-3.0f, 2.0f,
-                            2.0f, 1.0f,
-                            -1.0f, 4.0f});
-    weight2->set_dims({3, 2});
-
-    auto bias2  = new TensorOpenCL<float>(program, queue, context);
-    bias2->set_host_data({5.0f, 4.0f});
-    bias2->set_dims({1, 2});
-    
-    auto dense2 = new Dense();
-    dense2->set_weight(weight2);
-    dense2->set_bias(bias2);
-
-    auto relu1 = new Activation(ACTIVATION::RELU);
-    auto argmax1 = new Activation(ACTIVATION::ARGMAX);
-
-    auto model = Model();
-    model.add_layer(dense1);
-    model.add_layer(relu1);
-    model.add_layer(dense2);
-    model.add_layer(argmax1);
-    model.to_device();
-    model.execute(input, result);
-
-    clFinish(queue);
-
-    result->load_to_host();
-
-    std::cout << "input: "    << input->to_string(true, true, true, true);
-    std::cout << "result: "   << result->to_string(true, true, true, true);
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/model/Model.h"
+#include "nn/model/TFLiteLoader.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+#include "nn/profiling/Profiler.h"
+#include "inference_opencl.h"
+
+#include <CL/cl.h>
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+
+// tensors and models release their device buffers to the runtime, so they must not outlive it
+static void run_tflite_model(const OpenCLRuntime& runtime, const char* model_path)
+{
+    const auto program = runtime.program;
+    const auto queue   = runtime.queue;
+    const auto context = runtime.context;
+
+    // run a .tflite model on an all-zero input, the weights are mapped from the file
+    auto model = Model();
+    const auto loader = TFLiteLoader(model_path);
+    loader.load(model, [&]() -> Tensor<float>* { return new TensorOpenCL<float>(program, queue, context); });
+
+    auto input = std::make_unique<TensorOpenCL<float>>(program, queue, context);
+    input->set_dims(loader.get_input_dims());
+    input->set_host_data(std::vector<float>(input->get_size(), 0.0f));
+    input->load_to_device();
+
+    auto result = std::make_unique<TensorOpenCL<float>>(program, queue, context);
+    result->set_dims(loader.get_output_dims());
+    result->set_host_data(std::vector<float>(result->get_size(), 0.0f));
+    result->load_to_device();
+
+    model.to_device();
+    model.execute(input.get(), result.get());
+    clFinish(queue);
+    result->load_to_host();
+
+    std::cout << "model: "  << model_path << std::endl;
+    std::cout << "result: " << result->to_string(true, true, true, true);
+}
+
+static void run_demo_model(const OpenCLRuntime& runtime)
+{
+    const auto program = runtime.program;
+    const auto queue   = runtime.queue;
+    const auto context = runtime.context;
+
+    // dense 1
+    auto weight1 = new TensorOpenCL<float>(program, queue, context);
+    weight1->set_host_data({3.0f, 2.0f, 1.0f,
+                            6.0f, 5.0f, 4.0f,
+                            2.0f, 3.0f, 4.0f});
+    weight1->set_dims({3, 3});
+
+    auto bias1  = new TensorOpenCL<float>(program, queue, context);
+    bias1->set_host_data({5.0f, 4.0f, 3.0f});
+    bias1->set_dims({1, 3});
+    
+    auto dense1 = new Dense();
+    dense1->set_weight(weight1);
+    dense1->set_bias(bias1);
+
+    // dense 2
+    auto weight2 = new TensorOpenCL<float>(program, queue, context);
+    weight2->set_host_data({-3.0f, 2.0f,
+                            2.0f, 1.0f,
+                            -1.0f, 4.0f});
+    weight2->set_dims({3, 2});
+
+    auto bias2  = new TensorOpenCL<float>(program, queue, context);
+    bias2->set_host_data({5.0f, 4.0f});
+    bias2->set_dims({1, 2});
+    
+    auto dense2 = new Dense();
+    dense2->set_weight(weight2);
+    dense2->set_bias(bias2);
+
+    auto relu1 = new Activation(ACTIVATION::RELU);
+    auto argmax1 = new Activation(ACTIVATION::ARGMAX);
+
+    auto model = Model();
+    model.add_layer(dense1);
+    model.add_layer(relu1);
+    model.add_layer(dense2);
+    model.add_layer(argmax1);
+    model.to_device();
+
+    // the same model runs any batch size, every row of the input is one sample
+    for (size_t batch_size : {1u, 8u, 64u, 256u, 1024u})
+    {
+        std::vector<float> input_data(batch_size * 3u);
+        for (auto i = 0u; i < input_data.size(); ++i)
+        {
+            input_data[i] = static_cast<float>(i % 7u) - 3.0f;
+        }
+
+        auto input = TensorOpenCL<float>(program, queue, context);
+        input.set_host_data(input_data);
+        input.set_dims({batch_size, 3});
+        input.load_to_device();
+
+        // the result grows to {batch_size, 1} on the first execute
+        auto result = TensorOpenCL<float>(program, queue, context);
+        result.set_host_data({0.0f});
+        result.set_dims({1, 1});
+        result.load_to_device();
+
+        const auto start = std::chrono::steady_clock::now();
+        model.execute(&input, &result);
+        clFinish(queue);
+        const auto elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        result.load_to_host();
+
+        std::cout << "batch " << batch_size << ": " << elapsed_us << " us, "
+                  << elapsed_us / batch_size << " us per sample" << std::endl;
+        if (batch_size == 1u)
+        {
+            std::cout << "input: "    << input.to_string(true, true, true, true);
+            std::cout << "result: "   << result.to_string(true, true, true, true);
+        }
+    }
+
+    const auto& buffer_pool = OpenCLBufferPool::instance();
+    std::cout << "device buffer pool: " << buffer_pool.get_num_hits() << " hits, "
+              << buffer_pool.get_num_misses() << " misses" << std::endl;
+    std::cout << "autotuned launch configurations: " << OpenCLAutotuner::instance().get_num_tuned() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Welcome to the Parallel AI Inference project" << std::endl;
+
+    // PROFILE_TRACE=trace.json prints the time of every layer, kernel and transfer and writes a Chrome trace
+    const char* profile_trace = std::getenv("PROFILE_TRACE");
+    Profiler::set_enabled(profile_trace != nullptr);
+
+    // initialize OpenCL, the queue only records event timestamps when profiling
+    auto runtime = create_opencl_runtime(profile_trace ? CL_QUEUE_PROFILING_ENABLE : 0);
+
+    // launch parameters tuned on earlier runs are reused, new shapes are tuned and appended
+    if (const char* autotune_cache = std::getenv("AUTOTUNE_CACHE"))
+    {
+        OpenCLAutotuner::instance().set_cache_path(autotune_cache);
+        OpenCLAutotuner::instance().set_enabled(true);
+    }
+
+    if (argc > 1)
+    {
+        run_tflite_model(runtime, argv[1]);
+    }
+    else
+    {
+        run_demo_model(runtime);
+    }
+
+    if (profile_trace)
+    {
+        auto& profiler = Profiler::instance();
+        std::cout << profiler.get_summary_table();
+        std::ofstream trace(profile_trace);
+        profiler.write_chrome_trace(trace);
+        std::cout << "trace of " << profiler.get_num_runs() << " runs written to " << profile_trace << std::endl;
+    }
+
+    release_opencl_runtime(runtime);
 }
\ No newline at end of file
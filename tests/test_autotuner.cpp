@@ -0,0 +1,69 @@
+#include "nn/tensor/OpenCLAutotuner.h"
+
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Autotuner shape classes bucket dims by power of two", "[autotuner]")
+{
+    REQUIRE(OpenCLAutotuner::get_shape_class({1}) == "0");
+    REQUIRE(OpenCLAutotuner::get_shape_class({64, 65}) == "6x7");
+    REQUIRE(OpenCLAutotuner::get_shape_class({33, 64}) == OpenCLAutotuner::get_shape_class({64, 40}));
+    REQUIRE(OpenCLAutotuner::round_up(17, 16) == 32);
+    REQUIRE(OpenCLAutotuner::round_up(32, 16) == 32);
+}
+
+TEST_CASE("Autotuner picks the fastest candidate and caches it on disk", "[autotuner]")
+{
+    auto& autotuner = OpenCLAutotuner::instance();
+    const std::string cache_path = "test_autotuner_cache.tsv";
+    std::remove(cache_path.c_str());
+    autotuner.clear();
+
+    const std::vector<size_t> candidates = {64, 128, 256};
+    size_t num_runs = 0u;
+    const auto run = [&](size_t candidate)
+    {
+        ++num_runs;
+        // 128 is the only fast candidate
+        if (candidate != 128u)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    };
+
+    SECTION("Disabled tuning returns the fallback without running")
+    {
+        autotuner.set_enabled(false);
+        REQUIRE(autotuner.select("device", "matSum", "10", candidates, 64u, run) == 64u);
+        REQUIRE(num_runs == 0u);
+    }
+
+    SECTION("Winners are reused and reloaded from the cache file")
+    {
+        autotuner.set_cache_path(cache_path);
+        autotuner.set_enabled(true);
+        REQUIRE(autotuner.select("device", "matSum", "10", candidates, 64u, run) == 128u);
+        REQUIRE(num_runs == candidates.size() * (OpenCLAutotuner::NUM_TIMED_RUNS + 1u));
+        REQUIRE(autotuner.get_num_tuned() == 1u);
+
+        num_runs = 0u;
+        REQUIRE(autotuner.select("device", "matSum", "10", candidates, 64u, run) == 128u);
+        REQUIRE(num_runs == 0u);
+
+        // a fresh process only has the file to go by
+        autotuner.clear();
+        autotuner.set_enabled(false);
+        autotuner.set_cache_path(cache_path);
+        REQUIRE(autotuner.select("device", "matSum", "10", candidates, 64u, run) == 128u);
+        REQUIRE(autotuner.select("other device", "matSum", "10", candidates, 64u, run) == 64u);
+        REQUIRE(num_runs == 0u);
+    }
+
+    autotuner.set_enabled(false);
+    autotuner.clear();
+    std::remove(cache_path.c_str());
+}
@@ -0,0 +1,97 @@
+"""Smoke test of the Python bindings, run by ctest when the pybindings module is built.
+
+Skipped when the module (or NumPy) cannot be imported, e.g. pybind11 was not found.
+"""
+import ctypes
+import ctypes.util
+import os
+import threading
+import unittest
+
+try:
+    import numpy as np
+    import pybindings
+    IMPORT_ERROR = None
+except ImportError as error:
+    IMPORT_ERROR = error
+
+MNIST_MODEL_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "models", "TFLite", "mnist_model.tflite")
+
+
+def has_opencl_device():
+    # the bindings assert on OpenCL errors, so look for a platform first
+    name = ctypes.util.find_library("OpenCL")
+    if not name:
+        return False
+    num_platforms = ctypes.c_uint(0)
+    return ctypes.CDLL(name).clGetPlatformIDs(0, None, ctypes.byref(num_platforms)) == 0 and num_platforms.value > 0
+
+
+def make_image(seed):
+    return np.random.default_rng(seed).random((1, 28, 28, 1), dtype=np.float32)
+
+
+@unittest.skipIf(IMPORT_ERROR, "pybindings is not available: {}".format(IMPORT_ERROR))
+class BindingsTest(unittest.TestCase):
+    def check_probabilities(self, output):
+        self.assertEqual(output.shape, (1, 10))
+        self.assertAlmostEqual(float(output.sum()), 1.0, places=4)
+
+    def test_read_only_inputs(self):
+        model = pybindings.Model(MNIST_MODEL_PATH)
+        image = make_image(0)
+        expected = model.execute(image).copy()
+
+        # forcecast passes read-only float32 arrays through without copying them
+        read_only = np.frombuffer(image.tobytes(), dtype=np.float32).reshape(image.shape)
+        self.assertFalse(read_only.flags.writeable)
+        np.testing.assert_allclose(model.execute(read_only), expected, rtol=1e-6)
+
+        broadcast = np.broadcast_to(np.float32(0.5), image.shape)
+        self.check_probabilities(model.execute(broadcast))
+
+    def test_tensor_copies_read_only_arrays(self):
+        image = make_image(1)
+        read_only = np.frombuffer(image.tobytes(), dtype=np.float32).reshape(image.shape)
+        view = np.asarray(pybindings.Tensor(read_only))
+        self.assertTrue(view.flags.writeable)
+        view[0, 0, 0, 0] = 42.0
+        self.assertEqual(read_only[0, 0, 0, 0], image[0, 0, 0, 0])
+
+        # writable arrays are still wrapped without copying
+        writable = make_image(2)
+        np.asarray(pybindings.Tensor(writable))[0, 0, 0, 0] = 42.0
+        self.assertEqual(writable[0, 0, 0, 0], 42.0)
+
+    def execute_concurrently(self, model):
+        images = [make_image(seed) for seed in range(16)]
+        expected = [model.execute(image).copy() for image in images]
+        results = [None] * len(images)
+
+        def run(first):
+            for i in range(first, len(images), 4):
+                results[i] = model.execute(images[i]).copy()
+
+        threads = [threading.Thread(target=run, args=(first,)) for first in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for result, reference in zip(results, expected):
+            self.check_probabilities(result)
+            np.testing.assert_allclose(result, reference, rtol=1e-5, atol=1e-6)
+
+    def test_concurrent_execute_on_host(self):
+        self.execute_concurrently(pybindings.Model(MNIST_MODEL_PATH))
+
+    def test_concurrent_execute_on_device(self):
+        if not has_opencl_device():
+            self.skipTest("no OpenCL device")
+        model = pybindings.Model(MNIST_MODEL_PATH, opencl=True)
+        model.to_device()
+        self.assertEqual(model.platform, pybindings.Platform.DEVICE)
+        self.execute_concurrently(model)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,236 @@
+#include "nn/layer/Conv2D.h"
+#include "nn/layer/Activation.h"
+#include "nn/model/Model.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // direct NHWC convolution with OHWI weights, one multiply-add per tap
+    std::vector<float> reference_conv2d(const std::vector<float>& input, const std::vector<size_t>& input_dims,
+                                        const std::vector<float>& weight, const std::vector<size_t>& weight_dims,
+                                        const std::vector<float>& bias, const Conv2DParams& params)
+    {
+        const auto batch = input_dims[0], in_h = input_dims[1], in_w = input_dims[2], in_c = input_dims[3];
+        const auto out_c = weight_dims[0];
+        std::vector<float> output(batch * params.out_h * params.out_w * out_c);
+        for (size_t n = 0; n < batch; ++n)
+        for (size_t oh = 0; oh < params.out_h; ++oh)
+        for (size_t ow = 0; ow < params.out_w; ++ow)
+        for (size_t oc = 0; oc < out_c; ++oc)
+        {
+            float sum = bias[oc];
+            for (size_t kh = 0; kh < params.kernel_h; ++kh)
+            for (size_t kw = 0; kw < params.kernel_w; ++kw)
+            {
+                const auto ih = static_cast<long>(oh * params.stride_h + kh * params.dilation_h) - static_cast<long>(params.pad_top);
+                const auto iw = static_cast<long>(ow * params.stride_w + kw * params.dilation_w) - static_cast<long>(params.pad_left);
+                if (ih < 0 || iw < 0 || ih >= static_cast<long>(in_h) || iw >= static_cast<long>(in_w))
+                {
+                    continue;
+                }
+                for (size_t ic = 0; ic < in_c; ++ic)
+                {
+                    sum += input[((n * in_h + ih) * in_w + iw) * in_c + ic] *
+                           weight[((oc * params.kernel_h + kh) * params.kernel_w + kw) * in_c + ic];
+                }
+            }
+            output[((n * params.out_h + oh) * params.out_w + ow) * out_c + oc] = sum;
+        }
+        return output;
+    }
+
+    // the same convolution with TensorOpenCL weights and activations on the device of runtime
+    std::vector<float> conv2d_on_device(const OpenCLRuntime* runtime, const std::vector<float>& input_data,
+                                        const std::vector<size_t>& input_dims, const std::vector<float>& weight_data,
+                                        const std::vector<size_t>& weight_dims, const std::vector<float>& bias_data,
+                                        Conv2D& conv)
+    {
+        auto input = make_device_tensor(runtime, input_data, input_dims);
+        auto weight = make_device_tensor(runtime, weight_data, weight_dims);
+        auto bias = make_device_tensor(runtime, bias_data, {1, weight_dims[0]});
+        auto scratch = make_device_tensor(runtime, {0.0f}, {1, 1});
+        auto result = make_device_tensor(runtime, {0.0f}, {1, 1});
+        conv.set_weight(weight.get());
+        conv.set_bias(bias.get());
+        conv.to_device();
+        for (auto tensor : {input.get(), scratch.get(), result.get()})
+        {
+            tensor->load_to_device();
+        }
+
+        conv.forward(input.get(), result.get(), scratch.get());
+        REQUIRE(result->get_dims() == conv.get_output_dims(input_dims));
+        result->load_to_host();
+        return std::vector<float>(result->data(), result->data() + result->get_size());
+    }
+
+    struct Conv2DCase
+    {
+        std::vector<size_t> input_dims;
+        std::vector<size_t> weight_dims;
+        size_t stride;
+        PADDING padding;
+        size_t dilation;
+        std::vector<size_t> expected_output_dims;
+    };
+}
+
+TEST_CASE("Conv2D matches a direct convolution", "[Conv2D]")
+{
+    const auto test_case = GENERATE(
+        Conv2DCase{{1, 5, 5, 1}, {1, 3, 3, 1}, 1, PADDING::VALID, 1, {1, 3, 3, 1}},
+        Conv2DCase{{2, 7, 6, 3}, {4, 3, 3, 3}, 1, PADDING::SAME, 1, {2, 7, 6, 4}},
+        Conv2DCase{{1, 9, 8, 2}, {5, 3, 2, 2}, 2, PADDING::SAME, 1, {1, 5, 4, 5}},
+        Conv2DCase{{3, 8, 8, 4}, {2, 3, 3, 4}, 2, PADDING::VALID, 1, {3, 3, 3, 2}},
+        Conv2DCase{{1, 10, 9, 2}, {3, 3, 3, 2}, 1, PADDING::SAME, 2, {1, 10, 9, 3}},
+        Conv2DCase{{2, 11, 11, 3}, {6, 2, 3, 3}, 3, PADDING::VALID, 2, {2, 3, 3, 6}},
+        Conv2DCase{{1, 28, 28, 1}, {32, 5, 5, 1}, 1, PADDING::SAME, 1, {1, 28, 28, 32}});
+
+    const auto input_data  = make_random_data(test_case.input_dims[0] * test_case.input_dims[1] *
+                                              test_case.input_dims[2] * test_case.input_dims[3], 1u);
+    const auto weight_data = make_random_data(test_case.weight_dims[0] * test_case.weight_dims[1] *
+                                              test_case.weight_dims[2] * test_case.weight_dims[3], 2u);
+    const auto bias_data   = make_random_data(test_case.weight_dims[0], 3u);
+
+    Tensor<float> input, weight, bias, scratch, result;
+    input.set_host_data(input_data);
+    input.set_dims(test_case.input_dims);
+    weight.set_host_data(weight_data);
+    weight.set_dims(test_case.weight_dims);
+    bias.set_host_data(bias_data);
+    bias.set_dims({1, test_case.weight_dims[0]});
+    scratch.set_host_data({0.0f});
+    result.set_host_data({0.0f});
+
+    Conv2D conv(test_case.stride, test_case.stride, test_case.padding, test_case.dilation, test_case.dilation);
+    conv.set_weight(&weight);
+    conv.set_bias(&bias);
+    conv.to_host();
+    REQUIRE(conv.get_output_dims(test_case.input_dims) == test_case.expected_output_dims);
+
+    conv.forward(&input, &result, &scratch);
+    REQUIRE(result.get_dims() == test_case.expected_output_dims);
+
+    const auto expected = reference_conv2d(input_data, test_case.input_dims, weight_data, test_case.weight_dims,
+                                           bias_data, conv.get_params(test_case.input_dims));
+    REQUIRE(result.get_size() == expected.size());
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        REQUIRE(result.data()[i] == Catch::Approx(expected[i]).margin(1e-4));
+    }
+
+    // im2col and the dense kernel on the device, if there is one
+    if (const auto runtime = get_opencl_runtime())
+    {
+        Conv2D device_conv(test_case.stride, test_case.stride, test_case.padding, test_case.dilation, test_case.dilation);
+        device_conv.set_winograd_enabled(false);
+        const auto device_result = conv2d_on_device(runtime, input_data, test_case.input_dims, weight_data,
+                                                    test_case.weight_dims, bias_data, device_conv);
+        REQUIRE(device_result.size() == expected.size());
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(device_result[i] == Catch::Approx(expected[i]).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("Conv2D fuses a following RELU and runs inside a planned model", "[Conv2D]")
+{
+    const std::vector<size_t> input_dims = {2, 6, 6, 2};
+    const std::vector<size_t> weight_dims = {3, 3, 3, 2};
+    const auto input_data  = make_random_data(2 * 6 * 6 * 2, 4u);
+    const auto weight_data = make_random_data(3 * 3 * 3 * 2, 5u);
+    const auto bias_data   = make_random_data(3, 6u);
+
+    Tensor<float> input, weight, bias, result;
+    input.set_host_data(input_data);
+    input.set_dims(input_dims);
+    weight.set_host_data(weight_data);
+    weight.set_dims(weight_dims);
+    bias.set_host_data(bias_data);
+    bias.set_dims({1, 3});
+    result.set_host_data({0.0f});
+
+    Conv2D conv(1, 1, PADDING::SAME);
+    conv.set_weight(&weight);
+    conv.set_bias(&bias);
+    Activation relu(ACTIVATION::RELU);
+
+    Model model;
+    model.add_layer(&conv);
+    model.add_layer(&relu);
+    model.to_host();
+    REQUIRE(model.get_num_layers() == 1u);
+    REQUIRE(conv.get_fused_activation() == ACTIVATION::RELU);
+
+    model.execute(&input, &result);
+    REQUIRE(result.get_dims() == std::vector<size_t>({2, 6, 6, 3}));
+
+    auto expected = reference_conv2d(input_data, input_dims, weight_data, weight_dims, bias_data, conv.get_params(input_dims));
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        REQUIRE(result.data()[i] == Catch::Approx(std::max(expected[i], 0.0f)).margin(1e-4));
+    }
+}
+
+TEST_CASE("Conv2D takes the Winograd path for 3x3 stride-1 convolutions", "[Conv2D]")
+{
+    const auto padding = GENERATE(PADDING::VALID, PADDING::SAME);
+    const auto input_dims = GENERATE(std::vector<size_t>({1, 7, 9, 5}), std::vector<size_t>({2, 16, 16, 32}));
+    const auto out_channels = input_dims[3] + 1u;
+    const std::vector<size_t> weight_dims = {out_channels, 3, 3, input_dims[3]};
+
+    const auto input_data  = make_random_data(input_dims[0] * input_dims[1] * input_dims[2] * input_dims[3], 7u);
+    const auto weight_data = make_random_data(out_channels * 9u * input_dims[3], 8u);
+    const auto bias_data   = make_random_data(out_channels, 9u);
+
+    Tensor<float> input, weight, bias, scratch, result;
+    input.set_host_data(input_data);
+    input.set_dims(input_dims);
+    weight.set_host_data(weight_data);
+    weight.set_dims(weight_dims);
+    bias.set_host_data(bias_data);
+    bias.set_dims({1, out_channels});
+    scratch.set_host_data({0.0f});
+    result.set_host_data({0.0f});
+
+    Conv2D conv(1, 1, padding);
+    conv.set_weight(&weight);
+    conv.set_bias(&bias);
+    conv.set_fused_activation(ACTIVATION::RELU);
+    conv.to_host();
+    REQUIRE(conv.uses_winograd());
+
+    conv.forward(&input, &result, &scratch);
+    REQUIRE(result.get_dims() == conv.get_output_dims(input_dims));
+    REQUIRE(scratch.get_dims() == conv.get_scratch_dims(input_dims));
+
+    const auto expected = reference_conv2d(input_data, input_dims, weight_data, weight_dims, bias_data, conv.get_params(input_dims));
+    REQUIRE(result.get_size() == expected.size());
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        REQUIRE(result.data()[i] == Catch::Approx(std::max(expected[i], 0.0f)).margin(1e-4));
+    }
+
+    // the input and output transform kernels on the device, if there is one
+    if (const auto runtime = get_opencl_runtime())
+    {
+        Conv2D device_conv(1, 1, padding);
+        device_conv.set_fused_activation(ACTIVATION::RELU);
+        const auto device_result = conv2d_on_device(runtime, input_data, input_dims, weight_data, weight_dims, bias_data,
+                                                    device_conv);
+        REQUIRE(device_conv.uses_winograd());
+        REQUIRE(device_result.size() == expected.size());
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(device_result[i] == Catch::Approx(std::max(expected[i], 0.0f)).margin(1e-4));
+        }
+    }
+
+    conv.set_winograd_enabled(false);
+    REQUIRE_FALSE(conv.uses_winograd());
+}
@@ -0,0 +1,165 @@
+#include "nn/model/CostModel.h"
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+#include "nn/layer/Flatten.h"
+
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // the host is cheap to start and slow to compute, the device the other way round
+    CostModel make_cost_model()
+    {
+        CostModel cost_model;
+        cost_model.set_layer_costs(PLATFORM::HOST, 1.0, 10.0);
+        cost_model.set_layer_costs(PLATFORM::DEVICE, 50.0, 1000.0);
+        cost_model.set_transfer_costs(5.0, 100.0);
+        return cost_model;
+    }
+}
+
+TEST_CASE("Layers count the operations of their forward", "[CostModel]")
+{
+    Tensor<float> weight, bias;
+    weight.set_host_data(std::vector<float>(12, 1.0f));
+    weight.set_dims({3, 4});
+    bias.set_host_data(std::vector<float>(4, 0.0f));
+    bias.set_dims({1, 4});
+    Dense dense;
+    dense.set_weight(&weight);
+    dense.set_bias(&bias);
+    // a multiply and an add per input element and output column
+    REQUIRE(dense.get_num_operations({2, 3}) == 2u * 6u * 4u);
+
+    Activation relu{ACTIVATION::RELU};
+    REQUIRE(relu.get_num_operations({2, 3}) == 6u);
+
+    // views cost nothing
+    Flatten flatten;
+    const auto cost_model = make_cost_model();
+    REQUIRE(cost_model.get_layer_us(&flatten, PLATFORM::DEVICE, {2, 3}) == 0.0);
+    REQUIRE(cost_model.get_layer_us(&relu, PLATFORM::HOST, {2, 3}) == Catch::Approx(1.0 + 0.6));
+    REQUIRE(cost_model.get_transfer_us(400u) == Catch::Approx(5.0 + 4.0));
+}
+
+TEST_CASE("Cost model places big layers on the device and small ones on the host", "[CostModel]")
+{
+    Tensor<float> weight, bias;
+    weight.set_host_data(std::vector<float>(256 * 256, 0.01f));
+    weight.set_dims({256, 256});
+    bias.set_host_data(std::vector<float>(256, 0.0f));
+    bias.set_dims({1, 256});
+    Dense dense;
+    dense.set_weight(&weight);
+    dense.set_bias(&bias);
+    Activation argmax{ACTIVATION::ARGMAX};
+    const std::vector<Layer*> layers = {&dense, &argmax};
+    const std::vector<PLATFORM> none(2, PLATFORM::UNKNOWN);
+    const auto cost_model = make_cost_model();
+
+    // reading back 256 floats and an argmax on the host beats the argmax's device overhead
+    REQUIRE(cost_model.place(layers, {1, 256}, PLATFORM::DEVICE, PLATFORM::HOST, none) ==
+            std::vector<PLATFORM>{PLATFORM::DEVICE, PLATFORM::HOST});
+    // a pin is kept, and the rest placed around it
+    REQUIRE(cost_model.place(layers, {1, 256}, PLATFORM::DEVICE, PLATFORM::HOST, {PLATFORM::UNKNOWN, PLATFORM::DEVICE}) ==
+            std::vector<PLATFORM>{PLATFORM::DEVICE, PLATFORM::DEVICE});
+    REQUIRE(cost_model.place(layers, {1, 256}, PLATFORM::DEVICE, PLATFORM::HOST, {PLATFORM::HOST, PLATFORM::UNKNOWN}) ==
+            std::vector<PLATFORM>{PLATFORM::HOST, PLATFORM::HOST});
+    REQUIRE_THROWS_AS(cost_model.place(layers, {1, 256}, PLATFORM::DEVICE, PLATFORM::HOST, {}), std::invalid_argument);
+
+    // too little work to pay for the transfers
+    Tensor<float> small_weight, small_bias;
+    small_weight.set_host_data(std::vector<float>(16, 0.5f));
+    small_weight.set_dims({4, 4});
+    small_bias.set_host_data(std::vector<float>(4, 0.0f));
+    small_bias.set_dims({1, 4});
+    Dense small_dense;
+    small_dense.set_weight(&small_weight);
+    small_dense.set_bias(&small_bias);
+    REQUIRE(cost_model.place({&small_dense, &argmax}, {1, 4}, PLATFORM::HOST, PLATFORM::HOST, none) ==
+            std::vector<PLATFORM>{PLATFORM::HOST, PLATFORM::HOST});
+}
+
+TEST_CASE("Cost model calibrates the host without a device", "[CostModel]")
+{
+    CostModel cost_model;
+    const auto device_overhead_us = cost_model.get_overhead_us(PLATFORM::DEVICE);
+    const auto transfer_latency_us = cost_model.get_transfer_latency_us();
+    cost_model.calibrate(nullptr, 2u);
+    REQUIRE(cost_model.get_overhead_us(PLATFORM::HOST) >= 0.0);
+    REQUIRE(cost_model.get_operations_per_us(PLATFORM::HOST) > 0.0);
+    REQUIRE(cost_model.get_overhead_us(PLATFORM::DEVICE) == device_overhead_us);
+    REQUIRE(cost_model.get_transfer_latency_us() == transfer_latency_us);
+
+    Tensor<float> host_tensor;
+    REQUIRE_THROWS_AS(cost_model.calibrate(&host_tensor), std::invalid_argument);
+    REQUIRE_THROWS_AS(cost_model.set_layer_costs(PLATFORM::HOST, 1.0, 0.0), std::invalid_argument);
+}
+
+TEST_CASE("Tensors copy between host tensors", "[CostModel]")
+{
+    Tensor<float> source, result;
+    source.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+    source.set_dims({2, 3});
+    result.set_host_data({0.0f});
+    source.copy_to_host(&result);
+    REQUIRE(result.get_dims() == std::vector<size_t>{2, 3});
+    REQUIRE(result(1, 2) == 6.0f);
+
+    Tensor<float> destination;
+    destination.set_host_data({0.0f});
+    destination.copy_from_host(&source);
+    REQUIRE(destination.get_dims() == std::vector<size_t>{2, 3});
+    REQUIRE(destination(0, 1) == 2.0f);
+
+    Tensor<float> unloaded;
+    REQUIRE_THROWS_AS(source.copy_to_host(&unloaded), std::invalid_argument);
+    REQUIRE_THROWS_AS(destination.copy_from_host(&unloaded), std::invalid_argument);
+}
+
+TEST_CASE("Heterogeneous model places every layer and computes the same result", "[CostModel]")
+{
+    Tensor<float> weight, bias;
+    weight.set_host_data({1.0f, -1.0f, 2.0f, 0.5f});
+    weight.set_dims({2, 2});
+    bias.set_host_data({0.5f, -0.5f});
+    bias.set_dims({1, 2});
+    Dense dense;
+    dense.set_weight(&weight);
+    dense.set_bias(&bias);
+    Activation relu{ACTIVATION::RELU};
+    Activation argmax{ACTIVATION::ARGMAX};
+
+    Model model;
+    model.add_layer(&dense);
+    model.add_layer(&relu);
+    model.add_layer(&argmax);
+    // layers this small are cheapest on the host
+    model.to_heterogeneous(std::make_shared<CostModel>(make_cost_model()));
+    REQUIRE(model.get_num_layers() == 2u);
+
+    auto input = Tensor<float>();
+    input.set_host_data({1.0f, 2.0f});
+    input.set_dims({1, 2});
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+    model.execute(&input, &result);
+    // argmax of {1 + 4 + 0.5, -1 + 1 - 0.5} after the RELU
+    REQUIRE(result(0, 0) == 0.0f);
+    REQUIRE(model.get_layer_platforms() == std::vector<PLATFORM>{PLATFORM::HOST, PLATFORM::HOST});
+    REQUIRE(dense.get_platform() == PLATFORM::HOST);
+
+    std::unique_ptr<Model> copy(model.clone());
+    copy->execute(&input, &result);
+    REQUIRE(copy->get_layer_platforms() == model.get_layer_platforms());
+
+    // a layer on the device needs OpenCL tensors
+    model.set_layer_platform(&argmax, PLATFORM::DEVICE);
+    REQUIRE_THROWS_AS(model.execute(&input, &result), std::invalid_argument);
+    model.set_layer_platform(&argmax, PLATFORM::UNKNOWN);
+    model.execute(&input, &result);
+    REQUIRE(argmax.get_platform() == PLATFORM::HOST);
+}
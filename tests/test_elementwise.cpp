@@ -0,0 +1,153 @@
+#include "nn/kernels/Elementwise.h"
+#include "nn/kernels/SimdDispatch.h"
+#include "nn/tensor/Tensor.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // every path this CPU can run, from the scalar loop up
+    std::vector<SIMD_ISA> get_supported_isas()
+    {
+        std::vector<SIMD_ISA> isas;
+        for (const auto isa : {SIMD_ISA::SCALAR, SIMD_ISA::SSE2, SIMD_ISA::AVX2, SIMD_ISA::AVX512})
+        {
+            if (isa <= get_cpu_simd_isa())
+            {
+                isas.push_back(isa);
+            }
+        }
+        return isas;
+    }
+}
+
+TEST_CASE("Elementwise kernels match the scalar algorithms on every instruction set", "[Elementwise]")
+{
+    const auto size = GENERATE(1u, 3u, 7u, 16u, 33u, 1000u, 4099u);
+    const auto a = make_random_data(size, 1u);
+    const auto b = make_random_data(size, 2u);
+
+    std::vector<float> expected_add(size), expected_relu(size);
+    std::transform(a.begin(), a.end(), b.begin(), expected_add.begin(), std::plus<float>());
+    std::transform(a.begin(), a.end(), expected_relu.begin(), [](float x) { return std::max(0.0f, x); });
+    const auto expected_argmax = static_cast<size_t>(std::max_element(a.begin(), a.end()) - a.begin());
+
+    for (const auto isa : get_supported_isas())
+    {
+        set_max_simd_isa(isa);
+        INFO("isa " << get_simd_isa_name(isa) << ", size " << size);
+        REQUIRE(get_simd_isa() == isa);
+
+        std::vector<float> out(size);
+        ElementwiseHost::add(a.data(), b.data(), out.data(), size);
+        REQUIRE(out == expected_add);
+
+        ElementwiseHost::relu(a.data(), out.data(), size);
+        REQUIRE(out == expected_relu);
+
+        REQUIRE(ElementwiseHost::argmax(a.data(), size) == expected_argmax);
+    }
+    set_max_simd_isa(SIMD_ISA::AVX512);
+}
+
+TEST_CASE("Elementwise argmax returns the first of equal maxima", "[Elementwise]")
+{
+    const size_t size = 1000u;
+    std::vector<float> data(size, -1.0f);
+    // ties inside one vector, across lanes and in the scalar tail
+    for (const auto index : {997u, 513u, 130u, 129u})
+    {
+        data[index] = 2.0f;
+    }
+
+    for (const auto isa : get_supported_isas())
+    {
+        set_max_simd_isa(isa);
+        INFO("isa " << get_simd_isa_name(isa));
+        REQUIRE(ElementwiseHost::argmax(data.data(), size) == 129u);
+        REQUIRE(ElementwiseHost::argmax(data.data() + 200u, size - 200u) == 313u);
+        REQUIRE(ElementwiseHost::argmax(data.data(), 0u) == 0u);
+    }
+    set_max_simd_isa(SIMD_ISA::AVX512);
+}
+
+TEST_CASE("Elementwise argmax orders nan like std::max_element", "[Elementwise]")
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const size_t size = 100u;
+    std::vector<std::vector<float>> inputs;
+    // nan in the first vector of every lane, later in the loop, in the tail and in front
+    std::vector<float> data(size, 0.0f);
+    data[0] = 1.0f;
+    data[1] = nan;
+    data[9] = 100.0f;
+    inputs.push_back(data);
+    for (size_t i = 1u; i < 32u; ++i)
+    {
+        data[i] = nan;
+    }
+    data[40] = 50.0f;
+    data[97] = nan;
+    inputs.push_back(data);
+    data[0] = nan;
+    inputs.push_back(data);
+    inputs.push_back(std::vector<float>(size, nan));
+
+    for (const auto& input : inputs)
+    {
+        const auto expected = static_cast<size_t>(std::max_element(input.begin(), input.end()) - input.begin());
+        for (const auto isa : get_supported_isas())
+        {
+            set_max_simd_isa(isa);
+            INFO("isa " << get_simd_isa_name(isa));
+            REQUIRE(ElementwiseHost::argmax(input.data(), size) == expected);
+        }
+    }
+    set_max_simd_isa(SIMD_ISA::AVX512);
+}
+
+TEST_CASE("Tensor add, relu and argmax use the elementwise kernels", "[Elementwise]")
+{
+    const size_t rows = 3u, cols = 37u;
+    const auto lhs_data = make_random_data(rows * cols, 3u);
+    const auto rhs_data = make_random_data(cols, 4u);
+
+    Tensor<float> lhs, rhs, result;
+    lhs.set_host_data(lhs_data);
+    lhs.set_dims({rows, cols});
+    rhs.set_host_data(rhs_data);
+    rhs.set_dims({1u, cols});
+    result.set_host_data({0.0f});
+
+    // the bias row is broadcast over every row of lhs
+    lhs.add(&rhs, &result);
+    REQUIRE(result.get_dims() == std::vector<size_t>({rows, cols}));
+    for (size_t i = 0u; i < rows; ++i)
+    {
+        for (size_t j = 0u; j < cols; ++j)
+        {
+            REQUIRE(result(i, j) == lhs_data[i * cols + j] + rhs_data[j]);
+        }
+    }
+
+    Tensor<float> relu_result, argmax_result;
+    relu_result.set_host_data({0.0f});
+    argmax_result.set_host_data({0.0f});
+    lhs.relu(&relu_result);
+    for (size_t i = 0u; i < rows * cols; ++i)
+    {
+        REQUIRE(relu_result.data()[i] == std::max(0.0f, lhs_data[i]));
+    }
+
+    lhs.argmax(&argmax_result);
+    for (size_t i = 0u; i < rows; ++i)
+    {
+        const auto row = lhs_data.begin() + i * cols;
+        REQUIRE(argmax_result.data()[i] == static_cast<float>(std::max_element(row, row + cols) - row));
+    }
+}
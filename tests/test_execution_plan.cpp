@@ -0,0 +1,119 @@
+#include "nn/tensor/ExecutionPlan.h"
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <vector>
+
+TEST_CASE("Execution plan records only on the thread it is set for", "[ExecutionPlan]")
+{
+    REQUIRE(ExecutionPlan::get_recording() == nullptr);
+    {
+        ExecutionPlan plan;
+        REQUIRE(ExecutionPlan::set_recording(&plan) == nullptr);
+        REQUIRE(ExecutionPlan::get_recording() == &plan);
+        // a plan that goes away stops recording
+    }
+    REQUIRE(ExecutionPlan::get_recording() == nullptr);
+}
+
+TEST_CASE("Execution plan without launches or with a transfer is not replayable", "[ExecutionPlan]")
+{
+    ExecutionPlan empty;
+    REQUIRE_FALSE(empty.is_replayable());
+    REQUIRE_FALSE(empty.finish(nullptr, nullptr));
+    REQUIRE_FALSE(empty.get_failure().empty());
+    REQUIRE_THROWS_AS(empty.replay(nullptr, nullptr), std::runtime_error);
+
+    ExecutionPlan transfer;
+    transfer.record_unsupported("a write");
+    transfer.record_unsupported("a read");
+    REQUIRE_FALSE(transfer.finish(nullptr, nullptr));
+    // the first reason is kept
+    REQUIRE(transfer.get_failure() == "a write can't be replayed");
+    REQUIRE(transfer.get_num_launches() == 0u);
+    REQUIRE(transfer.get_num_bindings() == 0u);
+}
+
+TEST_CASE("Replay is a no-op for host models", "[ExecutionPlan]")
+{
+    Tensor<float> weight, bias;
+    weight.set_host_data({1.0f, -1.0f, 2.0f, 0.5f});
+    weight.set_dims({2, 2});
+    bias.set_host_data({0.5f, -0.5f});
+    bias.set_dims({1, 2});
+    Dense dense;
+    dense.set_weight(&weight);
+    dense.set_bias(&bias);
+    Activation relu{ACTIVATION::RELU};
+
+    Model model;
+    model.add_layer(&dense);
+    model.add_layer(&relu);
+    model.set_replay_enabled(true);
+    REQUIRE(model.get_replay_enabled());
+    model.to_host();
+
+    auto input = Tensor<float>();
+    input.set_host_data({1.0f, 2.0f});
+    input.set_dims({1, 2});
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+    for (auto i = 0u; i < 2u; ++i)
+    {
+        model.execute(&input, &result);
+        // {1 + 4 + 0.5, -1 + 1 - 0.5}
+        REQUIRE(result(0, 0) == Catch::Approx(5.5));
+        REQUIRE(result(0, 1) == Catch::Approx(0.0));
+    }
+    REQUIRE(model.get_execution_plan() == nullptr);
+
+    std::unique_ptr<Model> copy(model.clone());
+    REQUIRE(copy->get_replay_enabled());
+}
+
+TEST_CASE("Replayed launches compute what the layers compute", "[ExecutionPlan][OpenCL]")
+{
+    const auto runtime = get_opencl_runtime();
+    if (!runtime)
+    {
+        SKIP("no OpenCL device");
+    }
+
+    RandomMlp layers(24, 16, 8, 6u, runtime), replayed(24, 16, 8, 6u, runtime);
+    layers.model.set_replay_enabled(false);
+    replayed.model.set_replay_enabled(true);
+
+    // the first execute records, the later ones replay with other input and result buffers bound
+    const size_t batch = 2u;
+    for (auto i = 0u; i < 3u; ++i)
+    {
+        const auto data = make_random_data(batch * 24u, 20u + i);
+        auto input = make_device_tensor(runtime, data, {batch, 24});
+        auto expected = make_device_tensor(runtime, {0.0f}, {1, 1});
+        auto result = make_device_tensor(runtime, {0.0f}, {1, 1});
+        for (auto tensor : {input.get(), expected.get(), result.get()})
+        {
+            tensor->load_to_device();
+        }
+
+        layers.model.execute(input.get(), expected.get());
+        replayed.model.execute(input.get(), result.get());
+        const auto plan = replayed.model.get_execution_plan();
+        REQUIRE(plan);
+        REQUIRE(plan->is_replayable());
+        REQUIRE(plan->get_num_launches() > 0u);
+        REQUIRE(layers.model.get_execution_plan() == nullptr);
+
+        REQUIRE(result->get_dims() == std::vector<size_t>({batch, 8}));
+        expected->load_to_host();
+        result->load_to_host();
+        for (auto j = 0u; j < expected->get_size(); ++j)
+        {
+            REQUIRE(result->data()[j] == Catch::Approx(expected->data()[j]).margin(1e-5));
+        }
+    }
+}
@@ -0,0 +1,181 @@
+#include "nn/tensor/Tensor.h"
+#include "nn/kernels/Gemm.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+    // the original triple loop of Tensor::multiply_on_host
+    std::vector<float> reference_multiply(const std::vector<float>& a, const std::vector<float>& b,
+                                          size_t m, size_t n, size_t k)
+    {
+        std::vector<float> c(m * n);
+        for (auto i = 0u; i < m; ++i)
+        {
+            for (auto j = 0u; j < n; ++j)
+            {
+                float sum = 0.0f;
+                for (auto p = 0u; p < k; ++p)
+                {
+                    sum += a[i * k + p] * b[p * n + j];
+                }
+                c[i * n + j] = sum;
+            }
+        }
+        return c;
+    }
+}
+
+TEST_CASE("Host GEMM matches the reference loop", "[Gemm]")
+{
+    // shapes cover the small-M path, partial register tiles and multiple KC/MC blocks
+    const std::vector<std::vector<size_t>> shapes = {
+        {1, 1, 1}, {1, 64, 1600}, {1, 10, 64}, {5, 17, 3}, {6, 8, 256},
+        {7, 33, 257}, {97, 50, 300}, {128, 128, 128}, {300, 10, 64}
+    };
+
+    for (const auto& shape : shapes)
+    {
+        const auto m = shape[0];
+        const auto n = shape[1];
+        const auto k = shape[2];
+        const auto a = make_random_data(m * k, 1u);
+        const auto b = make_random_data(k * n, 2u);
+        const auto expected = reference_multiply(a, b, m, n, k);
+
+        for (size_t num_threads : std::vector<size_t>{1u, 4u})
+        {
+            std::vector<float> c(m * n, -1.0f);
+            GemmHost<float>::multiply(m, n, k, {a.data(), k, 1u}, {b.data(), n, 1u}, c.data(), n, num_threads);
+            for (auto i = 0u; i < c.size(); ++i)
+            {
+                REQUIRE(c[i] == Catch::Approx(expected[i]).margin(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("Host GEMM reads strided and transposed operands", "[Gemm]")
+{
+    const size_t m = 13, n = 21, k = 40;
+    const auto a = make_random_data(m * k, 3u);
+    const auto b = make_random_data(k * n, 4u);
+    const auto expected = reference_multiply(a, b, m, n, k);
+
+    // store B as its transpose (n x k) and describe it with swapped strides
+    std::vector<float> b_transposed(n * k);
+    for (auto p = 0u; p < k; ++p)
+    {
+        for (auto j = 0u; j < n; ++j)
+        {
+            b_transposed[j * k + p] = b[p * n + j];
+        }
+    }
+
+    for (size_t rows : std::vector<size_t>{1u, m})
+    {
+        std::vector<float> c(rows * n);
+        GemmHost<float>::multiply(rows, n, k, {a.data(), k, 1u}, {b_transposed.data(), 1u, k}, c.data(), n);
+        for (auto i = 0u; i < c.size(); ++i)
+        {
+            REQUIRE(c[i] == Catch::Approx(expected[i]).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("Tensor::multiply on host uses the blocked GEMM", "[Gemm]")
+{
+    auto t1 = Tensor<float>();
+    t1.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+    t1.set_dims({2, 3});
+
+    auto t2 = Tensor<float>();
+    t2.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+    t2.set_dims({3, 2});
+
+    auto t3 = Tensor<float>();
+    t3.set_host_data({0.0f});
+    t1.multiply(&t2, &t3);
+
+    REQUIRE(t3.get_dims() == std::vector<size_t>({2, 2}));
+    REQUIRE(t3(0, 0) == Catch::Approx(22.0));
+    REQUIRE(t3(0, 1) == Catch::Approx(28.0));
+    REQUIRE(t3(1, 0) == Catch::Approx(49.0));
+    REQUIRE(t3(1, 1) == Catch::Approx(64.0));
+}
+
+TEST_CASE("Tensor::multiply_transposed reads external weights in place", "[Gemm]")
+{
+    // {out, in} weights as a TFLite file stores them
+    auto weights_storage = std::make_shared<std::vector<float>>(std::vector<float>({1.0f, 3.0f, 5.0f,
+                                                                                    2.0f, 4.0f, 6.0f}));
+    auto weights = Tensor<float>();
+    weights.set_dims({2, 3});
+    weights.set_external_host_data(weights_storage->data(), weights_storage->size(), weights_storage);
+    REQUIRE(weights.is_host_data_external());
+    REQUIRE(weights.data() == weights_storage->data());
+
+    auto input = Tensor<float>();
+    input.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+    input.set_dims({2, 3});
+
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+    input.multiply_transposed(&weights, &result);
+
+    REQUIRE(result.get_dims() == std::vector<size_t>({2, 2}));
+    REQUIRE(result(0, 0) == Catch::Approx(22.0));
+    REQUIRE(result(0, 1) == Catch::Approx(28.0));
+    REQUIRE(result(1, 0) == Catch::Approx(49.0));
+    REQUIRE(result(1, 1) == Catch::Approx(64.0));
+}
+
+TEST_CASE("Tensor::dense fuses bias and relu into the GEMM", "[Gemm]")
+{
+    // shapes cover the small-M path and a bias that spans several NC/NR blocks
+    const std::vector<std::vector<size_t>> shapes = {{1, 64, 1600}, {5, 17, 3}, {97, 50, 300}};
+
+    for (const auto& shape : shapes)
+    {
+        const auto m = shape[0];
+        const auto n = shape[1];
+        const auto k = shape[2];
+        const auto a = make_random_data(m * k, 3u);
+        const auto b = make_random_data(k * n, 4u);
+        const auto bias_data = make_random_data(n, 5u);
+        const auto product = reference_multiply(a, b, m, n, k);
+
+        auto input = Tensor<float>();
+        input.set_host_data(a);
+        input.set_dims({m, k});
+
+        auto weight = Tensor<float>();
+        weight.set_host_data(b);
+        weight.set_dims({k, n});
+
+        auto bias = Tensor<float>();
+        bias.set_host_data(bias_data);
+        bias.set_dims({1, n});
+
+        for (bool relu : {false, true})
+        {
+            auto result = Tensor<float>();
+            result.set_host_data({0.0f});
+            input.dense(&weight, &bias, &result, false, relu);
+
+            REQUIRE(result.get_dims() == std::vector<size_t>({m, n}));
+            for (auto i = 0u; i < m; ++i)
+            {
+                for (auto j = 0u; j < n; ++j)
+                {
+                    const auto value = product[i * n + j] + bias_data[j];
+                    const auto expected = relu ? std::max(0.0f, value) : value;
+                    REQUIRE(result(i, j) == Catch::Approx(expected).margin(1e-4));
+                }
+            }
+        }
+    }
+}
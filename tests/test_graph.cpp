@@ -0,0 +1,309 @@
+#include "nn/graph/Graph.h"
+#include "nn/graph/GraphPass.h"
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+#include "nn/layer/Flatten.h"
+
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // x * w + b on the host, x is rows x weight_rows
+    std::vector<float> reference_dense(const std::vector<float>& x, const std::vector<float>& w, const std::vector<float>& b,
+                                       size_t rows, size_t weight_rows, bool relu)
+    {
+        const auto cols = b.size();
+        std::vector<float> result(rows * cols);
+        for (auto r = 0u; r < rows; ++r)
+        {
+            for (auto c = 0u; c < cols; ++c)
+            {
+                auto sum = b[c];
+                for (auto k = 0u; k < weight_rows; ++k)
+                {
+                    sum += x[r * weight_rows + k] * w[k * cols + c];
+                }
+                result[r * cols + c] = relu ? std::max(sum, 0.0f) : sum;
+            }
+        }
+        return result;
+    }
+
+    struct DenseWeights
+    {
+        Tensor<float> weight, bias;
+        std::vector<float> w, b;
+        Dense dense;
+
+        DenseWeights(size_t rows, size_t cols, float seed)
+        {
+            for (auto i = 0u; i < rows * cols; ++i)
+            {
+                w.push_back(static_cast<float>((i * 7u) % 11u) * 0.25f - seed);
+            }
+            for (auto i = 0u; i < cols; ++i)
+            {
+                b.push_back(seed - static_cast<float>(i) * 0.5f);
+            }
+            weight.set_host_data(w);
+            weight.set_dims({rows, cols});
+            bias.set_host_data(b);
+            bias.set_dims({1, cols});
+            dense.set_weight(&weight);
+            dense.set_bias(&bias);
+        }
+    };
+
+    // x -> left: Dense -> RELU, x -> right: Dense, sum = left + right -> head: Dense
+    struct ResidualGraph
+    {
+        DenseWeights left{4, 4, 1.0f};
+        DenseWeights right{4, 4, 0.5f};
+        DenseWeights head{4, 3, 0.25f};
+        Activation relu{ACTIVATION::RELU};
+        Graph graph;
+
+        ResidualGraph()
+        {
+            // out of order on purpose, tensors may be read before they are written
+            graph.add_node("head", &head.dense, "sum", "y");
+            graph.add_add("add", "left_relu", "right", "sum");
+            graph.add_input("x");
+            graph.add_node("left", &left.dense, "x", "left");
+            graph.add_node("left_relu", &relu, "left", "left_relu");
+            graph.add_node("right", &right.dense, "x", "right");
+            graph.add_output("y");
+        }
+
+        std::vector<float> reference(const std::vector<float>& x, size_t rows) const
+        {
+            const auto l = reference_dense(x, left.w, left.b, rows, 4u, true);
+            auto sum = reference_dense(x, right.w, right.b, rows, 4u, false);
+            for (auto i = 0u; i < sum.size(); ++i)
+            {
+                sum[i] += l[i];
+            }
+            return reference_dense(sum, head.w, head.b, rows, 4u, false);
+        }
+    };
+
+    std::vector<float> get_input(size_t rows)
+    {
+        std::vector<float> x;
+        for (auto i = 0u; i < rows * 4u; ++i)
+        {
+            x.push_back(static_cast<float>(i % 5u) - 1.5f);
+        }
+        return x;
+    }
+
+    void require_equal(const Tensor<float>& result, const std::vector<float>& expected)
+    {
+        REQUIRE(result.get_size() == expected.size());
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(result.data()[i] == Catch::Approx(expected[i]).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("Graph schedules independent branches into one stage", "[Graph]")
+{
+    ResidualGraph net;
+    const auto& schedule = net.graph.get_schedule();
+    REQUIRE(schedule.size() == 4u);
+    // left (2) and right (4) only read the input
+    REQUIRE(schedule[0] == std::vector<size_t>{2u, 4u});
+    REQUIRE(schedule[1] == std::vector<size_t>{3u});
+    REQUIRE(schedule[2] == std::vector<size_t>{1u});
+    REQUIRE(schedule[3] == std::vector<size_t>{0u});
+    REQUIRE(net.graph.get_topological_order() == std::vector<size_t>{2u, 4u, 3u, 1u, 0u});
+}
+
+TEST_CASE("Graph rejects cycles and tensors nobody writes", "[Graph]")
+{
+    DenseWeights a{2, 2, 1.0f};
+    DenseWeights b{2, 2, 1.0f};
+
+    Graph cycle;
+    cycle.add_input("x");
+    cycle.add_node("a", &a.dense, "t1", "t0");
+    cycle.add_node("b", &b.dense, "t0", "t1");
+    cycle.add_output("t1");
+    REQUIRE_THROWS_AS(cycle.get_schedule(), std::runtime_error);
+
+    Graph unwritten;
+    unwritten.add_input("x");
+    unwritten.add_node("a", &a.dense, "missing", "y");
+    unwritten.add_output("y");
+    REQUIRE_THROWS_AS(unwritten.get_schedule(), std::runtime_error);
+
+    // every tensor has one writer
+    REQUIRE_THROWS_AS(unwritten.add_node("b", &b.dense, "x", "y"), std::invalid_argument);
+    REQUIRE_THROWS_AS(unwritten.add_input("y"), std::invalid_argument);
+}
+
+TEST_CASE("Graph runs concurrent branches like the sequential schedule", "[Graph]")
+{
+    const size_t rows = 5u;
+    const auto x = get_input(rows);
+
+    ResidualGraph net;
+    net.graph.to_host();
+    // the RELU was fused into its Dense
+    REQUIRE(net.graph.get_num_nodes() == 4u);
+    REQUIRE(net.left.dense.get_fused_activation() == ACTIVATION::RELU);
+
+    auto input = Tensor<float>();
+    input.set_host_data(x);
+    input.set_dims({rows, 4});
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+
+    REQUIRE(net.graph.get_concurrent_branches());
+    net.graph.execute(&input, &result);
+    require_equal(result, net.reference(x, rows));
+    REQUIRE(result.get_dims() == std::vector<size_t>{rows, 3u});
+
+    net.graph.set_concurrent_branches(false);
+    auto sequential = Tensor<float>();
+    sequential.set_host_data({0.0f});
+    net.graph.execute({{"x", &input}}, {{"y", &sequential}});
+    require_equal(sequential, net.reference(x, rows));
+
+    // the add reads both branches while it writes the sum, the three blocks are live at once
+    const auto block_bytes = rows * 4u * sizeof(float);
+    REQUIRE(net.graph.get_peak_activation_bytes() >= 3u * block_bytes);
+    REQUIRE(net.graph.get_peak_activation_bytes() <= 3u * (block_bytes + 64u));
+    // the two small branches share the first stage
+    REQUIRE(net.graph.get_concurrent_stages() == std::vector<bool>{true, false, false});
+
+    // branches large enough to split their own GEMMs across the pool run one after the other
+    net.graph.set_concurrent_branches(true);
+    const size_t large_rows = 8192u;
+    const auto large_x = get_input(large_rows);
+    auto large_input = Tensor<float>();
+    large_input.set_host_data(large_x);
+    large_input.set_dims({large_rows, 4});
+    auto large_result = Tensor<float>();
+    large_result.set_host_data({0.0f});
+    net.graph.execute(&large_input, &large_result);
+    REQUIRE(net.graph.get_concurrent_stages() == std::vector<bool>{false, false, false});
+    require_equal(large_result, net.reference(large_x, large_rows));
+
+    REQUIRE_THROWS_AS(net.graph.execute({}, {{"y", &sequential}}), std::invalid_argument);
+}
+
+TEST_CASE("Fusion pass leaves tensors other nodes read", "[Graph]")
+{
+    DenseWeights a{4, 4, 1.0f};
+    DenseWeights b{4, 4, 0.5f};
+    Activation relu{ACTIVATION::RELU};
+
+    // the Dense output is also added to the RELU output, so the RELU can't be fused away
+    Graph graph;
+    graph.add_input("x");
+    graph.add_node("a", &a.dense, "x", "a");
+    graph.add_node("relu", &relu, "a", "r");
+    graph.add_add("add", "a", "r", "y");
+    graph.add_output("y");
+
+    FusionPass fusion;
+    REQUIRE(fusion.run(graph) == 0u);
+    REQUIRE(a.dense.get_fused_activation() != ACTIVATION::RELU);
+
+    // a RELU writing a graph output fuses, its producer then writes the output
+    Graph chain;
+    chain.add_input("x");
+    chain.add_node("b", &b.dense, "x", "b");
+    chain.add_node("relu", &relu, "b", "y");
+    chain.add_output("y");
+    REQUIRE(fusion.run(chain) == 1u);
+    REQUIRE(chain.get_num_nodes() == 1u);
+    REQUIRE(chain.get_tensor(chain.get_tensor_id("y")).producer == 0u);
+    REQUIRE(fusion.run(chain) == 0u);
+}
+
+TEST_CASE("Constant folding and dead-node elimination", "[Graph]")
+{
+    const size_t rows = 2u;
+    const auto x = get_input(rows);
+
+    DenseWeights bias_net{4, 4, 0.75f};
+    DenseWeights unused{4, 4, 0.0f};
+    Flatten flatten;
+
+    // bias = Dense(c) is known before execute, y = x + bias, the unused branch feeds no output
+    auto constant = std::make_shared<Tensor<float>>();
+    constant->set_host_data({1.0f, -2.0f, 0.5f, 3.0f});
+    constant->set_dims({1, 4});
+    Graph graph;
+    graph.add_input("x");
+    graph.add_constant("c", constant);
+    graph.add_node("bias", &bias_net.dense, "c", "bias");
+    graph.add_node("flat_bias", &flatten, "bias", "flat_bias");
+    graph.add_add("add", "x", "flat_bias", "y");
+    graph.add_node("unused", &unused.dense, "x", "z");
+    graph.add_output("y");
+
+    auto manager = PassManager::create_default();
+    REQUIRE(manager->get_num_passes() == 3u);
+    REQUIRE(manager->run(graph) == 3u);
+    REQUIRE(manager->get_num_rewrites() == std::vector<size_t>{1u, 2u, 0u});
+    REQUIRE(graph.get_num_nodes() == 1u);
+    REQUIRE(graph.get_tensor(graph.get_tensor_id("flat_bias")).constant);
+    REQUIRE(manager->run(graph) == 0u);
+
+    graph.to_host();
+    auto input = Tensor<float>();
+    input.set_host_data(x);
+    input.set_dims({rows, 4});
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+    graph.execute(&input, &result);
+
+    const auto bias = reference_dense({1.0f, -2.0f, 0.5f, 3.0f}, bias_net.w, bias_net.b, 1u, 4u, false);
+    auto expected = x;
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        expected[i] += bias[i % 4u];
+    }
+    require_equal(result, expected);
+}
+
+TEST_CASE("Model converts to a chain graph with the same result", "[Graph]")
+{
+    const size_t rows = 3u;
+    const auto x = get_input(rows);
+
+    DenseWeights first{4, 4, 1.0f};
+    DenseWeights second{4, 3, 0.5f};
+    Activation relu{ACTIVATION::RELU};
+    Model model;
+    model.add_layer(&first.dense);
+    model.add_layer(&relu);
+    model.add_layer(&second.dense);
+
+    std::unique_ptr<Graph> graph(model.to_graph());
+    REQUIRE(graph->get_num_nodes() == 3u);
+    REQUIRE(graph->get_node(1).name == "1:RELU");
+    graph->to_host();
+    model.to_host();
+
+    auto input = Tensor<float>();
+    input.set_host_data(x);
+    input.set_dims({rows, 4});
+    auto graph_result = Tensor<float>();
+    graph_result.set_host_data({0.0f});
+    auto model_result = Tensor<float>();
+    model_result.set_host_data({0.0f});
+    graph->execute(&input, &graph_result);
+    model.execute(&input, &model_result);
+
+    const auto hidden = reference_dense(x, first.w, first.b, rows, 4u, true);
+    require_equal(graph_result, reference_dense(hidden, second.w, second.b, rows, 4u, false));
+    require_equal(model_result, reference_dense(hidden, second.w, second.b, rows, 4u, false));
+}
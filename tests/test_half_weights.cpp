@@ -0,0 +1,169 @@
+#include "nn/layer/Dense.h"
+#include "nn/model/TFLiteLoader.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    const std::string mnist_model_path = std::string(MODELS_DIR) + "/TFLite/mnist_model.tflite";
+
+    // a FULLY_CONNECTED layer of the MNIST model as a Dense layer over copies of its weights
+    struct MnistDense
+    {
+        Tensor<float> weight;
+        Tensor<float> bias;
+        Dense dense;
+
+        MnistDense(const TFLiteLoader& loader, size_t op_index)
+        {
+            const auto& op = loader.get_operators()[op_index];
+            const auto& weight_tensor = loader.get_tensors()[op.inputs[1]];
+            const auto& bias_tensor = loader.get_tensors()[op.inputs[2]];
+            const auto weight_data = reinterpret_cast<const float*>(weight_tensor.data);
+            const auto bias_data = reinterpret_cast<const float*>(bias_tensor.data);
+            weight.set_host_data(std::vector<float>(weight_data, weight_data + weight_tensor.data_size / sizeof(float)));
+            weight.set_dims(weight_tensor.dims);
+            bias.set_host_data(std::vector<float>(bias_data, bias_data + bias_tensor.data_size / sizeof(float)));
+            bias.set_dims({1, weight_tensor.dims[0]});
+            dense.set_weight(&weight, true);
+            dense.set_bias(&bias);
+        }
+    };
+}
+
+TEST_CASE("FP16 and BF16 conversions round to nearest even", "[HalfWeights]")
+{
+    for (const float value : {0.0f, 1.0f, -2.5f, 0.333251953125f, 65504.0f, 6.103515625e-05f, 5.9604644775390625e-08f})
+    {
+        REQUIRE(half_to_float(float_to_half(value)) == value);
+    }
+    REQUIRE(float_to_half(1.0f) == 0x3c00u);
+    REQUIRE(float_to_half(-2.0f) == 0xc000u);
+    // 1 + 2^-11 is halfway between 1 and the next half, it ties to the even 1
+    REQUIRE(float_to_half(1.0f + std::ldexp(1.0f, -11)) == 0x3c00u);
+    REQUIRE(float_to_half(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02u);
+    REQUIRE(float_to_half(65520.0f) == 0x7c00u);
+    REQUIRE(float_to_half(std::ldexp(1.0f, -26)) == 0u);
+    REQUIRE(std::isnan(half_to_float(float_to_half(std::numeric_limits<float>::quiet_NaN()))));
+
+    REQUIRE(float_to_bfloat16(1.0f) == 0x3f80u);
+    REQUIRE(bfloat16_to_float(float_to_bfloat16(-3.0f)) == -3.0f);
+    REQUIRE(float_to_bfloat16(1.0f + std::ldexp(1.0f, -8)) == 0x3f80u);
+    REQUIRE(float_to_bfloat16(1.0f + 3.0f * std::ldexp(1.0f, -8)) == 0x3f82u);
+    REQUIRE(std::isnan(bfloat16_to_float(float_to_bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST_CASE("The 16-bit weight GEMM matches an fp32 GEMM over the rounded weights", "[HalfWeights]")
+{
+    const auto format = GENERATE(WEIGHT_FORMAT::FP16, WEIGHT_FORMAT::BF16);
+    const auto m = GENERATE(1u, 5u, 33u);
+    const auto k = GENERATE(7u, 64u, 203u);
+    const size_t n = 37u;
+
+    const auto a = make_random_data(m * k, 1u);
+    const auto w = make_random_data(n * k, 2u);
+    const auto bias = make_random_data(n, 3u);
+    std::vector<uint16_t> w_half(n * k);
+    GemmHalfHost::convert(w.data(), w.size(), format, w_half.data());
+
+    GemmEpilogue<float> epilogue;
+    epilogue.bias = bias.data();
+    epilogue.relu = true;
+    std::vector<float> c(m * n);
+    GemmHalfHost::multiply(m, n, k, a.data(), k, w_half.data(), format, c.data(), n, epilogue, 3);
+
+    std::vector<float> expected(m * n);
+    for (size_t i = 0; i < m; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            float sum = bias[j];
+            for (size_t p = 0; p < k; ++p)
+            {
+                const auto weight = format == WEIGHT_FORMAT::FP16 ? half_to_float(w_half[j * k + p]) : bfloat16_to_float(w_half[j * k + p]);
+                sum += a[i * k + p] * weight;
+            }
+            expected[i * n + j] = std::max(sum, 0.0f);
+            REQUIRE(c[i * n + j] == Catch::Approx(expected[i * n + j]).margin(1e-4));
+        }
+    }
+
+    // the 16-bit weight dense kernel on the device, if there is one
+    if (const auto runtime = get_opencl_runtime())
+    {
+        auto input = make_device_tensor(runtime, a, {m, k});
+        auto weight = make_device_tensor(runtime, w, {n, k});
+        auto device_bias = make_device_tensor(runtime, bias, {1, n});
+        auto result = make_device_tensor(runtime, {0.0f}, {1, 1});
+        input->load_to_device();
+        result->load_to_device();
+
+        Dense dense;
+        dense.set_weight(weight.get(), true);
+        dense.set_bias(device_bias.get());
+        dense.set_fused_activation(ACTIVATION::RELU);
+        dense.set_weight_format(format);
+        dense.to_device();
+        dense.forward(input.get(), result.get(), nullptr);
+        REQUIRE(result->get_dims() == std::vector<size_t>({m, n}));
+        result->load_to_host();
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(result->data()[i] == Catch::Approx(expected[i]).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("16-bit weights keep the MNIST classifier head accurate", "[HalfWeights]")
+{
+    const auto format = GENERATE(WEIGHT_FORMAT::FP16, WEIGHT_FORMAT::BF16);
+    const auto loader = TFLiteLoader(mnist_model_path);
+
+    // FULLY_CONNECTED 1600 -> 64 (RELU) and 64 -> 10, the layers that hold nearly all the weights
+    MnistDense hidden(loader, 5), logits(loader, 6);
+    hidden.dense.set_fused_activation(ACTIVATION::RELU);
+    hidden.dense.to_host();
+    logits.dense.to_host();
+
+    const size_t batch = 8u;
+    Tensor<float> input, hidden_fp32, output_fp32, hidden_half, output_half;
+    input.set_host_data(make_random_data(batch * 1600, 4u));
+    input.set_dims({batch, 1600});
+    for (auto tensor : {&hidden_fp32, &output_fp32, &hidden_half, &output_half})
+    {
+        tensor->set_host_data({0.0f});
+    }
+
+    hidden.dense.forward(&input, &hidden_fp32, nullptr);
+    logits.dense.forward(&hidden_fp32, &output_fp32, nullptr);
+
+    const auto fp32_bytes = hidden.dense.get_weight_bytes();
+    hidden.dense.set_weight_format(format);
+    logits.dense.set_weight_format(format);
+    REQUIRE(hidden.dense.get_weight_bytes() * 2u == fp32_bytes);
+    hidden.dense.forward(&input, &hidden_half, nullptr);
+    logits.dense.forward(&hidden_half, &output_half, nullptr);
+    REQUIRE(output_half.get_dims() == std::vector<size_t>({batch, 10}));
+
+    // bf16 keeps 8 mantissa bits, fp16 11
+    const auto tolerance = format == WEIGHT_FORMAT::FP16 ? 2e-3f : 2e-2f;
+    float max_logit = 0.0f;
+    for (auto i = 0u; i < output_fp32.get_size(); ++i)
+    {
+        max_logit = std::max(max_logit, std::abs(output_fp32.data()[i]));
+    }
+    for (size_t row = 0; row < batch; ++row)
+    {
+        const auto fp32_row = output_fp32.data() + row * 10;
+        const auto half_row = output_half.data() + row * 10;
+        for (size_t col = 0; col < 10; ++col)
+        {
+            REQUIRE(half_row[col] == Catch::Approx(fp32_row[col]).margin(tolerance * max_logit));
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include "nn/serving/InferenceServer.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <future>
+#include <thread>
+#include <vector>
+
+TEST_CASE("InferenceServer returns every request its own row of the batch", "[InferenceServer]")
+{
+    RandomMlp net(6, 5, 4, 1u);
+    InferenceServerParams params;
+    params.sample_dims = {6};
+    params.max_batch_size = 8u;
+    params.num_executors = 2u;
+
+    const size_t num_clients = 4u, requests_per_client = 50u;
+    std::vector<std::vector<float>> samples(num_clients * requests_per_client);
+    std::vector<std::vector<float>> expected(samples.size());
+    for (auto i = 0u; i < samples.size(); ++i)
+    {
+        samples[i] = make_random_data(6, 10u + i);
+        expected[i] = net.run(samples[i], 1u);
+    }
+
+    std::vector<std::vector<float>> results(samples.size());
+    {
+        InferenceServer server(net.model, params);
+        std::vector<std::thread> clients;
+        for (auto client = 0u; client < num_clients; ++client)
+        {
+            clients.emplace_back([&, client]()
+            {
+                std::vector<std::future<std::vector<float>>> futures;
+                for (auto i = 0u; i < requests_per_client; ++i)
+                {
+                    futures.push_back(server.submit(samples[client * requests_per_client + i]));
+                }
+                for (auto i = 0u; i < requests_per_client; ++i)
+                {
+                    results[client * requests_per_client + i] = futures[i].get();
+                }
+            });
+        }
+        for (auto& client : clients)
+        {
+            client.join();
+        }
+
+        const auto stats = server.get_stats();
+        REQUIRE(stats.num_requests == samples.size());
+        REQUIRE(stats.num_batches >= samples.size() / params.max_batch_size);
+        REQUIRE(stats.mean_batch_size >= 1.0);
+        REQUIRE(stats.mean_batch_size <= static_cast<double>(params.max_batch_size));
+        REQUIRE(stats.p99_latency_ms >= stats.p50_latency_ms);
+        REQUIRE(stats.throughput > 0.0);
+    }
+
+    for (auto i = 0u; i < samples.size(); ++i)
+    {
+        REQUIRE(results[i].size() == 4u);
+        for (auto j = 0u; j < 4u; ++j)
+        {
+            REQUIRE(results[i][j] == Catch::Approx(expected[i][j]).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("InferenceServer batches requests that arrive within the queueing delay", "[InferenceServer]")
+{
+    RandomMlp net(6, 5, 4, 1u);
+    InferenceServerParams params;
+    params.sample_dims = {6};
+    params.max_batch_size = 16u;
+    params.max_queue_delay = std::chrono::milliseconds(200);
+    params.num_executors = 1u;
+
+    InferenceServer server(net.model, params);
+    std::vector<std::future<std::vector<float>>> futures;
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        futures.push_back(server.submit(make_random_data(6, i)));
+    }
+    for (auto& future : futures)
+    {
+        REQUIRE(future.get().size() == 4u);
+    }
+    // 16 requests fill one batch long before the delay runs out
+    const auto stats = server.get_stats();
+    REQUIRE(stats.num_requests == 16u);
+    REQUIRE(stats.num_batches <= 2u);
+
+    server.reset_stats();
+    REQUIRE(server.get_stats().num_requests == 0u);
+}
+
+TEST_CASE("InferenceServer reports bad requests and model errors", "[InferenceServer]")
+{
+    RandomMlp net(6, 5, 4, 1u);
+    InferenceServerParams params;
+    params.sample_dims = {6};
+
+    InferenceServer server(net.model, params);
+    REQUIRE_THROWS_AS(server.submit(make_random_data(5, 1u)), std::invalid_argument);
+
+    // a sample the first Dense cannot multiply fails inside the model
+    InferenceServerParams wrong_params;
+    wrong_params.sample_dims = {3, 2};
+    InferenceServer wrong_server(net.model, wrong_params);
+    auto future = wrong_server.submit(make_random_data(6, 2u));
+    REQUIRE_THROWS(future.get());
+
+    server.stop();
+    REQUIRE_THROWS_AS(server.submit(make_random_data(6, 3u)), std::runtime_error);
+
+    Model unloaded;
+    REQUIRE_THROWS_AS(InferenceServer(unloaded, params), std::invalid_argument);
+}
+
+TEST_CASE("InferenceServer executes clones of a device model concurrently", "[InferenceServer][OpenCL]")
+{
+    const auto runtime = get_opencl_runtime();
+    if (!runtime)
+    {
+        SKIP("no OpenCL device");
+    }
+
+    // the clones of every executor record their reads of the same weights
+    RandomMlp reference(6, 5, 4, 1u);
+    RandomMlp net(6, 5, 4, 1u, runtime);
+    InferenceServerParams params;
+    params.sample_dims = {6};
+    params.max_batch_size = 4u;
+    params.num_executors = 4u;
+
+    std::vector<std::vector<float>> samples(200u);
+    for (auto i = 0u; i < samples.size(); ++i)
+    {
+        samples[i] = make_random_data(6, 20u + i);
+    }
+
+    InferenceServer server(net.model, params, [runtime]() -> Tensor<float>*
+    {
+        return new TensorOpenCL<float>(runtime->program, runtime->queue, runtime->context);
+    });
+    std::vector<std::future<std::vector<float>>> futures;
+    for (const auto& sample : samples)
+    {
+        futures.push_back(server.submit(sample));
+    }
+    for (auto i = 0u; i < samples.size(); ++i)
+    {
+        const auto result = futures[i].get();
+        const auto expected = reference.run(samples[i], 1u);
+        REQUIRE(result.size() == expected.size());
+        for (auto j = 0u; j < expected.size(); ++j)
+        {
+            REQUIRE(result[j] == Catch::Approx(expected[j]).margin(1e-4));
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+#include "nn/model/MemoryPlanner.h"
+#include "nn/model/ArenaPlan.h"
+
+#include <catch2/catch_all.hpp>
+#include <vector>
+
+namespace
+{
+    // Dense(3 -> 2) -> RELU -> Dense(2 -> 2) -> RELU -> ARGMAX
+    struct TwoLayerModel
+    {
+        Tensor<float> w1, b1, w2, b2;
+        Dense dense1, dense2;
+        Activation relu1{ACTIVATION::RELU};
+        Activation relu2{ACTIVATION::RELU};
+        Activation argmax{ACTIVATION::ARGMAX};
+        Model model;
+
+        TwoLayerModel()
+        {
+            w1.set_host_data({1.0f, -1.0f, 2.0f, 0.5f, -3.0f, 1.0f});
+            w1.set_dims({3, 2});
+            b1.set_host_data({0.5f, -4.0f});
+            b1.set_dims({1, 2});
+            w2.set_host_data({-1.0f, 2.0f, 1.0f, 1.0f});
+            w2.set_dims({2, 2});
+            b2.set_host_data({0.0f, -1.0f});
+            b2.set_dims({1, 2});
+
+            dense1.set_weight(&w1);
+            dense1.set_bias(&b1);
+            dense2.set_weight(&w2);
+            dense2.set_bias(&b2);
+
+            model.add_layer(&dense1);
+            model.add_layer(&relu1);
+            model.add_layer(&dense2);
+            model.add_layer(&relu2);
+            model.add_layer(&argmax);
+        }
+    };
+}
+
+TEST_CASE("Model fuses Dense followed by RELU", "[Model]")
+{
+    TwoLayerModel net;
+    REQUIRE(net.model.get_num_layers() == 5u);
+
+    net.model.to_host();
+    REQUIRE(net.model.get_num_layers() == 3u);
+    REQUIRE(net.dense1.get_fused_activation() == ACTIVATION::RELU);
+    REQUIRE(net.dense2.get_fused_activation() == ACTIVATION::RELU);
+
+    // nothing left to fuse
+    REQUIRE(net.model.fuse_layers() == 0u);
+}
+
+TEST_CASE("Fused model computes the same result as the unfused layers", "[Model]")
+{
+    TwoLayerModel net;
+    net.model.to_host();
+
+    auto input = Tensor<float>();
+    input.set_host_data({1.0f, 2.0f, 3.0f});
+    input.set_dims({1, 3});
+
+    // unfused reference: relu(relu(x * w1 + b1) * w2 + b2)
+    // x * w1 + b1 = {1 + 4 - 9 + 0.5, -1 + 1 + 3 - 4} = {-3.5, -1} -> relu {0, 0}
+    // 0 * w2 + b2 = {0, -1} -> relu {0, 0}
+    auto hidden = Tensor<float>();
+    hidden.set_host_data({0.0f});
+    net.model.execute(&input, &hidden);
+    REQUIRE(hidden.get_size() == 1u);
+    REQUIRE(hidden(0, 0) == Catch::Approx(0.0));
+
+    input.set_host_data({3.0f, 1.0f, 0.0f});
+    // x * w1 + b1 = {3 + 2 + 0.5, -3 + 0.5 - 4} = {5.5, -6.5} -> relu {5.5, 0}
+    // {5.5, 0} * w2 + b2 = {-5.5, 11 - 1} -> relu {0, 10} -> argmax 1
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+    net.model.execute(&input, &result);
+    REQUIRE(result(0, 0) == Catch::Approx(1.0));
+}
+
+TEST_CASE("Model executes a whole batch in one call", "[Model]")
+{
+    TwoLayerModel net;
+    net.model.to_host();
+
+    for (size_t batch_size : std::vector<size_t>{1u, 7u, 64u, 1024u})
+    {
+        std::vector<float> batch_data(batch_size * 3u);
+        for (auto i = 0u; i < batch_data.size(); ++i)
+        {
+            batch_data[i] = static_cast<float>((i * 7u) % 11u) - 5.0f;
+        }
+
+        auto batch = Tensor<float>();
+        batch.set_host_data(batch_data);
+        batch.set_dims({batch_size, 3});
+
+        auto batch_result = Tensor<float>();
+        batch_result.set_host_data({0.0f});
+        net.model.execute(&batch, &batch_result);
+        REQUIRE(batch_result.get_dims() == std::vector<size_t>({batch_size, 1}));
+
+        // every row matches running its sample on its own
+        for (auto row = 0u; row < batch_size; ++row)
+        {
+            auto sample = Tensor<float>();
+            sample.set_host_data({batch_data[row * 3u], batch_data[row * 3u + 1u], batch_data[row * 3u + 2u]});
+            sample.set_dims({1, 3});
+
+            auto sample_result = Tensor<float>();
+            sample_result.set_host_data({0.0f});
+            net.model.execute(&sample, &sample_result);
+            REQUIRE(batch_result(row, 0) == Catch::Approx(sample_result(0, 0)));
+        }
+    }
+}
+
+TEST_CASE("Memory planner shares arena ranges between buffers that are never alive together", "[Model]")
+{
+    auto planner = MemoryPlanner(4u);
+    const auto first  = planner.add_block(100u, 0u, 1u);
+    const auto second = planner.add_block(50u, 1u, 2u);
+    const auto third  = planner.add_block(100u, 2u, 3u);
+    REQUIRE(planner.plan() == 150u);
+
+    // first and third never overlap in time, second overlaps both
+    REQUIRE(planner.get_offset(first) == planner.get_offset(third));
+    REQUIRE(planner.get_offset(second) == 100u);
+    REQUIRE(planner.get_offset(second) % 4u == 0u);
+}
+
+TEST_CASE("Arena plan keeps the storage of views alive and leaves external values out", "[Model]")
+{
+    ArenaPlan arena_plan;
+    const auto host = arena_plan.add_arena(1u);
+    const auto device = arena_plan.add_arena(4u);
+    const auto input = arena_plan.add_external();
+    const auto input_view = arena_plan.add_view(input);
+    arena_plan.add_use(input_view, 0u);
+    const auto first = arena_plan.add_value(host, {10, 10}, 0u);
+    const auto view = arena_plan.add_view(first);
+    // the view is read at step 2, so first's block must not be shared with second
+    arena_plan.add_use(view, 2u);
+    const auto second = arena_plan.add_value(host, {5, 10}, 1u);
+    arena_plan.add_use(second, 2u);
+    const auto third = arena_plan.add_value(host, {2, 5}, 3u);
+    const auto copy = arena_plan.add_value(device, {3}, 0u);
+    REQUIRE_FALSE(arena_plan.has_block(input));
+    REQUIRE_FALSE(arena_plan.has_block(input_view));
+    REQUIRE_FALSE(arena_plan.has_block(view));
+    REQUIRE(arena_plan.has_block(first));
+    REQUIRE(arena_plan.has_block(copy));
+    REQUIRE_THROWS_AS(arena_plan.add_value(2u, {1}, 0u), std::invalid_argument);
+
+    REQUIRE(arena_plan.plan(host) == 150u);
+    REQUIRE(arena_plan.plan(device) == 3u);
+
+    Tensor<float> arena, window;
+    arena.allocate({150});
+    arena_plan.alias(second, &arena, &window);
+    REQUIRE(window.get_dims() == std::vector<size_t>{5, 10});
+    REQUIRE(window.data() == arena.data() + 100);
+    arena_plan.alias(third, &arena, &window);
+    REQUIRE(window.data() == arena.data());
+}
+
+TEST_CASE("Model plans its activations once per input shape", "[Model]")
+{
+    TwoLayerModel net;
+    net.model.to_host();
+
+    auto input = Tensor<float>();
+    input.set_host_data(std::vector<float>(64u * 3u, 1.0f));
+    input.set_dims({64, 3});
+
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+    net.model.execute(&input, &result);
+
+    // two {64, 2} intermediates are alive at the same time, the argmax output goes to result
+    const auto peak_bytes = net.model.get_peak_activation_bytes();
+    REQUIRE(peak_bytes == 2u * 64u * 2u * sizeof(float));
+
+    net.model.execute(&input, &result);
+    REQUIRE(net.model.get_peak_activation_bytes() == peak_bytes);
+
+    input.set_host_data(std::vector<float>(3u, 1.0f));
+    input.set_dims({1, 3});
+    net.model.execute(&input, &result);
+    REQUIRE(net.model.get_peak_activation_bytes() < peak_bytes);
+    REQUIRE(result.get_dims() == std::vector<size_t>({1, 1}));
+}
@@ -0,0 +1,200 @@
+#include "nn/layer/Pool2D.h"
+#include "nn/layer/GlobalAveragePool.h"
+#include "nn/layer/Flatten.h"
+#include "nn/layer/Reshape.h"
+#include "nn/layer/Dense.h"
+#include "nn/model/Model.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // direct NHWC pooling, taps in the padding are skipped
+    std::vector<float> reference_pool2d(const std::vector<float>& input, const std::vector<size_t>& input_dims,
+                                        POOLING pooling, const Conv2DParams& params)
+    {
+        const auto batch = input_dims[0], in_h = input_dims[1], in_w = input_dims[2], channels = input_dims[3];
+        std::vector<float> output(batch * params.out_h * params.out_w * channels);
+        for (size_t n = 0; n < batch; ++n)
+        for (size_t oh = 0; oh < params.out_h; ++oh)
+        for (size_t ow = 0; ow < params.out_w; ++ow)
+        for (size_t c = 0; c < channels; ++c)
+        {
+            float value = pooling == POOLING::MAX ? std::numeric_limits<float>::lowest() : 0.0f;
+            size_t count = 0;
+            for (size_t kh = 0; kh < params.kernel_h; ++kh)
+            for (size_t kw = 0; kw < params.kernel_w; ++kw)
+            {
+                const auto ih = static_cast<long>(oh * params.stride_h + kh) - static_cast<long>(params.pad_top);
+                const auto iw = static_cast<long>(ow * params.stride_w + kw) - static_cast<long>(params.pad_left);
+                if (ih < 0 || iw < 0 || ih >= static_cast<long>(in_h) || iw >= static_cast<long>(in_w))
+                {
+                    continue;
+                }
+                const auto tap = input[((n * in_h + ih) * in_w + iw) * channels + c];
+                value = pooling == POOLING::MAX ? std::max(value, tap) : value + tap;
+                ++count;
+            }
+            output[((n * params.out_h + oh) * params.out_w + ow) * channels + c] = pooling == POOLING::MAX ? value : value / count;
+        }
+        return output;
+    }
+
+    struct Pool2DCase
+    {
+        std::vector<size_t> input_dims;
+        size_t filter;
+        size_t stride;
+        PADDING padding;
+        std::vector<size_t> expected_output_dims;
+    };
+}
+
+TEST_CASE("Pool2D matches a direct max and average pooling", "[Pool2D]")
+{
+    const auto pooling = GENERATE(POOLING::MAX, POOLING::AVERAGE);
+    const auto test_case = GENERATE(
+        Pool2DCase{{1, 4, 4, 1}, 2, 2, PADDING::VALID, {1, 2, 2, 1}},
+        Pool2DCase{{2, 7, 5, 3}, 3, 2, PADDING::SAME, {2, 4, 3, 3}},
+        Pool2DCase{{1, 9, 9, 16}, 3, 1, PADDING::SAME, {1, 9, 9, 16}},
+        Pool2DCase{{3, 11, 8, 5}, 2, 3, PADDING::VALID, {3, 4, 3, 5}});
+
+    const auto input_data = make_random_data(test_case.input_dims[0] * test_case.input_dims[1] *
+                                             test_case.input_dims[2] * test_case.input_dims[3], 1u);
+    Tensor<float> input, result;
+    input.set_host_data(input_data);
+    input.set_dims(test_case.input_dims);
+    result.set_host_data({0.0f});
+
+    Pool2D pool(pooling, test_case.filter, test_case.filter, test_case.stride, test_case.stride, test_case.padding);
+    pool.to_host();
+    REQUIRE(pool.get_output_dims(test_case.input_dims) == test_case.expected_output_dims);
+
+    pool.forward(&input, &result, nullptr);
+    REQUIRE(result.get_dims() == test_case.expected_output_dims);
+
+    const auto expected = reference_pool2d(input_data, test_case.input_dims, pooling, pool.get_params(test_case.input_dims));
+    REQUIRE(result.get_size() == expected.size());
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        REQUIRE(result.data()[i] == Catch::Approx(expected[i]).margin(1e-5));
+    }
+
+    // the pooling kernel on the device, if there is one
+    if (const auto runtime = get_opencl_runtime())
+    {
+        auto device_input = make_device_tensor(runtime, input_data, test_case.input_dims);
+        auto device_result = make_device_tensor(runtime, {0.0f}, {1, 1});
+        device_input->load_to_device();
+        device_result->load_to_device();
+        pool.to_device();
+        pool.forward(device_input.get(), device_result.get(), nullptr);
+        REQUIRE(device_result->get_dims() == test_case.expected_output_dims);
+        device_result->load_to_host();
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(device_result->data()[i] == Catch::Approx(expected[i]).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("GlobalAveragePool averages every channel over the image", "[Pool2D]")
+{
+    const std::vector<size_t> input_dims = {2, 5, 3, 4};
+    const auto input_data = make_random_data(2 * 5 * 3 * 4, 2u);
+    Tensor<float> input, result;
+    input.set_host_data(input_data);
+    input.set_dims(input_dims);
+    result.set_host_data({0.0f});
+
+    GlobalAveragePool pool;
+    pool.to_host();
+    pool.forward(&input, &result, nullptr);
+    REQUIRE(result.get_dims() == std::vector<size_t>({2, 4}));
+
+    for (size_t n = 0; n < 2; ++n)
+    {
+        for (size_t c = 0; c < 4; ++c)
+        {
+            float sum = 0.0f;
+            for (size_t pixel = 0; pixel < 5 * 3; ++pixel)
+            {
+                sum += input_data[(n * 5 * 3 + pixel) * 4 + c];
+            }
+            REQUIRE(result(n, c) == Catch::Approx(sum / 15.0f).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("Flatten and Reshape only change the dims", "[Reshape]")
+{
+    Tensor<float> input, flat, reshaped;
+    input.set_host_data(make_random_data(2 * 3 * 4 * 5, 3u));
+    input.set_dims({2, 3, 4, 5});
+    flat.set_host_data({0.0f});
+    reshaped.set_host_data({0.0f});
+
+    Flatten flatten;
+    Reshape reshape({6, 10});
+    flatten.to_host();
+    reshape.to_host();
+
+    flatten.forward(&input, &flat, nullptr);
+    REQUIRE(flat.get_dims() == std::vector<size_t>({2, 60}));
+    REQUIRE(flat.data() == input.data());
+
+    reshape.forward(&flat, &reshaped, nullptr);
+    REQUIRE(reshaped.get_dims() == std::vector<size_t>({2, 6, 10}));
+    REQUIRE(reshaped.data() == input.data());
+    REQUIRE(input.get_dims() == std::vector<size_t>({2, 3, 4, 5}));
+
+    REQUIRE_THROWS_AS(Reshape({7, 10}).get_output_dims({2, 3, 4, 5}), std::invalid_argument);
+}
+
+TEST_CASE("A planned model gives views no memory of their own", "[Reshape]")
+{
+    // MaxPool2D -> Flatten -> Dense(4 * 4 * 2 -> 3)
+    const std::vector<size_t> input_dims = {2, 8, 8, 2};
+    const auto input_data = make_random_data(2 * 8 * 8 * 2, 4u);
+    Tensor<float> input, weight, bias, result;
+    input.set_host_data(input_data);
+    input.set_dims(input_dims);
+    weight.set_host_data(make_random_data(32 * 3, 5u));
+    weight.set_dims({32, 3});
+    bias.set_host_data({0.1f, -0.2f, 0.3f});
+    bias.set_dims({1, 3});
+    result.set_host_data({0.0f});
+
+    MaxPool2D pool(2, 2, 2, 2);
+    Flatten flatten;
+    Dense dense;
+    dense.set_weight(&weight);
+    dense.set_bias(&bias);
+
+    Model model;
+    model.add_layer(&pool);
+    model.add_layer(&flatten);
+    model.add_layer(&dense);
+    model.to_host();
+    model.execute(&input, &result);
+
+    // only the pooled activations, {2, 4, 4, 2}, live in the arena
+    REQUIRE(model.get_peak_activation_bytes() == 2 * 4 * 4 * 2 * sizeof(float));
+    REQUIRE(result.get_dims() == std::vector<size_t>({2, 3}));
+
+    Tensor<float> pooled, flat, expected;
+    pooled.set_host_data({0.0f});
+    flat.set_host_data({0.0f});
+    expected.set_host_data({0.0f});
+    input.pool2d(POOLING::MAX, pool.get_params(input_dims), &pooled);
+    pooled.reshape({2, 32}, &flat);
+    flat.dense(&weight, &bias, &expected);
+    for (auto i = 0u; i < expected.get_size(); ++i)
+    {
+        REQUIRE(result.data()[i] == Catch::Approx(expected.data()[i]).margin(1e-5));
+    }
+}
@@ -0,0 +1,139 @@
+#include "nn/profiling/Profiler.h"
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+
+#include <catch2/catch_all.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Dense(4 -> 3) -> ARGMAX on the host
+    struct ProfiledModel
+    {
+        Tensor<float> weight, bias, input, result;
+        Dense dense;
+        Activation argmax{ACTIVATION::ARGMAX};
+        Model model;
+
+        ProfiledModel()
+        {
+            weight.set_host_data(std::vector<float>(4 * 3, 0.5f));
+            weight.set_dims({4, 3});
+            bias.set_host_data({0.1f, 0.2f, 0.3f});
+            bias.set_dims({1, 3});
+            input.set_host_data(std::vector<float>(2 * 4, 1.0f));
+            input.set_dims({2, 4});
+            result.set_host_data({0.0f});
+
+            dense.set_weight(&weight);
+            dense.set_bias(&bias);
+            model.add_layer(&dense);
+            model.add_layer(&argmax);
+            model.to_host();
+        }
+    };
+}
+
+TEST_CASE("Profiler records nothing while disabled", "[Profiler]")
+{
+    auto& profiler = Profiler::instance();
+    Profiler::set_enabled(false);
+    profiler.clear();
+
+    ProfiledModel net;
+    net.model.execute(&net.input, &net.result);
+    REQUIRE(profiler.get_num_runs() == 0u);
+    REQUIRE(profiler.get_records().empty());
+    REQUIRE(profiler.get_summary().empty());
+}
+
+TEST_CASE("Profiler aggregates the layers of many runs", "[Profiler]")
+{
+    auto& profiler = Profiler::instance();
+    profiler.clear();
+    Profiler::set_enabled(true);
+
+    ProfiledModel net;
+    const size_t num_runs = 5u;
+    for (auto i = 0u; i < num_runs; ++i)
+    {
+        net.model.execute(&net.input, &net.result);
+    }
+    // an event-less transfer keeps its host times
+    const auto start_us = profiler.now_us();
+    profiler.record_event(nullptr, "write", PROFILE_CATEGORY::TRANSFER, 64u, start_us);
+    Profiler::set_enabled(false);
+
+    REQUIRE(profiler.get_num_runs() == num_runs);
+    const auto records = profiler.get_records();
+    REQUIRE(records.size() == 2u * num_runs + 1u);
+    REQUIRE(records[0].name == "0:Dense");
+    REQUIRE(records[1].name == "1:ARGMAX");
+    REQUIRE(records[2].run == records[0].run + 1u);
+    for (const auto& record : records)
+    {
+        REQUIRE(record.host_end_us >= record.host_start_us);
+        REQUIRE_FALSE(record.has_device_times());
+    }
+
+    const auto summary = profiler.get_summary();
+    REQUIRE(summary.size() == 3u);
+    size_t num_layer_entries = 0u;
+    for (const auto& entry : summary)
+    {
+        if (entry.category == PROFILE_CATEGORY::LAYER)
+        {
+            ++num_layer_entries;
+            REQUIRE(entry.count == num_runs);
+            REQUIRE(entry.min_us <= entry.total_us / num_runs);
+            REQUIRE(entry.max_us >= entry.total_us / num_runs);
+        }
+        else
+        {
+            REQUIRE(entry.name == "write");
+            REQUIRE(entry.bytes == 64u);
+        }
+    }
+    REQUIRE(num_layer_entries == 2u);
+
+    const auto table = profiler.get_summary_table();
+    REQUIRE_THAT(table, Catch::Matchers::ContainsSubstring("0:Dense"));
+    REQUIRE_THAT(table, Catch::Matchers::ContainsSubstring("transfer"));
+
+    std::ostringstream trace;
+    profiler.write_chrome_trace(trace);
+    REQUIRE_THAT(trace.str(), Catch::Matchers::StartsWith("{\"displayTimeUnit\""));
+    REQUIRE_THAT(trace.str(), Catch::Matchers::ContainsSubstring("\"name\": \"1:ARGMAX\", \"cat\": \"layer\", \"ph\": \"X\""));
+    REQUIRE_THAT(trace.str(), Catch::Matchers::EndsWith("]}\n"));
+
+    profiler.clear();
+    REQUIRE(profiler.get_records().empty());
+}
+
+TEST_CASE("Profiler keeps summarizing past its record limit", "[Profiler]")
+{
+    auto& profiler = Profiler::instance();
+    profiler.clear();
+    profiler.set_max_records(4u);
+    Profiler::set_enabled(true);
+
+    ProfiledModel net;
+    for (auto i = 0u; i < 3u; ++i)
+    {
+        net.model.execute(&net.input, &net.result);
+    }
+    Profiler::set_enabled(false);
+
+    REQUIRE(profiler.get_records().size() == 4u);
+    REQUIRE(profiler.get_num_dropped() == 2u);
+    for (const auto& entry : profiler.get_summary())
+    {
+        REQUIRE(entry.count == 3u);
+    }
+
+    profiler.set_max_records(size_t{1} << 20);
+    profiler.clear();
+}
@@ -0,0 +1,266 @@
+#include "nn/layer/QuantizedDense.h"
+#include "nn/layer/QuantizedConv2D.h"
+#include "nn/layer/Conv2D.h"
+#include "nn/layer/Activation.h"
+#include "nn/model/Model.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::vector<int8_t> make_random_int8(size_t size, unsigned seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dist(-127, 127);
+        std::vector<int8_t> data(size);
+        for (auto& value : data)
+        {
+            value = static_cast<int8_t>(dist(gen));
+        }
+        return data;
+    }
+
+    // values snapped to the int8 grid of scale / zero_point, like the output of a quantized layer
+    std::vector<float> make_quantized_data(size_t size, float scale, int32_t zero_point, unsigned seed)
+    {
+        auto data = make_random_int8(size, seed);
+        std::vector<float> result(size);
+        for (auto i = 0u; i < size; ++i)
+        {
+            result[i] = (static_cast<int32_t>(data[i]) - zero_point) * scale;
+        }
+        return result;
+    }
+
+    // TFLite's int8 FULLY_CONNECTED with a double precision requantization
+    std::vector<float> reference_quantized_dense(const std::vector<float>& input, size_t m, size_t k,
+                                                 const std::vector<int8_t>& weight, const std::vector<float>& weight_scales,
+                                                 const std::vector<int32_t>& bias, size_t n, const QuantizedGemmParams& params)
+    {
+        std::vector<float> output(m * n);
+        for (size_t i = 0; i < m; ++i)
+        for (size_t j = 0; j < n; ++j)
+        {
+            int32_t acc = bias[j];
+            for (size_t p = 0; p < k; ++p)
+            {
+                const auto q = static_cast<int32_t>(std::round(input[i * k + p] / params.input_scale)) + params.input_zero_point;
+                acc += (std::min(std::max(q, -128), 127) - params.input_zero_point) * weight[j * k + p];
+            }
+            const auto weight_scale = weight_scales.size() == 1u ? weight_scales[0] : weight_scales[j];
+            const auto real = static_cast<double>(params.input_scale) * weight_scale / params.output_scale;
+            auto value = static_cast<int32_t>(std::round(acc * real)) + params.output_zero_point;
+            value = std::min(std::max(value, params.activation_min), params.activation_max);
+            output[i * n + j] = (value - params.output_zero_point) * params.output_scale;
+        }
+        return output;
+    }
+}
+
+TEST_CASE("QuantizedMultiplier requantizes like a real multiplication", "[Quantization]")
+{
+    for (const double real : {0.0003, 0.0071, 0.25, 0.5, 0.7312, 1.0, 3.5})
+    {
+        const auto multiplier = QuantizedMultiplier::from_real(real);
+        for (const int32_t value : {-100000, -1234, -3, 0, 1, 77, 4096, 250000})
+        {
+            const auto expected = std::round(value * real);
+            REQUIRE(std::abs(multiplier.apply(value) - expected) <= 1.0);
+        }
+    }
+    REQUIRE(QuantizedMultiplier::from_real(0.0).apply(12345) == 0);
+}
+
+TEST_CASE("The int8 dot product matches a scalar loop", "[Quantization]")
+{
+    const auto k = GENERATE(1u, 15u, 16u, 17u, 32u, 33u, 100u, 1000u);
+    const auto a = make_random_int8(k, 1u);
+    const auto b = make_random_int8(k, 2u);
+
+    int32_t expected = 0;
+    for (auto p = 0u; p < k; ++p)
+    {
+        expected += static_cast<int32_t>(a[p]) * static_cast<int32_t>(b[p]);
+    }
+    REQUIRE(GemmInt8Host::dot(a.data(), b.data(), k) == expected);
+}
+
+TEST_CASE("QuantizedDense matches TFLite's int8 FULLY_CONNECTED", "[Quantization]")
+{
+    const auto per_channel = GENERATE(false, true);
+    const auto m = GENERATE(1u, 7u, 64u);
+    const size_t k = 45u, n = 13u;
+
+    QuantizedGemmParams params;
+    params.input_scale = 1.0f / 100.0f;
+    params.input_zero_point = -5;
+    params.output_scale = 1.0f / 20.0f;
+    params.output_zero_point = 3;
+
+    const auto input_data = make_random_data(m * k, 3u);
+    const auto weight_data = make_random_int8(n * k, 4u);
+    std::vector<int32_t> bias_data(n);
+    for (auto j = 0u; j < n; ++j)
+    {
+        bias_data[j] = static_cast<int32_t>(j * 97) - 500;
+    }
+    QuantizationParams weight_quantization;
+    weight_quantization.scales = {1.0f / 127.0f};
+    if (per_channel)
+    {
+        weight_quantization.scales.resize(n);
+        for (auto j = 0u; j < n; ++j)
+        {
+            weight_quantization.scales[j] = (1.0f + 0.25f * j) / 127.0f;
+        }
+    }
+
+    Tensor<float> input, result;
+    Tensor<int8_t> weight;
+    Tensor<int32_t> bias;
+    input.set_host_data(input_data);
+    input.set_dims({m, k});
+    weight.set_host_data(weight_data);
+    weight.set_dims({n, k});
+    bias.set_host_data(bias_data);
+    bias.set_dims({1, n});
+    result.set_host_data({0.0f});
+
+    QuantizedDense dense;
+    dense.set_weight(&weight, weight_quantization);
+    dense.set_bias(&bias);
+    dense.set_input_quantization(params.input_scale, params.input_zero_point);
+    dense.set_output_quantization(params.output_scale, params.output_zero_point);
+    Activation relu(ACTIVATION::RELU);
+
+    Model model;
+    model.add_layer(&dense);
+    model.add_layer(&relu);
+    model.to_host();
+    REQUIRE(model.get_num_layers() == 1u);
+    model.execute(&input, &result);
+    REQUIRE(result.get_dims() == std::vector<size_t>({m, n}));
+
+    // the fused RELU clamps at the output zero point
+    params.activation_min = params.output_zero_point;
+    const auto expected = reference_quantized_dense(input_data, m, k, weight_data, weight_quantization.scales, bias_data, n, params);
+    for (auto i = 0u; i < expected.size(); ++i)
+    {
+        // the fixed-point requantization may round a tie the other way
+        REQUIRE(result.data()[i] == Catch::Approx(expected[i]).margin(params.output_scale * 1.01f));
+        REQUIRE(result.data()[i] >= 0.0f);
+    }
+
+    // the int8 dense kernel on the device, if there is one
+    if (const auto runtime = get_opencl_runtime())
+    {
+        auto device_input = make_device_tensor(runtime, input_data, {m, k});
+        auto device_weight = make_device_tensor(runtime, weight_data, {n, k});
+        auto device_bias = make_device_tensor(runtime, bias_data, {1, n});
+        auto device_result = make_device_tensor(runtime, {0.0f}, {1, 1});
+        device_input->load_to_device();
+        device_result->load_to_device();
+
+        QuantizedDense device_dense;
+        device_dense.set_weight(device_weight.get(), weight_quantization);
+        device_dense.set_bias(device_bias.get());
+        device_dense.set_input_quantization(params.input_scale, params.input_zero_point);
+        device_dense.set_output_quantization(params.output_scale, params.output_zero_point);
+        Activation device_relu(ACTIVATION::RELU);
+
+        Model device_model;
+        device_model.add_layer(&device_dense);
+        device_model.add_layer(&device_relu);
+        device_model.to_device();
+        device_model.execute(device_input.get(), device_result.get());
+        REQUIRE(device_result->get_dims() == std::vector<size_t>({m, n}));
+        device_result->load_to_host();
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(device_result->data()[i] == Catch::Approx(expected[i]).margin(params.output_scale * 1.01f));
+        }
+    }
+
+    QuantizationParams asymmetric = weight_quantization;
+    asymmetric.zero_points = {1};
+    REQUIRE_THROWS_AS(dense.set_weight(&weight, asymmetric), std::invalid_argument);
+}
+
+TEST_CASE("QuantizedConv2D with per-channel weights follows the float convolution", "[Quantization]")
+{
+    const std::vector<size_t> input_dims = {2, 9, 8, 4};
+    const std::vector<size_t> weight_dims = {6, 3, 3, 4};
+    const size_t out_c = weight_dims[0], inner = 3 * 3 * 4;
+    const float input_scale = 1.0f / 64.0f;
+    const int32_t input_zero_point = 10;
+    const float output_scale = 1.0f / 16.0f;
+    const int32_t output_zero_point = -20;
+
+    const auto input_data = make_quantized_data(2 * 9 * 8 * 4, input_scale, input_zero_point, 5u);
+    auto weight_data = make_random_data(out_c * inner, 6u);
+    const auto bias_data = make_random_data(out_c, 7u);
+
+    // symmetric per-channel quantization of the weights, the float conv gets the quantized values back
+    QuantizationParams weight_quantization;
+    std::vector<int8_t> quantized_weight(weight_data.size());
+    std::vector<int32_t> quantized_bias(out_c);
+    for (size_t oc = 0; oc < out_c; ++oc)
+    {
+        const auto begin = weight_data.begin() + oc * inner;
+        const auto max_abs = std::abs(*std::max_element(begin, begin + inner, [](float a, float b) { return std::abs(a) < std::abs(b); }));
+        const auto scale = max_abs / 127.0f;
+        weight_quantization.scales.emplace_back(scale);
+        for (size_t p = 0; p < inner; ++p)
+        {
+            quantized_weight[oc * inner + p] = static_cast<int8_t>(std::round(weight_data[oc * inner + p] / scale));
+            weight_data[oc * inner + p] = quantized_weight[oc * inner + p] * scale;
+        }
+        quantized_bias[oc] = static_cast<int32_t>(std::round(bias_data[oc] / (input_scale * scale)));
+    }
+
+    Tensor<float> input, float_weight, float_bias, scratch, result, expected;
+    Tensor<int8_t> weight;
+    Tensor<int32_t> bias;
+    input.set_host_data(input_data);
+    input.set_dims(input_dims);
+    float_weight.set_host_data(weight_data);
+    float_weight.set_dims(weight_dims);
+    float_bias.set_host_data(bias_data);
+    float_bias.set_dims({1, out_c});
+    weight.set_host_data(quantized_weight);
+    weight.set_dims(weight_dims);
+    bias.set_host_data(quantized_bias);
+    bias.set_dims({1, out_c});
+    scratch.set_host_data({0.0f});
+    result.set_host_data({0.0f});
+    expected.set_host_data({0.0f});
+
+    QuantizedConv2D conv(2, 1, PADDING::SAME);
+    conv.set_weight(&weight, weight_quantization);
+    conv.set_bias(&bias);
+    conv.set_input_quantization(input_scale, input_zero_point);
+    conv.set_output_quantization(output_scale, output_zero_point);
+    conv.to_host();
+    conv.forward(&input, &result, &scratch);
+    REQUIRE(result.get_dims() == std::vector<size_t>({2, 5, 8, 6}));
+    REQUIRE(scratch.get_dims() == conv.get_scratch_dims(input_dims));
+
+    Conv2D float_conv(2, 1, PADDING::SAME);
+    float_conv.set_weight(&float_weight);
+    float_conv.set_bias(&float_bias);
+    float_conv.to_host();
+    float_conv.forward(&input, &expected, &scratch);
+
+    for (auto i = 0u; i < expected.get_size(); ++i)
+    {
+        const auto clamped = std::min(std::max(expected.data()[i], (-128 - output_zero_point) * output_scale),
+                                      (127 - output_zero_point) * output_scale);
+        // the input is on its grid, so only the output rounding and the bias rounding remain
+        REQUIRE(result.data()[i] == Catch::Approx(clamped).margin(output_scale * 0.51f));
+    }
+}
@@ -1,44 +1,102 @@
-#include "nn/tensor/Tensor.h"
-
-#include <catch2/catch_all.hpp>
-#include <vector>
-#include <numeric>
-
-TEST_CASE("Tensor indexing works fine", "[TensorIndexing]")
-{
-
-    std::vector<float> data(2 * 3 * 4);
-    std::iota(data.begin(), data.end(), 0.0);
-
-    auto t1 = Tensor<float>();
-    t1.set_host_data(data);
-    t1.set_dims({2, 3, 4});
-
-    REQUIRE(t1(0, 0, 0) == Catch::Approx(0.0));
-    REQUIRE(t1(0, 2, 3) == Catch::Approx(11.0));
-    REQUIRE(t1(1, 1, 1) == Catch::Approx(17.0));
-    REQUIRE(t1(1, 1, 2) == Catch::Approx(18.0));
-}
-
-TEST_CASE("Matrix arithmetics on host works correctly", "[MatrixOperations]")
-{
-    auto t1 = Tensor<float>();
-    t1.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
-    t1.set_dims({2, 3});
-
-    auto t2 = Tensor<float>();
-    t2.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
-    t2.set_dims({3, 2});
-
-    // auto t3 = t2 + t2;
-    // auto t4 = t1 * t2;
-
-    // REQUIRE(t4(0, 0) == Catch::Approx(22.0));
-    // REQUIRE(t4(0, 1) == Catch::Approx(28.0));
-    // REQUIRE(t4(1, 0) == Catch::Approx(49.0));
-    // REQUIRE(t4(1, 1) == Catch::Approx(64.0));
-
-    // REQUIRE(t3(0, 0) == Catch::Approx(2.0));
-    // REQUIRE(t3(2, 0) == Catch::Approx(10.0));
-    // REQUIRE(t3(1, 1) == Catch::Approx(8.0));
-}
\ No newline at end of file
+#include "nn/tensor/Tensor.h"
+
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include <numeric>
+#include <cmath>
+
+TEST_CASE("Tensor indexing works fine", "[TensorIndexing]")
+{
+
+    std::vector<float> data(2 * 3 * 4);
+    std::iota(data.begin(), data.end(), 0.0);
+
+    auto t1 = Tensor<float>();
+    t1.set_host_data(data);
+    t1.set_dims({2, 3, 4});
+
+    REQUIRE(t1(0, 0, 0) == Catch::Approx(0.0));
+    REQUIRE(t1(0, 2, 3) == Catch::Approx(11.0));
+    REQUIRE(t1(1, 1, 1) == Catch::Approx(17.0));
+    REQUIRE(t1(1, 1, 2) == Catch::Approx(18.0));
+}
+
+TEST_CASE("Matrix arithmetics on host works correctly", "[MatrixOperations]")
+{
+    auto t1 = Tensor<float>();
+    t1.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+    t1.set_dims({2, 3});
+
+    auto t2 = Tensor<float>();
+    t2.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+    t2.set_dims({3, 2});
+
+    // auto t3 = t2 + t2;
+    // auto t4 = t1 * t2;
+
+    // REQUIRE(t4(0, 0) == Catch::Approx(22.0));
+    // REQUIRE(t4(0, 1) == Catch::Approx(28.0));
+    // REQUIRE(t4(1, 0) == Catch::Approx(49.0));
+    // REQUIRE(t4(1, 1) == Catch::Approx(64.0));
+
+    // REQUIRE(t3(0, 0) == Catch::Approx(2.0));
+    // REQUIRE(t3(2, 0) == Catch::Approx(10.0));
+    // REQUIRE(t3(1, 1) == Catch::Approx(8.0));
+}
+TEST_CASE("Bias rows broadcast and argmax reduces every row of a batch", "[MatrixOperations]")
+{
+    auto batch = Tensor<float>();
+    batch.set_host_data({1.0f, 5.0f, 2.0f,
+                         7.0f, 0.0f, 3.0f,
+                         4.0f, 4.0f, 9.0f});
+    batch.set_dims({3, 3});
+
+    auto bias = Tensor<float>();
+    bias.set_host_data({0.0f, 3.0f, -1.0f});
+    bias.set_dims({1, 3});
+
+    auto sum = Tensor<float>();
+    sum.set_host_data({0.0f});
+    batch.add(&bias, &sum);
+
+    REQUIRE(sum.get_dims() == std::vector<size_t>({3, 3}));
+    REQUIRE(sum(0, 1) == Catch::Approx(8.0));
+    REQUIRE(sum(1, 0) == Catch::Approx(7.0));
+    REQUIRE(sum(2, 2) == Catch::Approx(8.0));
+
+    // {1, 8, 1}, {7, 3, 2}, {4, 7, 8}
+    auto indices = Tensor<float>();
+    indices.set_host_data({0.0f});
+    sum.argmax(&indices);
+
+    REQUIRE(indices.get_dims() == std::vector<size_t>({3, 1}));
+    REQUIRE(indices(0, 0) == Catch::Approx(1.0));
+    REQUIRE(indices(1, 0) == Catch::Approx(0.0));
+    REQUIRE(indices(2, 0) == Catch::Approx(2.0));
+
+    // a column vector is still reduced as a whole
+    auto column = Tensor<float>();
+    column.set_host_data({1.0f, 3.0f, 2.0f});
+    column.set_dims({3, 1});
+    column.argmax(&indices);
+    REQUIRE(indices.get_dims() == std::vector<size_t>({1, 1}));
+    REQUIRE(indices(0, 0) == Catch::Approx(1.0));
+}
+
+TEST_CASE("Softmax normalizes every row of a batch", "[MatrixOperations]")
+{
+    auto logits = Tensor<float>();
+    logits.set_host_data({1.0f, 2.0f, 3.0f,
+                          1000.0f, 1000.0f, 1000.0f});
+    logits.set_dims({2, 3});
+    auto result = Tensor<float>();
+    result.set_host_data({0.0f});
+    logits.softmax(&result);
+
+    REQUIRE(result.get_dims() == std::vector<size_t>({2, 3}));
+    const auto total = std::exp(1.0f) + std::exp(2.0f) + std::exp(3.0f);
+    REQUIRE(result(0, 0) == Catch::Approx(std::exp(1.0f) / total));
+    REQUIRE(result(0, 2) == Catch::Approx(std::exp(3.0f) / total));
+    // large logits do not overflow
+    REQUIRE(result(1, 1) == Catch::Approx(1.0f / 3.0f));
+}
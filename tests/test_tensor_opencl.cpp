@@ -0,0 +1,181 @@
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/tensor/OpenCLBufferPool.h"
+#include "test_utils.h"
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    void require_data(const Tensor<float>* tensor, const std::vector<float>& expected)
+    {
+        REQUIRE(tensor->get_platform() == PLATFORM::HOST);
+        REQUIRE(tensor->get_size() == expected.size());
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(tensor->data()[i] == Catch::Approx(expected[i]).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("Buffer pool size classes are powers of two", "[OpenCLBufferPool]")
+{
+    REQUIRE(OpenCLBufferPool::get_size_class(1u) == OpenCLBufferPool::MIN_SIZE_CLASS);
+    REQUIRE(OpenCLBufferPool::get_size_class(1000u) == 1024u);
+    REQUIRE(OpenCLBufferPool::get_size_class(1024u) == 1024u);
+    REQUIRE(OpenCLBufferPool::get_size_class(1025u) == 2048u);
+}
+
+TEST_CASE("Device ops chain through events on an out-of-order queue", "[TensorOpenCL][OpenCL]")
+{
+    const auto in_order = get_opencl_runtime();
+    if (!in_order)
+    {
+        SKIP("no OpenCL device");
+    }
+    cl_command_queue_properties properties = 0;
+    clGetDeviceInfo(in_order->device, CL_DEVICE_QUEUE_PROPERTIES, sizeof(properties), &properties, nullptr);
+    if (!(properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE))
+    {
+        SKIP("the device has no out-of-order queues");
+    }
+    const auto runtime = get_opencl_runtime(CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+
+    const size_t size = 1u << 16;
+    const auto a_data = make_random_data(size, 1u);
+    const auto b_data = make_random_data(size, 2u);
+    auto a = make_device_tensor(runtime, a_data, {1, size});
+    auto b = make_device_tensor(runtime, b_data, {1, size});
+    auto sum = make_device_tensor(runtime, {0.0f}, {1, 1});
+    auto positive = make_device_tensor(runtime, {0.0f}, {1, 1});
+    auto result = make_device_tensor(runtime, {0.0f}, {1, 1});
+    for (auto tensor : {a.get(), b.get(), sum.get(), positive.get(), result.get()})
+    {
+        tensor->load_to_device();
+    }
+
+    // nothing waits in between: every command only runs after the ones it depends on, and the
+    // in-place add must not overwrite sum before the RELU has read it
+    a->add(b.get(), sum.get());
+    sum->relu(positive.get());
+    a->add(sum.get(), sum.get());
+    positive->add(sum.get(), result.get());
+    result->load_to_host();
+
+    std::vector<float> expected(size);
+    for (auto i = 0u; i < size; ++i)
+    {
+        const auto first_sum = a_data[i] + b_data[i];
+        expected[i] = std::max(0.0f, first_sum) + a_data[i] + first_sum;
+    }
+    require_data(result.get(), expected);
+}
+
+TEST_CASE("Asynchronous loads return at once and are complete after wait", "[TensorOpenCL][OpenCL]")
+{
+    const auto runtime = get_opencl_runtime();
+    if (!runtime)
+    {
+        SKIP("no OpenCL device");
+    }
+
+    // the host data of an asynchronous upload must stay valid until it completes
+    const auto data = make_random_data(256u * 256u, 3u);
+    auto input = make_device_tensor(runtime, data, {256, 256});
+    input->load_to_device_async();
+    REQUIRE(input->get_platform() == PLATFORM::DEVICE);
+
+    auto result = make_device_tensor(runtime, {0.0f}, {1, 1});
+    result->load_to_device();
+    input->relu(result.get());
+    result->load_to_host_async();
+    REQUIRE(result->get_platform() == PLATFORM::HOST);
+    result->wait();
+
+    std::vector<float> expected(data.size());
+    std::transform(data.cbegin(), data.cend(), expected.begin(), [](float value) { return std::max(0.0f, value); });
+    require_data(result.get(), expected);
+
+    // the tensor can go back to the device and is read again after its new data was uploaded
+    std::vector<float> doubled(expected.size());
+    std::transform(expected.cbegin(), expected.cend(), doubled.begin(), [](float value) { return 2.0f * value; });
+    result->set_host_data(doubled);
+    result->set_dims({256, 256});
+    result->load_to_device_async();
+    result->relu(input.get());
+    input->load_to_host();
+    require_data(input.get(), doubled);
+}
+
+TEST_CASE("Pipelined execution computes what execute computes", "[TensorOpenCL][OpenCL]")
+{
+    const auto runtime = get_opencl_runtime();
+    if (!runtime)
+    {
+        SKIP("no OpenCL device");
+    }
+
+    RandomMlp reference(32, 16, 8, 5u);
+    RandomMlp net(32, 16, 8, 5u, runtime);
+
+    const size_t num_requests = 5u, batch = 3u;
+    std::vector<std::vector<float>> samples;
+    std::vector<std::unique_ptr<TensorOpenCL<float>>> inputs, results;
+    std::vector<Tensor<float>*> input_ptrs, result_ptrs;
+    for (auto i = 0u; i < num_requests; ++i)
+    {
+        samples.emplace_back(make_random_data(batch * 32u, 10u + i));
+        inputs.emplace_back(make_device_tensor(runtime, samples.back(), {batch, 32}));
+        results.emplace_back(make_device_tensor(runtime, {0.0f}, {1, 1}));
+        results.back()->load_to_device();
+        input_ptrs.push_back(inputs.back().get());
+        result_ptrs.push_back(results.back().get());
+    }
+
+    net.model.execute_pipelined(input_ptrs, result_ptrs);
+    for (auto i = 0u; i < num_requests; ++i)
+    {
+        REQUIRE(results[i]->get_dims() == std::vector<size_t>({batch, 8}));
+        require_data(results[i].get(), reference.run(samples[i], batch));
+    }
+}
+
+TEST_CASE("Buffer pool hands released buffers out again", "[OpenCLBufferPool][OpenCL]")
+{
+    const auto runtime = get_opencl_runtime();
+    if (!runtime)
+    {
+        SKIP("no OpenCL device");
+    }
+    auto& pool = OpenCLBufferPool::instance();
+
+    size_t capacity = 0u;
+    const auto buffer = pool.acquire(runtime->context, runtime->queue, 1000u, capacity);
+    REQUIRE(buffer);
+    REQUIRE(capacity == 1024u);
+    pool.release(runtime->context, runtime->queue, buffer, capacity);
+
+    // the same size class on the in-order queue that released it is handed out right away
+    const auto num_hits = pool.get_num_hits();
+    size_t reused_capacity = 0u;
+    const auto reused = pool.acquire(runtime->context, runtime->queue, 600u, reused_capacity);
+    REQUIRE(reused == buffer);
+    REQUIRE(reused_capacity == capacity);
+    REQUIRE(pool.get_num_hits() == num_hits + 1u);
+    pool.release(runtime->context, runtime->queue, reused, reused_capacity);
+
+    // tensors draw their buffers from the pool and return them when they are destroyed
+    const auto data = make_random_data(4096u, 4u);
+    {
+        auto tensor = make_device_tensor(runtime, data, {1, 4096});
+        tensor->load_to_device();
+    }
+    const auto tensor_hits = pool.get_num_hits();
+    auto tensor = make_device_tensor(runtime, data, {1, 4096});
+    tensor->load_to_device();
+    REQUIRE(pool.get_num_hits() == tensor_hits + 1u);
+    tensor->load_to_host();
+    require_data(tensor.get(), data);
+}
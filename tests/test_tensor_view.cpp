@@ -0,0 +1,83 @@
+#include "nn/tensor/Tensor.h"
+#include "nn/tensor/TensorView.h"
+
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include <numeric>
+
+TEST_CASE("Tensor views index without copying", "[TensorView]")
+{
+    std::vector<float> data(2 * 3 * 4);
+    std::iota(data.begin(), data.end(), 0.0);
+
+    auto t1 = Tensor<float>();
+    t1.set_host_data(data);
+    t1.set_dims({2, 3, 4});
+
+    auto view = t1.view<3>();
+    REQUIRE(view.data() == t1.data());
+    REQUIRE(view.is_contiguous());
+    REQUIRE(view(0, 2, 3) == Catch::Approx(11.0));
+    REQUIRE(view(1, 1, 2) == Catch::Approx(18.0));
+
+    view(1, 1, 2) = -1.0f;
+    REQUIRE(t1(1, 1, 2) == Catch::Approx(-1.0));
+
+    REQUIRE_THROWS_AS(t1.view<2>(), std::invalid_argument);
+}
+
+TEST_CASE("Tensor views slice, transpose and reshape", "[TensorView]")
+{
+    std::vector<float> data(3 * 4);
+    std::iota(data.begin(), data.end(), 0.0);
+
+    auto matrix = TensorView<float, 2>(data.data(), {3, 4});
+
+    const auto rows = matrix.slice(0, 1, 3);
+    REQUIRE(rows.dim(0) == 2);
+    REQUIRE(rows(0, 0) == Catch::Approx(4.0));
+    REQUIRE(rows.is_contiguous());
+
+    const auto cols = matrix.slice(1, 1, 3);
+    REQUIRE(cols.dim(1) == 2);
+    REQUIRE(cols(2, 1) == Catch::Approx(10.0));
+    REQUIRE_FALSE(cols.is_contiguous());
+    REQUIRE_THROWS_AS(cols.reshape<1>({6}), std::invalid_argument);
+
+    const auto transposed = matrix.transpose(0, 1);
+    REQUIRE(transposed.dim(0) == 4);
+    REQUIRE(transposed(3, 2) == Catch::Approx(matrix(2, 3)));
+
+    const auto flat = matrix.reshape<1>({12});
+    REQUIRE(flat(7) == Catch::Approx(7.0));
+    REQUIRE_THROWS_AS(matrix.reshape<2>({5, 2}), std::invalid_argument);
+
+    const TensorView<const float, 2> read_only = matrix;
+    REQUIRE(read_only(1, 2) == Catch::Approx(6.0));
+}
+
+TEST_CASE("Elementwise host ops run on views", "[TensorView]")
+{
+    auto t1 = Tensor<float>();
+    t1.set_host_data({1.0f, -2.0f, 3.0f, -4.0f, 5.0f, -6.0f});
+    t1.set_dims({2, 3});
+
+    auto t2 = Tensor<float>();
+    t2.set_host_data({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+    t2.set_dims({2, 3});
+
+    auto sum = Tensor<float>();
+    sum.set_host_data({0.0f});
+    t1.add(&t2, &sum);
+    REQUIRE(sum(0, 1) == Catch::Approx(0.0));
+    REQUIRE(sum(1, 2) == Catch::Approx(0.0));
+    REQUIRE(sum(1, 1) == Catch::Approx(10.0));
+
+    auto relu = Tensor<float>();
+    relu.set_host_data({0.0f});
+    t1.relu(&relu);
+    REQUIRE(relu(0, 1) == Catch::Approx(0.0));
+    REQUIRE(relu(1, 1) == Catch::Approx(5.0));
+
+    REQUIRE(t1.to_string(false, false, false, true) == "host data: {{1, -2, 3}, {-4, 5, -6}}\n");
+}
@@ -0,0 +1,117 @@
+#include "nn/model/TFLiteLoader.h"
+
+#include <catch2/catch_all.hpp>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+
+namespace
+{
+    const std::string mnist_model_path = std::string(MODELS_DIR) + "/TFLite/mnist_model.tflite";
+}
+
+TEST_CASE("TFLite loader parses the bundled MNIST model", "[TFLiteLoader]")
+{
+    const auto loader = TFLiteLoader(mnist_model_path);
+
+    REQUIRE(loader.get_input_dims() == std::vector<size_t>({1, 28, 28, 1}));
+    REQUIRE(loader.get_output_dims() == std::vector<size_t>({1, 10}));
+
+    std::vector<std::string> op_names;
+    for (const auto& op : loader.get_operators())
+    {
+        op_names.emplace_back(TFLiteLoader::get_operator_name(op.builtin_code));
+    }
+    REQUIRE(op_names == std::vector<std::string>({"CONV_2D", "MAX_POOL_2D", "CONV_2D", "MAX_POOL_2D",
+                                                  "RESHAPE", "FULLY_CONNECTED", "FULLY_CONNECTED", "SOFTMAX"}));
+}
+
+TEST_CASE("TFLite constant tensors point into the mapped file", "[TFLiteLoader]")
+{
+    const auto loader = TFLiteLoader(mnist_model_path);
+    const auto& file = loader.get_file();
+
+    std::ifstream stream(mnist_model_path, std::ios::binary);
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    REQUIRE(bytes.size() == file.size());
+
+    // the 64 x 1600 weights of the first FULLY_CONNECTED layer
+    const auto& fc_op = loader.get_operators()[5];
+    const auto& weights = loader.get_tensors()[fc_op.inputs[1]];
+    REQUIRE(weights.dims == std::vector<size_t>({64, 1600}));
+    REQUIRE(weights.data_size == 64 * 1600 * sizeof(float));
+    REQUIRE(weights.data >= file.data());
+    REQUIRE(weights.data + weights.data_size <= file.data() + file.size());
+
+    const auto offset = static_cast<size_t>(weights.data - file.data());
+    REQUIRE(std::equal(weights.data, weights.data + weights.data_size, bytes.begin() + offset));
+}
+
+TEST_CASE("TFLite loader runs the bundled MNIST model end to end", "[TFLiteLoader]")
+{
+    const auto loader = TFLiteLoader(mnist_model_path);
+    auto model = Model();
+    loader.load(model);
+    model.to_host();
+
+    auto classify = [&](const std::vector<float>& image)
+    {
+        auto input = Tensor<float>();
+        input.set_host_data(image);
+        input.set_dims(loader.get_input_dims());
+        auto result = Tensor<float>();
+        result.set_host_data({0.0f});
+        model.execute(&input, &result);
+
+        REQUIRE(result.get_dims() == loader.get_output_dims());
+        float sum = 0.0f;
+        for (auto i = 0u; i < 10u; ++i)
+        {
+            REQUIRE(result(0, i) >= 0.0f);
+            sum += result(0, i);
+        }
+        REQUIRE(sum == Catch::Approx(1.0f).epsilon(1e-5));
+
+        auto prediction = Tensor<float>();
+        prediction.set_host_data({0.0f});
+        result.argmax(&prediction);
+        // the model is confident about both digits below
+        REQUIRE(result(0, static_cast<size_t>(prediction(0, 0))) > 0.9f);
+        return prediction(0, 0);
+    };
+
+    // a vertical stroke in the middle of the image is a one
+    std::vector<float> stroke(28 * 28, 0.0f);
+    for (auto row = 4u; row < 24u; ++row)
+    {
+        stroke[row * 28 + 13] = 1.0f;
+        stroke[row * 28 + 14] = 1.0f;
+    }
+    REQUIRE(classify(stroke) == 1.0f);
+
+    // an upright elliptic ring is a zero
+    std::vector<float> ring(28 * 28, 0.0f);
+    for (auto row = 0u; row < 28u; ++row)
+    {
+        for (auto col = 0u; col < 28u; ++col)
+        {
+            const float dy = (row - 13.5f) / 9.0f;
+            const float dx = (col - 13.5f) / 6.0f;
+            const float radius = dx * dx + dy * dy;
+            if (radius > 0.6f && radius < 1.2f)
+            {
+                ring[row * 28 + col] = 1.0f;
+            }
+        }
+    }
+    REQUIRE(classify(ring) == 0.0f);
+
+    // the same image gives the same class after another one ran
+    REQUIRE(classify(stroke) == 1.0f);
+}
+
+TEST_CASE("TFLite loader rejects missing files", "[TFLiteLoader]")
+{
+    REQUIRE_THROWS_AS(TFLiteLoader(std::string(MODELS_DIR) + "/missing.tflite"), std::runtime_error);
+}
@@ -0,0 +1,197 @@
+#include "nn/kernels/ThreadPool.h"
+#include "nn/kernels/Gemm.h"
+
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Catch2 assertions are not thread-safe, bodies that run on workers only count what they see
+namespace
+{
+    // how often parallel_for visited every index of [0, size)
+    std::vector<int> count_visits(ThreadPool& pool, size_t size, size_t grain, size_t max_threads)
+    {
+        std::vector<std::atomic<int>> visits(size);
+        pool.parallel_for(0u, size, grain, [&](size_t first, size_t last)
+        {
+            for (auto i = first; i < last; ++i)
+            {
+                visits[i].fetch_add(1);
+            }
+        }, max_threads);
+        return std::vector<int>(visits.begin(), visits.end());
+    }
+}
+
+TEST_CASE("ThreadPool::parallel_for runs every index exactly once", "[ThreadPool]")
+{
+    ThreadPool pool(4);
+    REQUIRE(pool.get_num_threads() == 4u);
+
+    const auto size = GENERATE(1u, 7u, 64u, 1000u, 100003u);
+    const auto grain = GENERATE(1u, 3u, 256u);
+    const auto max_threads = GENERATE(0u, 1u, 2u);
+    const auto visits = count_visits(pool, size, grain, max_threads);
+    REQUIRE(visits == std::vector<int>(size, 1));
+}
+
+TEST_CASE("ThreadPool balances uneven chunks", "[ThreadPool]")
+{
+    ThreadPool pool(4);
+    // the first chunks are far slower than the rest, stealing hands the rest to idle threads
+    std::vector<std::atomic<int>> visits(64);
+    pool.parallel_for(0u, 64u, 1u, [&](size_t first, size_t last)
+    {
+        if (first < 4u)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        for (auto i = first; i < last; ++i)
+        {
+            visits[i].fetch_add(1);
+        }
+    });
+    for (const auto& visit : visits)
+    {
+        REQUIRE(visit == 1);
+    }
+}
+
+TEST_CASE("ThreadPool runs small and nested loops on the caller", "[ThreadPool]")
+{
+    ThreadPool pool(4);
+    const auto caller = std::this_thread::get_id();
+
+    // one chunk never leaves the calling thread
+    pool.parallel_for(0u, 100u, 100u, [&](size_t first, size_t last)
+    {
+        REQUIRE(std::this_thread::get_id() == caller);
+        REQUIRE(first == 0u);
+        REQUIRE(last == 100u);
+    });
+
+    // a loop inside a chunk runs inline on the thread that runs the chunk
+    std::atomic<size_t> inner_total(0u), moved(0u);
+    pool.parallel_for(0u, 16u, 1u, [&](size_t, size_t)
+    {
+        const auto outer = std::this_thread::get_id();
+        pool.parallel_for(0u, 1000u, 1u, [&](size_t first, size_t last)
+        {
+            moved.fetch_add(std::this_thread::get_id() != outer ? 1u : 0u);
+            inner_total.fetch_add(last - first);
+        });
+    });
+    REQUIRE(inner_total == 16u * 1000u);
+    REQUIRE(moved == 0u);
+}
+
+TEST_CASE("ThreadPool without caller participation runs chunks on workers only", "[ThreadPool]")
+{
+    ThreadPool pool(3);
+    pool.set_caller_participates(false);
+    REQUIRE_FALSE(pool.get_caller_participates());
+
+    const auto caller = std::this_thread::get_id();
+    std::atomic<size_t> total(0u), on_caller(0u);
+    pool.parallel_for(0u, 500u, 7u, [&](size_t first, size_t last)
+    {
+        on_caller.fetch_add(std::this_thread::get_id() == caller ? 1u : 0u);
+        total.fetch_add(last - first);
+    });
+    REQUIRE(total == 500u);
+    REQUIRE(on_caller == 0u);
+
+    // a pool without workers always runs on the caller
+    ThreadPool single(1);
+    single.set_caller_participates(false);
+    REQUIRE(count_visits(single, 10u, 1u, 0u) == std::vector<int>(10u, 1));
+}
+
+TEST_CASE("ThreadPool rethrows the exception of a chunk", "[ThreadPool]")
+{
+    ThreadPool pool(4);
+    std::atomic<size_t> total(0u);
+    REQUIRE_THROWS_AS(pool.parallel_for(0u, 100u, 1u, [&](size_t first, size_t last)
+    {
+        total.fetch_add(last - first);
+        if (first <= 50u && 50u < last)
+        {
+            throw std::runtime_error("chunk failed");
+        }
+    }), std::runtime_error);
+    // the other chunks still ran
+    REQUIRE(total == 100u);
+}
+
+TEST_CASE("ThreadPool serves many concurrent callers", "[ThreadPool]")
+{
+    ThreadPool pool(4);
+    const size_t num_callers = 8u, size = 20000u;
+    std::vector<std::thread> callers;
+    std::vector<int> correct(num_callers, 0);
+    for (size_t caller = 0u; caller < num_callers; ++caller)
+    {
+        callers.emplace_back([&, caller]()
+        {
+            for (auto repeat = 0; repeat < 20; ++repeat)
+            {
+                std::vector<uint64_t> values(size);
+                pool.parallel_for(0u, size, 64u, [&](size_t first, size_t last)
+                {
+                    for (auto i = first; i < last; ++i)
+                    {
+                        values[i] = i * caller;
+                    }
+                });
+                for (size_t i = 0u; i < size; ++i)
+                {
+                    if (values[i] != i * caller)
+                    {
+                        return;
+                    }
+                }
+            }
+            correct[caller] = 1;
+        });
+    }
+    for (auto& caller : callers)
+    {
+        caller.join();
+    }
+    REQUIRE(correct == std::vector<int>(num_callers, 1));
+}
+
+TEST_CASE("Host GEMM gives the same result on any default pool", "[ThreadPool]")
+{
+    const size_t m = 67, n = 131, k = 96;
+    std::mt19937 gen(1u);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> a(m * k), b(k * n);
+    for (auto& value : a)
+    {
+        value = dist(gen);
+    }
+    for (auto& value : b)
+    {
+        value = dist(gen);
+    }
+
+    std::vector<float> expected(m * n), c(m * n);
+    ThreadPool::set_default(std::make_shared<ThreadPool>(1));
+    GemmHost<float>::multiply(m, n, k, {a.data(), k, 1u}, {b.data(), n, 1u}, expected.data(), n);
+
+    ThreadPool::set_default(std::make_shared<ThreadPool>(5, true));
+    REQUIRE(ThreadPool::get_default()->get_num_threads() == 5u);
+    REQUIRE(GemmHost<float>::default_num_threads() == 5u);
+    GemmHost<float>::multiply(m, n, k, {a.data(), k, 1u}, {b.data(), n, 1u}, c.data(), n);
+    REQUIRE(c == expected);
+
+    // back to one thread per core
+    ThreadPool::set_default(nullptr);
+    REQUIRE(ThreadPool::get_default()->get_num_threads() == ThreadPool::get_hardware_threads());
+}
@@ -0,0 +1,137 @@
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include "inference_opencl.h"
+#include "nn/tensor/TensorOpenCL.h"
+#include "nn/model/Model.h"
+#include "nn/layer/Dense.h"
+#include "nn/layer/Activation.h"
+
+#include <CL/cl.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+// size values drawn uniformly from [-1, 1), the same for the same seed
+inline std::vector<float> make_random_data(size_t size, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> data(size);
+    for (auto& value : data)
+    {
+        value = dist(gen);
+    }
+    return data;
+}
+
+// create_opencl_runtime only asserts on errors, so the device tests look for a device first
+inline bool has_opencl_device()
+{
+    cl_platform_id platform = nullptr;
+    cl_uint num_platforms = 0u;
+    if (clGetPlatformIDs(1, &platform, &num_platforms) != CL_SUCCESS || num_platforms == 0u)
+    {
+        return false;
+    }
+    cl_device_id device = nullptr;
+    return clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, nullptr) == CL_SUCCESS ||
+           clGetDeviceIDs(platform, CL_DEVICE_TYPE_CPU, 1, &device, nullptr) == CL_SUCCESS;
+}
+
+// one runtime per queue type, shared by the device tests and kept until the process ends;
+// nullptr without a device, the tests SKIP then
+inline OpenCLRuntime* get_opencl_runtime(cl_command_queue_properties queue_properties = 0)
+{
+    static const bool found = has_opencl_device();
+    static std::map<cl_command_queue_properties, OpenCLRuntime> runtimes;
+    if (!found)
+    {
+        return nullptr;
+    }
+    auto iter = runtimes.find(queue_properties);
+    if (iter == runtimes.end())
+    {
+        iter = runtimes.emplace(queue_properties, create_opencl_runtime(queue_properties, false)).first;
+    }
+    return &iter->second;
+}
+
+// a TensorOpenCL holding data, on the host until loaded
+template <typename DATA_T = float>
+std::unique_ptr<TensorOpenCL<DATA_T>> make_device_tensor(const OpenCLRuntime* runtime, const std::vector<DATA_T>& data,
+                                                         const std::vector<size_t>& dims)
+{
+    auto tensor = std::make_unique<TensorOpenCL<DATA_T>>(runtime->program, runtime->queue, runtime->context);
+    tensor->set_host_data(data);
+    tensor->set_dims(dims);
+    return tensor;
+}
+
+/*
+* @brief  Dense(inputs -> hidden) -> RELU -> Dense(hidden -> outputs) with weights drawn from seed
+* @note   on the host, or with TensorOpenCL weights on the device of runtime. The same seed gives the
+*         same weights on both, so a host model is the reference of a device one
+*/
+struct RandomMlp
+{
+    std::vector<std::unique_ptr<Tensor<float>>> parameters;
+    Dense dense1, dense2;
+    Activation relu{ACTIVATION::RELU};
+    Model model;
+
+    RandomMlp(size_t inputs, size_t hidden, size_t outputs, unsigned seed, const OpenCLRuntime* runtime = nullptr)
+    {
+        set_parameters(dense1, inputs, hidden, seed, runtime);
+        set_parameters(dense2, hidden, outputs, seed + 2u, runtime);
+        model.add_layer(&dense1);
+        model.add_layer(&relu);
+        model.add_layer(&dense2);
+        if (runtime)
+        {
+            model.to_device();
+        }
+        else
+        {
+            model.to_host();
+        }
+    }
+
+    RandomMlp(const RandomMlp&) = delete;
+    RandomMlp& operator=(const RandomMlp&) = delete;
+
+    // a host model's result of a {batch, inputs} input
+    std::vector<float> run(const std::vector<float>& input, size_t batch)
+    {
+        Tensor<float> input_tensor, result;
+        input_tensor.set_host_data(input);
+        input_tensor.set_dims({batch, input.size() / batch});
+        result.set_host_data({0.0f});
+        model.execute(&input_tensor, &result);
+        return std::vector<float>(result.data(), result.data() + result.get_size());
+    }
+
+private:
+    void set_parameters(Dense& dense, size_t rows, size_t cols, unsigned seed, const OpenCLRuntime* runtime)
+    {
+        for (const auto& dims : {std::vector<size_t>{rows, cols}, std::vector<size_t>{1, cols}})
+        {
+            const auto data = make_random_data(dims[0] * dims[1], seed++);
+            if (runtime)
+            {
+                parameters.emplace_back(make_device_tensor(runtime, data, dims));
+            }
+            else
+            {
+                parameters.emplace_back(std::make_unique<Tensor<float>>());
+                parameters.back()->set_host_data(data);
+                parameters.back()->set_dims(dims);
+            }
+        }
+        dense.set_weight(parameters[parameters.size() - 2u].get());
+        dense.set_bias(parameters.back().get());
+    }
+};
+
+#endif  // TEST_UTILS_H